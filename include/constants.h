@@ -44,11 +44,35 @@ extern "C"
  */
 #define PATH_SEP '/'
 
+/*
+ * Supported checksum types.
+ */
+#define NULLSUM   0  /* not used...or shouldn't be */
+#define MD5SUM    1
+#define SHA1SUM   2
+#define SHA224SUM 3
+#define SHA256SUM 4
+#define SHA384SUM 5
+#define SHA512SUM 6
+
+/**
+ * @def NUM_CHECKSUMS
+ *
+ * Size of an array indexed by checksum type, see compute_checksums().
+ */
+#define NUM_CHECKSUMS (SHA512SUM + 1)
+
+/**
+ * @def CHECKSUM_BIT
+ *
+ * Bit for the given checksum type in a mask of checksum types.
+ */
+#define CHECKSUM_BIT(type) (1U << (type))
+
 /**
  * @def DEFAULT_MESSAGE_DIGEST
  *
- * Default message digest to use internally.  The definition comes
- * from a macro in rpminspect.h.
+ * Default message digest to use internally.
  */
 #define DEFAULT_MESSAGE_DIGEST SHA256SUM
 
@@ -357,6 +381,15 @@ extern "C"
  */
 #define ABI_HEADERS_DIR2 "--hd2"
 
+/**
+ * @def ABIDIFF_JOB_MEMORY
+ *
+ * Memory in bytes one abidiff(1) run is assumed to need.  The number
+ * of abidiff(1) processes run at once is limited so they fit in the
+ * available memory, see get_memory_limited_processes().
+ */
+#define ABIDIFF_JOB_MEMORY (1024ULL * 1024 * 1024)
+
 /**
  * @def KMIDIFF_CMD
  *
@@ -429,6 +462,69 @@ extern "C"
  */
 #define RPM_X86_ARCH_PATTERN "i?86"
 
+/**
+ * @def KOJI_MULTICALL_SIZE
+ *
+ * Maximum number of calls sent to the Koji hub in a single multiCall
+ * request.
+ */
+#define KOJI_MULTICALL_SIZE 100
+
+/**
+ * @def CMDPOOL_BATCH_SIZE
+ *
+ * Maximum number of files given to a single invocation of an external
+ * validator by cmdpool_add_files().
+ */
+#define CMDPOOL_BATCH_SIZE 64
+
+/**
+ * @def CMD_OUTPUT_READ_SIZE
+ *
+ * Number of bytes read(2) at a time when collecting the output of
+ * an external command.
+ */
+#define CMD_OUTPUT_READ_SIZE 65536
+
+/**
+ * @def FILE_CONTENT_MAX
+ *
+ * Largest payload file get_file_content() maps in to memory, in
+ * bytes.  Larger files are read through their path.
+ */
+#define FILE_CONTENT_MAX (64 * 1024 * 1024)
+
+/**
+ * @def FILE_CONTENT_MAPS
+ *
+ * Number of payload files get_file_content() keeps mapped at once.
+ * The least recently used mapping is released to make room for
+ * another.  Must be at least 2 so two files can be compared.
+ */
+#define FILE_CONTENT_MAPS 128
+
+/**
+ * @def DEFAULT_CACHE_SIZE
+ *
+ * Default size limit of the analysis cache directory in MiB, see
+ * trim_cache().
+ */
+#define DEFAULT_CACHE_SIZE 1024
+
+/**
+ * @def CACHE_DIR_MODE
+ *
+ * Mode of the directories created in the analysis cache.
+ */
+#define CACHE_DIR_MODE (S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH)
+
+/**
+ * @def CACHE_ENTRY_MAX
+ *
+ * Largest result stored in a single analysis cache entry, in bytes.
+ */
+#define CACHE_ENTRY_MAX 65536
+
 /**
  * @def BIN_OWNER
  *
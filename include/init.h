@@ -26,6 +26,8 @@ extern "C"
 #define RI_BIN_OWNER                "bin_owner"
 #define RI_BIN_PATHS                "bin_paths"
 #define RI_BUILDHOST_SUBDOMAIN      "buildhost_subdomain"
+#define RI_CACHE_SIZE               "cache_size"
+#define RI_CACHEDIR                 "cachedir"
 #define RI_CAPABILITIES             "capabilities"
 #define RI_CHANGEDFILES             "changedfiles"
 #define RI_CHANGELOG                "changelog"
@@ -42,6 +44,7 @@ extern "C"
 #define RI_DESKTOP_SKIP_EXEC_CHECK  "skip_exec_check"
 #define RI_DESKTOP_SKIP_ICON_CHECK  "skip_icon_check"
 #define RI_DOC                      "doc"
+#define RI_DOWNLOAD_JOBS            "download_jobs"
 #define RI_DOWNLOAD_MBS             "download_mbs"
 #define RI_DOWNLOAD_URSINE          "download_ursine"
 #define RI_ELF                      "elf"
@@ -55,6 +58,7 @@ extern "C"
 #define RI_EXPECTED_EMPTY           "expected_empty"
 #define RI_EXTRA_ARGS               "extra_args"
 #define RI_EXTRA_OPTS               "extra_opts"
+#define RI_EXTRACT_JOBS             "extract_jobs"
 #define RI_FAILURE_SEVERITY         "failure_severity"
 #define RI_FAVOR_RELEASE            "favor_release"
 #define RI_FILENAME                 "filename"
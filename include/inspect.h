@@ -1031,6 +1031,12 @@ bool inspect_udevrules(struct rpminspect *ri);
  */
 #define INSPECT_UDEVRULES                   (((uint64_t) 1) << 46)
 
+/**
+ * @def ELF_FACTS_INSPECTIONS
+ * Inspections that read ELF files through get_elf_facts().
+ */
+#define ELF_FACTS_INSPECTIONS               (INSPECT_ABIDIFF | INSPECT_BADFUNCS | INSPECT_DEBUGINFO | INSPECT_DSODEPS | INSPECT_ELF | INSPECT_LTO | INSPECT_REMOVEDFILES | INSPECT_RUNPATH)
+
 /** @} */
 
 /**
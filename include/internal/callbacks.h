@@ -31,14 +31,12 @@ typedef struct {
     string_map_t **table;
 } tabledict_cb_data;
 
-/* Context structure for lic_cb() in lib/inspect_license.c. */
+/* Context structure for index_cb() in lib/inspect_license.c. */
 typedef struct {
-    struct rpminspect *ri;
     parser_plugin *p;
     parser_context *db;
-    const char *lic;
-    bool valid;
-} lic_cb_data;
+    struct license_index *index;
+} licdb_cb_data;
 
 #endif /* _LIBRPMINSPECT_CALLBACKS_H */
 
@@ -20,13 +20,14 @@ typedef struct {
     int      exit_status;
     /*int    output_fd; - fd is in pfd[] */
     unsigned output_len;
+    unsigned output_size;  /* allocated size of output */
     char     *output;
 } parallel_slot_t;
 
 typedef struct {
     unsigned running;
     unsigned max_pids;
-    unsigned max_len;
+    unsigned max_len;      /* output limit per slot, 0 for none */
     unsigned ready_fds;
     struct pollfd *pfd;
     parallel_slot_t *slot;
@@ -34,6 +35,9 @@ typedef struct {
 
 extern unsigned default_parallel_processes;
 
+unsigned get_parallel_processes(void);
+void share_parallel_processes(const unsigned shares);
+unsigned get_memory_limited_processes(const unsigned long long per_process);
 parallel_t *new_parallel(int max);
 void delete_parallel(parallel_t *col, int kill_sig);
 
@@ -41,6 +45,38 @@ parallel_slot_t* collect_one(parallel_t *col);
 /* unused yet: parallel_slot_t *collect_until_have_free_slot(parallel_t *col); */
 void insert_new_pid_and_fd(parallel_t *col, pid_t pid, int fd);
 
+/*
+ * Called when a command run through a cmdpool_t finishes.  The
+ * callback owns output (which may be NULL) and may queue more
+ * commands on the same pool.
+ */
+typedef void (*cmdpool_done_fn)(int exitcode, char *output, void *data);
+
+typedef struct {
+    cmdpool_done_fn done;
+    void *data;
+} cmdpool_job_t;
+
+/* jobs[] is indexed the same as col->slot[] */
+typedef struct {
+    parallel_t *col;
+    cmdpool_job_t *jobs;
+} cmdpool_t;
+
+/* exit code and output of one command, see cmdpool_store_result() */
+typedef struct {
+    int exitcode;
+    char *output;
+} cmd_result_t;
+
+/* runcmd.c */
+cmdpool_t *new_cmdpool(const unsigned int max);
+void cmdpool_add(cmdpool_t *pool, const char *workdir, char **argv, cmdpool_done_fn done, void *data);
+void cmdpool_add_files(cmdpool_t *pool, const char *workdir, char **argv, char **files, void **data, const size_t nfiles, cmdpool_done_fn done);
+void cmdpool_store_result(int exitcode, char *output, void *data);
+void cmdpool_wait(cmdpool_t *pool);
+void free_cmdpool(cmdpool_t *pool);
+
 #endif
 
 #ifdef __cplusplus
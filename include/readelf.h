@@ -45,6 +45,61 @@ extern "C"
 
 /** @} */
 
+/**
+ * @defgroup Types
+ *
+ * @{
+ */
+
+/**
+ * @brief One section header of an ELF object.
+ */
+typedef struct _elf_section_t {
+    char *name;                /* section name, may be NULL */
+    GElf_Word type;            /* sh_type */
+    GElf_Xword flags;          /* sh_flags */
+} elf_section_t;
+
+/**
+ * @brief One .dynamic entry of an ELF object.
+ */
+typedef struct _elf_dyn_t {
+    GElf_Sxword tag;           /* d_tag */
+    GElf_Xword val;            /* d_un.d_val */
+    char *str;                 /* d_un.d_ptr resolved in the dynamic
+                                * string table for DT_NEEDED, DT_SONAME,
+                                * DT_RPATH, and DT_RUNPATH; else NULL
+                                */
+} elf_dyn_t;
+
+/**
+ * @brief Facts about an ELF file gathered once and kept with the
+ * rpmfile_entry_t for the rest of the run.
+ *
+ * Several inspections look at the same ELF data for each file (the
+ * section names, dynamic tags, imported symbols, and so on).  Rather
+ * than have each one open the file and walk the ELF structures
+ * again, get_elf_facts() collects everything in a single pass the
+ * first time it is asked for a file.  The .symtab symbols can be
+ * very large, so they are only read on request.
+ */
+typedef struct _elf_facts_t {
+    GElf_Half type;            /* e_type */
+    GElf_Half machine;         /* e_machine */
+    elf_section_t *sections;   /* all section headers */
+    size_t num_sections;
+    GElf_Phdr *phdrs;          /* all program headers */
+    size_t num_phdrs;
+    elf_dyn_t *dyn;            /* all .dynamic entries */
+    size_t num_dyn;
+    char *soname;              /* DT_SONAME, or NULL */
+    string_list_t *imported;   /* .dynsym symbol names */
+    bool have_exported;        /* true once .symtab has been read */
+    string_list_t *exported;   /* .symtab symbol names */
+} elf_facts_t;
+
+/** @} */
+
 /**
  * @defgroup Function Prototypes
  *
@@ -353,6 +408,98 @@ string_list_t *get_elf_imported_functions(Elf *elf, bool (*filter)(const char *)
  */
 string_list_t *get_elf_exported_functions(Elf *elf, bool (*filter)(const char *));
 
+/**
+ * @brief Return the cached ELF facts for a file.
+ *
+ * The first call for a file opens it and collects the ELF header
+ * type and machine, the section headers, program headers, .dynamic
+ * entries, DT_SONAME, and the .dynsym symbol names.  The result is
+ * stored in the rpmfile_entry_t and returned on every later call.
+ * Files that are not ELF files (including ELF archives) return NULL.
+ * The facts are released by free_files().
+ *
+ * @param file The file to read
+ * @return The ELF facts for the file or NULL if it is not ELF
+ */
+const elf_facts_t *get_elf_facts(rpmfile_entry_t *file);
+
+/**
+ * @brief Read the ELF facts of all regular files in the peers.
+ *
+ * Calls get_elf_facts() on every regular file in the before and
+ * after builds, so processes forked afterwards share the results.
+ *
+ * @param peers The peers to read
+ */
+void load_elf_facts(const rpmpeer_t *peers);
+
+/**
+ * @brief Free an elf_facts_t and all member data.
+ *
+ * @param facts The elf_facts_t to free
+ */
+void free_elf_facts(elf_facts_t *facts);
+
+/**
+ * @brief Determine if the ELF facts contain the specified section.
+ *
+ * Same semantics as have_elf_section() but uses the cached section
+ * headers.
+ *
+ * @param facts The ELF facts
+ * @param section The ELF section type (or -1 for unspecified)
+ * @param name The ELF section name (or NULL for unspecified)
+ * @return True if the section exists, false otherwise.
+ */
+bool have_elf_facts_section(const elf_facts_t *facts, int64_t section, const char *name);
+
+/**
+ * @brief Collect all section names after a starting section.
+ *
+ * Same semantics as get_elf_section_names() but uses the cached
+ * section headers.  The caller must free the returned list with
+ * list_free(list, free).
+ *
+ * @param facts The ELF facts
+ * @param start The starting ELF section index
+ * @return List of section names, NULL if none found.
+ */
+string_list_t *get_elf_facts_section_names(const elf_facts_t *facts, size_t start);
+
+/**
+ * @brief Return the strings for the specified dynamic tag.
+ *
+ * Only valid for string valued tags (DT_NEEDED, DT_SONAME, DT_RPATH,
+ * and DT_RUNPATH).  The list elements are copies and the caller must
+ * free the list with list_free(list, free).
+ *
+ * @param facts The ELF facts
+ * @param tag The dynamic tag
+ * @return List of tag values in .dynamic order, NULL if none found.
+ */
+string_list_t *get_elf_facts_tag_strings(const elf_facts_t *facts, const Elf64_Sxword tag);
+
+/**
+ * @brief Return the program header of the given type.
+ *
+ * @param facts The ELF facts
+ * @param type The program header type
+ * @return Pointer to the cached program header or NULL if not found
+ */
+const GElf_Phdr *get_elf_facts_phdr(const elf_facts_t *facts, Elf64_Word type);
+
+/**
+ * @brief Return the .symtab symbol names for the file.
+ *
+ * The .symtab symbols are read the first time this is called for a
+ * file and cached in its ELF facts.  The returned list is owned by
+ * the facts and must not be freed by the caller.
+ *
+ * @param file The file to read
+ * @return List of .symtab symbol names, NULL if none found.
+ */
+const string_list_t *get_elf_facts_exported_functions(rpmfile_entry_t *file);
+
 /**
  * @typedef elf_ar_action
  *
@@ -81,17 +81,6 @@ extern volatile sig_atomic_t terminal_resized;
 #define BEFORE_BUILD 0
 #define AFTER_BUILD  1
 
-/*
- * Supported checksum types.
- */
-#define NULLSUM   0  /* not used...or shouldn't be */
-#define MD5SUM    1
-#define SHA1SUM   2
-#define SHA224SUM 3
-#define SHA256SUM 4
-#define SHA384SUM 5
-#define SHA512SUM 6
-
 /* Common functions */
 
 /* init.c */
@@ -162,6 +151,7 @@ struct koji_task *get_koji_task(struct rpminspect *, const char *);
 string_list_t *get_all_arches(const struct rpminspect *);
 bool allowed_arch(const struct rpminspect *, const char *);
 const char *buildtype_desc(const koji_build_type_t type);
+void free_koji_client(void);
 
 /* kmods.c */
 #ifdef _WITH_LIBKMOD
@@ -179,6 +169,14 @@ int mkdirp(const char *, mode_t);
 /* rmtree.c */
 int rmtree(const char *, const bool, const bool);
 
+/* cache.c */
+bool init_cache(const char *cachedir);
+bool cache_enabled(void);
+char *cache_get(rpmfile_entry_t *file, const char *kind);
+void cache_put(rpmfile_entry_t *file, const char *kind, const char *value);
+void trim_cache(const char *cachedir, const unsigned long size);
+void free_cache(void);
+
 /* strfuncs.c */
 bool strprefix(const char *, const char *);
 bool strsuffix(const char *, const char *);
@@ -229,6 +227,7 @@ const char *get_rpm_header_arch(Header);
 string_list_t *get_rpm_header_string_array(Header h, rpmTagVal tag);
 char *get_rpm_header_string_array_value(const rpmfile_entry_t *file, rpmTag tag);
 uint64_t get_rpm_header_num_array_value(const rpmfile_entry_t *file, rpmTag tag);
+void free_rpm_file_tables(void);
 char *extract_rpm_payload(const char *rpm);
 bool is_debuginfo_rpm(Header hdr);
 bool is_debugsource_rpm(Header hdr);
@@ -256,10 +255,13 @@ int extract_peers(struct rpminspect *ri, bool fetchonly);
 
 /* files.c */
 void free_files(rpmfile_t *files);
-rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const char *subdir, char **output_dir);
+bool write_files(FILE *fp, const char *root, const rpmfile_t *files);
+rpmfile_t *read_files(const char *buf, const size_t len, Header hdr, char **root, bool *ok);
+rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const char *subdir, char **output_dir, const bool contents);
 bool process_file_path(const rpmfile_entry_t *file, regex_t *include_regex, regex_t *exclude_regex);
 void find_file_peers(struct rpminspect *ri, rpmfile_t *before, rpmfile_t *after);
 bool is_debug_or_build_path(const char *path);
+const void *get_file_content(rpmfile_entry_t *file, size_t *len);
 
 /* tty.c */
 size_t tty_width(void);
@@ -270,8 +272,12 @@ results_t *init_results(void);
 void free_results(results_t *);
 void add_result_entry(results_t **, struct result_params *);
 void add_result(struct rpminspect *, struct result_params *);
+const results_summary_t *get_results_summary(const results_t *results, const char *header);
 bool suppressed_results(const results_t *results, const char *header, const severity_t suppress);
 void debug_print_result(const results_entry_t *result);
+bool write_results(FILE *fp, const results_t *results);
+results_t *read_results(const char *buf, const size_t len);
+severity_t merge_results(results_t **dest, results_t *src);
 
 /* output.c */
 const char *format_desc(unsigned int);
@@ -293,15 +299,25 @@ int unpack_archive(const char *, const char *, const bool);
 
 /* magic.c */
 const char *mime_type(struct rpminspect *, const char *);
-const char *get_mime_type(struct rpminspect *, const rpmfile_entry_t *);
+const char *get_mime_type(struct rpminspect *, rpmfile_entry_t *);
 bool is_text_file(struct rpminspect *, rpmfile_entry_t *);
 
 /* checksums.c */
+bool compute_checksums(const char *filename, mode_t *st_mode, const unsigned int types, char **digests);
 char *compute_checksum(const char *, mode_t *, int);
+int get_digest_type(const char *digest);
+char *get_checksum(rpmfile_entry_t *file, const int type);
+bool get_checksums(rpmfile_entry_t *file, const unsigned int types);
+int get_header_checksum_type(const rpmfile_entry_t *file);
+char *get_header_checksum(const rpmfile_entry_t *file);
+bool verify_header_checksum(rpmfile_entry_t *file);
 char *checksum(rpmfile_entry_t *);
+void checksum_files(rpmfile_t *files, const unsigned int types);
 
 /* runcmd.c */
+char *read_cmd_output(int fd, cmd_output_line_fn fn, void *data);
 char *run_cmd_vp(int *exitcode, const char *workdir, char **argv);
+void run_cmd_vp_lines(int *exitcode, const char *workdir, char **argv, cmd_output_line_fn fn, void *data);
 char *run_cmd(int *, const char *, const char *, ...) __attribute__((__sentinel__));
 void free_argv_table(struct rpminspect *ri, string_list_map_t *table);
 char **build_argv(const char *cmd);
@@ -317,7 +333,7 @@ caps_filelist_entry_t *get_caps_entry(struct rpminspect *, const char *, const c
 
 /* permissions.c */
 bool check_ownership(struct rpminspect *, const rpmfile_entry_t *, const char *, bool *, bool);
-bool check_permissions(struct rpminspect *, const rpmfile_entry_t *, const char *, bool *, bool);
+bool check_permissions(struct rpminspect *, rpmfile_entry_t *, const char *, bool *, bool);
 
 /* flags.c */
 bool process_inspection_flag(const char *, const bool, uint64_t *);
@@ -332,6 +348,9 @@ string_list_t *read_file(const char *);
 
 /* io.c */
 ssize_t full_write(int fd, const void *buf, size_t len);
+void write_stream_string(FILE *fp, const char *s);
+bool read_stream_field(void *dest, const size_t size, const char **pos, const char *end);
+bool read_stream_string(char **dest, const char **pos, const char *end);
 
 /* release.c */
 char *read_release(const rpmfile_t *);
@@ -380,6 +399,41 @@ const char *get_debuginfo_path(struct rpminspect *ri, const rpmfile_entry_t *fil
 
 bool usable_path(const char *path);
 bool match_path(const char *pattern, const char *root, const char *path);
+
+/**
+ * @brief Compile a list of glob(7) patterns for path matching.
+ *
+ * The compiled patterns are matched against path strings with
+ * path_matcher_match() using the same rules as match_path(),
+ * including GLOB_BRACE and GLOB_PERIOD behavior, without looking at
+ * the filesystem.
+ *
+ * @param patterns List of glob(7) patterns.
+ * @return Newly allocated path_matcher_t, or NULL for an empty list.
+ *         Free with free_path_matcher().
+ */
+path_matcher_t *compile_path_matcher(const string_list_t *patterns);
+
+/**
+ * @brief Return true if path matches any compiled pattern.
+ *
+ * @param matcher The compiled patterns (NULL matches nothing).
+ * @param path The path to check.
+ * @return True if path matches, false otherwise.
+ */
+bool path_matcher_match(const path_matcher_t *matcher, const char *path);
+void free_path_matcher(path_matcher_t *matcher);
+
+/**
+ * @brief Compile the global and per-inspection ignore lists.
+ *
+ * Called by init_rpminspect() after all configuration files are
+ * read.  Any previously compiled lists are freed first.
+ *
+ * @param ri The struct rpminspect for the program.
+ */
+void compile_ignores(struct rpminspect *ri);
+void free_ignores(struct rpminspect *ri);
 char *find_cmd(const char *cmd);
 
 /**
@@ -388,8 +442,9 @@ char *find_cmd(const char *cmd);
  *
  * @param ri The struct rpminspect for the program.  @param path The
  * relative path to check (i.e., localpath).  @param root The root
- * directory, optional (pass NULL to use '/').  @return True if path
- * should be ignored, false otherwise.
+ * directory, unused since the ignore lists are matched against the
+ * path string.  @return True if path should be ignored, false
+ * otherwise.
  */
 bool ignore_path(const struct rpminspect *ri, const char *inspection, const char *path, const char *root);
 
@@ -422,6 +477,7 @@ char *uncompress_file(struct rpminspect *ri, const char *infile, const char *sub
 
 /* filecmp.c */
 int filecmp(const char *x, const char *y);
+int filecmp_rpmfile(rpmfile_entry_t *x, rpmfile_entry_t *y);
 
 /* abspath.c */
 char *abspath(const char *path);
@@ -429,6 +485,13 @@ char *abspath(const char *path);
 /* diags.c */
 string_list_t *gather_diags(struct rpminspect *ri, const char *progname, const char *progver);
 
+/* ruleindex.c */
+rule_index_t *new_rule_index(const int flags);
+void rule_index_add(rule_index_t *index, const char *pattern, void *data);
+void *rule_index_find(const rule_index_t *index, const char *s);
+size_t rule_index_find_all(const rule_index_t *index, const char *s, void ***matches);
+void free_rule_index(rule_index_t *index);
+
 /* secrule.c */
 security_entry_t *get_secrule_by_path(struct rpminspect *ri, const rpmfile_entry_t *file);
 severity_t get_secrule_result_severity(struct rpminspect *ri, const rpmfile_entry_t *file, const int type);
@@ -476,6 +539,22 @@ unsigned long int get_available_space(const char *path);
  */
 void curl_get_file(const bool verbose, const char *src, const char *dst);
 
+/**
+ * @brief Download a list of files concurrently
+ *
+ * Downloads each file in the list using a single libcurl multi
+ * handle and a shared connection cache.  The key of each pair is the
+ * source URL and the value is the full local destination path.  At
+ * most max transfers run at once; a max of 1 downloads the files one
+ * at a time with curl_get_file().  Destination files are removed for
+ * failed transfers.
+ *
+ * @param verbose True to display download progress
+ * @param files List of source URL and destination path pairs
+ * @param max Maximum number of concurrent transfers
+ */
+void curl_get_files(const bool verbose, const pair_list_t *files, const long max);
+
 /**
  * @brief Get the size of the file at the URL specified
  *
@@ -499,6 +578,13 @@ curl_off_t curl_get_size(const char *src);
  */
 bool is_remote_rpm(const char *url);
 
+/**
+ * @brief Release the connection cache shared by all libcurl handles
+ *
+ * Called when rpminspect is finished with all downloads.
+ */
+void free_curl_share(void);
+
 /* humansize.c */
 /**
  * @brief Return human-readable size for the bytes given.
@@ -531,6 +617,7 @@ string_list_t *read_spec(struct rpminspect *ri, const char *specfile);
 
 /* inspect.c */
 bool has_security_checks(const char *inspection);
+bool need_payload(const struct rpminspect *ri);
 
 #endif
 
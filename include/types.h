@@ -33,6 +33,7 @@ extern "C"
 #include <sys/capability.h>
 #endif
 
+#include "constants.h"
 #include "secrules.h"
 #include "queue.h"
 #include "uthash.h"
@@ -107,7 +108,8 @@ typedef TAILQ_HEAD(regex_entry_s, _regex_entry_t) regex_list_t;
  *
  * cap is the getcap() value for the file.
  *
- * checksum is a string containing the human-readable checksum digest
+ * checksums holds the human-readable checksum digests computed so
+ * far, indexed by checksum type (see get_checksum()).
  *
  * moved_path is true if the file moved path locations between the
  * before and after build, false otherwise
@@ -124,8 +126,8 @@ typedef struct _rpmfile_entry_t {
     mode_t st_mode;
     unsigned st_nlink;
     int idx;
-    char *type;
-    char *checksum;
+    const char *type;              /* MIME type, see get_mime_type() */
+    char *checksums[NUM_CHECKSUMS];
 #ifdef _WITH_LIBCAP
     cap_t cap;
 #endif
@@ -137,6 +139,10 @@ typedef struct _rpmfile_entry_t {
     signed char is_elf_file;
     signed char is_elf_executable;
     signed char is_elf_shared_library;
+    signed char header_checksum_ok;   /* see verify_header_checksum() */
+    struct _elf_facts_t *elf_facts;   /* see get_elf_facts() */
+    void *content;                    /* see get_file_content() */
+    size_t content_len;
     TAILQ_ENTRY(_rpmfile_entry_t) items;
 } rpmfile_entry_t;
 
@@ -286,7 +292,23 @@ typedef struct _results_entry_t {
     TAILQ_ENTRY(_results_entry_t) items;
 } results_entry_t;
 
-typedef TAILQ_HEAD(results_s, _results_entry_t) results_t;
+typedef TAILQ_HEAD(results_s, _results_entry_t) results_list_t;
+
+/*
+ * Per-inspection summary of a results_t, kept up to date as results
+ * are added so formatters do not have to rescan the list.
+ */
+typedef struct _results_summary_t {
+    const char *header;       /* key, header string for reporting */
+    severity_t worst;         /* worst severity reported */
+    unsigned int count;       /* number of results */
+    UT_hash_handle hh;
+} results_summary_t;
+
+typedef struct _results_t {
+    results_list_t entries;       /* results in reporting order */
+    results_summary_t *summary;   /* hash table keyed by header */
+} results_t;
 
 /*
  * Known types of Koji builds
@@ -316,6 +338,7 @@ typedef struct _fileinfo_entry_t {
     char *group;
     char *filename;
     TAILQ_ENTRY(_fileinfo_entry_t) items;
+    UT_hash_handle hh;         /* hashed by filename, first entry wins */
 } fileinfo_entry_t;
 
 typedef TAILQ_HEAD(fileinfo_entry_s, _fileinfo_entry_t) fileinfo_t;
@@ -341,6 +364,7 @@ typedef TAILQ_HEAD(caps_filelist_entry_s, _caps_filelist_entry_t) caps_filelist_
 typedef struct _caps_entry_t {
     char *pkg;
     caps_filelist_t *files;
+    struct _rule_index_t *files_index;  /* files by path pattern */
     TAILQ_ENTRY(_caps_entry_t) items;
 } caps_entry_t;
 
@@ -392,6 +416,7 @@ typedef enum _favor_release_t {
 typedef struct _politics_entry_t {
     char *pattern;
     char *digest;
+    int type;                  /* checksum type of digest, NULLSUM for "*" */
     bool allowed;
     TAILQ_ENTRY(_politics_entry_t) items;
 } politics_entry_t;
@@ -436,6 +461,60 @@ typedef struct _string_list_map_t {
     UT_hash_handle hh;
 } string_list_map_t;
 
+/*
+ * A path glob(7) pattern compiled for matching against path strings
+ * without touching the filesystem.  See match_path() in paths.c.
+ */
+typedef struct _path_glob_t {
+    char *pattern;               /* the pattern as written */
+    char *prefix;                /* directory prefix, for patterns ending
+                                  * in a slash or a slash and asterisk
+                                  */
+    bool leading_dir;            /* pattern ends in '*' or '?' */
+    string_list_t *alternatives; /* GLOB_BRACE expansions of pattern */
+    TAILQ_ENTRY(_path_glob_t) items;
+} path_glob_t;
+
+typedef TAILQ_HEAD(path_glob_s, _path_glob_t) path_glob_list_t;
+
+/* A compiled list of path patterns, see compile_path_matcher(). */
+typedef struct _path_matcher_t {
+    string_hash_t *exact;        /* patterns without glob characters */
+    path_glob_list_t *globs;     /* everything else */
+} path_matcher_t;
+
+/* Hash table with a string key and a path_matcher_t value. */
+typedef struct _path_matcher_map_t {
+    char *key;
+    path_matcher_t *value;
+    UT_hash_handle hh;
+} path_matcher_map_t;
+
+/*
+ * fnmatch(3) patterns indexed for lookups, see ruleindex.c.  Literal
+ * patterns are hashed as-is and globs are hashed by the directory
+ * part of their literal prefix.
+ */
+typedef struct _rule_t {
+    const char *pattern;
+    void *data;
+    size_t order;                /* position the rule was added in */
+} rule_t;
+
+typedef struct _rule_bucket_t {
+    char *key;
+    rule_t *rules;               /* in the order they were added */
+    size_t num;
+    UT_hash_handle hh;
+} rule_bucket_t;
+
+typedef struct _rule_index_t {
+    int flags;                   /* fnmatch(3) flags for the globs */
+    size_t num;                  /* number of rules added */
+    rule_bucket_t *literals;
+    rule_bucket_t *globs;
+} rule_index_t;
+
 /*
  * Security rule actions hash table
  * There is one of these for each row in the vendor security
@@ -512,6 +591,9 @@ struct rpminspect {
     char *profiledir;          /* full path to profiles directory */
     char *remedyfile;          /* full path to remedy strings override file */
     char *worksubdir;          /* within workdir, where these builds go */
+    unsigned int extract_jobs; /* max concurrent package extractions */
+    char *cachedir;            /* analysis cache directory, see cache.c */
+    unsigned long cache_size;  /* analysis cache size limit in MiB */
 
     /* Commands */
     struct command_paths commands;
@@ -527,16 +609,20 @@ struct rpminspect {
     /* Populated at runtime for the product release */
     char *fileinfo_filename;
     fileinfo_t *fileinfo;
+    fileinfo_entry_t *fileinfo_table;  /* fileinfo hashed by filename */
     caps_t *caps;
+    rule_index_t *caps_index;          /* caps by package pattern */
     char *caps_filename;
     string_list_t *rebaseable;
     char *rebaseable_filename;
     politics_list_t *politics;
+    rule_index_t *politics_index;      /* politics by path pattern */
     char *politics_filename;
     security_list_t *security;
+    rule_index_t *security_index;      /* security by path pattern */
     char *security_filename;
     bool security_initialized;
-    string_list_t *icons;
+    string_hash_t *icons;
     char *icons_filename;
     bool librpm_initialized;
 
@@ -544,6 +630,7 @@ struct rpminspect {
     char *kojihub;             /* URL of Koji hub */
     char *kojiursine;          /* URL to access packages built in Koji */
     char *kojimbs;             /* URL to access module packages in Koji */
+    unsigned int download_jobs; /* max concurrent package downloads */
 
     /* Information used by different tests */
     string_list_t *badwords;   /* Space-delimited list of words prohibited
@@ -722,6 +809,13 @@ struct rpminspect {
      */
     string_list_map_t *inspection_ignores;
 
+    /*
+     * the ignores and inspection_ignores compiled once the
+     * configuration is loaded, used by ignore_path()
+     */
+    path_matcher_t *ignore_matcher;
+    path_matcher_map_t *inspection_ignore_matchers;
+
     /* Optional list of expected RPMs with empty payloads */
     string_list_t *expected_empty_rpms;
 
@@ -856,6 +950,14 @@ struct inspect {
      */
     bool single_build;
 
+    /*
+     * Does this inspection read the contents of files in the
+     * packages?  Inspections that only look at the package headers
+     * and file lists set this to false.  If none of the selected
+     * inspections need the payload, it is not written to disk.
+     */
+    bool payload;
+
     /* the driver function for the inspection */
     bool (*driver)(struct rpminspect *);
 };
@@ -1063,13 +1165,6 @@ typedef struct _koji_task_entry_t {
     TAILQ_ENTRY(_koji_task_entry_t) items;
 } koji_task_entry_t;
 
-/* Types of files -- used by internal nftw() callbacks */
-typedef enum _filetype_t {
-    FILETYPE_NULL = 0,
-    FILETYPE_EXECUTABLE = 1,
-    FILETYPE_ICON = 2
-} filetype_t;
-
 /* Kernel module handling */
 #ifdef _WITH_LIBKMOD
 
@@ -1107,6 +1202,15 @@ typedef enum _workdir_t {
  */
 typedef bool (*foreach_peer_file_func)(struct rpminspect *, rpmfile_entry_t *);
 
+/**
+ * @brief Callback function to pass to run_cmd_vp_lines().
+ *
+ * Called with each line of output from the command as it is read,
+ * without the trailing newline, and the data pointer given to
+ * run_cmd_vp_lines().  The line is only valid during the call.
+ */
+typedef void (*cmd_output_line_fn)(const char *, void *);
+
 /* Types of ELF information we can return */
 typedef enum _elfinfo_t {
     ELF_TYPE    = 0,
@@ -26,6 +26,7 @@
 #include <err.h>
 #include <rpm/rpmlib.h>
 #include "parser.h"
+#include "parallel.h"
 #include "rpminspect.h"
 
 /* Local global variables */
@@ -40,6 +41,8 @@ static char *build_desc[] = { "before", "after" };
 /* Local prototypes */
 static void set_worksubdir(struct rpminspect *, workdir_t, const struct koji_build *, const struct koji_task *);
 static void get_rpm_info(const char *);
+static bool queue_download(pair_list_t **, const char *, const char *);
+static void get_downloads(pair_list_t *);
 static void prune_local(const int);
 static int copytree(const char *, const struct stat *, int, struct FTW *);
 static int download_build(struct rpminspect *, const struct koji_build *);
@@ -111,6 +114,61 @@ static void get_rpm_info(const char *pkg)
     return;
 }
 
+/*
+ * Add a package to the list of files to download.  Returns false if
+ * the destination is already in the list.
+ */
+static bool queue_download(pair_list_t **downloads, const char *src, const char *dst)
+{
+    pair_entry_t *pair = NULL;
+
+    assert(downloads != NULL);
+    assert(src != NULL);
+    assert(dst != NULL);
+
+    if (*downloads == NULL) {
+        *downloads = xalloc(sizeof(**downloads));
+        TAILQ_INIT(*downloads);
+    }
+
+    TAILQ_FOREACH(pair, *downloads, items) {
+        if (!strcmp(pair->value, dst)) {
+            return false;
+        }
+    }
+
+    pair = xalloc(sizeof(*pair));
+    pair->key = strdup(src);
+    assert(pair->key != NULL);
+    pair->value = strdup(dst);
+    assert(pair->value != NULL);
+    TAILQ_INSERT_TAIL(*downloads, pair, items);
+    return true;
+}
+
+/*
+ * Download all of the queued packages at once and then collect the
+ * package peer information for each in the order they were queued.
+ */
+static void get_downloads(pair_list_t *downloads)
+{
+    long max = 0;
+    pair_entry_t *pair = NULL;
+
+    if (downloads == NULL) {
+        return;
+    }
+
+    max = workri->download_jobs ? workri->download_jobs : get_parallel_processes();
+    curl_get_files(workri->verbose, downloads, max);
+
+    TAILQ_FOREACH(pair, downloads, items) {
+        get_rpm_info(pair->value);
+    }
+
+    return;
+}
+
 /*
  * Walk a local build tree and prune empty arch subdirectories.
  */
@@ -275,6 +333,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
     parser_plugin *p = &yaml_parser;
     parser_context *ctx = NULL;
     string_list_t *filter = NULL;
+    pair_list_t *downloads = NULL;
 
     assert(build != NULL);
     assert(build->builds != NULL);
@@ -359,6 +418,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
 
             if (mkdirp(dst, mode)) {
                 free(dst);
+                free_pair(downloads);
                 return -1;
             }
 
@@ -373,6 +433,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
                 if (p->parse_file(&ctx, dst)) {
                     warnx(_("*** ignoring malformed module metadata file: %s"), dst);
                     free(dst);
+                    free_pair(downloads);
                     return -1;
                 }
 
@@ -384,6 +445,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
                     warnx(_("*** malformed rpm filters in file: %s"), dst);
                     list_free(filter, free);
                     free(dst);
+                    free_pair(downloads);
                     return -1;
                 }
 
@@ -410,6 +472,8 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
 
             if (mkdirp(dst, mode)) {
                 free(dst);
+                list_free(filter, free);
+                free_pair(downloads);
                 return -1;
             }
 
@@ -465,11 +529,8 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
                       rpm->arch,
                       pkg);
 
-            /* download the package */
-            curl_get_file(workri->verbose, src, dst);
-
-            /* gather the RPM header */
-            get_rpm_info(dst);
+            /* queue the package for download */
+            queue_download(&downloads, src, dst);
 
             /* start over */
             free(src);
@@ -481,6 +542,10 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
         filter = NULL;
     }
 
+    /* download the packages and gather the RPM headers */
+    get_downloads(downloads);
+    free_pair(downloads);
+
     return RI_SUCCESS;
 }
 
@@ -504,6 +569,7 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
     char *tail = NULL;
     koji_task_entry_t *descendent = NULL;
     string_entry_t *entry = NULL;
+    pair_list_t *downloads = NULL;
 
     assert(ri != NULL);
     assert(task != NULL);
@@ -616,6 +682,7 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
 
         if (mkdirp(dst, mode)) {
             free(dst);
+            free_pair(downloads);
             return -1;
         }
 
@@ -634,6 +701,7 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
 
                 if (mkdirp(dst, mode)) {
                     free(dst);
+                    free_pair(downloads);
                     return -1;
                 }
 
@@ -647,17 +715,12 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
                 xasprintf(&src, "%s/work/%s", workri->kojiursine, entry->data);
 
                 /* skip if we already have this one */
-                if (access(dst, F_OK | R_OK) == 0) {
+                if (access(dst, F_OK | R_OK) == 0 || !queue_download(&downloads, src, dst)) {
                     sz = curl_get_size(src);
 
                     if (sz < 0) {
                         task->total_size -= sz;
                     }
-                } else {
-                    curl_get_file(workri->verbose, src, dst);
-
-                    /* gather the RPM header */
-                    get_rpm_info(dst);
                 }
 
                 free(dst);
@@ -680,16 +743,16 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
             }
 
             xasprintf(&src, "%s/work/%s", workri->kojiursine, entry->data);
-            curl_get_file(workri->verbose, src, dst);
-
-            /* gather the RPM header */
-            get_rpm_info(dst);
-
+            queue_download(&downloads, src, dst);
             free(dst);
             free(src);
         }
     }
 
+    /* download the packages and gather the RPM headers */
+    get_downloads(downloads);
+    free_pair(downloads);
+
     return RI_SUCCESS;
 }
 
@@ -0,0 +1,317 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+#include <err.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "rpminspect.h"
+
+/*
+ * Persistent analysis cache.
+ *
+ * Results that only depend on the contents of a file (MIME type,
+ * checksums, ELF classification) are stored in a directory tree so
+ * later runs over the same packages can skip the work.  Entries are
+ * keyed on the file digest from the package header and live in:
+ *
+ *     CACHEDIR/PACKAGE_VERSION/KIND/XX/DIGEST
+ *
+ * where KIND names the result and includes anything else the result
+ * depends on (e.g. the libmagic version) and XX is the start of the
+ * digest to keep directories small.  Each entry holds the result as
+ * a string.  Entries are written to a temporary file and renamed in
+ * place, so concurrent inspections and runs never see partial
+ * entries.  Reading an entry updates its modification time and
+ * trim_cache() removes the least recently used entries once the
+ * cache grows beyond its size limit.
+ *
+ * A package can declare any digest it likes for a file, so the
+ * header digest is only used as a key once it has been checked
+ * against the extracted file (see verify_header_checksum()).
+ * Otherwise a crafted package could borrow the cached results of a
+ * different, harmless file.
+ */
+
+/* Directory for entries from this version of rpminspect */
+static char *cache_root = NULL;
+
+/* Used by trim_cache() */
+struct cache_file {
+    char *path;
+    off_t size;
+    time_t mtime;
+};
+
+static struct cache_file *cache_files = NULL;
+static size_t num_cache_files = 0;
+static unsigned long long cache_total = 0;
+
+/*
+ * Enable the analysis cache in the given directory.  Returns false
+ * and leaves the cache disabled if the directory cannot be used.
+ */
+bool init_cache(const char *cachedir)
+{
+    free_cache();
+
+    if (cachedir == NULL) {
+        return false;
+    }
+
+    xasprintf(&cache_root, "%s/%s", cachedir, PACKAGE_VERSION);
+    assert(cache_root != NULL);
+
+    if (mkdirp(cache_root, CACHE_DIR_MODE)) {
+        warnx(_("*** unable to use cache directory %s, continuing without it"), cachedir);
+        free_cache();
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Returns true if the analysis cache is in use.
+ */
+bool cache_enabled(void)
+{
+    return (cache_root != NULL);
+}
+
+/*
+ * Return the path to the cache entry of the given kind for file, or
+ * NULL if the cache is disabled or the file has no digest in the
+ * package header that matches the extracted file.  Caller must free
+ * the returned string.
+ */
+static char *cache_path(rpmfile_entry_t *file, const char *kind)
+{
+    char *key = NULL;
+    char *path = NULL;
+
+    assert(file != NULL);
+    assert(kind != NULL);
+
+    if (cache_root == NULL || !verify_header_checksum(file)) {
+        return NULL;
+    }
+
+    key = get_header_checksum(file);
+
+    if (key == NULL || strlen(key) < 2) {
+        free(key);
+        return NULL;
+    }
+
+    xasprintf(&path, "%s/%s/%.2s/%s", cache_root, kind, key, key);
+    assert(path != NULL);
+    free(key);
+    return path;
+}
+
+/*
+ * Look up the cached result of the given kind for file.  Returns
+ * NULL if there is none.  Caller must free the returned string.
+ */
+char *cache_get(rpmfile_entry_t *file, const char *kind)
+{
+    int fd = -1;
+    ssize_t len = 0;
+    struct stat sb;
+    char *path = NULL;
+    char *value = NULL;
+
+    path = cache_path(file, kind);
+
+    if (path == NULL) {
+        return NULL;
+    }
+
+    fd = open(path, O_RDONLY);
+    free(path);
+
+    if (fd == -1) {
+        return NULL;
+    }
+
+    if (fstat(fd, &sb) == 0 && sb.st_size > 0 && sb.st_size <= CACHE_ENTRY_MAX) {
+        value = xalloc(sb.st_size + 1);
+        len = read(fd, value, sb.st_size);
+
+        if (len != sb.st_size) {
+            free(value);
+            value = NULL;
+        } else {
+            /* keep recently used entries around, see trim_cache() */
+            (void) futimens(fd, NULL);
+        }
+    }
+
+    if (close(fd) == -1) {
+        warn("*** close");
+    }
+
+    return value;
+}
+
+/*
+ * Store a result of the given kind for file in the cache.  Does
+ * nothing if the cache is disabled.  Failures are not fatal, the
+ * result just is not cached.
+ */
+void cache_put(rpmfile_entry_t *file, const char *kind, const char *value)
+{
+    int fd = -1;
+    size_t len = 0;
+    bool ok = false;
+    char *path = NULL;
+    char *tmp = NULL;
+    char *dir = NULL;
+
+    if (value == NULL) {
+        return;
+    }
+
+    path = cache_path(file, kind);
+
+    if (path == NULL) {
+        return;
+    }
+
+    len = strlen(value);
+
+    if (len == 0 || len > CACHE_ENTRY_MAX) {
+        free(path);
+        return;
+    }
+
+    xasprintf(&tmp, "%s.XXXXXX", path);
+    assert(tmp != NULL);
+    fd = mkstemp(tmp);
+
+    if (fd == -1 && errno == ENOENT) {
+        /* first entry in this directory */
+        dir = strdup(path);
+        assert(dir != NULL);
+        *strrchr(dir, PATH_SEP) = '\0';
+
+        if (mkdirp(dir, CACHE_DIR_MODE) == 0) {
+            /* mkstemp(3) does not leave the template intact on failure */
+            free(tmp);
+            xasprintf(&tmp, "%s.XXXXXX", path);
+            assert(tmp != NULL);
+            fd = mkstemp(tmp);
+        }
+
+        free(dir);
+    }
+
+    if (fd != -1) {
+        ok = (write(fd, value, len) == (ssize_t) len);
+
+        if (close(fd) == -1) {
+            ok = false;
+        }
+
+        if (!ok || rename(tmp, path) == -1) {
+            (void) unlink(tmp);
+        }
+    }
+
+    free(tmp);
+    free(path);
+    return;
+}
+
+static int collect_cache_file(const char *fpath, const struct stat *sb, int tflag, __attribute__((unused)) struct FTW *ftwbuf)
+{
+    struct cache_file *entry = NULL;
+
+    if (tflag != FTW_F) {
+        return 0;
+    }
+
+    cache_files = xrealloc(cache_files, (num_cache_files + 1) * sizeof(*cache_files));
+    entry = &cache_files[num_cache_files++];
+    entry->path = strdup(fpath);
+    assert(entry->path != NULL);
+    entry->size = sb->st_blocks * 512;
+    entry->mtime = sb->st_mtime;
+    cache_total += entry->size;
+
+    return 0;
+}
+
+static int cmp_cache_files(const void *a, const void *b)
+{
+    const struct cache_file *x = a;
+    const struct cache_file *y = b;
+
+    if (x->mtime < y->mtime) {
+        return -1;
+    } else if (x->mtime > y->mtime) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Keep the cache directory below size MiB by removing the least
+ * recently used entries, including those left by other versions of
+ * rpminspect.  A size of 0 means no limit.
+ */
+void trim_cache(const char *cachedir, const unsigned long size)
+{
+    size_t i = 0;
+    unsigned long long limit = 0;
+
+    if (cachedir == NULL || size == 0) {
+        return;
+    }
+
+    limit = (unsigned long long) size * 1024 * 1024;
+    cache_total = 0;
+
+    if (nftw(cachedir, collect_cache_file, FOPEN_MAX, FTW_MOUNT | FTW_PHYS) == -1) {
+        warn("*** nftw");
+    }
+
+    if (cache_total > limit) {
+        qsort(cache_files, num_cache_files, sizeof(*cache_files), cmp_cache_files);
+
+        for (i = 0; i < num_cache_files && cache_total > limit; i++) {
+            if (unlink(cache_files[i].path) == 0) {
+                cache_total -= cache_files[i].size;
+            }
+        }
+    }
+
+    for (i = 0; i < num_cache_files; i++) {
+        free(cache_files[i].path);
+    }
+
+    free(cache_files);
+    cache_files = NULL;
+    num_cache_files = 0;
+    return;
+}
+
+/* Disable the cache, this does not remove the cache directory */
+void free_cache(void)
+{
+    free(cache_root);
+    cache_root = NULL;
+    return;
+}
@@ -35,8 +35,10 @@
 #define OPENSSL_API_COMPAT 0x101010bfL
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
@@ -45,40 +47,178 @@
 #include <assert.h>
 #include <openssl/md5.h>
 #include <openssl/sha.h>
+#include <rpm/rpmtd.h>
+#include <rpm/rpmpgp.h>
 
 #include "rpminspect.h"
+#include "parallel.h"
+
+/* Read size for files that cannot be mapped in to memory. */
+#define CHECKSUM_READ_SIZE (1024 * 1024)
+
+/* Contexts for every checksum type computed in one pass over a file. */
+struct checksum_ctx {
+    unsigned int types;
+    MD5_CTX md5c;
+    SHA_CTX sha1c;
+    SHA256_CTX sha224c;
+    SHA256_CTX sha256c;
+    SHA512_CTX sha384c;
+    SHA512_CTX sha512c;
+};
+
+static void init_checksum_ctx(struct checksum_ctx *ctx, const unsigned int types)
+{
+    assert(ctx != NULL);
+
+    ctx->types = types;
+
+    if (types & CHECKSUM_BIT(MD5SUM)) {
+        MD5_Init(&ctx->md5c);
+    }
+
+    if (types & CHECKSUM_BIT(SHA1SUM)) {
+        SHA1_Init(&ctx->sha1c);
+    }
+
+    if (types & CHECKSUM_BIT(SHA224SUM)) {
+        SHA224_Init(&ctx->sha224c);
+    }
+
+    if (types & CHECKSUM_BIT(SHA256SUM)) {
+        SHA256_Init(&ctx->sha256c);
+    }
+
+    if (types & CHECKSUM_BIT(SHA384SUM)) {
+        SHA384_Init(&ctx->sha384c);
+    }
+
+    if (types & CHECKSUM_BIT(SHA512SUM)) {
+        SHA512_Init(&ctx->sha512c);
+    }
+
+    return;
+}
+
+static void update_checksum_ctx(struct checksum_ctx *ctx, const void *buf, const size_t len)
+{
+    assert(ctx != NULL);
+
+    if (ctx->types & CHECKSUM_BIT(MD5SUM)) {
+        MD5_Update(&ctx->md5c, buf, len);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA1SUM)) {
+        SHA1_Update(&ctx->sha1c, buf, len);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA224SUM)) {
+        SHA224_Update(&ctx->sha224c, buf, len);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA256SUM)) {
+        SHA256_Update(&ctx->sha256c, buf, len);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA384SUM)) {
+        SHA384_Update(&ctx->sha384c, buf, len);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA512SUM)) {
+        SHA512_Update(&ctx->sha512c, buf, len);
+    }
+
+    return;
+}
+
+/* Return the human-readable form of a binary digest, caller must free. */
+static char *digest_string(const unsigned char *digest, const size_t len)
+{
+    size_t i = 0;
+    char *ret = NULL;
+
+    ret = xcalloc((len * 2) + 1, sizeof(char));
+
+    for (i = 0; i < len; i++) {
+        sprintf(&ret[i * 2], "%02x", (unsigned int) digest[i]);
+    }
+
+    return ret;
+}
+
+static void final_checksum_ctx(struct checksum_ctx *ctx, char **digests)
+{
+    unsigned char digest[SHA512_DIGEST_LENGTH];
+
+    assert(ctx != NULL);
+    assert(digests != NULL);
+
+    if (ctx->types & CHECKSUM_BIT(MD5SUM)) {
+        MD5_Final(digest, &ctx->md5c);
+        digests[MD5SUM] = digest_string(digest, MD5_DIGEST_LENGTH);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA1SUM)) {
+        SHA1_Final(digest, &ctx->sha1c);
+        digests[SHA1SUM] = digest_string(digest, SHA_DIGEST_LENGTH);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA224SUM)) {
+        SHA224_Final(digest, &ctx->sha224c);
+        digests[SHA224SUM] = digest_string(digest, SHA224_DIGEST_LENGTH);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA256SUM)) {
+        SHA256_Final(digest, &ctx->sha256c);
+        digests[SHA256SUM] = digest_string(digest, SHA256_DIGEST_LENGTH);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA384SUM)) {
+        SHA384_Final(digest, &ctx->sha384c);
+        digests[SHA384SUM] = digest_string(digest, SHA384_DIGEST_LENGTH);
+    }
+
+    if (ctx->types & CHECKSUM_BIT(SHA512SUM)) {
+        SHA512_Final(digest, &ctx->sha512c);
+        digests[SHA512SUM] = digest_string(digest, SHA512_DIGEST_LENGTH);
+    }
+
+    return;
+}
 
 /**
- * @brief Take in a file, return a checksum.
+ * @brief Take in a file, compute one or more checksums in one pass.
  *
- * Given a file, its **mode_t**, and a valid checksum type, compute
- * the checksum and return the human-readable digest string for that
- * checksum.  This function allocates memory for the string and the
- * caller must free it when done.
+ * Given a file, its **mode_t**, and a mask of checksum types (see
+ * CHECKSUM_BIT()), read the file once and store the human-readable
+ * digest string for each requested type in digests[type].  The
+ * digests array must have NUM_CHECKSUMS entries.  Regular files are
+ * mapped in to memory, anything else is read in large blocks.  The
+ * caller must free the strings stored in digests.
  *
  * @param filename Filename the function should use.
  * @param st_mode The **mode_t** for the specified file, gathered from **stat(2)**.
- * @param type Which checksum type to calculate.
- * @note Caller must free returned string when done.
- * @return String containing the human-readable checksum digest, or NULL on failure.
+ * @param types Mask of checksum types to calculate.
+ * @param digests Array of NUM_CHECKSUMS strings to fill in.
+ * @return True on success, false on failure.
  */
-char *compute_checksum(const char *filename, mode_t *st_mode, int type)
+bool compute_checksums(const char *filename, mode_t *st_mode, const unsigned int types, char **digests)
 {
     struct stat sb;
     mode_t *mode = NULL;
-    unsigned char buf[BUFSIZ];
-    int input, len, i;
-    char *ret = NULL;
-    unsigned char digest[BUFSIZ];
-    MD5_CTX md5c;
-    SHA_CTX sha1c;
-    SHA256_CTX sha256c;
-    SHA512_CTX sha512c;
+    int input = -1;
+    ssize_t len = 0;
+    unsigned char *buf = NULL;
+    void *map = MAP_FAILED;
+    struct checksum_ctx ctx;
+
+    assert(filename != NULL);
+    assert(digests != NULL);
 
     /* if the user did not provide a mode_t, get it */
     if (st_mode == NULL) {
         if (lstat(filename, &sb) != 0) {
-            return NULL;
+            return false;
         }
 
         mode = &sb.st_mode;
@@ -89,112 +229,367 @@ char *compute_checksum(const char *filename, mode_t *st_mode, int type)
     /* don't calculate the checksum of a device node */
     if (S_ISCHR(*mode) || S_ISBLK(*mode) || S_ISFIFO(*mode) || S_ISSOCK(*mode)) {
         warnx(_("*** %s is a FIFO"), filename);
-        return NULL;
+        return false;
     }
 
-    /*
-     * This holds all possible digest type computations.  if any future digest
-     * is larger than BUFSIZ, hopefully we update this and get faster systems.
-     */
-    memset(&buf, '\0', BUFSIZ);
-    memset(&digest, '\0', BUFSIZ);
-
-    /* Initialize the correct context based on the checksum type. */
-    if (type == MD5SUM) {
-        MD5_Init(&md5c);
-    } else if (type == SHA1SUM) {
-        SHA1_Init(&sha1c);
-    } else if (type == SHA224SUM || type == SHA256SUM) {
-        SHA256_Init(&sha256c);
-    } else if (type == SHA384SUM || type == SHA512SUM) {
-        SHA512_Init(&sha512c);
-    }
-
-    /* read in the file to generate the requested checksum */
+    /* read in the file to generate the requested checksums */
     input = open(filename, O_RDONLY);
 
     if (input == -1) {
         warn("*** open");
-        return NULL;
+        return false;
     }
 
-    len = read(input, buf, sizeof(buf));
-
-    if (len == -1) {
-        warn("*** read");
+    if (fstat(input, &sb) == -1) {
+        warn("*** fstat");
 
         if (close(input) == -1) {
             warn("*** close");
         }
 
-        return NULL;
+        return false;
+    }
+
+    init_checksum_ctx(&ctx, types);
+
+    if (S_ISREG(sb.st_mode) && sb.st_size > 0) {
+        map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, input, 0);
     }
 
-    while (len > 0) {
-        /* update the correct context based on the checksum type */
-        if (type == MD5SUM) {
-            MD5_Update(&md5c, buf, len);
-        } else if (type == SHA1SUM) {
-            SHA1_Update(&sha1c, buf, len);
-        } else if (type == SHA224SUM || type == SHA256SUM) {
-            SHA256_Update(&sha256c, buf, len);
-        } else if (type == SHA384SUM || type == SHA512SUM) {
-            SHA512_Update(&sha512c, buf, len);
+    if (map != MAP_FAILED) {
+        (void) madvise(map, sb.st_size, MADV_SEQUENTIAL);
+        update_checksum_ctx(&ctx, map, sb.st_size);
+
+        if (munmap(map, sb.st_size) == -1) {
+            warn("*** munmap");
         }
+    } else {
+        buf = xalloc(CHECKSUM_READ_SIZE);
 
-        len = read(input, buf, sizeof(buf));
+        while ((len = read(input, buf, CHECKSUM_READ_SIZE)) != 0) {
+            if (len == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
 
-        if (len == -1) {
-            warn("*** read");
+                warn("*** read");
+                free(buf);
 
-            if (close(input) == -1) {
-                warn("*** close");
+                if (close(input) == -1) {
+                    warn("*** close");
+                }
+
+                return false;
             }
 
-            return NULL;
+            update_checksum_ctx(&ctx, buf, len);
         }
+
+        free(buf);
     }
 
     if (close(input) == -1) {
         warn("*** close");
+        return false;
+    }
+
+    final_checksum_ctx(&ctx, digests);
+    return true;
+}
+
+/*
+ * Like compute_checksums() for a payload file, but hashing the
+ * contents from get_file_content() when the file is mapped so
+ * checksums and comparisons of the same file share one read.
+ */
+static bool compute_file_checksums(rpmfile_entry_t *file, const unsigned int types, char **digests)
+{
+    const void *content = NULL;
+    size_t len = 0;
+    struct checksum_ctx ctx;
+
+    content = get_file_content(file, &len);
+
+    if (content == NULL) {
+        return compute_checksums(file->fullpath, &file->st_mode, types, digests);
+    }
+
+    init_checksum_ctx(&ctx, types);
+    update_checksum_ctx(&ctx, content, len);
+    final_checksum_ctx(&ctx, digests);
+    return true;
+}
+
+/**
+ * @brief Take in a file, return a checksum.
+ *
+ * Given a file, its **mode_t**, and a valid checksum type, compute
+ * the checksum and return the human-readable digest string for that
+ * checksum.  This function allocates memory for the string and the
+ * caller must free it when done.
+ *
+ * @param filename Filename the function should use.
+ * @param st_mode The **mode_t** for the specified file, gathered from **stat(2)**.
+ * @param type Which checksum type to calculate.
+ * @note Caller must free returned string when done.
+ * @return String containing the human-readable checksum digest, or NULL on failure.
+ */
+char *compute_checksum(const char *filename, mode_t *st_mode, int type)
+{
+    char *digests[NUM_CHECKSUMS] = { NULL };
+
+    assert(type > NULLSUM && type < NUM_CHECKSUMS);
+
+    if (!compute_checksums(filename, st_mode, CHECKSUM_BIT(type), digests)) {
         return NULL;
     }
 
-    /* finalize the correct context type and determine the loop length */
-    if (type == MD5SUM) {
-        MD5_Final(digest, &md5c);
-    } else if (type == SHA1SUM) {
-        SHA1_Final(digest, &sha1c);
-    } else if (type == SHA224SUM || type == SHA256SUM) {
-        SHA256_Final(digest, &sha256c);
-    } else if (type == SHA384SUM || type == SHA512SUM) {
-        SHA512_Final(digest, &sha512c);
+    return digests[type];
+}
+
+/**
+ * @brief Return the checksum type of a human-readable digest string.
+ *
+ * The type is guessed from the length of the string, which is
+ * distinct for each supported checksum type.
+ *
+ * @param digest The human-readable digest string.
+ * @return The checksum type, or NULLSUM if the length is unknown.
+ */
+int get_digest_type(const char *digest)
+{
+    size_t len = 0;
+
+    assert(digest != NULL);
+
+    len = strlen(digest);
+
+    if (len == (MD5_DIGEST_LENGTH * 2)) {
+        return MD5SUM;
+    } else if (len == (SHA_DIGEST_LENGTH * 2)) {
+        return SHA1SUM;
+    } else if (len == (SHA224_DIGEST_LENGTH * 2)) {
+        return SHA224SUM;
+    } else if (len == (SHA256_DIGEST_LENGTH * 2)) {
+        return SHA256SUM;
+    } else if (len == (SHA384_DIGEST_LENGTH * 2)) {
+        return SHA384SUM;
+    } else if (len == (SHA512_DIGEST_LENGTH * 2)) {
+        return SHA512SUM;
+    }
+
+    return NULLSUM;
+}
+
+/*
+ * Map the RPMTAG_FILEDIGESTALGO of a package to our checksum type.
+ * Packages without the tag use MD5.  Returns NULLSUM for algorithms
+ * we do not compute.
+ */
+static int header_checksum_type(Header h)
+{
+    assert(h != NULL);
+
+    switch (headerGetNumber(h, RPMTAG_FILEDIGESTALGO)) {
+        case 0:
+        case PGPHASHALGO_MD5:
+            return MD5SUM;
+        case PGPHASHALGO_SHA1:
+            return SHA1SUM;
+        case PGPHASHALGO_SHA224:
+            return SHA224SUM;
+        case PGPHASHALGO_SHA256:
+            return SHA256SUM;
+        case PGPHASHALGO_SHA384:
+            return SHA384SUM;
+        case PGPHASHALGO_SHA512:
+            return SHA512SUM;
+        default:
+            return NULLSUM;
     }
+}
 
-    if (type == MD5SUM) {
-        len = MD5_DIGEST_LENGTH;
-    } else if (type == SHA1SUM) {
-        len = SHA_DIGEST_LENGTH;
-    } else if (type == SHA224SUM) {
-        len = SHA224_DIGEST_LENGTH;
-    } else if (type == SHA256SUM) {
-        len = SHA256_DIGEST_LENGTH;
-    } else if (type == SHA384SUM) {
-        len = SHA384_DIGEST_LENGTH;
-    } else if (type == SHA512SUM) {
-        len = SHA512_DIGEST_LENGTH;
+/**
+ * @brief Return the checksum type of the file digest the package
+ * header carries for the given file.
+ *
+ * Only regular files have a digest in the header.  get_checksum()
+ * returns digests of this type without reading the file.
+ *
+ * @param file The **rpmfile_entry_t** specifying the file to use.
+ * @return The checksum type, or NULLSUM if there is no usable digest.
+ */
+int get_header_checksum_type(const rpmfile_entry_t *file)
+{
+    assert(file != NULL);
+
+    if (file->rpm_header == NULL || file->idx < 0 || !S_ISREG(file->st_mode)) {
+        return NULLSUM;
     }
 
-    /* this is our human readable digest, caller must free */
-    ret = xcalloc(len + 1, sizeof(char *));
+    return header_checksum_type(file->rpm_header);
+}
 
-    for (i = 0; i < len; ++i) {
-        sprintf(&ret[i*2], "%02x", (unsigned int) digest[i]);
+/**
+ * @brief Return the file digest the package header carries for the
+ * given file.
+ *
+ * The file itself is never read.  The type of the digest is given by
+ * get_header_checksum_type().
+ *
+ * @param file The **rpmfile_entry_t** specifying the file to use.
+ * @note Caller must free returned string when done.
+ * @return String containing the human-readable checksum digest, or
+ *         NULL if the header has no digest for the file.
+ */
+char *get_header_checksum(const rpmfile_entry_t *file)
+{
+    char *ret = NULL;
+
+    assert(file != NULL);
+
+    if (get_header_checksum_type(file) == NULLSUM) {
+        return NULL;
+    }
+
+    /* the digests are decoded once per package */
+    ret = get_rpm_header_string_array_value(file, RPMTAG_FILEDIGESTS);
+
+    if (ret != NULL && *ret == '\0') {
+        free(ret);
+        ret = NULL;
     }
 
     return ret;
 }
 
+/*
+ * Helper for verify_header_checksum() and checksum_files().  Record
+ * whether the digest computed from the extracted file matches the
+ * one in the package header.
+ */
+static void check_header_checksum(rpmfile_entry_t *file, const char *computed)
+{
+    char *header = NULL;
+
+    header = get_header_checksum(file);
+    file->header_checksum_ok = (header != NULL && computed != NULL && !strcmp(header, computed)) ? 1 : -1;
+    free(header);
+    return;
+}
+
+/**
+ * @brief Check the file digest in the package header against the
+ * extracted file.
+ *
+ * The analysis cache (see cache.c) is keyed on the header digest, so
+ * a file may only use it once the digest is known to describe the
+ * contents that were actually extracted.  The file is read once and
+ * the answer is kept in the **rpmfile_entry_t**.  The computed
+ * digest is kept as the file's checksum of that type if it does not
+ * have one yet.
+ *
+ * @param file The **rpmfile_entry_t** specifying the file to use.
+ * @return True if the header digest matches the extracted file.
+ */
+bool verify_header_checksum(rpmfile_entry_t *file)
+{
+    int type = NULLSUM;
+    char *digests[NUM_CHECKSUMS] = { NULL };
+
+    assert(file != NULL);
+
+    if (file->header_checksum_ok != 0) {
+        return (file->header_checksum_ok == 1);
+    }
+
+    type = get_header_checksum_type(file);
+
+    if (type == NULLSUM || file->fullpath == NULL || !compute_file_checksums(file, CHECKSUM_BIT(type), digests)) {
+        file->header_checksum_ok = -1;
+        return false;
+    }
+
+    check_header_checksum(file, digests[type]);
+
+    if (file->checksums[type] == NULL) {
+        file->checksums[type] = digests[type];
+    } else {
+        free(digests[type]);
+    }
+
+    return (file->header_checksum_ok == 1);
+}
+
+/* Names of the checksum types in the analysis cache, see cache.c */
+static const char *cache_kinds[NUM_CHECKSUMS] = { NULL, "md5", "sha1", "sha224", "sha256", "sha384", "sha512" };
+
+/* Fill in missing checksums of the given types from the analysis cache */
+static void load_cached_checksums(rpmfile_entry_t *file, const unsigned int types)
+{
+    int i = 0;
+
+    for (i = MD5SUM; i < NUM_CHECKSUMS; i++) {
+        if ((types & CHECKSUM_BIT(i)) && file->checksums[i] == NULL) {
+            file->checksums[i] = cache_get(file, cache_kinds[i]);
+        }
+    }
+
+    return;
+}
+
+/* Store the checksums of the given types in the analysis cache */
+static void save_cached_checksums(rpmfile_entry_t *file, const unsigned int types)
+{
+    int i = 0;
+
+    for (i = MD5SUM; i < NUM_CHECKSUMS; i++) {
+        if ((types & CHECKSUM_BIT(i)) && file->checksums[i] != NULL) {
+            cache_put(file, cache_kinds[i], file->checksums[i]);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Return checksum string of the given type for the given
+ * **rpmfile_entry_t**.
+ *
+ * The **rpmfile_entry_t** caches each checksum type once computed.
+ * If the package header already carries file digests of the
+ * requested type, those are used and the file is not read.  Other
+ * types are looked up in the analysis cache before reading the file.
+ *
+ * @param file The **rpmfile_entry_t** specifying the file to use.
+ * @param type Which checksum type to return.
+ * @note Do not free the result returned, that is handled by
+ *       **free_files()**.
+ * @return String containing the human-readable checksum digest, or
+ *         NULL on failure.
+ */
+char *get_checksum(rpmfile_entry_t *file, const int type)
+{
+    assert(file != NULL);
+    assert(type > NULLSUM && type < NUM_CHECKSUMS);
+
+    if (file->checksums[type]) {
+        return file->checksums[type];
+    }
+
+    if (get_header_checksum_type(file) == type) {
+        file->checksums[type] = get_header_checksum(file);
+    } else {
+        load_cached_checksums(file, CHECKSUM_BIT(type));
+    }
+
+    if (file->checksums[type] == NULL && compute_file_checksums(file, CHECKSUM_BIT(type), file->checksums)) {
+        save_cached_checksums(file, CHECKSUM_BIT(type));
+    }
+
+    return file->checksums[type];
+}
+
 /**
  * @brief Return checksum string of the given **rpmfile_entry_t**.
  *
@@ -211,12 +606,297 @@ char *compute_checksum(const char *filename, mode_t *st_mode, int type)
  */
 char *checksum(rpmfile_entry_t *file)
 {
+    return get_checksum(file, DEFAULT_MESSAGE_DIGEST);
+}
+
+/* Return the checksum types in types that file does not have yet. */
+static unsigned int missing_checksums(const rpmfile_entry_t *file, const unsigned int types)
+{
+    int i = 0;
+    unsigned int missing = 0;
+
+    for (i = MD5SUM; i < NUM_CHECKSUMS; i++) {
+        if ((types & CHECKSUM_BIT(i)) && file->checksums[i] == NULL) {
+            missing |= CHECKSUM_BIT(i);
+        }
+    }
+
+    return missing;
+}
+
+/**
+ * @brief Fill in the cached checksums of the given
+ * **rpmfile_entry_t** for every type in the types mask.
+ *
+ * The digest carried in the package header is used if its type is
+ * requested.  All other missing types are computed in a single read
+ * of the file, so asking for several types at once is much cheaper
+ * than several get_checksum() calls.
+ *
+ * @param file The **rpmfile_entry_t** specifying the file to use.
+ * @param types Mask of checksum types to calculate.
+ * @return True if all requested checksums are available, false
+ *         otherwise.
+ */
+bool get_checksums(rpmfile_entry_t *file, const unsigned int types)
+{
+    int type = NULLSUM;
+    unsigned int missing = 0;
+
     assert(file != NULL);
 
-    if (file->checksum) {
-        return file->checksum;
+    type = get_header_checksum_type(file);
+
+    if (type != NULLSUM && (types & CHECKSUM_BIT(type)) && file->checksums[type] == NULL) {
+        file->checksums[type] = get_header_checksum(file);
+    }
+
+    /* then anything a previous run left in the analysis cache */
+    load_cached_checksums(file, types);
+    missing = missing_checksums(file, types);
+
+    if (missing == 0) {
+        return true;
+    }
+
+    if (!compute_file_checksums(file, missing, file->checksums)) {
+        return false;
+    }
+
+    save_cached_checksums(file, missing);
+    return true;
+}
+
+/*
+ * Child process for checksum_files().  Hashes every nth file in the
+ * work list for the types in work_missing and writes "index type
+ * digest" lines to fd.
+ */
+static void checksum_worker(rpmfile_entry_t **work, const unsigned int *work_missing, const size_t nwork, const size_t first, const size_t step, const int fd)
+{
+    size_t n = 0;
+    int i = 0;
+    char *digests[NUM_CHECKSUMS];
+    FILE *fp = NULL;
+
+    fp = fdopen(fd, "w");
+
+    if (fp == NULL) {
+        err(RI_PROGRAM_ERROR, "*** fdopen");
+    }
+
+    for (n = first; n < nwork; n += step) {
+        memset(digests, 0, sizeof(digests));
+
+        if (!compute_checksums(work[n]->fullpath, &work[n]->st_mode, work_missing[n], digests)) {
+            continue;
+        }
+
+        for (i = MD5SUM; i < NUM_CHECKSUMS; i++) {
+            if (digests[i]) {
+                fprintf(fp, "%zu %d %s\n", n, i, digests[i]);
+                free(digests[i]);
+            }
+        }
+    }
+
+    if (fclose(fp) != 0) {
+        err(RI_PROGRAM_ERROR, "*** fclose");
+    }
+
+    return;
+}
+
+/* Store the digests written by checksum_worker() on the files. */
+static void read_worker_checksums(rpmfile_entry_t **work, const size_t nwork, char *output)
+{
+    char *line = NULL;
+    char *end = NULL;
+    size_t n = 0;
+    unsigned long type = 0;
+
+    for (line = strtok(output, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        n = strtoul(line, &end, 10);
+
+        if (*end != ' ' || n >= nwork) {
+            continue;
+        }
+
+        type = strtoul(end + 1, &end, 10);
+
+        if (*end != ' ' || type <= NULLSUM || type >= NUM_CHECKSUMS || work[n]->checksums[type]) {
+            continue;
+        }
+
+        work[n]->checksums[type] = strdup(end + 1);
+    }
+
+    return;
+}
+
+/*
+ * Helper for checksum_files().  Check the header digest of a file
+ * that was hashed along with its other checksums, then store the new
+ * checksums in the analysis cache.
+ */
+static void save_work_checksums(rpmfile_entry_t *file, const unsigned int missing)
+{
+    int type = get_header_checksum_type(file);
+
+    if (type != NULLSUM && file->header_checksum_ok == 0 && (missing & CHECKSUM_BIT(type)) && cache_enabled()) {
+        check_header_checksum(file, file->checksums[type]);
+    }
+
+    save_cached_checksums(file, missing);
+    return;
+}
+
+/**
+ * @brief Compute checksums for all regular files in a list.
+ *
+ * Fills in the cached checksums of each regular file in the list for
+ * every type in the types mask (see CHECKSUM_BIT()).  Digests
+ * carried in the package header are used where the algorithm
+ * matches, as are digests stored in the analysis cache by earlier
+ * runs (see cache.c).  The remaining files are read once each,
+ * computing all of the missing types in a single pass, and spread
+ * over parallel worker processes.  With the cache enabled, a file
+ * whose header digest has not been verified yet is hashed instead,
+ * header digest included, so verify_header_checksum() needs no
+ * extra read.  Files that fail here are left for get_checksum()
+ * to retry and report.
+ *
+ * @param files The rpmfile_t list of files to checksum.
+ * @param types Mask of checksum types to calculate.
+ */
+void checksum_files(rpmfile_t *files, const unsigned int types)
+{
+    rpmfile_entry_t *file = NULL;
+    rpmfile_entry_t **work = NULL;
+    unsigned int *work_missing = NULL;
+    size_t nwork = 0;
+    size_t n = 0;
+    unsigned int max = 0;
+    unsigned int i = 0;
+    unsigned int missing = 0;
+    int pipefd[2];
+    pid_t pid;
+    parallel_t *col = NULL;
+    parallel_slot_t *slot = NULL;
+    int type = NULLSUM;
+
+    if (files == NULL || TAILQ_EMPTY(files) || types == 0) {
+        return;
+    }
+
+    TAILQ_FOREACH(file, files, items) {
+        if (!S_ISREG(file->st_mode)) {
+            continue;
+        }
+
+        type = get_header_checksum_type(file);
+
+        if (type != NULLSUM && file->checksums[type] == NULL && file->header_checksum_ok == 0 && cache_enabled()) {
+            /*
+             * The analysis cache can only be used once the header
+             * digest is checked against the file, which takes a read
+             * of the file anyway, so hash it with everything else.
+             */
+            missing = missing_checksums(file, types | CHECKSUM_BIT(type));
+        } else {
+            /* reuse the file digest from the header */
+            if (type != NULLSUM && (types & CHECKSUM_BIT(type)) && file->checksums[type] == NULL) {
+                file->checksums[type] = get_header_checksum(file);
+            }
+
+            /* then anything a previous run left in the analysis cache */
+            load_cached_checksums(file, types);
+            missing = missing_checksums(file, types);
+        }
+
+        if (missing) {
+            work = xrealloc(work, (nwork + 1) * sizeof(*work));
+            work_missing = xrealloc(work_missing, (nwork + 1) * sizeof(*work_missing));
+            work[nwork] = file;
+            work_missing[nwork++] = missing;
+        }
+    }
+
+    if (nwork == 0) {
+        return;
+    }
+
+    max = get_parallel_processes();
+
+    if (max > nwork) {
+        max = nwork;
+    }
+
+    if (max <= 1) {
+        for (n = 0; n < nwork; n++) {
+            /* failures are reported by compute_checksums() */
+            (void) compute_file_checksums(work[n], work_missing[n], work[n]->checksums);
+            save_work_checksums(work[n], work_missing[n]);
+        }
+
+        free(work);
+        free(work_missing);
+        return;
+    }
+
+    /* one worker per process, each takes every max'th file */
+    fflush(NULL);
+    col = new_parallel(max);
+
+    /* workers report on every file they take, however many there are */
+    col->max_len = 0;
+
+    for (i = 0; i < max; i++) {
+        if (pipe(pipefd)) {
+            err(RI_PROGRAM_ERROR, "*** pipe");
+        }
+
+        pid = fork();
+
+        if (pid < 0) {
+            err(RI_PROGRAM_ERROR, "*** fork");
+        }
+
+        if (pid == 0) {
+            /* child */
+            if (close(pipefd[0]) == -1) {
+                warn("*** close");
+            }
+
+            checksum_worker(work, work_missing, nwork, i, max, pipefd[1]);
+            _exit(RI_SUCCESS);
+        }
+
+        /* parent */
+        if (close(pipefd[1]) == -1) {
+            warn("*** close");
+        }
+
+        insert_new_pid_and_fd(col, pid, pipefd[0]);
+    }
+
+    while ((slot = collect_one(col)) != NULL) {
+        if (slot->output) {
+            read_worker_checksums(work, nwork, slot->output);
+            free(slot->output);
+            slot->output = NULL;
+            slot->output_len = 0;
+            slot->output_size = 0;
+        }
+    }
+
+    delete_parallel(col, 0);
+
+    for (n = 0; n < nwork; n++) {
+        save_work_checksums(work[n], work_missing[n]);
     }
 
-    file->checksum = compute_checksum(file->fullpath, &file->st_mode, DEFAULT_MESSAGE_DIGEST);
-    return file->checksum;
+    free(work);
+    free(work_missing);
+    return;
 }
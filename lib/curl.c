@@ -24,13 +24,44 @@ static size_t half_width = 0;
 static size_t bar_width = 0;
 static curl_off_t progress_displayed = 0;
 static size_t progress_msg_len = 0;
+static CURLSH *share = NULL;
+
+/*
+ * Attach the shared DNS, TLS session, and connection cache to a curl
+ * handle.  Every transfer made by rpminspect goes to a small number
+ * of hosts (the Koji hub and download servers), so reusing resolved
+ * names and open connections between the size queries and downloads
+ * avoids a new TCP and TLS handshake per package.
+ */
+static void use_curl_share(CURL *c)
+{
+    assert(c != NULL);
+
+    if (share == NULL) {
+        share = curl_share_init();
+
+        if (share == NULL) {
+            warnx("*** curl_share_init");
+            return;
+        }
+
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900 /* connection sharing arrived in 7.57.0 */
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+    }
+
+    curl_easy_setopt(c, CURLOPT_SHARE, share);
+    return;
+}
 
 /*
  * Called by either the download helper or the progress bar callback
- * on SIGWINCH.  Sets the line up for the progress bar.  NULL input
- * means reposition an in-progress progress bar.
+ * on SIGWINCH.  Sets the line up for the progress bar labeled with
+ * name.  NULL input means reposition an in-progress progress bar.
  */
-static void setup_progress_bar(const char *src)
+static void setup_progress_bar(const char *name)
 {
     char *archive = NULL;
     char *vmsg = NULL;
@@ -45,20 +76,16 @@ static void setup_progress_bar(const char *src)
     progress_displayed = 0;
 
     /* generate the verbose message string */
-    if (src != NULL) {
-        /* the basename of the source URL, which is the file name */
-        archive = xstrrchr(src, PATH_SEP) + 1;
-        assert(archive != NULL);
-
-        /* we need to shorten the package basename if too wide */
-        if ((strlen(archive) + 5) > bar_width) {
-            archive = strshorten(archive, bar_width - 5);
+    if (name != NULL) {
+        /* we need to shorten the label if too wide */
+        if ((strlen(name) + 5) > bar_width) {
+            archive = strshorten(name, bar_width - 5);
             assert(archive != NULL);
             xasprintf(&vmsg, "=> %s ", archive);
             assert(vmsg != NULL);
             free(archive);
         } else {
-            xasprintf(&vmsg, "=> %s ", archive);
+            xasprintf(&vmsg, "=> %s ", name);
         }
 
         progress_msg_len = strlen(vmsg);
@@ -181,6 +208,7 @@ void curl_get_file(const bool verbose, const char *src, const char *dst)
     curl_easy_setopt(c, CURLOPT_WRITEFUNCTION, NULL);
     curl_easy_setopt(c, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(c, CURLOPT_MAXREDIRS, 10L);
+    use_curl_share(c);
 
     if (verbose) {
         if (isatty(STDOUT_FILENO) == 1) {
@@ -190,7 +218,11 @@ void curl_get_file(const bool verbose, const char *src, const char *dst)
             curl_easy_setopt(c, CURLOPT_PROGRESSFUNCTION, legacy_download_progress);
 #endif
             curl_easy_setopt(c, CURLOPT_NOPROGRESS, 0L);
-            setup_progress_bar(src);
+
+            /* the basename of the source URL, which is the file name */
+            archive = xstrrchr(src, PATH_SEP) + 1;
+            assert(archive != NULL);
+            setup_progress_bar(archive);
         } else {
             archive = xstrrchr(src, PATH_SEP) + 1;
             assert(archive != NULL);
@@ -234,6 +266,247 @@ void curl_get_file(const bool verbose, const char *src, const char *dst)
     return;
 }
 
+/*
+ * State for one transfer in curl_get_files().
+ */
+struct transfer {
+    CURL *c;
+    FILE *fp;
+    const pair_entry_t *file;
+};
+
+static void finish_transfer(CURLM *, struct transfer *, const CURLcode);
+
+/*
+ * Start the download described by file on a new easy handle and add
+ * it to the multi handle.  Returns false if the transfer could not
+ * be started.
+ */
+static bool start_transfer(CURLM *m, struct transfer *xfer, const pair_entry_t *file)
+{
+    assert(m != NULL);
+    assert(xfer != NULL);
+    assert(file != NULL);
+
+    DEBUG_PRINT("src=|%s|\ndst=|%s|\n", file->key, file->value);
+
+    xfer->file = file;
+    xfer->c = curl_easy_init();
+
+    if (xfer->c == NULL) {
+        warn("*** curl_easy_init");
+        return false;
+    }
+
+    xfer->fp = fopen(file->value, "wb");
+
+    if (xfer->fp == NULL) {
+        err(RI_PROGRAM_ERROR, "*** fopen");
+    }
+
+    curl_easy_setopt(xfer->c, CURLOPT_WRITEFUNCTION, NULL);
+    curl_easy_setopt(xfer->c, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(xfer->c, CURLOPT_MAXREDIRS, 10L);
+    curl_easy_setopt(xfer->c, CURLOPT_URL, file->key);
+    curl_easy_setopt(xfer->c, CURLOPT_WRITEDATA, xfer->fp);
+    curl_easy_setopt(xfer->c, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(xfer->c, CURLOPT_PRIVATE, xfer);
+#ifdef CURLOPT_TCP_FASTOPEN /* not available on all versions of libcurl (e.g., <= 7.29) */
+    curl_easy_setopt(xfer->c, CURLOPT_TCP_FASTOPEN, 1L);
+#endif
+    use_curl_share(xfer->c);
+
+    if (curl_multi_add_handle(m, xfer->c) != CURLM_OK) {
+        warnx("*** curl_multi_add_handle");
+        finish_transfer(m, xfer, CURLE_FAILED_INIT);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Close out a transfer.  The destination file is removed if there
+ * was a download error (e.g., 404), same as curl_get_file().
+ */
+static void finish_transfer(CURLM *m, struct transfer *xfer, const CURLcode cc)
+{
+    assert(m != NULL);
+    assert(xfer != NULL);
+
+    if (xfer->fp != NULL && fclose(xfer->fp) != 0) {
+        err(RI_PROGRAM_ERROR, "*** fclose");
+    }
+
+    if (cc != CURLE_OK && xfer->file != NULL) {
+        warnx(_("*** unable to download %s: %s"), xfer->file->key, curl_easy_strerror(cc));
+
+        if (unlink(xfer->file->value)) {
+            warn("*** unlink");
+        }
+    }
+
+    if (xfer->c != NULL) {
+        curl_multi_remove_handle(m, xfer->c);
+        curl_easy_cleanup(xfer->c);
+    }
+
+    xfer->c = NULL;
+    xfer->fp = NULL;
+    return;
+}
+
+/*
+ * Download a list of files concurrently.  Each entry in files is a
+ * pair where the key is the source URL and the value is the full
+ * destination path.  Up to max transfers run at once on a single
+ * curl multi handle sharing one connection cache, so consecutive
+ * packages from the same server reuse open connections rather than
+ * connecting again for each file.  A max of 1 (or a single file)
+ * uses curl_get_file() for each entry and keeps the per-file
+ * progress bar.  In verbose mode with parallel transfers, a single
+ * progress bar tracks the number of completed files on a terminal
+ * and a line is printed for each completed file otherwise.
+ */
+void curl_get_files(const bool verbose, const pair_list_t *files, const long max)
+{
+    size_t total = 0;
+    size_t done = 0;
+    long running = 0;
+    long i = 0;
+    int still = 0;
+    int queued = 0;
+    bool tty = false;
+    char *label = NULL;
+    char *archive = NULL;
+    const pair_entry_t *file = NULL;
+    const pair_entry_t *next = NULL;
+    struct transfer *xfers = NULL;
+    struct transfer *xfer = NULL;
+    CURLM *m = NULL;
+    CURLMsg *msg = NULL;
+    CURLMcode mc;
+
+    if (files == NULL || TAILQ_EMPTY(files)) {
+        return;
+    }
+
+    TAILQ_FOREACH(file, files, items) {
+        total++;
+    }
+
+    /* serial downloads */
+    if (max <= 1 || total == 1) {
+        TAILQ_FOREACH(file, files, items) {
+            curl_get_file(verbose, file->key, file->value);
+        }
+
+        return;
+    }
+
+    m = curl_multi_init();
+
+    if (m == NULL) {
+        warnx("*** curl_multi_init");
+        return;
+    }
+
+    curl_multi_setopt(m, CURLMOPT_MAXCONNECTS, max);
+#if LIBCURL_VERSION_NUM >= 0x071e00 /* 7.30.0 */
+    curl_multi_setopt(m, CURLMOPT_MAX_TOTAL_CONNECTIONS, max);
+#endif
+#ifdef CURLPIPE_MULTIPLEX
+    curl_multi_setopt(m, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+
+    if (verbose) {
+        tty = (isatty(STDOUT_FILENO) == 1);
+
+        if (tty) {
+            xasprintf(&label, _("%zu files"), total);
+            assert(label != NULL);
+            setup_progress_bar(label);
+            free(label);
+        }
+    }
+
+    /* transfer slots, one per concurrently running download */
+    xfers = xcalloc(max, sizeof(*xfers));
+    next = TAILQ_FIRST(files);
+
+    while (next != NULL || running > 0) {
+        /* fill any free transfer slots */
+        for (i = 0; i < max && next != NULL; i++) {
+            if (xfers[i].c != NULL) {
+                continue;
+            }
+
+            if (start_transfer(m, &xfers[i], next)) {
+                running++;
+            } else {
+                done++;
+            }
+
+            next = TAILQ_NEXT(next, items);
+        }
+
+        /* run the transfers */
+        mc = curl_multi_perform(m, &still);
+
+        if (mc == CURLM_OK && still > 0) {
+            mc = curl_multi_wait(m, NULL, 0, 1000, NULL);
+        }
+
+        if (mc != CURLM_OK) {
+            warnx("*** curl_multi: %s", curl_multi_strerror(mc));
+            break;
+        }
+
+        /* reap completed transfers */
+        while ((msg = curl_multi_info_read(m, &queued)) != NULL) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **) &xfer);
+            assert(xfer != NULL);
+            file = xfer->file;
+            finish_transfer(m, xfer, msg->data.result);
+            running--;
+            done++;
+
+            if (verbose) {
+                if (tty) {
+                    download_progress(NULL, total, done, 0, 0);
+                } else {
+                    archive = xstrrchr(file->key, PATH_SEP) + 1;
+                    assert(archive != NULL);
+                    printf(">>> %s\n", archive);
+                }
+            }
+        }
+    }
+
+    /* clean up anything left over from an aborted run */
+    for (i = 0; i < max; i++) {
+        if (xfers[i].c != NULL) {
+            finish_transfer(m, &xfers[i], CURLE_ABORTED_BY_CALLBACK);
+        }
+    }
+
+    if (verbose) {
+        if (tty) {
+            printf("\n");
+        }
+
+        fflush(stdout);
+    }
+
+    free(xfers);
+    curl_multi_cleanup(m);
+    return;
+}
+
 curl_off_t curl_get_size(const char *src)
 {
     curl_off_t r = 0;
@@ -252,6 +525,7 @@ curl_off_t curl_get_size(const char *src)
     }
 
     /* get the size */
+    use_curl_share(c);
     curl_easy_setopt(c, CURLOPT_URL, src);
     curl_easy_setopt(c, CURLOPT_NOBODY, 1L);
     curl_easy_setopt(c, CURLOPT_FAILONERROR, 1L);
@@ -302,3 +576,16 @@ bool is_remote_rpm(const char *url)
 
     return (r == CURLE_OK);
 }
+
+/*
+ * Release the shared curl connection cache.
+ */
+void free_curl_share(void)
+{
+    if (share != NULL) {
+        curl_share_cleanup(share);
+        share = NULL;
+    }
+
+    return;
+}
@@ -98,6 +98,15 @@ void dump_cfg(const struct rpminspect *ri)
         if (ri->remedyfile) {
             printf("    remedyfile: %s\n", ri->remedyfile);
         }
+
+        if (ri->extract_jobs) {
+            printf("    extract_jobs: %u\n", ri->extract_jobs);
+        }
+
+        if (ri->cachedir) {
+            printf("    cachedir: %s\n", ri->cachedir);
+            printf("    cache_size: %lu\n", ri->cache_size);
+        }
     }
 
     /* environment */
@@ -108,7 +117,7 @@ void dump_cfg(const struct rpminspect *ri)
 
     /* koji */
 
-    if (ri->kojihub || ri->kojiursine || ri->kojimbs) {
+    if (ri->kojihub || ri->kojiursine || ri->kojimbs || ri->download_jobs) {
         printf("koji:\n");
 
         if (ri->kojihub) {
@@ -122,6 +131,10 @@ void dump_cfg(const struct rpminspect *ri)
         if (ri->kojimbs) {
             printf("    download_mbs: %s\n", ri->kojimbs);
         }
+
+        if (ri->download_jobs) {
+            printf("    download_jobs: %u\n", ri->download_jobs);
+        }
     }
 
     /* commands */
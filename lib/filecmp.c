@@ -7,39 +7,179 @@
 #include <stddef.h>
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
+#include <err.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "rpminspect.h"
 
+/* Size of the blocks compared at a time. */
+#define FILECMP_BLOCK_SIZE (128 * 1024)
+
+/*
+ * Open a file for comparison and return its size.  Unreadable files,
+ * empty files, and anything that is not a regular file count as
+ * having no content, in which case -1 is returned in fd.
+ */
+static off_t open_cmp_file(const char *path, int *fd)
+{
+    struct stat sb;
+
+    assert(path != NULL);
+    assert(fd != NULL);
+
+    *fd = -1;
+
+    if (stat(path, &sb) == -1 || sb.st_size == 0 || !S_ISREG(sb.st_mode)) {
+        return 0;
+    }
+
+    *fd = open(path, O_RDONLY);
+
+    if (*fd == -1) {
+        return 0;
+    }
+
+    return sb.st_size;
+}
+
+/* Read up to len bytes, retrying short reads.  Returns bytes read. */
+static ssize_t read_block(const int fd, unsigned char *buf, const size_t len)
+{
+    ssize_t r = 0;
+    size_t total = 0;
+
+    while (total < len) {
+        r = read(fd, buf + total, len - total);
+
+        if (r == -1 && errno == EINTR) {
+            continue;
+        } else if (r == -1) {
+            return -1;
+        } else if (r == 0) {
+            break;
+        }
+
+        total += r;
+    }
+
+    return total;
+}
+
 /*
  * Compares two files.  The return value of this function matches what
  * memcmp() returns (mostly).  The function will return 1 if the sizes
- * read of each file are different and it will skip the comparison
- * entirely.
+ * of each file are different and it will skip the comparison
+ * entirely.  Otherwise the files are read a block at a time and the
+ * comparison stops at the first block that differs.
  */
 int filecmp(const char *x, const char *y)
 {
     int r = 0;
-    void *xbuf = NULL;
-    void *ybuf = NULL;
+    int xfd = -1;
+    int yfd = -1;
     off_t xlen = 0;
     off_t ylen = 0;
+    ssize_t xr = 0;
+    ssize_t yr = 0;
+    unsigned char *xbuf = NULL;
+    unsigned char *ybuf = NULL;
 
     assert(x != NULL);
     assert(y != NULL);
 
-    /* read in the files */
-    xbuf = read_file_bytes(x, &xlen);
-    ybuf = read_file_bytes(y, &ylen);
+    xlen = open_cmp_file(x, &xfd);
+    ylen = open_cmp_file(y, &yfd);
 
-    /* they are different if the sizes read are different */
+    /* they are different if the sizes are different */
     if (xlen != ylen) {
+        r = 1;
+    } else if (xfd != -1 && yfd != -1) {
+        xbuf = xalloc(FILECMP_BLOCK_SIZE);
+        ybuf = xalloc(FILECMP_BLOCK_SIZE);
+
+        while (r == 0) {
+            xr = read_block(xfd, xbuf, FILECMP_BLOCK_SIZE);
+            yr = read_block(yfd, ybuf, FILECMP_BLOCK_SIZE);
+
+            if (xr == -1 || yr == -1) {
+                warn("*** read");
+                r = 1;
+            } else if (xr != yr) {
+                /* the file changed size underneath us */
+                r = 1;
+            } else if (xr == 0) {
+                break;
+            } else {
+                r = memcmp(xbuf, ybuf, xr);
+            }
+        }
+
         free(xbuf);
         free(ybuf);
-        return 1;
     }
 
-    r = memcmp(xbuf, ybuf, xlen);
-    free(xbuf);
-    free(ybuf);
+    if (xfd != -1 && close(xfd) == -1) {
+        warn("*** close");
+    }
+
+    if (yfd != -1 && close(yfd) == -1) {
+        warn("*** close");
+    }
 
     return r;
 }
+
+/*
+ * Compares the contents of two rpmfile_entry_t files, usually peers.
+ * Returns 0 if they are the same and non-zero if they differ.  Any
+ * digests already available, cached or from the package headers,
+ * answer most comparisons without reading the files.  Files mapped
+ * by get_file_content() are compared in memory and anything else
+ * falls back to filecmp(), which checks the sizes first.
+ */
+int filecmp_rpmfile(rpmfile_entry_t *x, rpmfile_entry_t *y)
+{
+    int type = NULLSUM;
+    const char *xsum = NULL;
+    const char *ysum = NULL;
+    const void *xbuf = NULL;
+    const void *ybuf = NULL;
+    size_t xlen = 0;
+    size_t ylen = 0;
+
+    assert(x != NULL);
+    assert(y != NULL);
+
+    if (S_ISREG(x->st_mode) && S_ISREG(y->st_mode)) {
+        /* digests we already have */
+        for (type = MD5SUM; type < NUM_CHECKSUMS; type++) {
+            if (x->checksums[type] && y->checksums[type]) {
+                return strcmp(x->checksums[type], y->checksums[type]);
+            }
+        }
+
+        /* digests carried in the package headers */
+        type = get_header_checksum_type(x);
+
+        if (type != NULLSUM && type == get_header_checksum_type(y)) {
+            xsum = get_checksum(x, type);
+            ysum = get_checksum(y, type);
+
+            if (xsum && ysum) {
+                return strcmp(xsum, ysum);
+            }
+        }
+
+        /* the contents, if both fit in memory */
+        xbuf = get_file_content(x, &xlen);
+        ybuf = get_file_content(y, &ylen);
+
+        if (xbuf && ybuf) {
+            return (xlen != ylen) ? 1 : memcmp(xbuf, ybuf, xlen);
+        }
+    }
+
+    return filecmp(x->fullpath, y->fullpath);
+}
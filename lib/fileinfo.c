@@ -9,7 +9,6 @@
 #include <assert.h>
 #include <err.h>
 #include <errno.h>
-#include <fnmatch.h>
 #include <rpm/header.h>
 #include "rpminspect.h"
 
@@ -51,31 +50,29 @@ bool match_fileinfo_mode(struct rpminspect *ri, const rpmfile_entry_t *file, con
     params.file = file->localpath;
 
     if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (file->st_mode == fientry->mode) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected mode %04o"), file->localpath, pkg, params.arch, perms);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
+        HASH_FIND_STR(ri->fileinfo_table, file->localpath, fientry);
+
+        if (fientry != NULL) {
+            if (file->st_mode == fientry->mode) {
+                xasprintf(&params.msg, _("%s in %s on %s carries expected mode %04o"), file->localpath, pkg, params.arch, perms);
+                params.severity = RESULT_INFO;
+                params.waiverauth = NOT_WAIVABLE;
+                add_result(ri, &params);
+                free(params.msg);
+                *reported = true;
+                return true;
+            } else {
+                params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+                if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                    params.waiverauth = WAIVABLE_BY_SECURITY;
+                    xasprintf(&params.msg, _("%s in %s on %s carries unexpected mode %04o; expected mode %04o; requires inspection by the Security Team"), file->localpath, pkg, params.arch, perms, fientry->mode);
                     add_result(ri, &params);
                     free(params.msg);
+                    *result = false;
                     *reported = true;
                     return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries unexpected mode %04o; expected mode %04o; requires inspection by the Security Team"), file->localpath, pkg, params.arch, perms, fientry->mode);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        *result = false;
-                        *reported = true;
-                        return true;
-                    }
                 }
-
-                break;
             }
         }
     }
@@ -137,31 +134,29 @@ bool match_fileinfo_owner(struct rpminspect *ri, const rpmfile_entry_t *file, co
     params.file = file->localpath;
 
     if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (!strcmp(owner, fientry->owner)) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected owner '%s'"), file->localpath, pkg, params.arch, fientry->owner);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
+        HASH_FIND_STR(ri->fileinfo_table, file->localpath, fientry);
+
+        if (fientry != NULL) {
+            if (!strcmp(owner, fientry->owner)) {
+                xasprintf(&params.msg, _("%s in %s on %s carries expected owner '%s'"), file->localpath, pkg, params.arch, fientry->owner);
+                params.severity = RESULT_INFO;
+                params.waiverauth = NOT_WAIVABLE;
+                add_result(ri, &params);
+                free(params.msg);
+                *reported = true;
+                return true;
+            } else {
+                params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+                if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                    params.waiverauth = WAIVABLE_BY_SECURITY;
+                    xasprintf(&params.msg, _("%s in %s on %s carries unexpected owner '%s'; expected owner '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, owner, fientry->owner);
                     add_result(ri, &params);
                     free(params.msg);
+                    *result = false;
                     *reported = true;
                     return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries unexpected owner '%s'; expected owner '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, owner, fientry->owner);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        *result = false;
-                        *reported = true;
-                        return true;
-                    }
                 }
-
-                break;
             }
         }
     }
@@ -223,31 +218,29 @@ bool match_fileinfo_group(struct rpminspect *ri, const rpmfile_entry_t *file, co
     params.file = file->localpath;
 
     if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (!strcmp(group, fientry->group)) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected group '%s'"), file->localpath, pkg, params.arch, fientry->group);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
+        HASH_FIND_STR(ri->fileinfo_table, file->localpath, fientry);
+
+        if (fientry != NULL) {
+            if (!strcmp(group, fientry->group)) {
+                xasprintf(&params.msg, _("%s in %s on %s carries expected group '%s'"), file->localpath, pkg, params.arch, fientry->group);
+                params.severity = RESULT_INFO;
+                params.waiverauth = NOT_WAIVABLE;
+                add_result(ri, &params);
+                free(params.msg);
+                *reported = true;
+                return true;
+            } else {
+                params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+                if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                    params.waiverauth = WAIVABLE_BY_SECURITY;
+                    xasprintf(&params.msg, _("%s in %s on %s carries group unexpected '%s'; expected group '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, group, fientry->group);
                     add_result(ri, &params);
                     free(params.msg);
+                    *result = false;
                     *reported = true;
                     return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries group unexpected '%s'; expected group '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, group, fientry->group);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        *result = false;
-                        *reported = true;
-                        return true;
-                    }
                 }
-
-                break;
             }
         }
     }
@@ -278,44 +271,24 @@ bool match_fileinfo_group(struct rpminspect *ri, const rpmfile_entry_t *file, co
 #ifdef _WITH_LIBCAP
 caps_filelist_entry_t *get_caps_entry(struct rpminspect *ri, const char *pkg, const char *filepath)
 {
-    bool found = false;
-    int flags = FNM_NOESCAPE;
     caps_entry_t *entry = NULL;
-    caps_filelist_entry_t *flentry = NULL;
 
     assert(ri != NULL);
     assert(pkg != NULL);
     assert(filepath != NULL);
 
-    if (init_caps(ri)) {
-        /* Look for the package in the caps list */
-        TAILQ_FOREACH(entry, ri->caps, items) {
-            if (!strcmp(entry->pkg, pkg) || !fnmatch(entry->pkg, pkg, flags)) {
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
-            return NULL;
-        }
-
-        found = false;
+    if (!init_caps(ri)) {
+        return NULL;
+    }
 
-        /* Look for this file's entry for that package */
-        TAILQ_FOREACH(flentry, entry->files, items) {
-            if (!strcmp(flentry->path, filepath) || !fnmatch(flentry->path, filepath, flags)) {
-                found = true;
-                break;
-            }
-        }
+    /* Look for the package in the caps list */
+    entry = rule_index_find(ri->caps_index, pkg);
 
-        /* No entry, make sure to return NULL */
-        if (!found) {
-            return NULL;
-        }
+    if (entry == NULL) {
+        return NULL;
     }
 
-    return flentry;
+    /* Look for this file's entry for that package */
+    return rule_index_find(entry->files_index, filepath);
 }
 #endif
@@ -21,6 +21,8 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <libgen.h>
 
@@ -95,6 +97,57 @@ static rpmfileAttrs get_rpmtag_fileflags(const Header h, const int i)
     return flags;
 }
 
+/*
+ * Files with a mapping from get_file_content(), least recently used
+ * first.  Each mapping is a separate VMA, so only FILE_CONTENT_MAPS
+ * of them are kept rather than one per payload file.
+ */
+static rpmfile_entry_t *mapped_files[FILE_CONTENT_MAPS];
+static unsigned int num_mapped_files = 0;
+
+/* Unmap the file contents if get_file_content() mapped them */
+static void release_file_content(rpmfile_entry_t *file)
+{
+    unsigned int i = 0;
+
+    if (file->content == NULL) {
+        return;
+    }
+
+    if (munmap(file->content, file->content_len) == -1) {
+        warn("*** munmap");
+    }
+
+    file->content = NULL;
+    file->content_len = 0;
+
+    for (i = 0; i < num_mapped_files; i++) {
+        if (mapped_files[i] == file) {
+            num_mapped_files--;
+            memmove(&mapped_files[i], &mapped_files[i + 1], (num_mapped_files - i) * sizeof(*mapped_files));
+            break;
+        }
+    }
+
+    return;
+}
+
+/* Move the file to the most recently used end of mapped_files */
+static void touch_file_content(rpmfile_entry_t *file)
+{
+    unsigned int i = 0;
+
+    for (i = 0; i < num_mapped_files; i++) {
+        if (mapped_files[i] == file) {
+            memmove(&mapped_files[i], &mapped_files[i + 1], (num_mapped_files - i - 1) * sizeof(*mapped_files));
+            mapped_files[num_mapped_files - 1] = file;
+            break;
+        }
+    }
+
+    return;
+}
+
 /**
  * @brief Free rpmfile_t memory.
  *
@@ -107,6 +160,7 @@ static rpmfileAttrs get_rpmtag_fileflags(const Header h, const int i)
 void free_files(rpmfile_t *files)
 {
     rpmfile_entry_t *entry;
+    int i = 0;
 
     if (files == NULL) {
         return;
@@ -117,14 +171,188 @@ void free_files(rpmfile_t *files)
         TAILQ_REMOVE(files, entry, items);
         free(entry->fullpath);
         free(entry->localpath);
-        free(entry->type);
-        free(entry->checksum);
+
+        for (i = 0; i < NUM_CHECKSUMS; i++) {
+            free(entry->checksums[i]);
+        }
+
+        free_elf_facts(entry->elf_facts);
+
+        release_file_content(entry);
         free(entry);
     }
 
     free(files);
 }
 
+/**
+ * @brief Return a read-only mapping of an extracted payload file.
+ *
+ * This is a cache over the files extract_rpm() wrote to the working
+ * directory, not a way to read payloads without extracting them.
+ * The file is mapped the first time this is called and the mapping
+ * is kept with the rpmfile_entry_t, so a checksum and the file
+ * comparison that follows it work from the same pages instead of
+ * each opening and reading the file again.  At most
+ * FILE_CONTENT_MAPS files stay mapped; the least recently used one
+ * is unmapped to make room for another, so the returned pointer is
+ * only good until the next few calls.  Anything other than a
+ * non-empty regular file of at most FILE_CONTENT_MAX bytes gives
+ * NULL and callers fall back to file->fullpath.
+ *
+ * @param file The **rpmfile_entry_t** to read.
+ * @param len Set to the length of the contents.
+ * @return Pointer to the read-only contents, or NULL.
+ */
+const void *get_file_content(rpmfile_entry_t *file, size_t *len)
+{
+    int fd = -1;
+    struct stat sb;
+    void *map = MAP_FAILED;
+
+    assert(file != NULL);
+    assert(len != NULL);
+
+    if (file->content) {
+        touch_file_content(file);
+        *len = file->content_len;
+        return file->content;
+    }
+
+    *len = 0;
+
+    if (file->fullpath == NULL || !S_ISREG(file->st_mode) || file->st_size <= 0 || file->st_size > FILE_CONTENT_MAX) {
+        return NULL;
+    }
+
+    fd = open(file->fullpath, O_RDONLY);
+
+    if (fd == -1) {
+        return NULL;
+    }
+
+    /* the header size may not be what was extracted */
+    if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) && sb.st_size > 0 && sb.st_size <= FILE_CONTENT_MAX) {
+        map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    if (close(fd) == -1) {
+        warn("*** close");
+    }
+
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    /* make room by unmapping the least recently used file */
+    if (num_mapped_files == FILE_CONTENT_MAPS) {
+        release_file_content(mapped_files[0]);
+    }
+
+    file->content = map;
+    file->content_len = sb.st_size;
+    mapped_files[num_mapped_files++] = file;
+    *len = file->content_len;
+    return file->content;
+}
+
+/**
+ * @brief Write an extracted package to a stream.
+ *
+ * Write the extraction root directory and the rpmfile_t list returned
+ * by extract_rpm() to the given stream in a form read_files() can
+ * reconstruct.  This is used to send the results of extracting a
+ * package in a child process back to the parent.  Only the members
+ * set by extract_rpm() are written.
+ *
+ * @param fp Stream to write to.
+ * @param root The directory the package was extracted to (may be NULL).
+ * @param files The list returned by extract_rpm() (may be NULL).
+ * @return True on success, false on write errors.
+ */
+bool write_files(FILE *fp, const char *root, const rpmfile_t *files)
+{
+    rpmfile_entry_t *file = NULL;
+
+    assert(fp != NULL);
+
+    write_stream_string(fp, root);
+    fputc(files != NULL, fp);
+
+    if (files != NULL) {
+        TAILQ_FOREACH(file, files, items) {
+            fwrite(&file->idx, sizeof(file->idx), 1, fp);
+            fwrite(&file->st_size, sizeof(file->st_size), 1, fp);
+            fwrite(&file->st_mode, sizeof(file->st_mode), 1, fp);
+            fwrite(&file->st_nlink, sizeof(file->st_nlink), 1, fp);
+            fwrite(&file->flags, sizeof(file->flags), 1, fp);
+            write_stream_string(fp, file->fullpath);
+            write_stream_string(fp, file->localpath);
+        }
+    }
+
+    return !ferror(fp);
+}
+
+/**
+ * @brief Reconstruct an extracted package from a buffer.
+ *
+ * Read the output of write_files() and return the rpmfile_t list it
+ * describes.  Each entry refers to the given RPM Header.
+ *
+ * @param buf Buffer written by write_files().
+ * @param len Length of buf.
+ * @param hdr RPM Header of the extracted package.
+ * @param root Returns the directory the package was extracted to.
+ * @param ok Set to false if the buffer is malformed.
+ * @return rpmfile_t list, or NULL if extract_rpm() returned NULL or
+ *         the buffer is malformed.  The caller must free the list.
+ */
+rpmfile_t *read_files(const char *buf, const size_t len, Header hdr, char **root, bool *ok)
+{
+    const char *pos = buf;
+    const char *end = buf + len;
+    rpmfile_t *files = NULL;
+    rpmfile_entry_t *file = NULL;
+
+    assert(root != NULL);
+    assert(ok != NULL);
+
+    *ok = false;
+
+    if (buf == NULL || !read_stream_string(root, &pos, end) || pos >= end) {
+        return NULL;
+    }
+
+    if (*pos++ == 0) {
+        *ok = (pos == end);
+        return NULL;
+    }
+
+    files = xalloc(sizeof(*files));
+    TAILQ_INIT(files);
+
+    while (pos < end) {
+        file = xalloc(sizeof(*file));
+        file->rpm_header = hdr;
+        TAILQ_INSERT_TAIL(files, file, items);
+
+        if (!read_stream_field(&file->idx, sizeof(file->idx), &pos, end)
+            || !read_stream_field(&file->st_size, sizeof(file->st_size), &pos, end)
+            || !read_stream_field(&file->st_mode, sizeof(file->st_mode), &pos, end)
+            || !read_stream_field(&file->st_nlink, sizeof(file->st_nlink), &pos, end)
+            || !read_stream_field(&file->flags, sizeof(file->flags), &pos, end)
+            || !read_stream_string(&file->fullpath, &pos, end)
+            || !read_stream_string(&file->localpath, &pos, end)) {
+            free_files(files);
+            return NULL;
+        }
+    }
+
+    *ok = true;
+    return files;
+}
+
 static struct archive *new_archive_reader(void)
 {
     struct archive *a = NULL;
@@ -157,10 +385,14 @@ static struct archive *new_archive_reader(void)
  * @param hdr RPM Header for the specified package.
  * @param subdir The build subdirectory in workdir, but without the arch.
  * @param output_dir The directory where this package was extracted.
+ * @param contents False to only read the list of payload members
+ *                 without writing anything to disk (see
+ *                 need_payload()).  The fullpath of each member is
+ *                 still set but the file does not exist.
  * @return rpmfile_t list of all payload members.  The caller is
  *                   responsible for freeing this list.
  */
-rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const char *subdir, char **output_dir)
+rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const char *subdir, char **output_dir, const bool contents)
 {
     rpmtd td = NULL;
     int src = 0;
@@ -201,7 +433,7 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
     *output_dir = joindelim(PATH_SEP, ri->worksubdir, ROOT_SUBDIR, subdir, get_rpm_header_arch(hdr), NULL);
     assert(*output_dir != NULL);
 
-    if (mkdirp(*output_dir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == -1) {
+    if (contents && mkdirp(*output_dir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == -1) {
         free(*output_dir);
         return NULL;
     }
@@ -341,7 +573,7 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
 
         file_entry->flags = get_rpmtag_fileflags(hdr, file_entry->idx);
         file_entry->type = NULL;
-        file_entry->checksum = NULL;
+        memset(file_entry->checksums, 0, sizeof(file_entry->checksums));
 #ifdef _WITH_LIBCAP
         file_entry->cap = NULL;
 #endif
@@ -380,6 +612,16 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
         }
 
         xasprintf(&file_entry->fullpath, "%s%s%s", *output_dir, div, tmp);
+
+        /* header-only inspections just need the list of members */
+        if (!contents) {
+            if (archive_read_data_skip(archive) != ARCHIVE_OK) {
+                warnx("*** archive_read_data_skip: %s", archive_error_string(archive));
+            }
+
+            continue;
+        }
+
         archive_entry_set_pathname(entry, file_entry->fullpath);
 
         /* Ensure the resulting file is user-rw and global-unwritable */
@@ -523,6 +765,31 @@ static void set_peer(rpmfile_entry_t *file, struct file_data *fentry)
     return;
 }
 
+/*
+ * Return true if s is a number segment of a version string, that is
+ * one or more digits, underscores, or dashes.  Same as matching the
+ * regular expression ^[0-9_-]+$ but without compiling it for every
+ * path.
+ */
+static bool is_version_token(const char *s)
+{
+    assert(s != NULL);
+
+    if (*s == '\0') {
+        return false;
+    }
+
+    while (*s != '\0') {
+        if (!isdigit((unsigned char) *s) && *s != '_' && *s != '-') {
+            return false;
+        }
+
+        s++;
+    }
+
+    return true;
+}
+
 /**
  * @brief Helper for find_one_peer.  Turns version numbers embedded in
  * certain filenames to generic placeholders.  For example, it would
@@ -544,11 +811,8 @@ static char *comparable_version_substrings(const char *s, const char *ignore)
     char *orig = NULL;
     char *inner_orig = NULL;
     char *outer_orig = NULL;
-    int reg_result = 0;
     char *outer_token = NULL;
     char *inner_token = NULL;
-    regex_t num_regex;
-    char reg_error[BUFSIZ];
     char *result = NULL;
     int ignore_result = false;
     size_t i = 0;
@@ -557,15 +821,6 @@ static char *comparable_version_substrings(const char *s, const char *ignore)
 
     assert(s != NULL);
 
-    /* match number segments of the tail using a regex */
-    reg_result = regcomp(&num_regex, "^[0-9_-]+$", REG_EXTENDED);
-
-    if (reg_result != 0) {
-        regerror(reg_result, &num_regex, reg_error, sizeof(reg_error));
-        warn("*** regcomp: %s", reg_error);
-        return NULL;
-    }
-
     /* make a copy of the input */
     orig = outer_orig = strdup(s);
 
@@ -584,7 +839,7 @@ static char *comparable_version_substrings(const char *s, const char *ignore)
         }
 
         /* the outer tokens are directory parts, see if there's a versioned one */
-        if (!regexec(&num_regex, outer_token, 0, NULL, 0) || strcmp(outer_token, "lib64")) {
+        if (is_version_token(outer_token) || strcmp(outer_token, "lib64")) {
             inner_orig = strdup(outer_token);
 
             /* there is, break down this token in to version number parts */
@@ -606,7 +861,7 @@ static char *comparable_version_substrings(const char *s, const char *ignore)
                 /* make the version substring generic */
                 same = true;
 
-                if (!regexec(&num_regex, inner_token, 0, NULL, 0) || (strcmp(inner_token, DEBUG_SUBSTRING) && ignore_result)) {
+                if (is_version_token(inner_token) || (strcmp(inner_token, DEBUG_SUBSTRING) && ignore_result)) {
                     for (i = 0; i < strlen(inner_token); i++) {
                         if (isdigit(inner_token[i])) {
                             inner_token[i] = '?';
@@ -635,7 +890,6 @@ static char *comparable_version_substrings(const char *s, const char *ignore)
 
     /* clean up */
     free(orig);
-    regfree(&num_regex);
 
     return result;
 }
@@ -712,6 +966,167 @@ static char *path_verrel_substring(const char *path, const char *version, const
     return r;
 }
 
+/*
+ * Index of the after build files used to find files that moved.  Each
+ * key maps to the after build files that share it, kept in the order
+ * they appear in the after list so matches come out the same as a
+ * walk of the whole list would produce.
+ */
+struct peer_candidates {
+    char *key;                   /* basename or comparable path */
+    size_t num;                  /* number of files */
+    size_t *order;               /* position of each file in the after list */
+    rpmfile_entry_t **files;     /* the after build files */
+    UT_hash_handle hh;           /* makes this structure hashable */
+};
+
+struct peer_index {
+    bool built;                  /* true once build_peer_index() ran */
+    struct peer_candidates *by_basename;
+    struct peer_candidates *by_version;
+};
+
+static void add_peer_candidate(struct peer_candidates **table, const char *key, const size_t order, rpmfile_entry_t *file)
+{
+    struct peer_candidates *entry = NULL;
+
+    assert(table != NULL);
+    assert(key != NULL);
+    assert(file != NULL);
+
+    HASH_FIND_STR(*table, key, entry);
+
+    if (entry == NULL) {
+        entry = xcalloc(1, sizeof(*entry));
+        entry->key = strdup(key);
+        assert(entry->key != NULL);
+        HASH_ADD_KEYPTR(hh, *table, entry->key, strlen(entry->key), entry);
+    }
+
+    entry->order = xrealloc(entry->order, (entry->num + 1) * sizeof(*entry->order));
+    entry->files = xrealloc(entry->files, (entry->num + 1) * sizeof(*entry->files));
+    entry->order[entry->num] = order;
+    entry->files[entry->num] = file;
+    entry->num++;
+
+    return;
+}
+
+static void free_peer_candidates(struct peer_candidates *table)
+{
+    struct peer_candidates *entry = NULL;
+    struct peer_candidates *tmp_entry = NULL;
+
+    HASH_ITER(hh, table, entry, tmp_entry) {
+        HASH_DEL(table, entry);
+        free(entry->key);
+        free(entry->order);
+        free(entry->files);
+        free(entry);
+    }
+
+    return;
+}
+
+/*
+ * Index the after build by file basename, which is what a moved
+ * subpackage match needs, and by comparable version path for the
+ * libraries and kernel modules that can match across versions.
+ * Built on first use since most before files find their peer by
+ * path.
+ */
+static void build_peer_index(struct peer_index *index, rpmfile_t *after)
+{
+    rpmfile_entry_t *after_file = NULL;
+    const char *base = NULL;
+    const char *arch = NULL;
+    char *cmp = NULL;
+    size_t order = 0;
+
+    assert(index != NULL);
+    assert(after != NULL);
+
+    TAILQ_FOREACH(after_file, after, items) {
+        base = strrchr(after_file->localpath, '/');
+        base = (base == NULL) ? after_file->localpath : base + 1;
+        add_peer_candidate(&index->by_basename, base, order, after_file);
+
+        if (S_ISREG(after_file->st_mode)
+            && (strstr(after_file->localpath, ELF_LIB_EXTENSION) || strstr(after_file->fullpath, KERNEL_MODULES_DIR))) {
+            arch = get_rpm_header_arch(after_file->rpm_header);
+            assert(arch != NULL);
+            cmp = comparable_version_substrings(after_file->localpath, arch);
+
+            if (cmp) {
+                add_peer_candidate(&index->by_version, cmp, order, after_file);
+                free(cmp);
+            }
+        }
+
+        order++;
+    }
+
+    index->built = true;
+    return;
+}
+
+static void free_peer_index(struct peer_index *index)
+{
+    assert(index != NULL);
+
+    free_peer_candidates(index->by_basename);
+    free_peer_candidates(index->by_version);
+    index->by_basename = NULL;
+    index->by_version = NULL;
+    index->built = false;
+    return;
+}
+
+/*
+ * Helper for same_file_type().  Return the length of the leading
+ * part of a file(1) description, up to the first comma.  That is
+ * the kind of file ("ELF 64-bit LSB shared object", "ASCII text")
+ * without details such as the build ID that change between builds.
+ */
+static size_t file_class_kind(const char *class)
+{
+    return strcspn(class, ",");
+}
+
+/*
+ * Helper for find_one_peer().  Compare the file types of two files
+ * using only what the package headers record: the file mode and,
+ * for regular files, the file(1) class rpmbuild stored for the file
+ * (RPMTAG_FILECLASS).  Nothing is read from the payload so files
+ * match the same way no matter which inspections were selected.
+ * Packages built without file classes are compared on the mode.
+ */
+static bool same_file_type(const rpmfile_entry_t *a, const rpmfile_entry_t *b)
+{
+    bool r = true;
+    char *aclass = NULL;
+    char *bclass = NULL;
+
+    if ((a->st_mode & S_IFMT) != (b->st_mode & S_IFMT)) {
+        return false;
+    }
+
+    if (!S_ISREG(a->st_mode)) {
+        return true;
+    }
+
+    aclass = get_rpm_header_string_array_value(a, RPMTAG_FILECLASS);
+    bclass = get_rpm_header_string_array_value(b, RPMTAG_FILECLASS);
+
+    if (aclass && bclass) {
+        r = (file_class_kind(aclass) == file_class_kind(bclass) && !strncmp(aclass, bclass, file_class_kind(aclass)));
+    }
+
+    free(aclass);
+    free(bclass);
+    return r;
+}
+
 /**
  * @brief For the given file from "before", attempt to find a matching
  * file in "after".
@@ -730,11 +1145,16 @@ static char *path_verrel_substring(const char *path, const char *version, const
  * if it moved or not between builds.  This helps with the reporting
  * messages.
  *
+ * Moved files are matched on the file type recorded in the headers
+ * (see same_file_type()) rather than anything in the payload, so the
+ * peers are the same whether or not the payloads were extracted.
+ *
  * @param file rpmfile_entry_t with missing peer_file.
  * @param after After build rpmfile_t list.
  * @param after_table Hash table of after build rpmfile_t localpaths.
+ * @param index Index of after build files for moved file matching.
  */
-static void find_one_peer(struct rpminspect *ri, rpmfile_entry_t *file, rpmfile_t *after, struct file_data *after_table)
+static void find_one_peer(rpmfile_entry_t *file, rpmfile_t *after, struct file_data *after_table, struct peer_index *index)
 {
     struct file_data *entry = NULL;
     rpmfile_entry_t *after_file = NULL;
@@ -748,10 +1168,17 @@ static void find_one_peer(struct rpminspect *ri, rpmfile_entry_t *file, rpmfile_
     char *search_path = NULL;
     const char *arch = NULL;
     const char *after_arch = NULL;
+    const char *base = NULL;
+    struct peer_candidates *by_basename = NULL;
+    struct peer_candidates *by_version = NULL;
+    size_t b = 0;
+    size_t v = 0;
+    bool same_version = false;
 
     assert(file != NULL);
     assert(after != NULL);
     assert(after_table != NULL);
+    assert(index != NULL);
 
     /* used in a number of matching checks below */
     after_file = TAILQ_FIRST(after);
@@ -846,8 +1273,46 @@ static void find_one_peer(struct rpminspect *ri, rpmfile_entry_t *file, rpmfile_
         arch = get_rpm_header_arch(file->rpm_header);
         assert(arch != NULL);
 
-        /* look for a possible match for files that move locations */
-        TAILQ_FOREACH(after_file, after, items) {
+        /*
+         * Look for a possible match for files that move locations.
+         * Only after files sharing the basename or the comparable
+         * version path can match, so walk those in after list order.
+         */
+        if (!index->built) {
+            build_peer_index(index, after);
+        }
+
+        base = strrchr(file->localpath, '/');
+        base = (base == NULL) ? file->localpath : base + 1;
+        HASH_FIND_STR(index->by_basename, base, by_basename);
+
+        if (strstr(file->localpath, ELF_LIB_EXTENSION) || strstr(file->fullpath, KERNEL_MODULES_DIR)) {
+            before_tmp = comparable_version_substrings(file->localpath, arch);
+
+            if (before_tmp) {
+                HASH_FIND_STR(index->by_version, before_tmp, by_version);
+                free(before_tmp);
+                before_tmp = NULL;
+            }
+        }
+
+        while ((by_basename && b < by_basename->num) || (by_version && v < by_version->num)) {
+            /* take the next candidate, the same file may be in both lists */
+            if (by_version == NULL || v == by_version->num) {
+                after_file = by_basename->files[b++];
+                same_version = false;
+            } else if (by_basename == NULL || b == by_basename->num || by_version->order[v] < by_basename->order[b]) {
+                after_file = by_version->files[v++];
+                same_version = true;
+            } else if (by_basename->order[b] < by_version->order[v]) {
+                after_file = by_basename->files[b++];
+                same_version = false;
+            } else {
+                after_file = by_basename->files[b++];
+                v++;
+                same_version = true;
+            }
+
             /* skip files with peers */
             if (after_file->peer_file) {
                 continue;
@@ -863,12 +1328,12 @@ static void find_one_peer(struct rpminspect *ri, rpmfile_entry_t *file, rpmfile_
 
             /* match files that move between subpackages */
             if (strsuffix(after_file->localpath, file->localpath)
-                && !strcmp(get_mime_type(ri, file), get_mime_type(ri, after_file))
+                && same_file_type(file, after_file)
                 && strcmp(headerGetString(file->rpm_header, RPMTAG_NAME), headerGetString(after_file->rpm_header, RPMTAG_NAME))) {
                 /*
                  * This is a best guess that checks the following:
                  * - localpath
-                 * - MIME type
+                 * - file type from the header
                  *
                  * This may need refinement down the road to check other things.
                  */
@@ -883,7 +1348,7 @@ static void find_one_peer(struct rpminspect *ri, rpmfile_entry_t *file, rpmfile_
                     file->peer_file->moved_subpackage = true;
                     return;
                 }
-            } else if ((S_ISREG(file->st_mode) && S_ISREG(after_file->st_mode)) || (is_elf(file) && is_elf(after_file))) {
+            } else if (S_ISREG(file->st_mode) && S_ISREG(after_file->st_mode)) {
                 /*
                  * Try to match libraries that have changed versions.
                  * The idea is to look for ELF files that carry a
@@ -899,12 +1364,8 @@ static void find_one_peer(struct rpminspect *ri, rpmfile_entry_t *file, rpmfile_
                     continue;
                 }
 
-                /* create generic version number paths */
-                before_tmp = comparable_version_substrings(file->localpath, arch);
-                after_tmp = comparable_version_substrings(after_file->localpath, arch);
-
-                /* see if these generic paths match */
-                if (!strcmp(before_tmp, after_tmp)) {
+                /* comparable version paths match, see the index */
+                if (same_version) {
                     DEBUG_PRINT("%s probably replaced by %s\n", file->localpath, after_file->localpath);
                     HASH_FIND_STR(after_table, after_file->localpath, entry);
 
@@ -912,9 +1373,6 @@ static void find_one_peer(struct rpminspect *ri, rpmfile_entry_t *file, rpmfile_
                         set_peer(file, entry);
                     }
                 }
-
-                free(before_tmp);
-                free(after_tmp);
             }
         }
     }
@@ -940,6 +1398,7 @@ void find_file_peers(struct rpminspect *ri, rpmfile_t *before, rpmfile_t *after)
     struct file_data *after_table = NULL;
     struct file_data *entry = NULL;
     struct file_data *tmp_entry = NULL;
+    struct peer_index index = { 0 };
     rpmfile_entry_t *before_entry = NULL;
 
     assert(ri != NULL);
@@ -957,10 +1416,12 @@ void find_file_peers(struct rpminspect *ri, rpmfile_t *before, rpmfile_t *after)
 
     /* Match peers */
     TAILQ_FOREACH(before_entry, before, items) {
-        find_one_peer(ri, before_entry, after, after_table);
+        find_one_peer(before_entry, after, after_table, &index);
     }
 
-    /* Clean up the hash table */
+    /* Clean up the hash tables */
+    free_peer_index(&index);
+
     HASH_ITER(hh, after_table, entry, tmp_entry) {
         HASH_DEL(after_table, entry);
         free(entry);
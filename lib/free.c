@@ -121,16 +121,22 @@ void free_rpminspect(struct rpminspect *ri)
     free(ri->localcfg);
     list_free(ri->locallines, free);
     free(ri->workdir);
+    free(ri->cachedir);
+    free_cache();
     free(ri->profiledir);
     free(ri->remedyfile);
     free(ri->kojihub);
     free(ri->kojiursine);
     free(ri->kojimbs);
     free(ri->worksubdir);
+    free_curl_share();
+    free_koji_client();
 
     free(ri->vendor_data_dir);
     list_free(ri->licensedb, free);
 
+    HASH_CLEAR(hh, ri->fileinfo_table);
+
     if (ri->fileinfo) {
         while (!TAILQ_EMPTY(ri->fileinfo)) {
             fientry = TAILQ_FIRST(ri->fileinfo);
@@ -148,12 +154,15 @@ void free_rpminspect(struct rpminspect *ri)
 
     free(ri->fileinfo_filename);
 
+    free_rule_index(ri->caps_index);
+
     if (ri->caps) {
         while (!TAILQ_EMPTY(ri->caps)) {
             centry = TAILQ_FIRST(ri->caps);
             TAILQ_REMOVE(ri->caps, centry, items);
 
             free(centry->pkg);
+            free_rule_index(centry->files_index);
 
             if (centry->files) {
                 while (!TAILQ_EMPTY(centry->files)) {
@@ -179,6 +188,8 @@ void free_rpminspect(struct rpminspect *ri)
     list_free(ri->rebaseable, free);
     free(ri->rebaseable_filename);
 
+    free_rule_index(ri->politics_index);
+
     if (ri->politics) {
         while (!TAILQ_EMPTY(ri->politics)) {
             pentry = TAILQ_FIRST(ri->politics);
@@ -194,6 +205,8 @@ void free_rpminspect(struct rpminspect *ri)
 
     free(ri->politics_filename);
 
+    free_rule_index(ri->security_index);
+
     if (ri->security) {
         while (!TAILQ_EMPTY(ri->security)) {
             sentry = TAILQ_FIRST(ri->security);
@@ -219,7 +232,7 @@ void free_rpminspect(struct rpminspect *ri)
 
     free(ri->security_filename);
     list_free(ri->badwords, free);
-    list_free(ri->icons, free);
+    free_string_hash(ri->icons);
     free(ri->icons_filename);
 
     free_regex(ri->elf_path_include);
@@ -300,6 +313,7 @@ void free_rpminspect(struct rpminspect *ri)
     list_free(ri->runpath_allowed_origin_paths, free);
     list_free(ri->runpath_origin_prefix_trim, free);
     free_string_list_map(ri->inspection_ignores);
+    free_ignores(ri);
     list_free(ri->expected_empty_rpms, free);
     free_regex(ri->unicode_exclude);
     list_free(ri->unicode_excluded_mime_types, free);
@@ -310,6 +324,7 @@ void free_rpminspect(struct rpminspect *ri)
     list_free(ri->changelog_forbidden, free);
 
     free_peers(ri->peers);
+    free_rpm_file_tables();
 
     HASH_ITER(hh, ri->header_cache, hentry, tmp_hentry) {
         HASH_DEL(ri->header_cache, hentry);
@@ -12,6 +12,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <err.h>
+#include <fnmatch.h>
 #include <toml.h>
 #include "internal/callbacks.h"
 #include "parser.h"
@@ -677,6 +678,37 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
     strget(p, ctx, RI_COMMON, RI_PROFILEDIR, &ri->profiledir);
     strget(p, ctx, RI_COMMON, RI_REMEDYFILE, &ri->remedyfile);
 
+    s = p->getstr(ctx, RI_COMMON, RI_EXTRACT_JOBS);
+
+    if (s != NULL) {
+        errno = 0;
+        ri->extract_jobs = strtoul(s, 0, 10);
+
+        if (errno == ERANGE) {
+            warn("*** strtoul");
+            ri->extract_jobs = 0;
+        }
+
+        free(s);
+        s = NULL;
+    }
+
+    strget(p, ctx, RI_COMMON, RI_CACHEDIR, &ri->cachedir);
+    s = p->getstr(ctx, RI_COMMON, RI_CACHE_SIZE);
+
+    if (s != NULL) {
+        errno = 0;
+        ri->cache_size = strtoul(s, 0, 10);
+
+        if (errno == ERANGE) {
+            warn("*** strtoul");
+            ri->cache_size = DEFAULT_CACHE_SIZE;
+        }
+
+        free(s);
+        s = NULL;
+    }
+
     if (ri->remedyfile != NULL) {
         /* remedy override strings, try to read in */
         read_remedy(ri->remedyfile, ri);
@@ -686,6 +718,22 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
     strget(p, ctx, RI_KOJI, RI_HUB, &ri->kojihub);
     strget(p, ctx, RI_KOJI, RI_DOWNLOAD_URSINE, &ri->kojiursine);
     strget(p, ctx, RI_KOJI, RI_DOWNLOAD_MBS, &ri->kojimbs);
+
+    s = p->getstr(ctx, RI_KOJI, RI_DOWNLOAD_JOBS);
+
+    if (s != NULL) {
+        errno = 0;
+        ri->download_jobs = strtoul(s, 0, 10);
+
+        if (errno == ERANGE) {
+            warn("*** strtoul");
+            ri->download_jobs = 0;
+        }
+
+        free(s);
+        s = NULL;
+    }
+
     strget(p, ctx, RI_COMMANDS, RI_MSGUNFMT, &ri->commands.msgunfmt);
     strget(p, ctx, RI_COMMANDS, RI_DESKTOP_FILE_VALIDATE, &ri->commands.desktop_file_validate);
     strget(p, ctx, RI_COMMANDS, RI_ABIDIFF, &ri->commands.abidiff);
@@ -1002,6 +1050,7 @@ bool init_fileinfo(struct rpminspect *ri)
     char *fnpart = NULL;
     fileinfo_field_t field = MODE;
     fileinfo_entry_t *fientry = NULL;
+    fileinfo_entry_t *found = NULL;
 
     assert(ri != NULL);
     assert(ri->vendor_data_dir != NULL);
@@ -1088,9 +1137,14 @@ bool init_fileinfo(struct rpminspect *ri)
             field++;
         }
 
-        /* add the entry */
+        /* add the entry, the first one for a filename is used for lookups */
         if (fientry != NULL) {
             TAILQ_INSERT_TAIL(ri->fileinfo, fientry, items);
+            HASH_FIND_STR(ri->fileinfo_table, fientry->filename, found);
+
+            if (found == NULL) {
+                HASH_ADD_KEYPTR(hh, ri->fileinfo_table, fientry->filename, strlen(fientry->filename), fientry);
+            }
         }
 
         /* clean up */
@@ -1235,6 +1289,20 @@ bool init_caps(struct rpminspect *ri)
 
     list_free(contents, free);
 
+    /* index the packages and their files for get_caps_entry() */
+    ri->caps_index = new_rule_index(FNM_NOESCAPE);
+
+    TAILQ_FOREACH(centry, ri->caps, items) {
+        rule_index_add(ri->caps_index, centry->pkg, centry);
+        centry->files_index = new_rule_index(FNM_NOESCAPE);
+
+        TAILQ_FOREACH(filelist_entry, centry->files, items) {
+            if (filelist_entry->path != NULL) {
+                rule_index_add(centry->files_index, filelist_entry->path, filelist_entry);
+            }
+        }
+    }
+
     return true;
 }
 #endif
@@ -1309,6 +1377,7 @@ bool init_politics(struct rpminspect *ri)
     string_entry_t *entry = NULL;
     char *line = NULL;
     char *token = NULL;
+    int flags = 0;
     politics_entry_t *pentry = NULL;
     politics_field_t field = PATTERN;
 
@@ -1394,6 +1463,34 @@ bool init_politics(struct rpminspect *ri)
 
     list_free(contents, free);
 
+    /* index the patterns for the politics inspection */
+    flags = FNM_PERIOD;
+#ifdef FNM_EXTMATCH
+    /* glibc provides this extended pattern matching syntax */
+    flags |= FNM_EXTMATCH;
+#endif
+    ri->politics_index = new_rule_index(flags);
+
+    TAILQ_FOREACH(pentry, ri->politics, items) {
+        /* malformatted lines */
+        if (pentry->pattern == NULL || pentry->digest == NULL) {
+            warnx(_("*** invalid politics entry with pattern=%s and digest=%s"), pentry->pattern, pentry->digest);
+            continue;
+        }
+
+        /* get the type of digest string */
+        if (strcmp(pentry->digest, "*")) {
+            pentry->type = get_digest_type(pentry->digest);
+
+            if (pentry->type == NULLSUM) {
+                warnx(_("*** unknown digest type for pattern %s: %s"), pentry->pattern, pentry->digest);
+                continue;
+            }
+        }
+
+        rule_index_add(ri->politics_index, pentry->pattern, pentry);
+    }
+
     return true;
 }
 
@@ -1572,18 +1669,26 @@ bool init_security(struct rpminspect *ri)
 
     list_free(contents, free);
 
+    /* index the rules by path for get_secrule_by_path() */
+    ri->security_index = new_rule_index(FNM_NOESCAPE);
+
+    TAILQ_FOREACH(sentry, ri->security, items) {
+        rule_index_add(ri->security_index, sentry->path, sentry);
+    }
+
     return true;
 }
 
 /*
- * Initialize the icons list for the given product release and cache
- * it.  Return the cached list.  If the file cannot be found, return
- * false.
+ * Initialize the icons set for the given product release and cache
+ * it.  Return false if the file cannot be found or lists no icons.
+ * The file is only read once, even if that fails.
  */
 bool init_icons(struct rpminspect *ri)
 {
     string_list_t *contents = NULL;
     string_entry_t *entry = NULL;
+    string_hash_t *icon = NULL;
     char *line = NULL;
 
     assert(ri != NULL);
@@ -1591,8 +1696,8 @@ bool init_icons(struct rpminspect *ri)
     assert(ri->product_release != NULL);
 
     /* already initialized */
-    if (ri->icons) {
-        return true;
+    if (ri->icons_filename) {
+        return ri->icons != NULL;
     }
 
     /* the actual icons list file */
@@ -1604,11 +1709,7 @@ bool init_icons(struct rpminspect *ri)
         return false;
     }
 
-    /* initialize the list */
-    ri->icons = xalloc(sizeof(*(ri->icons)));
-    TAILQ_INIT(ri->icons);
-
-    /* add all the entries to the icons list */
+    /* add all the entries to the icons set */
     TAILQ_FOREACH(entry, contents, items) {
         if (entry->data == NULL) {
             continue;
@@ -1623,13 +1724,20 @@ bool init_icons(struct rpminspect *ri)
             continue;
         }
 
-        /* add the entry to the actual list */
-        ri->icons = list_add(ri->icons, line);
+        /* add the entry to the actual set */
+        HASH_FIND_STR(ri->icons, line, icon);
+
+        if (icon == NULL) {
+            icon = xalloc(sizeof(*icon));
+            icon->data = strdup(line);
+            assert(icon->data != NULL);
+            HASH_ADD_KEYPTR(hh, ri->icons, icon->data, strlen(icon->data), icon);
+        }
     }
 
     list_free(contents, free);
 
-    return true;
+    return ri->icons != NULL;
 }
 
 /*
@@ -1646,6 +1754,7 @@ struct rpminspect *xalloc_rpminspect(struct rpminspect *ri)
 
     /* Initialize the struct before reading files */
     ri->workdir = strdup(DEFAULT_WORKDIR);
+    ri->cache_size = DEFAULT_CACHE_SIZE;
     ri->vendor_data_dir = strdup(VENDOR_DATA_DIR);
     ri->favor_release = FAVOR_NEWEST;
     ri->tests = ~0;
@@ -1797,5 +1906,13 @@ struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, c
         ri->peers = init_peers();
     }
 
+    /* compile the ignore lists now that all config files are read */
+    compile_ignores(ri);
+
+    /* use the analysis cache if one is configured */
+    if (ri->cachedir) {
+        (void) init_cache(ri->cachedir);
+    }
+
     return ri;
 }
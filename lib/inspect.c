@@ -25,65 +25,66 @@ struct inspect inspections[] = {
      *   "short name",
      *   bool--true if this inspection contains security checks,
      *   bool--true if for single build, false if before&after required,
+     *   bool--true if the inspection reads file contents from the payload,
      *   &function_pointer },
      *
      * NOTE: long descriptions are inspect.h and returned by inspection_desc()
      */
-    { INSPECT_ABIDIFF,       "abidiff",       false, false, &inspect_abidiff },
-    { INSPECT_ADDEDFILES,    "addedfiles",    true,  true,  &inspect_addedfiles },
+    { INSPECT_ABIDIFF,       "abidiff",       false, false, true,  &inspect_abidiff },
+    { INSPECT_ADDEDFILES,    "addedfiles",    true,  true,  true,  &inspect_addedfiles },
 #if defined(_WITH_ANNOCHECK) || defined(_WITH_LIBANNOCHECK)
-    { INSPECT_ANNOCHECK,     "annocheck",     true,  true,  &inspect_annocheck },
+    { INSPECT_ANNOCHECK,     "annocheck",     true,  true,  true,  &inspect_annocheck },
 #endif
-    { INSPECT_ARCH,          "arch",          false, false, &inspect_arch },
-    { INSPECT_BADFUNCS,      "badfuncs",      false, true,  &inspect_badfuncs },
+    { INSPECT_ARCH,          "arch",          false, false, false, &inspect_arch },
+    { INSPECT_BADFUNCS,      "badfuncs",      false, true,  true,  &inspect_badfuncs },
 #ifdef _WITH_LIBCAP
-    { INSPECT_CAPABILITIES,  "capabilities",  true,  true,  &inspect_capabilities },
+    { INSPECT_CAPABILITIES,  "capabilities",  true,  true,  true,  &inspect_capabilities },
 #endif
-    { INSPECT_CHANGEDFILES,  "changedfiles",  true,  false, &inspect_changedfiles },
-    { INSPECT_CHANGELOG,     "changelog",     false, false, &inspect_changelog },
-    { INSPECT_CONFIG,        "config",        false, false, &inspect_config },
-    { INSPECT_DEBUGINFO,     "debuginfo",     false, true,  &inspect_debuginfo },
-    { INSPECT_DESKTOP,       "desktop",       false, true,  &inspect_desktop },
-    { INSPECT_DISTTAG,       "disttag",       false, true,  &inspect_disttag },
-    { INSPECT_DOC,           "doc",           false, false, &inspect_doc },
-    { INSPECT_DSODEPS,       "dsodeps",       false, false, &inspect_dsodeps },
-    { INSPECT_ELF,           "elf",           true,  true,  &inspect_elf },
-    { INSPECT_EMPTYRPM,      "emptyrpm",      false, true,  &inspect_emptyrpm },
-    { INSPECT_FILES,         "files",         false, true,  &inspect_files },
-    { INSPECT_FILESIZE,      "filesize",      false, false, &inspect_filesize },
-    { INSPECT_JAVABYTECODE,  "javabytecode",  false, true,  &inspect_javabytecode },
-    { INSPECT_KMIDIFF,       "kmidiff",       false, false, &inspect_kmidiff },
+    { INSPECT_CHANGEDFILES,  "changedfiles",  true,  false, true,  &inspect_changedfiles },
+    { INSPECT_CHANGELOG,     "changelog",     false, false, false, &inspect_changelog },
+    { INSPECT_CONFIG,        "config",        false, false, true,  &inspect_config },
+    { INSPECT_DEBUGINFO,     "debuginfo",     false, true,  true,  &inspect_debuginfo },
+    { INSPECT_DESKTOP,       "desktop",       false, true,  true,  &inspect_desktop },
+    { INSPECT_DISTTAG,       "disttag",       false, true,  true,  &inspect_disttag },
+    { INSPECT_DOC,           "doc",           false, false, true,  &inspect_doc },
+    { INSPECT_DSODEPS,       "dsodeps",       false, false, true,  &inspect_dsodeps },
+    { INSPECT_ELF,           "elf",           true,  true,  true,  &inspect_elf },
+    { INSPECT_EMPTYRPM,      "emptyrpm",      false, true,  false, &inspect_emptyrpm },
+    { INSPECT_FILES,         "files",         false, true,  true,  &inspect_files },
+    { INSPECT_FILESIZE,      "filesize",      false, false, true,  &inspect_filesize },
+    { INSPECT_JAVABYTECODE,  "javabytecode",  false, true,  true,  &inspect_javabytecode },
+    { INSPECT_KMIDIFF,       "kmidiff",       false, false, true,  &inspect_kmidiff },
 #ifdef _WITH_LIBKMOD
-    { INSPECT_KMOD,          "kmod",          false, false, &inspect_kmod },
+    { INSPECT_KMOD,          "kmod",          false, false, true,  &inspect_kmod },
 #endif
-    { INSPECT_LICENSE,       "license",       false, true,  &inspect_license },
-    { INSPECT_LOSTPAYLOAD,   "lostpayload",   false, false, &inspect_lostpayload },
-    { INSPECT_LTO,           "lto",           false, true,  &inspect_lto },
-    { INSPECT_MANPAGE,       "manpage",       false, true,  &inspect_manpage },
-    { INSPECT_METADATA,      "metadata",      false, true,  &inspect_metadata },
+    { INSPECT_LICENSE,       "license",       false, true,  false, &inspect_license },
+    { INSPECT_LOSTPAYLOAD,   "lostpayload",   false, false, false, &inspect_lostpayload },
+    { INSPECT_LTO,           "lto",           false, true,  true,  &inspect_lto },
+    { INSPECT_MANPAGE,       "manpage",       false, true,  true,  &inspect_manpage },
+    { INSPECT_METADATA,      "metadata",      false, true,  false, &inspect_metadata },
 #ifdef _HAVE_MODULARITYLABEL
-    { INSPECT_MODULARITY,    "modularity",    false, true,  &inspect_modularity },
+    { INSPECT_MODULARITY,    "modularity",    false, true,  false, &inspect_modularity },
 #endif
-    { INSPECT_MOVEDFILES,    "movedfiles",    false, false, &inspect_movedfiles },
-    { INSPECT_OWNERSHIP,     "ownership",     true,  true,  &inspect_ownership },
-    { INSPECT_PATCHES,       "patches",       false, true,  &inspect_patches },
-    { INSPECT_PATHMIGRATION, "pathmigration", false, true,  &inspect_pathmigration },
-    { INSPECT_PERMISSIONS,   "permissions",   true,  true,  &inspect_permissions },
-    { INSPECT_POLITICS,      "politics",      false, true,  &inspect_politics },
-    { INSPECT_REMOVEDFILES,  "removedfiles",  true,  false, &inspect_removedfiles },
-    { INSPECT_RPMDEPS,       "rpmdeps",       false, true,  &inspect_rpmdeps },
-    { INSPECT_RUNPATH,       "runpath",       false, true,  &inspect_runpath },
-    { INSPECT_SHELLSYNTAX,   "shellsyntax",   false, true,  &inspect_shellsyntax },
-    { INSPECT_SPECNAME,      "specname",      false, true,  &inspect_specname },
-    { INSPECT_SUBPACKAGES,   "subpackages",   false, false, &inspect_subpackages },
-    { INSPECT_SYMLINKS,      "symlinks",      false, true,  &inspect_symlinks },
-    { INSPECT_TYPES,         "types",         false, false, &inspect_types },
-    { INSPECT_UDEVRULES,     "udevrules",     false, true,  &inspect_udevrules },
-    { INSPECT_UNICODE,       "unicode",       false, true,  &inspect_unicode },
-    { INSPECT_UPSTREAM,      "upstream",      false, false, &inspect_upstream },
-    { INSPECT_VIRUS,         "virus",         true,  true,  &inspect_virus },
-    { INSPECT_XML,           "xml",           false, true,  &inspect_xml },
-    { 0,                     NULL,            false, false, NULL }
+    { INSPECT_MOVEDFILES,    "movedfiles",    false, false, false, &inspect_movedfiles },
+    { INSPECT_OWNERSHIP,     "ownership",     true,  true,  false, &inspect_ownership },
+    { INSPECT_PATCHES,       "patches",       false, true,  true,  &inspect_patches },
+    { INSPECT_PATHMIGRATION, "pathmigration", false, true,  false, &inspect_pathmigration },
+    { INSPECT_PERMISSIONS,   "permissions",   true,  true,  true,  &inspect_permissions },
+    { INSPECT_POLITICS,      "politics",      false, true,  true,  &inspect_politics },
+    { INSPECT_REMOVEDFILES,  "removedfiles",  true,  false, true,  &inspect_removedfiles },
+    { INSPECT_RPMDEPS,       "rpmdeps",       false, true,  false, &inspect_rpmdeps },
+    { INSPECT_RUNPATH,       "runpath",       false, true,  true,  &inspect_runpath },
+    { INSPECT_SHELLSYNTAX,   "shellsyntax",   false, true,  true,  &inspect_shellsyntax },
+    { INSPECT_SPECNAME,      "specname",      false, true,  false, &inspect_specname },
+    { INSPECT_SUBPACKAGES,   "subpackages",   false, false, false, &inspect_subpackages },
+    { INSPECT_SYMLINKS,      "symlinks",      false, true,  true,  &inspect_symlinks },
+    { INSPECT_TYPES,         "types",         false, false, true,  &inspect_types },
+    { INSPECT_UDEVRULES,     "udevrules",     false, true,  true,  &inspect_udevrules },
+    { INSPECT_UNICODE,       "unicode",       false, true,  true,  &inspect_unicode },
+    { INSPECT_UPSTREAM,      "upstream",      false, false, true,  &inspect_upstream },
+    { INSPECT_VIRUS,         "virus",         true,  true,  true,  &inspect_virus },
+    { INSPECT_XML,           "xml",           false, true,  true,  &inspect_xml },
+    { 0,                     NULL,            false, false, false, NULL }
 };
 
 /*
@@ -104,6 +105,26 @@ bool has_security_checks(const char *inspection)
     return false;
 }
 
+/*
+ * Returns true if any of the selected inspections read the contents
+ * of files in the packages, false if the package headers and file
+ * lists are enough.
+ */
+bool need_payload(const struct rpminspect *ri)
+{
+    int i = 0;
+
+    assert(ri != NULL);
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if ((ri->tests & inspections[i].flag) && inspections[i].payload) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /**
  * @brief Iterate over each file in each package in a build.
  *
@@ -17,6 +17,7 @@
 #include "queue.h"
 #include "uthash.h"
 #include "rpminspect.h"
+#include "parallel.h"
 
 /* Globals */
 static char *cmdprefix = NULL;
@@ -25,6 +26,30 @@ static abi_t *abi = NULL;
 static pair_list_t *before_headers = NULL;
 static pair_list_t *after_headers = NULL;
 
+/*
+ * The debug and header directory arguments for one architecture.
+ * These only depend on the architecture, so they are built once by
+ * get_arch_args() and shared by every file.
+ */
+struct arch_args {
+    char *arch;
+    char *args;
+    UT_hash_handle hh;
+};
+
+static struct arch_args *arch_args = NULL;
+
+/* A shared library queued by abidiff_driver() and its result */
+struct abidiff_job {
+    rpmfile_entry_t *file;
+    const char *arch;
+    char *cmd;
+    cmd_result_t result;
+    TAILQ_ENTRY(abidiff_job) items;
+};
+
+static TAILQ_HEAD(abidiff_jobs_s, abidiff_job) jobs;
+
 /*
  * Helper function for build_header_list().
  */
@@ -141,23 +166,95 @@ static severity_t check_abi(const severity_t sev, const long int threshold, cons
     return sev;
 }
 
-static bool abidiff_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+/*
+ * Return the abidiff debug and header directory arguments for the
+ * given architecture.
+ */
+static const char *get_arch_args(const struct rpminspect *ri, const char *arch)
 {
-    bool result = true;
-    bool rebase = false;
-    char **argv = NULL;
-    string_entry_t *entry = NULL;
+    struct arch_args *entry = NULL;
     pair_entry_t *pair = NULL;
+    char *tmp = NULL;
+    char *args = NULL;
+
+    assert(ri != NULL);
+    assert(arch != NULL);
+
+    HASH_FIND_STR(arch_args, arch, entry);
+
+    if (entry != NULL) {
+        return entry->args;
+    }
+
+    /* debug dir1 args */
+    tmp = joindelim(PATH_SEP, ri->worksubdir, ROOT_SUBDIR, BEFORE_SUBDIR, arch, DEBUG_PATH, NULL);
+    assert(tmp != NULL);
+    args = strappend(args, ABI_DEBUG_INFO_DIR1, " ", tmp, NULL);
+    assert(args != NULL);
+    free(tmp);
+
+    /* header dir1 args */
+    if (before_headers && !TAILQ_EMPTY(before_headers)) {
+        TAILQ_FOREACH(pair, before_headers, items) {
+            if (pair->key && pair->value && !strcmp(pair->value, arch)) {
+                args = strappend(args, " ", ABI_HEADERS_DIR1, " ", pair->key, NULL);
+                assert(args != NULL);
+            }
+        }
+    }
+
+    /* debug dir2 args */
+    tmp = joindelim(PATH_SEP, ri->worksubdir, ROOT_SUBDIR, AFTER_SUBDIR, arch, DEBUG_PATH, NULL);
+    assert(tmp != NULL);
+    args = strappend(args, " ", ABI_DEBUG_INFO_DIR2, " ", tmp, NULL);
+    assert(args != NULL);
+    free(tmp);
+
+    /* header dir2 args */
+    if (after_headers && !TAILQ_EMPTY(after_headers)) {
+        TAILQ_FOREACH(pair, after_headers, items) {
+            if (pair->key && pair->value && !strcmp(pair->value, arch)) {
+                args = strappend(args, " ", ABI_HEADERS_DIR2, " ", pair->key, NULL);
+                assert(args != NULL);
+            }
+        }
+    }
+
+    entry = xalloc(sizeof(*entry));
+    entry->arch = strdup(arch);
+    assert(entry->arch != NULL);
+    entry->args = args;
+    HASH_ADD_KEYPTR(hh, arch_args, entry->arch, strlen(entry->arch), entry);
+
+    return entry->args;
+}
+
+static void free_arch_args(void)
+{
+    struct arch_args *entry = NULL;
+    struct arch_args *tmp = NULL;
+
+    HASH_ITER(hh, arch_args, entry, tmp) {
+        HASH_DEL(arch_args, entry);
+        free(entry->arch);
+        free(entry->args);
+        free(entry);
+    }
+
+    arch_args = NULL;
+    return;
+}
+
+/*
+ * Find ELF shared libraries with a peer.  They are compared by
+ * inspect_abidiff() and reported by report_abidiff_job().
+ */
+static bool abidiff_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+{
+    struct abidiff_job *job = NULL;
     const char *arch = NULL;
-    const char *name = NULL;
     char *soname = NULL;
-    int exitcode = 0;
     char *cmd = NULL;
-    char *tmp = NULL;
-    char *output = NULL;
-    struct result_params params;
-    bool report = false;
-    long int compat_level = 0;
 
     assert(ri != NULL);
     assert(file != NULL);
@@ -196,60 +293,40 @@ static bool abidiff_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     /* get the package architecture */
     arch = get_rpm_header_arch(file->rpm_header);
 
-    /* build the abidiff command */
-    cmd = strdup(cmdprefix);
+    /* build the abidiff command, the before and after builds go last */
+    xasprintf(&cmd, "%s %s %s %s", cmdprefix, get_arch_args(ri, arch), file->peer_file->fullpath, file->fullpath);
     assert(cmd != NULL);
 
-    if (suppressions && !TAILQ_EMPTY(suppressions)) {
-        TAILQ_FOREACH(entry, suppressions, items) {
-            cmd = strappend(cmd, " ", entry->data, NULL);
-        }
-    }
+    job = xalloc(sizeof(*job));
+    job->file = file;
+    job->arch = arch;
+    job->cmd = cmd;
+    TAILQ_INSERT_TAIL(&jobs, job, items);
 
-    /* debug dir1 args */
-    tmp = joindelim(PATH_SEP, ri->worksubdir, ROOT_SUBDIR, BEFORE_SUBDIR, arch, DEBUG_PATH, NULL);
-    assert(tmp != NULL);
-    cmd = strappend(cmd, " ", ABI_DEBUG_INFO_DIR1, " ", tmp, NULL);
-    assert(cmd != NULL);
-    free(tmp);
-
-    /* header dir1 args */
-    if (before_headers && !TAILQ_EMPTY(before_headers)) {
-        TAILQ_FOREACH(pair, before_headers, items) {
-            if (pair->key && pair->value && !strcmp(pair->value, arch)) {
-                cmd = strappend(cmd, " ", ABI_HEADERS_DIR1, " ", pair->key, NULL);
-                assert(cmd != NULL);
-            }
-        }
-    }
-
-    /* debug dir2 args */
-    tmp = joindelim(PATH_SEP, ri->worksubdir, ROOT_SUBDIR, AFTER_SUBDIR, arch, DEBUG_PATH, NULL);
-    assert(tmp != NULL);
-    cmd = strappend(cmd, " ", ABI_DEBUG_INFO_DIR2, " ", tmp, NULL);
-    assert(cmd != NULL);
-    free(tmp);
-
-    /* header dir2 args */
-    if (after_headers && !TAILQ_EMPTY(after_headers)) {
-        TAILQ_FOREACH(pair, after_headers, items) {
-            if (pair->key && pair->value && !strcmp(pair->value, arch)) {
-                cmd = strappend(cmd, " ", ABI_HEADERS_DIR2, " ", pair->key, NULL);
-                assert(cmd != NULL);
-            }
-        }
-    }
+    return true;
+}
 
-    /* the before and after builds */
-    cmd = strappend(cmd, " ", file->peer_file->fullpath, " ", file->fullpath, NULL);
+/*
+ * Report the abidiff results for one shared library.  Returns false
+ * if ABI differences were found.
+ */
+static bool report_abidiff_job(struct rpminspect *ri, const struct abidiff_job *job, const bool rebase)
+{
+    bool result = true;
+    rpmfile_entry_t *file = NULL;
+    const char *arch = NULL;
+    const char *name = NULL;
+    int exitcode = 0;
+    struct result_params params;
+    bool report = false;
+    long int compat_level = 0;
 
-    /* run abidiff */
-    argv = build_argv(cmd);
-    output = run_cmd_vp(&exitcode, NULL, argv);
-    free_argv(argv);
+    assert(ri != NULL);
+    assert(job != NULL);
 
-    /* determine if this is a rebase build */
-    rebase = is_rebase(ri);
+    file = job->file;
+    arch = job->arch;
+    exitcode = job->result.exitcode;
 
     /* report the results */
     init_result_params(&params);
@@ -307,17 +384,13 @@ static bool abidiff_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
 
         params.file = file->localpath;
-        xasprintf(&params.details, _("Command: %s\n\n%s"), cmd, output);
+        xasprintf(&params.details, _("Command: %s\n\n%s"), job->cmd, job->result.output);
         add_result(ri, &params);
         free(params.msg);
         free(params.details);
         result = false;
     }
 
-    /* cleanup */
-    free(cmd);
-    free(output);
-
     return result;
 }
 
@@ -327,7 +400,12 @@ static bool abidiff_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 bool inspect_abidiff(struct rpminspect *ri)
 {
     bool result = false;
+    bool rebase = false;
     rpmpeer_entry_t *peer = NULL;
+    string_entry_t *entry = NULL;
+    struct abidiff_job *job = NULL;
+    cmdpool_t *pool = NULL;
+    char **argv = NULL;
     struct result_params params;
 
     assert(ri != NULL);
@@ -345,20 +423,65 @@ bool inspect_abidiff(struct rpminspect *ri)
         cmdprefix = strdup(ri->commands.abidiff);
     }
 
+    assert(cmdprefix != NULL);
+
+    if (suppressions && !TAILQ_EMPTY(suppressions)) {
+        TAILQ_FOREACH(entry, suppressions, items) {
+            cmdprefix = strappend(cmdprefix, " ", entry->data, NULL);
+            assert(cmdprefix != NULL);
+        }
+    }
+
     /* gather header directories */
     TAILQ_FOREACH(peer, ri->peers, items) {
         build_header_list(peer);
     }
 
-    /* run the main inspection */
+    /* find the shared libraries to compare */
+    TAILQ_INIT(&jobs);
     result = foreach_peer_file(ri, NAME_ABIDIFF, abidiff_driver);
 
+    /*
+     * abidiff runs one comparison per invocation and can use a lot of
+     * memory on large libraries, so run as many as the available
+     * memory allows.
+     */
+    if (!TAILQ_EMPTY(&jobs)) {
+        pool = new_cmdpool(get_memory_limited_processes(ABIDIFF_JOB_MEMORY));
+
+        TAILQ_FOREACH(job, &jobs, items) {
+            argv = build_argv(job->cmd);
+            cmdpool_add(pool, NULL, argv, cmdpool_store_result, &job->result);
+            free_argv(argv);
+        }
+
+        cmdpool_wait(pool);
+        free_cmdpool(pool);
+    }
+
+    /* report in the order the files were found */
+    rebase = is_rebase(ri);
+
+    while (!TAILQ_EMPTY(&jobs)) {
+        job = TAILQ_FIRST(&jobs);
+        TAILQ_REMOVE(&jobs, job, items);
+
+        if (!report_abidiff_job(ri, job, rebase)) {
+            result = false;
+        }
+
+        free(job->cmd);
+        free(job->result.output);
+        free(job);
+    }
+
     /* clean up */
     free_abi(abi);
     free(cmdprefix);
     list_free(suppressions, free);
     free_pair(before_headers);
     free_pair(after_headers);
+    free_arch_args();
 
     /* report the inspection results */
     if (result) {
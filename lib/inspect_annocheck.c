@@ -15,6 +15,7 @@
 #endif
 
 #include "rpminspect.h"
+#include "parallel.h"
 
 /* Global variables */
 static bool reported = false;
@@ -86,6 +87,172 @@ static char *build_annocheck_cmd(const char *cmd, const char *opts, const char *
 
     return r;
 }
+
+/* One annocheck test run on an ELF file and its before peer */
+struct annocheck_run {
+    const char *test;
+    char *after_cmd;
+    char *before_cmd;
+    cmd_result_t after;
+    cmd_result_t before;
+};
+
+/* An ELF file queued by annocheck_driver() and its test runs */
+struct annocheck_job {
+    rpmfile_entry_t *file;
+    const char *arch;
+    bool ignore;
+    unsigned int nruns;
+    struct annocheck_run *runs;
+    TAILQ_ENTRY(annocheck_job) items;
+};
+
+static TAILQ_HEAD(annocheck_jobs_s, annocheck_job) jobs;
+static cmdpool_t *pool = NULL;
+
+/*
+ * Report the annocheck(1) results for one ELF file once all of the
+ * queued commands have finished.  Returns false if a test failed at
+ * or above the failure severity.
+ */
+static bool report_annocheck_job(struct rpminspect *ri, struct annocheck_job *job)
+{
+    bool result = true;
+    unsigned int i = 0;
+    rpmfile_entry_t *file = job->file;
+    const char *arch = job->arch;
+    struct annocheck_run *run = NULL;
+    char *before_cmd = NULL;
+    char *after_cmd = NULL;
+    char *after_out = NULL;
+    int after_exit = 0;
+    char *before_out = NULL;
+    int before_exit = 0;
+    char *details = NULL;
+    string_list_t *slist = NULL;
+    string_entry_t *sentry = NULL;
+    struct result_params params;
+
+    /* Set up the result parameters */
+    init_result_params(&params);
+    params.header = NAME_ANNOCHECK;
+    params.severity = RESULT_INFO;
+    params.waiverauth = NOT_WAIVABLE;
+    params.remedy = REMEDY_ANNOCHECK;
+    params.verb = VERB_OK;
+    params.arch = arch;
+    params.file = file->localpath;
+
+    for (i = 0; i < job->nruns; i++) {
+        run = &job->runs[i];
+        after_cmd = run->after_cmd;
+        before_cmd = run->before_cmd;
+        after_exit = run->after.exitcode;
+        after_out = run->after.output;
+        before_exit = run->before.exitcode;
+        before_out = run->before.output;
+
+        /* Compare with the before build if we ran the test on that */
+        if (!job->ignore) {
+            if (file->peer_file) {
+                /* Build a reporting message if we need to */
+                if (before_exit == 0 && after_exit == 0) {
+                    xasprintf(&params.msg, _("annocheck '%s' test passes for %s on %s"), run->test, file->localpath, arch);
+                } else if (before_exit && after_exit == 0) {
+                    xasprintf(&params.msg, _("annocheck '%s' test now passes for %s on %s"), run->test, file->localpath, arch);
+                } else if (before_exit == 0 && after_exit) {
+                    xasprintf(&params.msg, _("annocheck '%s' test now fails for %s on %s"), run->test, file->localpath, arch);
+                    params.severity = ri->annocheck_failure_severity;
+                    params.waiverauth = WAIVABLE_BY_ANYONE;
+                    params.verb = VERB_CHANGED;
+                    result = !(ri->annocheck_failure_severity >= RESULT_VERIFY);
+                } else if (after_exit) {
+                    xasprintf(&params.msg, _("annocheck '%s' test fails for %s on %s"), run->test, file->localpath, arch);
+                    params.severity = ri->annocheck_failure_severity;
+                    params.waiverauth = WAIVABLE_BY_ANYONE;
+                    params.verb = VERB_CHANGED;
+                    result = !(ri->annocheck_failure_severity >= RESULT_VERIFY);
+                }
+            } else {
+                if (after_exit == 0) {
+                    xasprintf(&params.msg, _("annocheck '%s' test passes for %s on %s"), run->test, file->localpath, arch);
+                } else if (after_exit) {
+                    xasprintf(&params.msg, _("annocheck '%s' test fails for %s on %s"), run->test, file->localpath, arch);
+                    params.severity = ri->annocheck_failure_severity;
+                    params.waiverauth = WAIVABLE_BY_ANYONE;
+                    params.verb = VERB_CHANGED;
+                    result = !(ri->annocheck_failure_severity >= RESULT_VERIFY);
+                }
+            }
+
+            /* Report the results */
+            if (params.msg) {
+                /* trim the before build working directory and generate details */
+                if (before_cmd) {
+                    before_cmd = trim_workdir(file->peer_file, before_cmd);
+                    xasprintf(&details, "Command: %s\nExit Code: %d\n    compared with the output of:\nCommand: %s\nExit Code: %d\n\n%s", before_cmd, before_exit, after_cmd, after_exit, after_out);
+                } else {
+                    xasprintf(&details, "Command: %s\nExit Code: %d\n\n%s", after_cmd, after_exit, after_out);
+                }
+
+                /* trim the after build working directory */
+                details = trim_workdir(file, details);
+
+                params.details = details;
+                add_result(ri, &params);
+                reported = true;
+                free(params.msg);
+            }
+        }
+
+        /* Check for loss of -O2 -D_FORTIFY_SOURCE=2 */
+        if (after_out) {
+            slist = strsplit(after_out, "\n");
+            assert(slist != NULL);
+
+            TAILQ_FOREACH(sentry, slist, items) {
+                if (strprefix(sentry->data, "FAIL:") && (strstr(sentry->data, "fortify") || strstr(sentry->data, "optimization"))) {
+                    init_result_params(&params);
+                    params.header = NAME_ANNOCHECK;
+                    params.waiverauth = WAIVABLE_BY_SECURITY;
+                    params.remedy = REMEDY_ANNOCHECK_FORTIFY_SOURCE;
+                    params.arch = arch;
+                    params.file = file->localpath;
+                    params.verb = VERB_REMOVED;
+                    params.noun = _("lost -D_FORTIFY_SOURCE in ${FILE} on ${ARCH}");
+                    params.severity = get_secrule_result_severity(ri, file, SECRULE_FORTIFYSOURCE);
+
+                    xasprintf(&params.msg, _("%s may have lost -D_FORTIFY_SOURCE on %s"), file->localpath, arch);
+                    params.details = details;
+
+                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                        add_result(ri, &params);
+                        reported = true;
+                        result = !(params.severity >= RESULT_VERIFY);
+                    }
+
+                    break;
+                }
+            }
+
+            list_free(slist, free);
+        }
+
+        /* Cleanup */
+        free(details);
+
+        free(after_out);
+        free(before_out);
+
+        free(after_cmd);
+        free(before_cmd);
+
+        details = NULL;
+    }
+
+    free(job->runs);
+    return result;
+}
 #endif
 
 #ifdef _WITH_LIBANNOCHECK
@@ -310,15 +477,8 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file, rpmpe
     libannocheck_test_state before_worst = 0;
 #else
     char **argv = NULL;
-    char *before_cmd = NULL;
-    char *after_cmd = NULL;
-    char *after_out = NULL;
-    int after_exit = 0;
-    char *before_out = NULL;
-    int before_exit = 0;
-    char *details = NULL;
-    string_list_t *slist = NULL;
-    string_entry_t *sentry = NULL;
+    struct annocheck_job *job = NULL;
+    struct annocheck_run *run = NULL;
 #endif
 
     assert(ri != NULL);
@@ -356,6 +516,14 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file, rpmpe
     params.arch = arch;
     params.file = file->localpath;
 
+#ifndef _WITH_LIBANNOCHECK
+    job = xalloc(sizeof(*job));
+    job->file = file;
+    job->arch = arch;
+    job->ignore = ignore;
+    job->runs = xcalloc(HASH_COUNT(ri->annocheck), sizeof(*job->runs));
+#endif
+
     /* Run each annocheck test and report the results */
     HASH_ITER(hh, ri->annocheck, hentry, tmp_hentry) {
 #ifdef _WITH_LIBANNOCHECK
@@ -536,116 +704,26 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file, rpmpe
 
     return result;
 #else
-        /* Run the test on the file */
-        after_cmd = build_annocheck_cmd(ri->commands.annocheck, hentry->value, annocheck_profile, get_debuginfo_path(ri, file, arch, AFTER_BUILD), file->localpath);
-        argv = build_argv(after_cmd);
-        after_out = run_cmd_vp(&after_exit, peer->after_root, argv);
+        /* Queue the test on the file */
+        run = &job->runs[job->nruns++];
+        run->test = hentry->key;
+        run->after_cmd = build_annocheck_cmd(ri->commands.annocheck, hentry->value, annocheck_profile, get_debuginfo_path(ri, file, arch, AFTER_BUILD), file->localpath);
+        argv = build_argv(run->after_cmd);
+        cmdpool_add(pool, peer->after_root, argv, cmdpool_store_result, &run->after);
         free_argv(argv);
 
-        /* If we have a before build, run the command on that */
-        if (!ignore) {
-            if (file->peer_file) {
-                before_cmd = build_annocheck_cmd(ri->commands.annocheck, hentry->value, annocheck_profile, get_debuginfo_path(ri, file->peer_file, arch, BEFORE_BUILD), file->peer_file->localpath);
-                argv = build_argv(before_cmd);
-                before_out = run_cmd_vp(&before_exit, peer->before_root, argv);
-                free_argv(argv);
-
-                /* Build a reporting message if we need to */
-                if (before_exit == 0 && after_exit == 0) {
-                    xasprintf(&params.msg, _("annocheck '%s' test passes for %s on %s"), hentry->key, file->localpath, arch);
-                } else if (before_exit && after_exit == 0) {
-                    xasprintf(&params.msg, _("annocheck '%s' test now passes for %s on %s"), hentry->key, file->localpath, arch);
-                } else if (before_exit == 0 && after_exit) {
-                    xasprintf(&params.msg, _("annocheck '%s' test now fails for %s on %s"), hentry->key, file->localpath, arch);
-                    params.severity = ri->annocheck_failure_severity;
-                    params.waiverauth = WAIVABLE_BY_ANYONE;
-                    params.verb = VERB_CHANGED;
-                    result = !(ri->annocheck_failure_severity >= RESULT_VERIFY);
-                } else if (after_exit) {
-                    xasprintf(&params.msg, _("annocheck '%s' test fails for %s on %s"), hentry->key, file->localpath, arch);
-                    params.severity = ri->annocheck_failure_severity;
-                    params.waiverauth = WAIVABLE_BY_ANYONE;
-                    params.verb = VERB_CHANGED;
-                    result = !(ri->annocheck_failure_severity >= RESULT_VERIFY);
-                }
-            } else {
-                if (after_exit == 0) {
-                    xasprintf(&params.msg, _("annocheck '%s' test passes for %s on %s"), hentry->key, file->localpath, arch);
-                } else if (after_exit) {
-                    xasprintf(&params.msg, _("annocheck '%s' test fails for %s on %s"), hentry->key, file->localpath, arch);
-                    params.severity = ri->annocheck_failure_severity;
-                    params.waiverauth = WAIVABLE_BY_ANYONE;
-                    params.verb = VERB_CHANGED;
-                    result = !(ri->annocheck_failure_severity >= RESULT_VERIFY);
-                }
-            }
-
-            /* Report the results */
-            if (params.msg) {
-                /* trim the before build working directory and generate details */
-                if (before_cmd) {
-                    before_cmd = trim_workdir(file->peer_file, before_cmd);
-                    xasprintf(&details, "Command: %s\nExit Code: %d\n    compared with the output of:\nCommand: %s\nExit Code: %d\n\n%s", before_cmd, before_exit, after_cmd, after_exit, after_out);
-                } else {
-                    xasprintf(&details, "Command: %s\nExit Code: %d\n\n%s", after_cmd, after_exit, after_out);
-                }
-
-                /* trim the after build working directory */
-                details = trim_workdir(file, details);
-
-                params.details = details;
-                add_result(ri, &params);
-                reported = true;
-                free(params.msg);
-            }
-        }
-
-        /* Check for loss of -O2 -D_FORTIFY_SOURCE=2 */
-        if (after_out) {
-            slist = strsplit(after_out, "\n");
-            assert(slist != NULL);
-
-            TAILQ_FOREACH(sentry, slist, items) {
-                if (strprefix(sentry->data, "FAIL:") && (strstr(sentry->data, "fortify") || strstr(sentry->data, "optimization"))) {
-                    init_result_params(&params);
-                    params.header = NAME_ANNOCHECK;
-                    params.waiverauth = WAIVABLE_BY_SECURITY;
-                    params.remedy = REMEDY_ANNOCHECK_FORTIFY_SOURCE;
-                    params.arch = arch;
-                    params.file = file->localpath;
-                    params.verb = VERB_REMOVED;
-                    params.noun = _("lost -D_FORTIFY_SOURCE in ${FILE} on ${ARCH}");
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_FORTIFYSOURCE);
-
-                    xasprintf(&params.msg, _("%s may have lost -D_FORTIFY_SOURCE on %s"), file->localpath, arch);
-                    params.details = details;
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        add_result(ri, &params);
-                        reported = true;
-                        result = !(params.severity >= RESULT_VERIFY);
-                    }
-
-                    break;
-                }
-            }
-
-            list_free(slist, free);
+        /* If we have a before build, queue the test on that */
+        if (!ignore && file->peer_file) {
+            run->before_cmd = build_annocheck_cmd(ri->commands.annocheck, hentry->value, annocheck_profile, get_debuginfo_path(ri, file->peer_file, arch, BEFORE_BUILD), file->peer_file->localpath);
+            argv = build_argv(run->before_cmd);
+            cmdpool_add(pool, peer->before_root, argv, cmdpool_store_result, &run->before);
+            free_argv(argv);
         }
-
-        /* Cleanup */
-        free(details);
-
-        free(after_out);
-        free(before_out);
-
-        free(after_cmd);
-        free(before_cmd);
-
-        after_exit = 0;
-        before_exit = 0;
     }
 
+    /* the results are reported by report_annocheck_job() */
+    TAILQ_INSERT_TAIL(&jobs, job, items);
+
     return result;
 #endif
 }
@@ -658,6 +736,9 @@ bool inspect_annocheck(struct rpminspect *ri)
     bool result = true;
     rpmpeer_entry_t *peer = NULL;
     rpmfile_entry_t *file = NULL;
+#ifndef _WITH_LIBANNOCHECK
+    struct annocheck_job *job = NULL;
+#endif
     struct result_params params;
 
     assert(ri != NULL);
@@ -694,6 +775,12 @@ bool inspect_annocheck(struct rpminspect *ri)
         warn("*** unsetenv");
     }
 
+#ifndef _WITH_LIBANNOCHECK
+    /* annocheck(1) runs are queued on a pool and reported in order */
+    TAILQ_INIT(&jobs);
+    pool = new_cmdpool(0);
+#endif
+
     /* run the annocheck tests across all ELF files */
     TAILQ_FOREACH(peer, ri->peers, items) {
         /* Disappearing subpackages are caught by INSPECT_EMPTYRPM */
@@ -713,6 +800,23 @@ bool inspect_annocheck(struct rpminspect *ri)
         }
     }
 
+#ifndef _WITH_LIBANNOCHECK
+    cmdpool_wait(pool);
+    free_cmdpool(pool);
+    pool = NULL;
+
+    while (!TAILQ_EMPTY(&jobs)) {
+        job = TAILQ_FIRST(&jobs);
+        TAILQ_REMOVE(&jobs, job, items);
+
+        if (!report_annocheck_job(ri, job)) {
+            result = false;
+        }
+
+        free(job);
+    }
+#endif
+
     /* if everything was fine, just say so */
     if (result && !reported) {
         init_result_params(&params);
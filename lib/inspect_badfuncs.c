@@ -79,9 +79,7 @@ static bool badfuncs_driver(struct rpminspect *ri, rpmfile_entry_t *after)
 {
     bool result = true;
     const char *arch;
-    Elf *after_elf = NULL;
-    int after_elf_fd = -1;
-    string_list_t *after_symbols = NULL;
+    const elf_facts_t *after_elf = NULL;
     string_list_t *used_symbols = NULL;
     string_list_t *sorted_used = NULL;
     string_list_t *allowed_symbols = NULL;
@@ -108,25 +106,19 @@ static bool badfuncs_driver(struct rpminspect *ri, rpmfile_entry_t *after)
 
     arch = get_rpm_header_arch(after->rpm_header);
 
-    /* get an ELF object of some sort, if we can */
-    after_elf = get_elf_archive(after, &after_elf_fd);
-
-    if (after_elf == NULL) {
-        after_elf = get_elf(after, &after_elf_fd);
-    }
+    /*
+     * get the ELF facts, if we can (ELF archives have no .dynsym
+     * section so there is nothing to check in them)
+     */
+    after_elf = get_elf_facts(after);
 
     if (after_elf == NULL) {
         result = true;
         goto cleanup;
     }
 
-    /* Don't filter the list -- filtering requires knowledge of the
-     * forbidden functions. Since we can't pass custom arguments to
-     * the filter, return them all and filter them locally. */
-    after_symbols = get_elf_imported_functions(after_elf, NULL);
-
     /* Get a list of forbidden symbols that we used. */
-    used_symbols = list_intersection(ri->bad_functions, after_symbols);
+    used_symbols = list_intersection(ri->bad_functions, after_elf->imported);
 
     if (!used_symbols || TAILQ_EMPTY(used_symbols)) {
         goto cleanup;
@@ -187,15 +179,9 @@ static bool badfuncs_driver(struct rpminspect *ri, rpmfile_entry_t *after)
     free(output_buffer);
 
 cleanup:
-    list_free(after_symbols, free);
     list_free(used_symbols, free);
     list_free(sorted_used, free);
 
-    if (after_elf) {
-        elf_end(after_elf);
-        close(after_elf_fd);
-    }
-
     return result;
 }
 
@@ -234,7 +234,7 @@ static bool changedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         /* we may not have been able to uncompress */
         if (before_uncompressed_file == NULL || after_uncompressed_file == NULL) {
             /* perform a byte comparison of the compressed files */
-            exitcode = filecmp(file->peer_file->fullpath, file->fullpath);
+            exitcode = filecmp_rpmfile(file->peer_file, file);
         } else {
             /* we can use diff on text files, so try that first */
             bun = xalloc(sizeof(*bun));
@@ -264,11 +264,9 @@ static bool changedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
             /* clean up */
             free(bun->fullpath);
-            free(bun->type);
             free(bun);
 
             free(aun->fullpath);
-            free(aun->type);
             free(aun);
 
             before_uncompressed_file = NULL;
@@ -488,6 +486,15 @@ bool inspect_changedfiles(struct rpminspect *ri)
 {
     bool result;
     struct result_params params;
+    rpmpeer_entry_t *peer = NULL;
+
+    /* Checksum the peer files in one batch rather than one at a time */
+    TAILQ_FOREACH(peer, ri->peers, items) {
+        if (peer->before_files && peer->after_files) {
+            checksum_files(peer->before_files, CHECKSUM_BIT(DEFAULT_MESSAGE_DIGEST));
+            checksum_files(peer->after_files, CHECKSUM_BIT(DEFAULT_MESSAGE_DIGEST));
+        }
+    }
 
     result = foreach_peer_file(ri, NAME_CHANGEDFILES, changedfiles_driver);
 
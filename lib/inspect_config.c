@@ -146,7 +146,7 @@ static bool config_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             }
         } else {
             /* compare the files */
-            exitcode = filecmp(file->peer_file->fullpath, file->fullpath);
+            exitcode = filecmp_rpmfile(file->peer_file, file);
 
             if (exitcode) {
                 /* the files differ and not a rebase, see if it's only whitespace changes */
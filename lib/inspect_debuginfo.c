@@ -50,34 +50,31 @@ static uint64_t get_flags(const char *s)
 static uint64_t _section_helper(rpmfile_entry_t *file, const uint64_t flags, const bool check)
 {
     uint64_t gathered = 0;
-    int fd = 0;
-    Elf *elf = NULL;
+    const elf_facts_t *elf = NULL;
 
-    elf = get_elf(file, &fd);
+    elf = get_elf_facts(file);
     assert(elf != NULL);
 
-    if ((flags & NEEDS_SYMTAB) && have_elf_section(elf, -1, ELF_SYMTAB) == check) {
+    if ((flags & NEEDS_SYMTAB) && have_elf_facts_section(elf, -1, ELF_SYMTAB) == check) {
         gathered |= NEEDS_SYMTAB;
     }
 
-    if ((flags & NEEDS_GDB_INDEX) && have_elf_section(elf, -1, ELF_GDB_INDEX) == check) {
+    if ((flags & NEEDS_GDB_INDEX) && have_elf_facts_section(elf, -1, ELF_GDB_INDEX) == check) {
         gathered |= NEEDS_GDB_INDEX;
     }
 
-    if ((flags & NEEDS_GNU_DEBUGDATA) && have_elf_section(elf, -1, ELF_GNU_DEBUGDATA) == check) {
+    if ((flags & NEEDS_GNU_DEBUGDATA) && have_elf_facts_section(elf, -1, ELF_GNU_DEBUGDATA) == check) {
         gathered |= NEEDS_GNU_DEBUGDATA;
     }
 
-    if ((flags & NEEDS_GNU_DEBUGLINK) && have_elf_section(elf, -1, ELF_GNU_DEBUGLINK) == check) {
+    if ((flags & NEEDS_GNU_DEBUGLINK) && have_elf_facts_section(elf, -1, ELF_GNU_DEBUGLINK) == check) {
         gathered |= NEEDS_GNU_DEBUGLINK;
     }
 
-    if ((flags & NEEDS_DEBUG_INFO) && have_elf_section(elf, -1, ELF_DEBUG_INFO) == check) {
+    if ((flags & NEEDS_DEBUG_INFO) && have_elf_facts_section(elf, -1, ELF_DEBUG_INFO) == check) {
         gathered |= NEEDS_DEBUG_INFO;
     }
 
-    close(fd);
-    elf_end(elf);
     return gathered;
 }
 
@@ -120,20 +117,17 @@ static char *strflags(const uint64_t flags)
 static bool is_guile(rpmfile_entry_t *file)
 {
     bool r = false;
-    Elf *elf = NULL;
-    int fd = -1;
+    const elf_facts_t *elf = NULL;
     string_list_t *sections = NULL;
     string_entry_t *entry = NULL;
 
-    elf = get_elf(file, &fd);
+    elf = get_elf_facts(file);
 
     if (elf == NULL) {
         return false;
     }
 
-    sections = get_elf_section_names(elf, SHT_PROGBITS);
-    elf_end(elf);
-    close(fd);
+    sections = get_elf_facts_section_names(elf, SHT_PROGBITS);
 
     if (sections == NULL || TAILQ_EMPTY(sections)) {
         return false;
@@ -161,8 +155,7 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     uint64_t have = 0;
     uint64_t before_missing = 0;
     uint64_t after_missing = 0;
-    int fd = 0;
-    Elf *elf = NULL;
+    const elf_facts_t *elf = NULL;
     struct result_params params;
 
     assert(ri != NULL);
@@ -307,9 +300,9 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
     /* Final non-debuginfo package checks */
     if (!debugpkg) {
-        elf = get_elf(file, &fd);
+        elf = get_elf_facts(file);
 
-        if (elf && have_elf_section(elf, -1, ELF_GOSYMTAB) && have_elf_section(elf, -1, ELF_GNU_DEBUGDATA)) {
+        if (elf && have_elf_facts_section(elf, -1, ELF_GOSYMTAB) && have_elf_facts_section(elf, -1, ELF_GNU_DEBUGDATA)) {
             xasprintf(&params.msg, _("%s in %s on %s carries .gosymtab but should not have the .gnu_debugdata symbol"), file->localpath, nvr, arch);
             params.verb = VERB_FAILED;
             params.noun = _(".gnu_debugdata with .gosymtab");
@@ -323,12 +316,6 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             add_result(ri, &params);
             free(params.msg);
         }
-
-        if (fd != 0) {
-            close(fd);
-        }
-
-        elf_end(elf);
     }
 
     free(nvr);
@@ -4,22 +4,15 @@
  */
 
 #include <stdio.h>
-#include <libgen.h>
 #include <string.h>
 #include <errno.h>
 #include <err.h>
-#include <libgen.h>
-#include <ftw.h>
 #include <assert.h>
 #include <sys/types.h>
 #include <dirent.h>
 
 #include "rpminspect.h"
-
-/* Global variables */
-static struct rpminspect *sri = NULL;
-static char *file_to_find = NULL;
-static filetype_t filetype = FILETYPE_NULL;
+#include "parallel.h"
 
 /*
  * From:
@@ -28,116 +21,193 @@ static filetype_t filetype = FILETYPE_NULL;
 static const char *icon_extensions[] = { ".png", ".svg", ".xpm", NULL };
 
 /*
- * Helper used by nftw() in validate_desktop_contents()
+ * The after build payload files sharing a basename, in peer order.
  */
-static int find_file(const char *fpath, __attribute__((unused)) const struct stat *sb, int tflag, __attribute__((unused)) struct FTW *ftwbuf)
+struct desktop_path {
+    const char *name;                /* points in to the localpath */
+    rpmfile_entry_t **files;
+    size_t num;
+    UT_hash_handle hh;
+};
+
+/*
+ * Built once per run by index_after_files() so Exec= and Icon=
+ * references are resolved without walking the extracted trees.
+ */
+static struct desktop_path *after_paths = NULL;
+
+/* Return the part of path after the last PATH_SEP */
+static const char *path_basename(const char *path)
+{
+    const char *r = strrchr(path, PATH_SEP);
+
+    return (r == NULL) ? path : r + 1;
+}
+
+/*
+ * Index everything but directories in the after build subpackages by
+ * basename.  The file lists are used, the payloads are not read.
+ */
+static void index_after_files(const rpmpeer_t *peers)
+{
+    rpmpeer_entry_t *peer = NULL;
+    rpmfile_entry_t *file = NULL;
+    struct desktop_path *entry = NULL;
+    const char *name = NULL;
+
+    assert(peers != NULL);
+
+    TAILQ_FOREACH(peer, peers, items) {
+        /*
+         * Skip the SRPM and any package that lacks a tree (like a
+         * meta package only providing headers)
+         */
+        if (headerIsSource(peer->after_hdr) || peer->after_root == NULL || peer->after_files == NULL) {
+            continue;
+        }
+
+        TAILQ_FOREACH(file, peer->after_files, items) {
+            /* Skip directories and debug paths */
+            if (file->fullpath == NULL || S_ISDIR(file->st_mode) || is_debug_or_build_path(file->localpath)) {
+                continue;
+            }
+
+            name = path_basename(file->localpath);
+            HASH_FIND_STR(after_paths, name, entry);
+
+            if (entry == NULL) {
+                entry = xalloc(sizeof(*entry));
+                entry->name = name;
+                HASH_ADD_KEYPTR(hh, after_paths, entry->name, strlen(entry->name), entry);
+            }
+
+            entry->files = xrealloc(entry->files, (entry->num + 1) * sizeof(*entry->files));
+            entry->files[entry->num++] = file;
+        }
+    }
+
+    return;
+}
+
+static void free_after_paths(void)
+{
+    struct desktop_path *entry = NULL;
+    struct desktop_path *tmp_entry = NULL;
+
+    HASH_ITER(hh, after_paths, entry, tmp_entry) {
+        HASH_DEL(after_paths, entry);
+        free(entry->files);
+        free(entry);
+    }
+
+    after_paths = NULL;
+    return;
+}
+
+/*
+ * Find an after build file whose path ends with the given path.  If
+ * ri is not NULL, the file must also be an image.  Returns NULL if
+ * there is no such file.
+ */
+static rpmfile_entry_t *find_after_file(struct rpminspect *ri, const char *path)
+{
+    size_t i = 0;
+    struct desktop_path *entry = NULL;
+
+    assert(path != NULL);
+
+    HASH_FIND_STR(after_paths, path_basename(path), entry);
+
+    for (i = 0; entry != NULL && i < entry->num; i++) {
+        if (!strsuffix(entry->files[i]->localpath, path)) {
+            continue;
+        }
+
+        if (ri == NULL || strprefix(get_mime_type(ri, entry->files[i]), "image/")) {
+            return entry->files[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Find the executable named in an Exec= value.  Returns NULL if no
+ * subpackage carries it.
+ */
+static rpmfile_entry_t *find_executable(const char *exec)
 {
-    int i = 0;
-    char *bn = NULL;
     char *tmp = NULL;
-    char *last = NULL;
-    char *tmpicon = NULL;
+    rpmfile_entry_t *found = NULL;
     string_list_t *list = NULL;
     string_entry_t *entry = NULL;
 
-    /* Only looking at regular files */
-    /*
-     * XXX: should FTW_SLN have special handling here?  does packaging policy
-     * allow packages to ship absolute symlinks to paths not provided by the
-     * package itself?
-     */
-    if (tflag == FTW_D || tflag == FTW_DNR || tflag == FTW_DP || tflag == FTW_NS) {
-        return 0;
-    }
+    assert(exec != NULL);
 
-    /* Skip debug paths */
-    if (is_debug_or_build_path(fpath)) {
-        return 0;
+    list = strsplit(exec, " ");
+
+    if (list == NULL) {
+        return NULL;
     }
 
-    /* Look for this name as the basename */
-    if (filetype == FILETYPE_EXECUTABLE) {
-        list = strsplit(file_to_find, " ");
-
-        if (list != NULL && !TAILQ_EMPTY(list)) {
-            TAILQ_FOREACH_REVERSE(entry, list, string_entry_s, items) {
-                /* safety check */
-                if (entry->data == NULL) {
-                    continue;
-                }
-
-                /* skip desktop spec params and any variables */
-                if (strchr(entry->data, '%') || strchr(entry->data, '=')) {
-                    continue;
-                }
-
-                if (*entry->data == PATH_SEP) {
-                    tmp = strdup(entry->data);
-                } else {
-                    /* everything else would be in /usr/bin */
-                    xasprintf(&tmp, "/usr/bin/%s", entry->data);
-                }
-
-                /* actual check */
-                if (strsuffix(fpath, tmp)) {
-                    free(file_to_find);
-                    file_to_find = strdup(fpath);
-                    list_free(list, free);
-                    free(tmp);
-                    return 1;
-                }
-
-                free(tmp);
-            }
+    TAILQ_FOREACH_REVERSE(entry, list, string_entry_s, items) {
+        /* safety check */
+        if (entry->data == NULL) {
+            continue;
         }
 
-        list_free(list, free);
-    }
+        /* skip desktop spec params and any variables */
+        if (strchr(entry->data, '%') || strchr(entry->data, '=')) {
+            continue;
+        }
 
-    /* Might be a base name missing a graphics format ending */
-    /*
-     * This will take an fpath like:
-     *     iconfile.png
-     *     iconfile.jpg
-     *     org.Organization.IconFile
-     * And will trim the end of the string from the last period
-     * to the end.  So if a desktop entry file specifies 'iconfile'
-     * and the package provides iconfile.* somewhere as a file, this
-     * will pass.
-     */
-    if (filetype == FILETYPE_ICON) {
-        if (strsuffix(fpath, file_to_find) && strprefix(mime_type(sri, fpath), "image/")) {
-            /* file is found and is an image type according to libmagic */
-            free(file_to_find);
-            file_to_find = strdup(fpath);
-            return 1;
+        if (*entry->data == PATH_SEP) {
+            tmp = strdup(entry->data);
         } else {
-            /* handle icon specs without an extension */
-            bn = strdup(file_to_find);
-            assert(bn != NULL);
-            last = basename(bn);
-            assert(last != NULL);
-
-            for (i = 0; icon_extensions[i] != NULL; i++) {
-                xasprintf(&tmpicon, "%s%s", last, icon_extensions[i]);
-                assert(tmpicon != NULL);
-
-                if (strsuffix(fpath, tmpicon)) {
-                    free(file_to_find);
-                    file_to_find = strdup(fpath);
-                    free(bn);
-                    free(tmpicon);
-                    return 1;
-                }
-
-                free(tmpicon);
-            }
+            /* everything else would be in /usr/bin */
+            xasprintf(&tmp, "/usr/bin/%s", entry->data);
+        }
 
-            free(bn);
+        found = find_after_file(NULL, tmp);
+        free(tmp);
+
+        if (found) {
+            break;
         }
     }
 
-    return 0;
+    list_free(list, free);
+    return found;
+}
+
+/*
+ * Find the icon named in an Icon= value.  This is either the image
+ * file itself or a base name missing a graphics format ending, so if
+ * a desktop entry file specifies 'iconfile' and the package provides
+ * iconfile.png somewhere as a file, this will pass.  Returns NULL if
+ * no subpackage carries it.
+ */
+static rpmfile_entry_t *find_icon(struct rpminspect *ri, const char *icon)
+{
+    int i = 0;
+    char *tmpicon = NULL;
+    rpmfile_entry_t *found = NULL;
+
+    assert(ri != NULL);
+    assert(icon != NULL);
+
+    /* file is found and is an image type according to libmagic */
+    found = find_after_file(ri, icon);
+
+    /* handle icon specs without an extension */
+    for (i = 0; found == NULL && icon_extensions[i] != NULL; i++) {
+        xasprintf(&tmpicon, "%s%s", path_basename(icon), icon_extensions[i]);
+        assert(tmpicon != NULL);
+        found = find_after_file(NULL, tmpicon);
+        free(tmpicon);
+    }
+
+    return found;
 }
 
 /*
@@ -184,8 +254,8 @@ static bool validate_desktop_contents(struct rpminspect *ri, const rpmfile_entry
     char *tmp = NULL;
     const char *arch = NULL;
     struct stat sb;
-    bool found = false;
-    rpmpeer_entry_t *peer = NULL;
+    rpmfile_entry_t *found = NULL;
+    string_hash_t *icon = NULL;
     struct result_params params;
     desktop_skips_t *ds = NULL;
     unsigned int flags = 0;
@@ -236,7 +306,6 @@ static bool validate_desktop_contents(struct rpminspect *ri, const rpmfile_entry
      */
     TAILQ_FOREACH(entry, contents, items) {
         buf = entry->data;
-        filetype = FILETYPE_NULL;
 
         if (!(flags & SKIP_EXEC) && strprefix(buf, "Exec=")) {
             key_exec = buf + 5;
@@ -251,56 +320,31 @@ static bool validate_desktop_contents(struct rpminspect *ri, const rpmfile_entry
     }
 
     if (key_exec != NULL) {
-        filetype = FILETYPE_EXECUTABLE;
-        file_to_find = strdup(key_exec);
-
-        TAILQ_FOREACH(peer, ri->peers, items) {
-            /*
-             * Skip the SRPM and any package that lacks a tree (like a
-             * meta package only providing headers)
-             */
-            if (headerIsSource(peer->after_hdr) || peer->after_root == NULL) {
-                continue;
-            }
+        found = find_executable(key_exec);
 
-            /*
-             * If we get 1 back from nftw(), it means the executable was
-             * found and is valid.  If found, the nftw() helper replaces
-             * file_to_find with the full path to where it was found.
-             */
-            found = false;
-
-            if (nftw(peer->after_root, find_file, FOPEN_MAX, FTW_MOUNT|FTW_PHYS) == 1) {
-                found = true;
-
-                if (lstat(file_to_find, &sb) == -1) {
-                    warn("*** lstat");
-                    list_free(contents, free);
-                    free(file_to_find);
-                    return false;
-                }
-
-                if (!(sb.st_mode & S_IXOTH)) {
-                    xasprintf(&params.msg, _("Desktop file %s on %s references executable %s but %s is not executable by all"), file->localpath, arch, tmp, tmp);
-                    params.severity = RESULT_VERIFY;
-                    params.waiverauth = WAIVABLE_BY_ANYONE;
-                    params.verb = VERB_FAILED;
-                    params.noun = _("${FILE} references non-executable file on ${ARCH}");
-                    add_result(ri, &params);
-                    free(params.msg);
-                    result = false;
-                }
+        if (found) {
+            if (lstat(found->fullpath, &sb) == -1) {
+                warn("*** lstat");
+                list_free(contents, free);
+                return false;
             }
 
-            if (found) {
-                break;
+            if (!(sb.st_mode & S_IXOTH)) {
+                xasprintf(&params.msg, _("Desktop file %s on %s references executable %s but %s is not executable by all"), file->localpath, arch, tmp, tmp);
+                params.severity = RESULT_VERIFY;
+                params.waiverauth = WAIVABLE_BY_ANYONE;
+                params.verb = VERB_FAILED;
+                params.noun = _("${FILE} references non-executable file on ${ARCH}");
+                add_result(ri, &params);
+                free(params.msg);
+                result = false;
             }
         }
 
         if (!found) {
             if (key_tryexec != NULL) {
                 /*
-                 * At this point, nftw() did not find the executable.
+                 * At this point, the executable was not found.
                  * However, since there is TryExec in the desktop file,
                  * then the desktop file may be ignored by menu
                  * implementations. Hence, report it only as "INFO"
@@ -324,64 +368,36 @@ static bool validate_desktop_contents(struct rpminspect *ri, const rpmfile_entry
                 result = false;
             }
         }
-
-        free(file_to_find);
     }
 
     if (key_icon != NULL) {
-        filetype = FILETYPE_ICON;
-        file_to_find = strdup(key_icon);
-        found = false;
-
-        TAILQ_FOREACH(peer, ri->peers, items) {
-            /*
-             * Skip the SRPM and any package that lacks a tree (like a
-             * meta package only providing headers)
-             */
-            if (headerIsSource(peer->after_hdr) || peer->after_root == NULL) {
-                continue;
-            }
+        found = find_icon(ri, key_icon);
 
-            /*
-             * If we get 1 back from nftw(), it means the icon was
-             * found and is valid.  If found, the nftw() helper replaces
-             * file_to_find with the full path to where it was found.
-             */
-            found = false;
-
-            if (nftw(peer->after_root, find_file, FOPEN_MAX, FTW_MOUNT|FTW_PHYS) == 1) {
-                found = true;
-
-                if (lstat(file_to_find, &sb) == -1) {
-                    warn("*** lstat");
-                    list_free(contents, free);
-                    free(file_to_find);
-                    return false;
-                }
-
-                if (!(sb.st_mode & S_IROTH)) {
-                    xasprintf(&params.msg, _("Desktop file %s on %s references icon %s but %s is not readable by all"), file->localpath, arch, key_icon, key_icon);
-                    params.severity = RESULT_VERIFY;
-                    params.waiverauth = WAIVABLE_BY_ANYONE;
-                    params.verb = VERB_FAILED;
-                    params.noun = _("${FILE} references unreadable icon on ${ARCH}");
-                    add_result(ri, &params);
-                    free(params.msg);
-                    result = false;
-                }
+        if (found) {
+            if (lstat(found->fullpath, &sb) == -1) {
+                warn("*** lstat");
+                list_free(contents, free);
+                return false;
             }
 
-            if (found) {
-                break;
+            if (!(sb.st_mode & S_IROTH)) {
+                xasprintf(&params.msg, _("Desktop file %s on %s references icon %s but %s is not readable by all"), file->localpath, arch, key_icon, key_icon);
+                params.severity = RESULT_VERIFY;
+                params.waiverauth = WAIVABLE_BY_ANYONE;
+                params.verb = VERB_FAILED;
+                params.noun = _("${FILE} references unreadable icon on ${ARCH}");
+                add_result(ri, &params);
+                free(params.msg);
+                result = false;
             }
         }
 
         /* check standard system icons as a failsafe */
-        if (!found && init_icons(ri) && list_contains(ri->icons, key_icon)) {
-            found = true;
+        if (!found && init_icons(ri)) {
+            HASH_FIND_STR(ri->icons, key_icon, icon);
         }
 
-        if (!found) {
+        if (!found && icon == NULL) {
             xasprintf(&params.msg, _("Desktop file %s on %s references icon %s but no subpackages contain %s"), file->localpath, arch, key_icon, key_icon);
             params.severity = RESULT_VERIFY;
             params.waiverauth = WAIVABLE_BY_ANYONE;
@@ -391,8 +407,6 @@ static bool validate_desktop_contents(struct rpminspect *ri, const rpmfile_entry
             free(params.msg);
             result = false;
         }
-
-        free(file_to_find);
     }
 
     list_free(contents, free);
@@ -400,17 +414,24 @@ static bool validate_desktop_contents(struct rpminspect *ri, const rpmfile_entry
     return result;
 }
 
+/* A desktop entry file queued by desktop_driver() and its results */
+struct desktop_job {
+    rpmfile_entry_t *file;
+    bool has_before;
+    cmd_result_t after;
+    cmd_result_t before;
+    TAILQ_ENTRY(desktop_job) items;
+};
+
+static TAILQ_HEAD(desktop_jobs_s, desktop_job) jobs;
+
+/*
+ * Find desktop entry files.  They are validated together by
+ * inspect_desktop() and reported by report_desktop_job().
+ */
 static bool desktop_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
-    bool result = true;
-    int after_code;
-    char *before_out = NULL;
-    const char *arch = NULL;
-    char *tmpbuf = NULL;
-    struct result_params params;
-
-    /* allow static callback functions to see ri */
-    sri = ri;
+    struct desktop_job *job = NULL;
 
     /*
      * Is this a file we should look at?
@@ -420,21 +441,40 @@ static bool desktop_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
+    job = xalloc(sizeof(*job));
+    job->file = file;
+
+    /* if we have a before peer, validate the corresponding desktop file */
+    job->has_before = (file->peer_file && is_desktop_entry_file(ri->desktop_entry_files_dir, file->peer_file));
+
+    TAILQ_INSERT_TAIL(&jobs, job, items);
+    return true;
+}
+
+/*
+ * Report the desktop-file-validate results for one desktop entry
+ * file and check its contents.  Returns false if the file is not
+ * valid.
+ */
+static bool report_desktop_job(struct rpminspect *ri, struct desktop_job *job)
+{
+    bool result = true;
+    int after_code = job->after.exitcode;
+    char *before_out = NULL;
+    const char *arch = NULL;
+    rpmfile_entry_t *file = job->file;
+    struct result_params params;
+
     /* Get result parameters ready */
     init_result_params(&params);
 
-    /* Validate the desktop file */
-    params.details = run_cmd(&after_code, ri->worksubdir, ri->commands.desktop_file_validate, "--no-hints", file->fullpath, NULL);
-    tmpbuf = strreplace(params.details, file->fullpath, file->localpath);
-    free(params.details);
-    params.details = tmpbuf;
-
-    if (file->peer_file && is_desktop_entry_file(ri->desktop_entry_files_dir, file->peer_file)) {
-        /* if we have a before peer, validate the corresponding desktop file */
-        before_out = run_cmd(NULL, ri->worksubdir, ri->commands.desktop_file_validate, "--no-hints", file->peer_file->fullpath, NULL);
-        tmpbuf = strreplace(before_out, file->peer_file->fullpath, file->peer_file->localpath);
-        free(before_out);
-        before_out = tmpbuf;
+    /* Desktop file validation results */
+    params.details = strreplace(job->after.output, file->fullpath, file->localpath);
+    free(job->after.output);
+
+    if (job->has_before) {
+        before_out = strreplace(job->before.output, file->peer_file->fullpath, file->peer_file->localpath);
+        free(job->before.output);
     }
 
     if (after_code) {
@@ -490,6 +530,12 @@ static bool desktop_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 bool inspect_desktop(struct rpminspect *ri)
 {
     bool result;
+    size_t n = 0;
+    char **files = NULL;
+    void **data = NULL;
+    char *argv[] = { NULL, "--no-hints", NULL };
+    struct desktop_job *job = NULL;
+    cmdpool_t *pool = NULL;
     struct result_params params;
 
     assert(ri != NULL);
@@ -501,8 +547,49 @@ bool inspect_desktop(struct rpminspect *ri)
      * them.  The before and after peers are compared for these files.
      * For the after files, the Exec and Icon references are checked.
      */
+    TAILQ_INIT(&jobs);
     result = foreach_peer_file(ri, NAME_DESKTOP, desktop_driver);
 
+    /* desktop-file-validate takes more than one file, run them in batches */
+    TAILQ_FOREACH(job, &jobs, items) {
+        files = xrealloc(files, sizeof(*files) * (n + 2));
+        data = xrealloc(data, sizeof(*data) * (n + 2));
+        files[n] = job->file->fullpath;
+        data[n++] = &job->after;
+
+        if (job->has_before) {
+            files[n] = job->file->peer_file->fullpath;
+            data[n++] = &job->before;
+        }
+    }
+
+    argv[0] = ri->commands.desktop_file_validate;
+    pool = new_cmdpool(0);
+    cmdpool_add_files(pool, ri->worksubdir, argv, files, data, n, cmdpool_store_result);
+    cmdpool_wait(pool);
+    free_cmdpool(pool);
+    free(files);
+    free(data);
+
+    /* Exec= and Icon= references are looked up by basename */
+    if (!TAILQ_EMPTY(&jobs)) {
+        index_after_files(ri->peers);
+    }
+
+    /* report in the order the files were found */
+    while (!TAILQ_EMPTY(&jobs)) {
+        job = TAILQ_FIRST(&jobs);
+        TAILQ_REMOVE(&jobs, job, items);
+
+        if (!report_desktop_job(ri, job)) {
+            result = false;
+        }
+
+        free(job);
+    }
+
+    free_after_paths();
+
     if (result) {
         init_result_params(&params);
         params.severity = RESULT_OK;
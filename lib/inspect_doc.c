@@ -76,7 +76,7 @@ static bool doc_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
     if (before_doc && after_doc) {
         /* compare the files */
-        exitcode = filecmp(file->peer_file->fullpath, file->fullpath);
+        exitcode = filecmp_rpmfile(file->peer_file, file);
 
         if (exitcode) {
             /* the files differ, see if it's only whitespace changes */
@@ -16,16 +16,8 @@ static bool dsodeps_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     const char *bv = NULL;
     const char *av = NULL;
     const char *arch = NULL;
-    int after_fd = -1;
-    int before_fd = -1;
-    Elf *after_elf = NULL;
-    Elf *before_elf = NULL;
-    GElf_Half after_type;
-    GElf_Half before_type;
-    size_t i;
-    GElf_Dyn *dyn = NULL;
-    size_t sz = 0;
-    GElf_Shdr shdr;
+    const elf_facts_t *after_elf = NULL;
+    const elf_facts_t *before_elf = NULL;
     string_list_t *after_needed = NULL;
     string_list_t *before_needed = NULL;
     string_list_t *removed = NULL;
@@ -66,14 +58,12 @@ static bool dsodeps_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
     /* If we lack dynamic or shared ELF files, we're done */
-    if ((after_elf = get_elf(file, &after_fd)) == NULL) {
+    if ((after_elf = get_elf_facts(file)) == NULL) {
         return true;
     }
 
-    after_type = get_elf_type(after_elf);
-
     /* this inspection only operates on ET_DYN ELF types */
-    if (after_type != ET_DYN) {
+    if (after_elf->type != ET_DYN) {
         goto done;
     }
 
@@ -90,7 +80,7 @@ static bool dsodeps_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.arch = arch;
     params.file = file->localpath;
 
-    if ((before_elf = get_elf(file, &before_fd)) == NULL) {
+    if ((before_elf = get_elf_facts(file)) == NULL) {
         xasprintf(&params.msg, _("%s was an ELF file and now is not on %s"), file->localpath, arch);
         params.verb = VERB_CHANGED;
         params.noun = _("ELF file ${FILE} on ${ARCH}");
@@ -100,9 +90,7 @@ static bool dsodeps_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         goto done;
     }
 
-    before_type = get_elf_type(before_elf);
-
-    if (before_type != ET_EXEC && before_type != ET_DYN) {
+    if (before_elf->type != ET_EXEC && before_elf->type != ET_DYN) {
         xasprintf(&params.msg, _("%s was a dynamic ELF file and now is not on %s"), file->localpath, arch);
         params.verb = VERB_CHANGED;
         params.noun = _("ELF file ${FILE} on ${ARCH}");
@@ -113,27 +101,8 @@ static bool dsodeps_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
     /* Gather the DT_NEEDED entries */
-    if (get_dynamic_tags(after_elf, DT_NEEDED, &dyn, &sz, &shdr)) {
-        after_needed = xalloc(sizeof(*after_needed));
-        TAILQ_INIT(after_needed);
-
-        for (i = 0; i < sz; i++) {
-            after_needed = list_add(after_needed, elf_strptr(after_elf, shdr.sh_link, (size_t) (dyn[i].d_un.d_ptr)));
-        }
-
-        free(dyn);
-    }
-
-    if (get_dynamic_tags(before_elf, DT_NEEDED, &dyn, &sz, &shdr)) {
-        before_needed = xalloc(sizeof(*before_needed));
-        TAILQ_INIT(before_needed);
-
-        for (i = 0; i < sz; i++) {
-            before_needed = list_add(before_needed, elf_strptr(before_elf, shdr.sh_link, (size_t) (dyn[i].d_un.d_ptr)));
-        }
-
-        free(dyn);
-    }
+    after_needed = get_elf_facts_tag_strings(after_elf, DT_NEEDED);
+    before_needed = get_elf_facts_tag_strings(before_elf, DT_NEEDED);
 
     /* Figure out what symbol changes happened*/
     removed = list_difference(before_needed, after_needed);
@@ -175,16 +144,6 @@ static bool dsodeps_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
 done:
-    if (after_elf && after_fd != -1) {
-        elf_end(after_elf);
-        close(after_fd);
-    }
-
-    if (before_elf && before_fd != -1) {
-        elf_end(before_elf);
-        close(before_fd);
-    }
-
     list_free(removed, free);
     list_free(added, free);
     list_free(before_needed, free);
@@ -846,6 +846,7 @@ static bool elf_driver(struct rpminspect *ri, rpmfile_entry_t *after)
     Elf *before_elf = NULL;
     int after_elf_fd = -1;
     int before_elf_fd = -1;
+    const elf_facts_t *facts = NULL;
     bool result = true;
 
     name = headerGetString(after->rpm_header, RPMTAG_NAME);
@@ -871,23 +872,15 @@ static bool elf_driver(struct rpminspect *ri, rpmfile_entry_t *after)
     }
 
     /* Skip kernel modules */
-    after_elf = get_elf(after, &after_elf_fd);
+    facts = get_elf_facts(after);
 
-    if (after_elf != NULL
-        && get_elf_type(after_elf) == ET_REL
-        && have_elf_section(after_elf, SHT_PROGBITS, ".modinfo")
+    if (facts != NULL
+        && facts->type == ET_REL
+        && have_elf_facts_section(facts, SHT_PROGBITS, ".modinfo")
         && strsuffix(after->localpath, KERNEL_MODULE_FILENAME_EXTENSION)) {
-        elf_end(after_elf);
-        close(after_elf_fd);
         return true;
     }
 
-    /* close this handle so the test can start over for .a vs .so */
-    if (after_elf) {
-        elf_end(after_elf);
-        close(after_elf_fd);
-    }
-
     arch = get_rpm_header_arch(after->rpm_header);
 
     /* Is this an archive or a regular ELF file? */
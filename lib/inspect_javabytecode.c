@@ -14,8 +14,9 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <err.h>
-#include <ftw.h>
 #include <assert.h>
+#include <archive.h>
+#include <archive_entry.h>
 
 #ifdef __linux__
 #include <byteswap.h>
@@ -32,13 +33,37 @@
 #endif
 
 #include "rpminspect.h"
+#include "parallel.h"
 
 /* Globals */
-static int prefixlen = 0;
-static char *jarfile = NULL;
 static short supported_major = -1;
-static struct rpminspect *jar_ri = NULL;
-static bool jar_result = true;
+
+/*
+ * Returns major JVM version from the first 8 bytes of a compiled
+ * Java class file, or -1 if they are not from a Java class file.
+ */
+static short get_class_major(const char *magic)
+{
+    short major;
+
+    assert(magic != NULL);
+
+    /* Java class files begin with 0xCAFEBABE */
+    if (magic[0] == '\xCA' && magic[1] == '\xFE' && magic[2] == '\xBA' && magic[3] == '\xBE') {
+        /* check the major number for compliance */
+        memcpy(&major, magic + 6, sizeof(major));
+
+        if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) {
+            major = BSWAPFUNC(major);
+        }
+
+        if (major >= 30) {
+            return major;
+        }
+    }
+
+    return -1;
+}
 
 /*
  * Returns major JVM version found if the file is a compiled Java
@@ -48,7 +73,6 @@ static short get_jvm_major(const char *filename, const char *localpath, const ch
 {
     int fd;
     int flags = O_RDONLY | O_CLOEXEC;
-    short major;
     char magic[8];
 
     assert(filename != NULL);
@@ -83,35 +107,20 @@ static short get_jvm_major(const char *filename, const char *localpath, const ch
             return -1;
         }
 
-        /* Java class files begin with 0xCAFEBABE */
-        if (magic[0] == '\xCA' && magic[1] == '\xFE' && magic[2] == '\xBA' && magic[3] == '\xBE') {
-            /* check the major number for compliance */
-            memcpy(&major, magic + 6, sizeof(major));
-
-            if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) {
-                major = BSWAPFUNC(major);
-            }
-
-            if (major >= 30) {
-                return major;
-            }
-        }
+        return get_class_major(magic);
     }
 
     return -1;
 }
 
 /*
- * Called for each file in the package payload or inside the .jar file.
+ * Basic checks on the major JVM version of a class file in the most
+ * recent build.  Returns false if it is not valid or not supported.
  */
-static bool check_class_file(struct rpminspect *ri, const char *fullpath, const char *localpath, const char *peerfullpath, const char *peerlocalpath, const char *container)
+static bool check_jvm_major(struct rpminspect *ri, const short major, const char *localpath, const char *container)
 {
-    short major, majorpeer;
     struct result_params params;
 
-    assert(fullpath != NULL);
-    assert(localpath != NULL);
-
     init_result_params(&params);
     params.severity = RESULT_BAD;
     params.waiverauth = WAIVABLE_BY_ANYONE;
@@ -120,13 +129,7 @@ static bool check_class_file(struct rpminspect *ri, const char *fullpath, const
     params.file = localpath;
     params.remedy = REMEDY_JAVABYTECODE;
 
-    /* try to see if this is just a .class file */
-    major = get_jvm_major(fullpath, localpath, container);
-
-    /* basic checks on the most recent build */
-    if (major == -1 && !strsuffix(localpath, CLASS_FILENAME_EXTENSION)) {
-        return true;
-    } else if (major < 0) {
+    if (major < 0) {
         xasprintf(&params.msg, _("File %s (%s), Java byte code version %d is incorrect (wrong endianness? corrupted file? space JDK?)"), localpath, container, major);
         params.noun = _("incorrect Java byte code version in ${FILE}");
         add_result(ri, &params);
@@ -140,6 +143,38 @@ static bool check_class_file(struct rpminspect *ri, const char *fullpath, const
         return false;
     }
 
+    return true;
+}
+
+/*
+ * Called for each Java class file in the package payload.
+ */
+static bool check_class_file(struct rpminspect *ri, const char *fullpath, const char *localpath, const char *peerfullpath, const char *peerlocalpath, const char *container)
+{
+    short major, majorpeer;
+    struct result_params params;
+
+    assert(fullpath != NULL);
+    assert(localpath != NULL);
+
+    /* try to see if this is just a .class file */
+    major = get_jvm_major(fullpath, localpath, container);
+
+    /* basic checks on the most recent build */
+    if (major == -1 && !strsuffix(localpath, CLASS_FILENAME_EXTENSION)) {
+        return true;
+    } else if (!check_jvm_major(ri, major, localpath, container)) {
+        return false;
+    }
+
+    init_result_params(&params);
+    params.severity = RESULT_BAD;
+    params.waiverauth = WAIVABLE_BY_ANYONE;
+    params.header = NAME_JAVABYTECODE;
+    params.verb = VERB_FAILED;
+    params.file = localpath;
+    params.remedy = REMEDY_JAVABYTECODE;
+
     /* if a peer exists, perform comparisons on version changes */
     if (peerfullpath && peerlocalpath) {
         majorpeer = get_jvm_major(peerfullpath, peerlocalpath, container);
@@ -161,82 +196,340 @@ static bool check_class_file(struct rpminspect *ri, const char *fullpath, const
 }
 
 /*
- * Helper used by nftw() in javabytecode_driver()
+ * A file queued by javabytecode_driver().  For .jar files, classes
+ * holds the findings of scan_jar().
  */
-static int jar_walker(const char *fpath, __attribute__((unused)) const struct stat *sb, int tflag, __attribute__((unused)) struct FTW *ftwbuf)
+struct class_job {
+    rpmfile_entry_t *file;
+    bool jar;
+    string_list_t *classes;          /* "major member" lines, see scan_jar() */
+    TAILQ_ENTRY(class_job) items;
+};
+
+static TAILQ_HEAD(class_jobs_s, class_job) jobs;
+
+/*
+ * Read the class file headers in a .jar file straight from the
+ * archive, without unpacking it, and write an "index major member"
+ * line to fp for each class that fails check_jvm_major().  Only the
+ * first 8 bytes of each class are read.  Files that are not archives
+ * are skipped.
+ */
+static void scan_jar(const char *jar, const size_t n, FILE *fp)
 {
-    /* Only looking at regular files */
-    if (tflag != FTW_F || !S_ISREG(sb->st_mode)) {
-        return 0;
+    int r = 0;
+    size_t len = 0;
+    ssize_t got = 0;
+    short major = -1;
+    const char *member = NULL;
+    char magic[8];
+    struct archive *input = NULL;
+    struct archive_entry *entry = NULL;
+
+    assert(jar != NULL);
+    assert(fp != NULL);
+
+    input = archive_read_new();
+#if ARCHIVE_VERSION_NUMBER < 3000000
+    archive_read_support_compression_all(input);
+#else
+    archive_read_support_filter_all(input);
+#endif
+    archive_read_support_format_all(input);
+
+    if (archive_read_open_filename(input, jar, BUFSIZ) != ARCHIVE_OK) {
+        /* not an archive */
+        archive_read_free(input);
+        return;
     }
 
-    if (!check_class_file(jar_ri, fpath, fpath + prefixlen, NULL, NULL, jarfile)) {
-        jar_result = false;
+    while ((r = archive_read_next_header(input, &entry)) != ARCHIVE_EOF) {
+        if (r != ARCHIVE_OK) {
+            warnx("*** archive_read_next_header: %s", archive_error_string(input));
+
+            if (r < ARCHIVE_WARN) {
+                /* just take what we could read */
+                break;
+            }
+        }
+
+        member = archive_entry_pathname(entry);
+
+        /* Only looking at regular files named like Java classes */
+        if (!S_ISREG(archive_entry_mode(entry)) || member == NULL
+            || !strsuffix(member, CLASS_FILENAME_EXTENSION) || strchr(member, '\n')) {
+            continue;
+        }
+
+        /* read the first 8 bytes and verify it's a Java class */
+        len = 0;
+
+        while (len < sizeof(magic) && (got = archive_read_data(input, magic + len, sizeof(magic) - len)) > 0) {
+            len += got;
+        }
+
+        major = (len == sizeof(magic)) ? get_class_major(magic) : -1;
+
+        if (major < 0 || major < supported_major) {
+            /* report members relative to the jar like an unpacked tree */
+            while (*member == PATH_SEP || strprefix(member, "./")) {
+                member += (*member == PATH_SEP) ? 1 : 2;
+            }
+
+            fprintf(fp, "%zu %d /%s\n", n, major, member);
+        }
     }
 
-    return 0;
+    archive_read_free(input);
+    return;
 }
 
 /*
- * Main driver for the inspection.
+ * Child process for scan_jars().  Scans every nth jar in the list.
  */
-static bool javabytecode_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+static void jar_worker(struct class_job **list, const size_t njobs, const size_t first, const size_t step, const int fd)
 {
-    bool result;
-    char *tmppath = NULL;
-    const char *container = NULL;
-    int jarstatus = 0;
+    size_t n = 0;
+    FILE *fp = NULL;
 
-    container = headerGetString(file->rpm_header, RPMTAG_NAME);
+    fp = fdopen(fd, "w");
 
-    if (strsuffix(file->fullpath, JAR_FILENAME_EXTENSION)) {
-        /* if we have a possible jar file, try to unpack and walk it */
+    if (fp == NULL) {
+        err(RI_PROGRAM_ERROR, "*** fdopen");
+    }
 
-        /* create a temporary directory to unpack this file */
-        xasprintf(&tmppath, "%s/jar.XXXXXX", ri->workdir);
-        tmppath = mkdtemp(tmppath);
+    for (n = first; n < njobs; n += step) {
+        scan_jar(list[n]->file->fullpath, n, fp);
+    }
 
-        if (tmppath == NULL) {
-            warn("*** mkdtemp");
-            free(tmppath);
-            return false;
+    if (fclose(fp) != 0) {
+        err(RI_PROGRAM_ERROR, "*** fclose");
+    }
+
+    return;
+}
+
+/* Store the lines written by jar_worker() on the jobs. */
+static void read_worker_classes(struct class_job **list, const size_t njobs, char *output)
+{
+    char *line = NULL;
+    char *end = NULL;
+    size_t n = 0;
+
+    for (line = strtok(output, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        n = strtoul(line, &end, 10);
+
+        if (*end != ' ' || n >= njobs) {
+            continue;
         }
 
-        /* try to unpack this file */
-        if (unpack_archive(file->fullpath, tmppath, true)) {
-            /* not an archive, just clean up and skip */
-            rmtree(tmppath, true, false);
-            free(tmppath);
-            return true;
+        list[n]->classes = list_add(list[n]->classes, end + 1);
+    }
+
+    return;
+}
+
+/*
+ * Scan the jars of a worker that did not finish in this process
+ * instead, dropping anything it reported before it failed.
+ */
+static void rescan_worker_jars(struct class_job **list, const size_t njobs, const size_t first, const size_t step)
+{
+    size_t n = 0;
+    char *output = NULL;
+    size_t output_size = 0;
+    FILE *fp = NULL;
+
+    for (n = first; n < njobs; n += step) {
+        list_free(list[n]->classes, free);
+        list[n]->classes = NULL;
+    }
+
+    fp = open_memstream(&output, &output_size);
+
+    if (fp == NULL) {
+        err(RI_PROGRAM_ERROR, "*** open_memstream");
+    }
+
+    for (n = first; n < njobs; n += step) {
+        scan_jar(list[n]->file->fullpath, n, fp);
+    }
+
+    if (fclose(fp) != 0) {
+        err(RI_PROGRAM_ERROR, "*** fclose");
+    }
+
+    read_worker_classes(list, njobs, output);
+    free(output);
+    return;
+}
+
+/*
+ * Scan the queued .jar files.  Jars are independent of each other,
+ * so they are spread over parallel worker processes.  The jars of a
+ * worker that fails are scanned again in this process so none are
+ * silently skipped.
+ */
+static void scan_jars(void)
+{
+    size_t njobs = 0;
+    unsigned int max = 0;
+    unsigned int i = 0;
+    unsigned int j = 0;
+    int pipefd[2];
+    pid_t pid;
+    unsigned int *workers = NULL;
+    struct class_job *job = NULL;
+    struct class_job **list = NULL;
+    parallel_t *col = NULL;
+    parallel_slot_t *slot = NULL;
+
+    TAILQ_FOREACH(job, &jobs, items) {
+        if (job->jar) {
+            list = xrealloc(list, (njobs + 1) * sizeof(*list));
+            list[njobs++] = job;
+        }
+    }
+
+    if (njobs == 0) {
+        return;
+    }
+
+    max = get_parallel_processes();
+
+    if (max > njobs) {
+        max = njobs;
+    }
+
+    if (max < 1) {
+        max = 1;
+    }
+
+    /* one worker per process, each takes every max'th jar */
+    fflush(NULL);
+    col = new_parallel(max);
+
+    /* there is no limit on the number of classes a worker reports */
+    col->max_len = 0;
+    workers = xcalloc(col->max_pids, sizeof(*workers));
+
+    for (i = 0; i < max; i++) {
+        if (pipe(pipefd)) {
+            err(RI_PROGRAM_ERROR, "*** pipe");
+        }
+
+        pid = fork();
+
+        if (pid < 0) {
+            err(RI_PROGRAM_ERROR, "*** fork");
+        }
+
+        if (pid == 0) {
+            /* child */
+            if (close(pipefd[0]) == -1) {
+                warn("*** close");
+            }
+
+            jar_worker(list, njobs, i, max, pipefd[1]);
+            _exit(RI_SUCCESS);
+        }
+
+        /* parent */
+        if (close(pipefd[1]) == -1) {
+            warn("*** close");
         }
 
-        /* iterate over the unpacked jar file */
-        prefixlen = strlen(tmppath);
-        jarfile = file->localpath;
-        jar_ri = ri;
-        jarstatus = nftw(tmppath, jar_walker, FOPEN_MAX, FTW_MOUNT | FTW_PHYS);
+        insert_new_pid_and_fd(col, pid, pipefd[0]);
 
-        if (jarstatus != 0) {
-            /* we errored somewhere, just report it */
-            warn("*** nftw");
+        for (j = 0; j < col->max_pids; j++) {
+            if (col->slot[j].pid == pid) {
+                workers[j] = i;
+                break;
+            }
+        }
+    }
+
+    while ((slot = collect_one(col)) != NULL) {
+        i = workers[slot - col->slot];
+
+        if (!WIFEXITED(slot->exit_status) || WEXITSTATUS(slot->exit_status) != RI_SUCCESS) {
+            warnx(_("*** %s worker %u failed, scanning its files again"), NAME_JAVABYTECODE, i);
+            rescan_worker_jars(list, njobs, i, max);
+        } else if (slot->output) {
+            read_worker_classes(list, njobs, slot->output);
         }
 
-        /* clean up */
-        rmtree(tmppath, true, false);
-        free(tmppath);
+        free(slot->output);
+        slot->output = NULL;
+        slot->output_len = 0;
+        slot->output_size = 0;
+    }
+
+    delete_parallel(col, 0);
+    free(workers);
+    free(list);
+    return;
+}
+
+/*
+ * Check a queued class file, or report the classes that scan_jar()
+ * found in a .jar file.
+ */
+static bool report_class_job(struct rpminspect *ri, struct class_job *job)
+{
+    bool result = true;
+    short major = -1;
+    char *member = NULL;
+    const char *container = NULL;
+    rpmfile_entry_t *file = job->file;
+    string_entry_t *entry = NULL;
+
+    if (!job->jar) {
+        container = headerGetString(file->rpm_header, RPMTAG_NAME);
 
-        result = jar_result;
-    } else {
         if (file->peer_file) {
-            result = check_class_file(ri, file->fullpath, file->localpath, file->peer_file->fullpath, file->peer_file->localpath, container);
-        } else {
-            result = check_class_file(ri, file->fullpath, file->localpath, NULL, NULL, container);
+            return check_class_file(ri, file->fullpath, file->localpath, file->peer_file->fullpath, file->peer_file->localpath, container);
+        }
+
+        return check_class_file(ri, file->fullpath, file->localpath, NULL, NULL, container);
+    }
+
+    if (job->classes == NULL) {
+        return true;
+    }
+
+    TAILQ_FOREACH(entry, job->classes, items) {
+        major = strtol(entry->data, &member, 10);
+
+        if (*member != ' ') {
+            continue;
+        }
+
+        if (!check_jvm_major(ri, major, member + 1, job->file->localpath)) {
+            result = false;
         }
     }
 
     return result;
 }
 
+/*
+ * Main driver for the inspection.  Files are queued, the .jar files
+ * are scanned together by scan_jars(), and then everything is
+ * checked in the order it was found by report_class_job().
+ */
+static bool javabytecode_driver(__attribute__((unused)) struct rpminspect *ri, rpmfile_entry_t *file)
+{
+    struct class_job *job = NULL;
+
+    job = xalloc(sizeof(*job));
+    job->file = file;
+    job->jar = strsuffix(file->fullpath, JAR_FILENAME_EXTENSION);
+    TAILQ_INSERT_TAIL(&jobs, job, items);
+
+    return true;
+}
+
 /*
  * Main driver for the 'javabytecode' inspection.
  */
@@ -244,6 +537,7 @@ bool inspect_javabytecode(struct rpminspect *ri)
 {
     bool result = true;
     string_map_t *hentry = NULL;
+    struct class_job *job = NULL;
     struct result_params params;
 
     assert(ri != NULL);
@@ -286,8 +580,25 @@ bool inspect_javabytecode(struct rpminspect *ri)
      * The minimum bytecode version data comes from the configuration
      * file and varies by vendor product release.
      */
+    TAILQ_INIT(&jobs);
     result = foreach_peer_file(ri, NAME_JAVABYTECODE, javabytecode_driver);
 
+    /* read the class headers in all of the .jar files */
+    scan_jars();
+
+    /* report in the order the files were found */
+    while (!TAILQ_EMPTY(&jobs)) {
+        job = TAILQ_FIRST(&jobs);
+        TAILQ_REMOVE(&jobs, job, items);
+
+        if (!report_class_job(ri, job)) {
+            result = false;
+        }
+
+        list_free(job->classes, free);
+        free(job);
+    }
+
     if (result) {
         init_result_params(&params);
         params.severity = RESULT_OK;
@@ -15,6 +15,9 @@
 static bool reported = false;
 static struct result_params params;
 
+/* libkmod context shared by every module read in a run */
+static struct kmod_ctx *kctx = NULL;
+
 static void lost_alias(const char *alias, const string_list_t *before_modules, const string_list_t *after_modules, void *user_data)
 {
     struct rpminspect *ri = (struct rpminspect *) user_data;
@@ -50,19 +53,53 @@ static void lost_alias(const char *alias, const string_list_t *before_modules, c
     return;
 }
 
-static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+/*
+ * Read the module name and modinfo of a kernel module file.  The
+ * libkmod module is released once its modinfo is read, so modules of
+ * the same name from the before and after builds can come from the
+ * one context.  Returns NULL if the file is not a kernel module or
+ * carries no modinfo.  Caller must free the name and the returned
+ * list.
+ */
+static struct kmod_list *get_module_info(const char *path, char **name)
 {
     int err = -1;
+    struct kmod_module *kmod = NULL;
+    struct kmod_list *info = NULL;
+
+    assert(path != NULL);
+    assert(name != NULL);
+
+    err = kmod_module_new_from_path(kctx, path, &kmod);
+
+    if (err < 0) {
+        /* not a kernel module */
+        return NULL;
+    }
+
+    err = kmod_module_get_info(kmod, &info);
+
+    if (err < 0) {
+        warn("*** kmod_module_get_info");
+    } else if (info != NULL) {
+        *name = strdup(kmod_module_get_name(kmod));
+        assert(*name != NULL);
+    }
+
+    kmod_module_unref(kmod);
+
+    return info;
+}
+
+static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+{
     bool result_parm = true;
     bool result_deps = true;
     bool result_aliases = true;
-    struct kmod_ctx *kctx = NULL;
-    struct kmod_module *beforekmod = NULL;
-    struct kmod_module *afterkmod = NULL;
     struct kmod_list *beforeinfo = NULL;
     struct kmod_list *afterinfo = NULL;
-    const char *before_kmod_name = NULL;
-    const char *after_kmod_name = NULL;
+    char *before_kmod_name = NULL;
+    char *after_kmod_name = NULL;
     kernel_alias_data_t *beforealiases = NULL;
     kernel_alias_data_t *afteraliases = NULL;
     string_list_t *lost = NULL;
@@ -121,63 +158,17 @@ static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     assert(afterver != NULL);
 
     /* Read in the kernel modules */
-    kctx = kmod_new(NULL, NULL);
-
-    if (kctx == NULL) {
-        warn("*** kmod_new");
-        return true;
-    }
-
-    err = kmod_module_new_from_path(kctx, file->peer_file->fullpath, &beforekmod);
-
-    if (err < 0) {
-        /* not a kernel module */
-        kmod_unref(kctx);
-        return true;
-    } else {
-        before_kmod_name = kmod_module_get_name(beforekmod);
-    }
-
-    kmod_unref(kctx);
-    kctx = kmod_new(NULL, NULL);
-
-    if (kctx == NULL) {
-        warn("*** kmod_new");
-        kmod_module_unref(beforekmod);
-        return true;
-    }
+    beforeinfo = get_module_info(file->peer_file->fullpath, &before_kmod_name);
 
-    err = kmod_module_new_from_path(kctx, file->fullpath, &afterkmod);
-
-    if (err < 0) {
-        /* not a kernel module */
-        kmod_module_unref(beforekmod);
-        kmod_module_unref(afterkmod);
-        kmod_unref(kctx);
+    if (beforeinfo == NULL) {
         return true;
-    } else {
-        after_kmod_name = kmod_module_get_name(afterkmod);
     }
 
-    /* Gather module parameters */
-    err = kmod_module_get_info(beforekmod, &beforeinfo);
+    afterinfo = get_module_info(file->fullpath, &after_kmod_name);
 
-    if (err < 0) {
-        warn("*** kmod_module_get_info");
-        kmod_module_unref(beforekmod);
-        kmod_module_unref(afterkmod);
-        kmod_unref(kctx);
-        return true;
-    }
-
-    err = kmod_module_get_info(afterkmod, &afterinfo);
-
-    if (err < 0) {
-        warn("*** kmod_module_get_info");
+    if (afterinfo == NULL) {
         kmod_module_info_free_list(beforeinfo);
-        kmod_module_unref(beforekmod);
-        kmod_module_unref(afterkmod);
-        kmod_unref(kctx);
+        free(before_kmod_name);
         return true;
     }
 
@@ -262,11 +253,10 @@ static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     /* Clean up libkmod usage */
     kmod_module_info_free_list(beforeinfo);
     kmod_module_info_free_list(afterinfo);
-    kmod_module_unref(beforekmod);
-    kmod_module_unref(afterkmod);
-    kmod_unref(kctx);
 
     /* Our own stuff */
+    free(before_kmod_name);
+    free(after_kmod_name);
     free_module_aliases(beforealiases);
     free_module_aliases(afteraliases);
 
@@ -289,7 +279,18 @@ bool inspect_kmod(struct rpminspect *ri)
     params.waiverauth = NOT_WAIVABLE;
     params.header = NAME_KMOD;
     params.verb = VERB_OK;
+
+    /* read every module through one libkmod context */
+    kctx = kmod_new(NULL, NULL);
+
+    if (kctx == NULL) {
+        warn("*** kmod_new");
+        return true;
+    }
+
     result = foreach_peer_file(ri, NAME_KMOD, kmod_driver);
+    kmod_unref(kctx);
+    kctx = NULL;
 
     /* if everything was fine, just say so */
     if (result && !reported) {
@@ -12,6 +12,7 @@
  */
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <err.h>
 #include <stdbool.h>
@@ -29,11 +30,76 @@
 /* Globals */
 static bool result = true;
 static const char *srpm = NULL;
-static int nspdx = 0;
-static int nlegacy = 0;
-static int ndual = 0;
-string_list_t *booleans = NULL;
-string_list_t *dual = NULL;
+static string_list_t *dual = NULL;
+
+/*
+ * An approved entry from a license database.  Only the fields used
+ * to validate License tags are kept.
+ */
+struct license_entry {
+    char *spdx_abbrev;
+    string_list_t *fedora_abbrev;
+    string_list_t *fedora_name;
+    unsigned int seen;               /* last lookup that checked this entry */
+};
+
+/*
+ * The license database entries sharing a lookup key.
+ */
+struct license_key {
+    char *key;
+    struct license_entry **entries;
+    size_t num;
+    UT_hash_handle hh;
+};
+
+/*
+ * One license database loaded in to hash tables.  The SPDX table is
+ * keyed by the lowercase expression because SPDX identifiers are
+ * case insensitive.  The Fedora tables are keyed by the exact legacy
+ * abbreviations and names.
+ */
+struct license_index {
+    struct license_entry **entries;
+    size_t num;
+    struct license_key *by_spdx;
+    struct license_key *by_abbrev;
+    struct license_key *by_name;
+};
+
+static struct license_index *indexes = NULL;
+static size_t nindexes = 0;
+static unsigned int lookup = 0;
+
+/*
+ * The result of checking one License tag string.  Subpackages almost
+ * always carry the same License tag, so the verdict is computed once
+ * per distinct string and reported for each package that uses it.
+ */
+struct license_verdict {
+    char *license;                   /* key, the License tag */
+    bool balanced;                   /* parentheses are balanced */
+    bool whole;                      /* approved as a whole string */
+    string_list_t *unapproved;       /* terms not in any database */
+    string_list_t *booleans;         /* 'and' and 'or' keywords used */
+    string_list_t *keywords;         /* mixed case SPDX keywords */
+    int nspdx;                       /* terms matched as SPDX */
+    int nlegacy;                     /* terms matched as legacy Fedora */
+    int ndual;                       /* terms valid under both */
+    UT_hash_handle hh;
+};
+
+static struct license_verdict *verdicts = NULL;
+
+/*
+ * A License tag broken in to its parts.
+ */
+struct license_expr {
+    bool balanced;                   /* parentheses are balanced */
+    string_list_t *terms;            /* license terms between keywords */
+    string_list_t *booleans;         /* 'and' and 'or' keywords */
+    string_list_t *groups;           /* contents of each paren group */
+};
 
 /* Helper to determine overall inspection result */
 static bool get_result(const bool result, const severity_t sev)
@@ -74,12 +140,9 @@ static parser_plugin *read_licensedb(struct rpminspect *ri, const char *db, pars
     return p;
 }
 
-/* another callback for dual_cb() and lic_cb() to get the actual strings */
-static bool get_db_strings(const char *license_name, void *cb_data, char **spdx_abbrev, string_list_t **fedora_abbrev, string_list_t **fedora_name, bool *approved)
+/* callback for index_cb() to get the actual strings */
+static bool get_db_strings(const char *license_name, parser_plugin *p, parser_context *db, char **spdx_abbrev, string_list_t **fedora_abbrev, string_list_t **fedora_name, bool *approved)
 {
-    lic_cb_data *data = cb_data;
-    parser_plugin *p = data->p;
-    parser_context *db = data->db;
     parser_context *cont = NULL;
     json_object *block = NULL;
     string_list_t *slist = NULL;
@@ -125,6 +188,8 @@ static bool get_db_strings(const char *license_name, void *cb_data, char **spdx_
     if (*spdx_abbrev == NULL) {
         list_free(*fedora_abbrev, free);
         list_free(*fedora_name, free);
+        *fedora_abbrev = NULL;
+        *fedora_name = NULL;
         *approved = false;
 
         /* the new API format failed, fall back on the legacy format */
@@ -162,11 +227,9 @@ static bool get_db_strings(const char *license_name, void *cb_data, char **spdx_
 }
 
 /* lambda: check the case and matching of SPDX special words */
-static bool check_spdx_special_words(struct rpminspect *ri, const char *pkg_word, const char *db_word)
+static bool check_spdx_special_words(struct license_verdict *verdict, const char *pkg_word, const char *db_word)
 {
-    struct result_params params;
-
-    assert(ri != NULL);
+    assert(verdict != NULL);
     assert(pkg_word != NULL);
     assert(db_word != NULL);
 
@@ -186,18 +249,10 @@ static bool check_spdx_special_words(struct rpminspect *ri, const char *pkg_word
         } else {
             /*
              * Did we catch a forbidden capitalization of the words "and",
-             * "or", or "with"?  Call the police!
+             * "or", or "with"?  Call the police!  These are reported
+             * for each package using this License tag.
              */
-            init_result_params(&params);
-            xasprintf(&params.msg, _("An invalid SPDX keyword was found.  The keyword '%s' must always be written in all lowercase or all uppercase (not mixed case)."), pkg_word);
-            params.header = NAME_LICENSE;
-            params.severity = RESULT_BAD;
-            params.remedy = REMEDY_INVALID_BOOLEAN;
-            params.verb = VERB_FAILED;
-            params.noun = _("invalid SPDX expression keyword");
-            add_result(ri, &params);
-            free(params.msg);
-
+            verdict->keywords = list_add(verdict->keywords, pkg_word);
             return false;
         }
     }
@@ -206,7 +261,7 @@ static bool check_spdx_special_words(struct rpminspect *ri, const char *pkg_word
 }
 
 /* lambda: see if two candidate SPDX expression strings match SPDX rules */
-static bool spdx_expression_match(struct rpminspect *ri, const char *pkg_license, const char *db_license)
+static bool spdx_expression_match(struct license_verdict *verdict, const char *pkg_license, const char *db_license)
 {
     bool match = false;
     string_list_t *pkgtokens = NULL;
@@ -214,9 +269,9 @@ static bool spdx_expression_match(struct rpminspect *ri, const char *pkg_license
     string_entry_t *pkg = NULL;
     string_entry_t *db = NULL;
 
-    assert(ri != NULL);
+    assert(verdict != NULL);
 
-    if ((pkg_license == NULL && db_license) || (pkg_license && db_license == NULL)) {
+    if (pkg_license == NULL || db_license == NULL) {
         return false;
     }
 
@@ -246,7 +301,7 @@ static bool spdx_expression_match(struct rpminspect *ri, const char *pkg_license
     while (pkg && db) {
         /* check special words first */
         if (!strcasecmp(pkg->data, "AND") || !strcasecmp(pkg->data, "OR") || !strcasecmp(pkg->data, "WITH")) {
-            if (check_spdx_special_words(ri, pkg->data, db->data)) {
+            if (check_spdx_special_words(verdict, pkg->data, db->data)) {
                 /* force a continue here since in SPDX-speak, "with == WITH" */
                 pkg = TAILQ_NEXT(pkg, items);
                 db = TAILQ_NEXT(db, items);
@@ -293,93 +348,134 @@ static bool list_contains_spdx_expression(string_list_t *list, const char *expre
     return match;
 }
 
-/* lambda; finds dual legacy and SPDX license expressions */
-static bool dual_cb(const char *license_name, void *cb_data)
+/* Return a lowercase copy of a string; caller must free */
+static char *lowercase(const char *s)
 {
-    string_list_t *fedora_abbrev = NULL;
-    string_list_t *fedora_name = NULL;
-    char *spdx_abbrev = NULL;
-    bool approved = false;
+    char *r = NULL;
+    char *c = NULL;
 
-    if (!get_db_strings(license_name, cb_data, &spdx_abbrev, &fedora_abbrev, &fedora_name, &approved)) {
-        return false;
+    assert(s != NULL);
+
+    r = strdup(s);
+    assert(r != NULL);
+
+    for (c = r; *c != '\0'; c++) {
+        *c = tolower((unsigned char) *c);
+    }
+
+    return r;
+}
+
+/* Add a license database entry to a lookup table under the given key */
+static void add_license_key(struct license_key **table, const char *key, struct license_entry *entry)
+{
+    struct license_key *k = NULL;
+
+    assert(table != NULL);
+    assert(key != NULL);
+    assert(entry != NULL);
+
+    HASH_FIND_STR(*table, key, k);
+
+    if (k == NULL) {
+        k = xalloc(sizeof(*k));
+        k->key = strdup(key);
+        assert(k->key != NULL);
+        HASH_ADD_KEYPTR(hh, *table, k->key, strlen(k->key), k);
+    } else if (k->num > 0 && k->entries[k->num - 1] == entry) {
+        /* listed twice in the same entry */
+        return;
     }
 
-    /* no SPDX expression or not approved? done */
-    if (spdx_abbrev == NULL || !approved) {
-        goto done;
+    k->entries = xrealloc(k->entries, (k->num + 1) * sizeof(*k->entries));
+    k->entries[k->num++] = entry;
+    return;
+}
+
+static void free_license_keys(struct license_key *table)
+{
+    struct license_key *k = NULL;
+    struct license_key *tmp_k = NULL;
+
+    HASH_ITER(hh, table, k, tmp_k) {
+        HASH_DEL(table, k);
+        free(k->key);
+        free(k->entries);
+        free(k);
     }
 
+    return;
+}
+
+/*
+ * Add an approved license database entry to the lookup tables and
+ * collect it if it is a dual legacy and SPDX license expression.  The
+ * index takes ownership of the strings.
+ */
+static void add_license_entry(struct license_index *index, char *spdx_abbrev, string_list_t *fedora_abbrev, string_list_t *fedora_name)
+{
+    struct license_entry *entry = NULL;
+    string_entry_t *s = NULL;
+    char *key = NULL;
+
+    assert(index != NULL);
+
     /* collect any dual licenses */
-    if (approved && spdx_abbrev && (list_contains_spdx_expression(fedora_abbrev, spdx_abbrev) || list_contains_spdx_expression(fedora_name, spdx_abbrev))) {
+    if (spdx_abbrev && (list_contains_spdx_expression(fedora_abbrev, spdx_abbrev) || list_contains_spdx_expression(fedora_name, spdx_abbrev))) {
         dual = list_add(dual, spdx_abbrev);
     }
 
-done:
-    list_free(fedora_abbrev, free);
-    list_free(fedora_name, free);
-    free(spdx_abbrev);
+    entry = xalloc(sizeof(*entry));
+    entry->spdx_abbrev = spdx_abbrev;
+    entry->fedora_abbrev = fedora_abbrev;
+    entry->fedora_name = fedora_name;
 
-    /*
-     * you may think this should be return true, but it can't be
-     * otherwise the parse_json() loopity loop will stop
-     */
-    return false;
+    index->entries = xrealloc(index->entries, (index->num + 1) * sizeof(*index->entries));
+    index->entries[index->num++] = entry;
+
+    if (spdx_abbrev) {
+        key = lowercase(spdx_abbrev);
+        add_license_key(&index->by_spdx, key, entry);
+        free(key);
+    }
+
+    if (fedora_abbrev) {
+        TAILQ_FOREACH(s, fedora_abbrev, items) {
+            add_license_key(&index->by_abbrev, s->data, entry);
+        }
+    }
+
+    if (fedora_name) {
+        TAILQ_FOREACH(s, fedora_name, items) {
+            add_license_key(&index->by_name, s->data, entry);
+        }
+    }
+
+    return;
 }
 
-/* lambda; checks against an entry in the license database. */
-static bool lic_cb(const char *license_name, void *cb_data)
+/* lambda: load one license database entry */
+static bool index_cb(const char *license_name, void *cb_data)
 {
-    lic_cb_data *data = cb_data;
+    licdb_cb_data *data = cb_data;
     string_list_t *fedora_abbrev = NULL;
     string_list_t *fedora_name = NULL;
     char *spdx_abbrev = NULL;
     bool approved = false;
 
-    if (!get_db_strings(license_name, cb_data, &spdx_abbrev, &fedora_abbrev, &fedora_name, &approved)) {
+    if (!get_db_strings(license_name, data->p, data->db, &spdx_abbrev, &fedora_abbrev, &fedora_name, &approved)) {
         return false;
     }
 
-    /* No full tag match and no abbreviations; license entry invalid. */
-    if (spdx_abbrev == NULL && (fedora_abbrev == NULL || TAILQ_EMPTY(fedora_abbrev)) && (fedora_name == NULL || TAILQ_EMPTY(fedora_name))) {
-        goto done;
-    }
-
-    /*
-     * If the entire license string is approved, that is valid.
-     * If we hit 'fedora_abbrev', that is valid.
-     * If we hit 'spdx_abbrev' and approved is true, that is valid.
-     * NOTE: we only match the first hit in the license database
-     */
-    if (approved) {
-        if (spdx_expression_match(data->ri, data->lic, spdx_abbrev)) {
-            data->valid = true;
-            nspdx++;
-
-            if (list_case_contains(dual, spdx_abbrev)) {
-                /* license token is valid under the legacy system and SPDX */
-                ndual++;
-            }
-        } else if ((fedora_abbrev && list_len(fedora_abbrev) > 0 && list_contains(fedora_abbrev, data->lic))
-                   || ((fedora_abbrev == NULL || list_len(fedora_abbrev) == 0)
-                       && (fedora_name && list_len(fedora_name) > 0)
-                       && list_contains(fedora_name, data->lic))) {
-            /* Old Fedora abbreviation matches -or- there are no Fedora abbreviations but a Fedora name matches */
-            data->valid = true;
-            nlegacy++;
-
-            if (list_contains(dual, data->lic)) {
-                /* license token is valid under the legacy system and SPDX */
-                ndual++;
-            }
-        }
+    if (approved && (spdx_abbrev || fedora_abbrev || fedora_name)) {
+        add_license_entry(data->index, spdx_abbrev, fedora_abbrev, fedora_name);
+    } else {
+        /* unapproved entries never validate anything */
+        list_free(fedora_abbrev, free);
+        list_free(fedora_name, free);
+        free(spdx_abbrev);
     }
 
-done:
-    list_free(fedora_abbrev, free);
-    list_free(fedora_name, free);
-    free(spdx_abbrev);
-
     /*
      * you may think this should be return true, but it can't be
      * otherwise the parse_json() loopity loop will stop
@@ -388,183 +484,396 @@ done:
 }
 
 /*
- * Gathers all approved licenses with the same abbreviation for the
- * SPDX expression and the legacy name.
+ * Read every license database once and load the approved entries in
+ * to lookup tables.
  */
-static void gather_dual_licenses(struct rpminspect *ri, parser_plugin *p, parser_context *db)
+static void load_license_indexes(struct rpminspect *ri)
 {
-    lic_cb_data data = { ri, p, db, NULL, false };
+    string_entry_t *entry = NULL;
+    parser_plugin *p = NULL;
+    parser_context *db = NULL;
+    licdb_cb_data data;
 
-    if (p->keymap(db, NULL, NULL, dual_cb, &data)) {
-        warnx(_("*** problem gathering dual SPDX/legacy license identifiers"));
-        return;
+    assert(ri != NULL);
+
+    indexes = xcalloc(list_len(ri->licensedb), sizeof(*indexes));
+    nindexes = 0;
+
+    TAILQ_FOREACH(entry, ri->licensedb, items) {
+        /* read in this license database */
+        p = read_licensedb(ri, entry->data, &db);
+
+        if (p == NULL) {
+            continue;
+        }
+
+        data.p = p;
+        data.db = db;
+        data.index = &indexes[nindexes];
+
+        if (p->keymap(db, NULL, NULL, index_cb, &data)) {
+            warnx(_("*** problem reading license database %s"), entry->data);
+        }
+
+        nindexes++;
+
+        /* close this db */
+        p->fini(db);
+    }
+
+    return;
+}
+
+static void free_license_indexes(void)
+{
+    size_t i = 0;
+    size_t j = 0;
+    struct license_index *index = NULL;
+
+    for (i = 0; i < nindexes; i++) {
+        index = &indexes[i];
+        free_license_keys(index->by_spdx);
+        free_license_keys(index->by_abbrev);
+        free_license_keys(index->by_name);
+
+        for (j = 0; j < index->num; j++) {
+            free(index->entries[j]->spdx_abbrev);
+            list_free(index->entries[j]->fedora_abbrev, free);
+            list_free(index->entries[j]->fedora_name, free);
+            free(index->entries[j]);
+        }
+
+        free(index->entries);
     }
 
+    free(indexes);
+    indexes = NULL;
+    nindexes = 0;
     return;
 }
 
 /*
- * Called by is_valid_license() to check each short license token.  It
- * will also try to do a whole match on the license tag string.
+ * Check a license string against one entry in a license database.
+ * If the entire license string is approved, that is valid.  If we hit
+ * 'fedora_abbrev', that is valid.  If we hit 'spdx_abbrev', that is
+ * valid.  Only approved entries are in the lookup tables.
  */
-static bool check_license_abbrev(struct rpminspect *ri, parser_plugin *p, parser_context *db, const char *lic)
+static bool check_license_entry(struct license_verdict *verdict, const struct license_entry *entry, const char *lic)
 {
-    lic_cb_data data = { ri, p, db, lic, false };
+    if (spdx_expression_match(verdict, lic, entry->spdx_abbrev)) {
+        verdict->nspdx++;
 
-    if (p->keymap(db, NULL, NULL, lic_cb, &data)) {
-        warnx(_("*** problem checking license database"));
-        return false;
+        if (list_case_contains(dual, entry->spdx_abbrev)) {
+            /* license token is valid under the legacy system and SPDX */
+            verdict->ndual++;
+        }
+
+        return true;
+    } else if ((entry->fedora_abbrev && !TAILQ_EMPTY(entry->fedora_abbrev) && list_contains(entry->fedora_abbrev, lic))
+               || ((entry->fedora_abbrev == NULL || TAILQ_EMPTY(entry->fedora_abbrev)) && entry->fedora_name && list_contains(entry->fedora_name, lic))) {
+        /* Old Fedora abbreviation matches -or- there are no Fedora abbreviations but a Fedora name matches */
+        verdict->nlegacy++;
+
+        if (list_contains(dual, lic)) {
+            /* license token is valid under the legacy system and SPDX */
+            verdict->ndual++;
+        }
+
+        return true;
     }
 
-    return data.valid;
+    return false;
 }
 
-static void token_add(string_map_t **tags, const char *token)
+/* Check a license string against the entries under one key */
+static bool check_license_key(struct license_verdict *verdict, struct license_key *table, const char *key, const char *lic)
 {
-    string_map_t *tag_entry = NULL;
+    bool valid = false;
+    size_t i = 0;
+    struct license_key *k = NULL;
 
-    assert(token != NULL);
+    HASH_FIND_STR(table, key, k);
 
-    tag_entry = xalloc(sizeof(*tag_entry));
-    tag_entry->key = strdup(token);
-    assert(tag_entry->key != NULL);
-    tag_entry->value = NULL;
-    HASH_ADD_KEYPTR(hh, *tags, tag_entry->key, strlen(tag_entry->key), tag_entry);
+    if (k == NULL) {
+        return false;
+    }
 
-    return;
+    for (i = 0; i < k->num; i++) {
+        /* an entry can be under more than one key */
+        if (k->entries[i]->seen == lookup) {
+            continue;
+        }
+
+        k->entries[i]->seen = lookup;
+
+        if (check_license_entry(verdict, k->entries[i], lic)) {
+            valid = true;
+        }
+    }
+
+    return valid;
 }
 
 /*
- * Split up the license expression in to tokens.  This can be an empty
- * list on return.
+ * Check a license string or term against the license databases.
+ * The databases are tried in order and the first one approving the
+ * string wins.
  */
-static string_map_t *tokenize_license_tag(const char *license)
+static bool check_license_abbrev(struct license_verdict *verdict, const char *lic)
 {
-    char *tagtokens = NULL;
-    char *tagcopy = NULL;
-    char *token = NULL;
-    char *lic = NULL;
-    string_map_t *tags = NULL;
+    bool valid = false;
+    size_t i = 0;
+    char *key = NULL;
 
-    assert(license != NULL);
+    assert(verdict != NULL);
+    assert(lic != NULL);
 
-    tagtokens = tagcopy = strdup(license);
-    assert(tagcopy != NULL);
+    if (*lic == '\0') {
+        return false;
+    }
 
-    while ((token = strsep(&tagtokens, " ()")) != NULL) {
-        if (!strcmp(token, "")) {
-            continue;
-        }
+    key = lowercase(lic);
 
-        if (!strcasecmp(token, "AND") || !strcasecmp(token, "OR")) {
-            booleans = list_add(booleans, token);
+    for (i = 0; i < nindexes && !valid; i++) {
+        lookup++;
 
-            if (lic == NULL) {
-                continue;
-            }
+        if (check_license_key(verdict, indexes[i].by_spdx, key, lic)) {
+            valid = true;
+        }
 
-            /* add this tag to the hash table */
-            token_add(&tags, lic);
+        if (check_license_key(verdict, indexes[i].by_abbrev, lic, lic)) {
+            valid = true;
+        }
 
-            /* clear the local tag to start over */
-            free(lic);
-            lic = NULL;
-        } else if (lic == NULL) {
-            lic = strdup(token);
-        } else {
-            lic = strappend(lic, " ", token, NULL);
+        if (check_license_key(verdict, indexes[i].by_name, lic, lic)) {
+            valid = true;
         }
     }
 
-    if (lic) {
-        /* add this last tag to the hash table */
-        token_add(&tags, lic);
+    free(key);
+    return valid;
+}
+
+/* Add a term to the list, words are collected in 'term' */
+static void add_license_term(struct license_expr *expr, char **term)
+{
+    if (*term == NULL) {
+        return;
     }
 
-    /* cleanup */
-    free(lic);
-    free(tagcopy);
+    expr->terms = list_add(expr->terms, *term);
+    free(*term);
+    *term = NULL;
+    return;
+}
 
-    return tags;
+static void free_license_expression(struct license_expr *expr)
+{
+    if (expr == NULL) {
+        return;
+    }
+
+    list_free(expr->terms, free);
+    list_free(expr->booleans, free);
+    list_free(expr->groups, free);
+    free(expr);
+    return;
 }
 
-/* Free the license tags hash */
-static void free_tags(string_map_t *tags)
+/*
+ * Parse a License tag in one pass.  Parentheses are checked for
+ * balance and the contents of every group are collected.  The 'and'
+ * and 'or' keywords split the tag in to license terms; everything
+ * else, including 'with' and the words of legacy multi-word license
+ * names, stays in the term.  Words are separated by spaces and
+ * parentheses.
+ */
+static struct license_expr *parse_license_expression(const char *license)
 {
-    string_map_t *tagtoken = NULL;
-    string_map_t *tmp_tagtoken = NULL;
+    int depth = 0;
+    const char *s = NULL;
+    const char **open = NULL;
+    char *word = NULL;
+    char *term = NULL;
+    char *group = NULL;
+    struct license_expr *expr = NULL;
 
-    if (tags == NULL) {
-        return;
+    assert(license != NULL);
+
+    expr = xalloc(sizeof(*expr));
+    expr->balanced = true;
+    open = xcalloc(strlen(license) + 1, sizeof(*open));
+    s = license;
+
+    while (*s != '\0') {
+        if (*s == ' ') {
+            s++;
+        } else if (*s == '(') {
+            open[depth++] = ++s;
+        } else if (*s == ')') {
+            if (depth == 0) {
+                expr->balanced = false;
+                break;
+            }
+
+            depth--;
+
+            if (s > open[depth]) {
+                group = strndup(open[depth], s - open[depth]);
+                assert(group != NULL);
+                expr->groups = list_add(expr->groups, group);
+                free(group);
+            }
+
+            s++;
+        } else {
+            word = strndup(s, strcspn(s, " ()"));
+            assert(word != NULL);
+            s += strlen(word);
+
+            if (!strcasecmp(word, "AND") || !strcasecmp(word, "OR")) {
+                expr->booleans = list_add(expr->booleans, word);
+                add_license_term(expr, &term);
+            } else if (term == NULL) {
+                term = strdup(word);
+                assert(term != NULL);
+            } else {
+                term = strappend(term, " ", word, NULL);
+            }
+
+            free(word);
+        }
     }
 
-    HASH_ITER(hh, tags, tagtoken, tmp_tagtoken) {
-        tagtoken->value = NULL;
+    if (depth != 0) {
+        expr->balanced = false;
+    }
+
+    /* add this last term */
+    add_license_term(expr, &term);
+    free(open);
+    return expr;
+}
+
+static void free_license_verdicts(void)
+{
+    struct license_verdict *verdict = NULL;
+    struct license_verdict *tmp_verdict = NULL;
+
+    HASH_ITER(hh, verdicts, verdict, tmp_verdict) {
+        HASH_DEL(verdicts, verdict);
+        free(verdict->license);
+        list_free(verdict->unapproved, free);
+        list_free(verdict->booleans, free);
+        list_free(verdict->keywords, free);
+        free(verdict);
     }
 
-    free_string_map(tags);
     return;
 }
 
 /*
- * This is very unique to how license tags have historically been used
- * in Fedora and Red Hat.  Sometimes a compound expression is allowed
- * but as individual tokens not all of them are allowed.  An example
- * is Perl packages using "GPL+ or Artistic" as their license tag for
- * a long time.  GPL+ was allowed but Artistic was not.  However the
- * compound expression "GPL+ or Artistic" was allowed per the license
- * database.  This is legacy stuff, but we still need to handle it
- * until all packages have moved over to SPDX expressions exclusively.
+ * Check a License tag string against the license databases and
+ * return the verdict.  The checking has 3 distinct phases because
+ * everything has to be complicated:
  *
- * The two in-use instances of these types of legacy compound
- * expression are either as the entire license tag or as an expression
- * within parens.  We do not handle nested parens.  This function
- * builds a list of compound expressions in parens and returns it to
- * the caller.  The caller is responsible for freeing this list.
+ * 1) Try to match the entire tag.  This is the common case.
+ * 2) Try to match the expressions in parens.  This is because of
+ *    past bad policy decisions; sometimes a compound expression is
+ *    allowed but as individual terms not all of them are allowed.
+ *    An example is Perl packages using "GPL+ or Artistic" as their
+ *    license tag for a long time.  GPL+ was allowed but Artistic was
+ *    not.  Groups that match are removed from the tag so the third
+ *    phase only deals with whatever is left over.
+ * 3) Check each remaining license term individually.
+ *
+ * Verdicts are cached by License tag string.
  */
-static string_list_t *get_paren_expressions(const char *license)
+static struct license_verdict *get_license_verdict(const char *license)
 {
-    char *start = NULL;
-    char *end = NULL;
-    char *copy = NULL;
-    string_list_t *list = NULL;
+    char *tmp = NULL;
+    char *wlicense = NULL;
+    char *nlicense = NULL;
     string_entry_t *entry = NULL;
+    string_list_t *seen = NULL;
+    struct license_expr *expr = NULL;
+    struct license_verdict *verdict = NULL;
 
     assert(license != NULL);
 
-    start = copy = strdup(license);
-    assert(start != NULL);
+    HASH_FIND_STR(verdicts, license, verdict);
 
-    /* do not use our wrappers for strchr() here because we need NULL */
-    while ((start = strchr(start, '(')) != NULL) {
-        while (*start == '(') {
-            start++;
-        }
+    if (verdict) {
+        return verdict;
+    }
 
-        end = strchr(start, ')');
+    verdict = xalloc(sizeof(*verdict));
+    verdict->license = strdup(license);
+    assert(verdict->license != NULL);
+    HASH_ADD_KEYPTR(hh, verdicts, verdict->license, strlen(verdict->license), verdict);
 
-        if (end == NULL) {
-            break;
+    /* parse the tag and check for matching parens */
+    expr = parse_license_expression(license);
+    verdict->balanced = expr->balanced;
+
+    if (!verdict->balanced) {
+        free_license_expression(expr);
+        return verdict;
+    }
+
+    /* first, try to match the entire string */
+    if (check_license_abbrev(verdict, license)) {
+        verdict->whole = true;
+        free_license_expression(expr);
+        return verdict;
+    }
+
+    /* second, match and remove license expressions in parens */
+    wlicense = strdup(license);
+    assert(wlicense != NULL);
+
+    if (expr->groups) {
+        TAILQ_FOREACH(entry, expr->groups, items) {
+            if (check_license_abbrev(verdict, entry->data)) {
+                xasprintf(&tmp, "(%s)", entry->data);
+                assert(tmp != NULL);
+                nlicense = strreplace(wlicense, tmp, NULL);
+                free(tmp);
+                free(wlicense);
+                wlicense = nlicense;
+            }
         }
+    }
+
+    /* the terms left over if any groups were removed */
+    if (strcmp(wlicense, license)) {
+        free_license_expression(expr);
+        expr = parse_license_expression(wlicense);
+    }
 
-        if ((end - start) > 0) {
-            entry = xalloc(sizeof(*entry));
-            entry->data = xalloc(end - start + 1);
-            entry->data = strncpy(entry->data, start, end - start);
+    free(wlicense);
 
-            if (list == NULL) {
-                list = xalloc(sizeof(*list));
-                TAILQ_INIT(list);
+    /* third, check each remaining license term, once per term */
+    if (expr->terms) {
+        TAILQ_FOREACH(entry, expr->terms, items) {
+            if (list_contains(seen, entry->data)) {
+                continue;
             }
 
-            TAILQ_INSERT_TAIL(list, entry, items);
-        }
+            seen = list_add(seen, entry->data);
 
-        start = end;
+            if (!check_license_abbrev(verdict, entry->data)) {
+                verdict->unapproved = list_add(verdict->unapproved, entry->data);
+            }
+        }
     }
 
-    free(copy);
-    return list;
+    list_free(seen, free);
+
+    verdict->booleans = expr->booleans;
+    expr->booleans = NULL;
+    free_license_expression(expr);
+    return verdict;
 }
 
 /*
@@ -584,23 +893,16 @@ static string_list_t *get_paren_expressions(const char *license)
  *    match against the license database.
  * 4) The function returns true if all license tags are approved in the
  *    database.  Any single tag that is unapproved results in false.
+ *
+ * The work is done once per License tag string by get_license_verdict()
+ * and the findings are reported here for each package.
  */
 static bool is_valid_license(struct rpminspect *ri, struct result_params *params, const char *nevra, const char *license)
 {
     bool r = true;
-    int balance = 0;
-    size_t i = 0;
-    char *tmp = NULL;
-    char *wlicense = NULL;
-    char *nlicense = NULL;
-    string_map_t *tags = NULL;
-    string_map_t *tagtoken = NULL;
-    string_map_t *tmp_tagtoken = NULL;
     string_entry_t *entry = NULL;
-    string_list_t *parenexps = NULL;
-    string_entry_t *pentry = NULL;
-    parser_plugin *p = NULL;
-    parser_context *db = NULL;
+    struct license_verdict *verdict = NULL;
+    struct result_params kwparams;
 
     assert(ri != NULL);
     assert(params != NULL);
@@ -611,161 +913,60 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
     params->severity = RESULT_BAD;
     params->remedy = REMEDY_UNAPPROVED_LICENSE;
 
-    /* check for matching parens */
-    for (i = 0; i < strlen(license); i++) {
-        if (balance < 0) {
-            return false;
-        }
-
-        if (license[i] == '(') {
-            balance++;
-            continue;
-        }
-
-        if (license[i] == ')') {
-            balance--;
+    verdict = get_license_verdict(license);
+
+    /* report forbidden capitalization of SPDX keywords */
+    if (verdict->keywords) {
+        TAILQ_FOREACH(entry, verdict->keywords, items) {
+            init_result_params(&kwparams);
+            xasprintf(&kwparams.msg, _("An invalid SPDX keyword was found.  The keyword '%s' must always be written in all lowercase or all uppercase (not mixed case)."), entry->data);
+            kwparams.header = NAME_LICENSE;
+            kwparams.severity = RESULT_BAD;
+            kwparams.remedy = REMEDY_INVALID_BOOLEAN;
+            kwparams.verb = VERB_FAILED;
+            kwparams.noun = _("invalid SPDX expression keyword");
+            add_result(ri, &kwparams);
+            free(kwparams.msg);
         }
     }
 
-    if (balance != 0) {
+    if (!verdict->balanced) {
         return false;
     }
 
-    wlicense = strdup(license);
-    assert(wlicense != NULL);
-
-    /*
-     * loop over each license database and try to validate all license
-     * tags, but there are 3 distinct phases because everything has to
-     * be complicated
-     */
-
-    /*
-     * first, loop over each db trying to match the entire tag.  this
-     * is the common case.
-     */
-    TAILQ_FOREACH(entry, ri->licensedb, items) {
-        /* read in this license database */
-        p = read_licensedb(ri, entry->data, &db);
-
-        if (p == NULL) {
-            continue;
-        }
-
-        /* first, try to match the entire string */
-        if (check_license_abbrev(ri, p, db, wlicense)) {
-            p->fini(db);
-            free(wlicense);
-            return true;
-        }
-
-        /* close this db */
-        p->fini(db);
-    }
-
-    /*
-     * second, try to match license substring tokens in parens (this
-     * is because of past bad policy decisions).  if any match, remove
-     * them from the whole license tag.  the reason for this is we
-     * only want the third phase to deal with whatever is leftoveer
-     * from this phase.
-     */
-    TAILQ_FOREACH(entry, ri->licensedb, items) {
-        /* read in this license database */
-        p = read_licensedb(ri, entry->data, &db);
-
-        if (p == NULL) {
-            continue;
-        }
-
-        parenexps = get_paren_expressions(wlicense);
-
-        if (parenexps && !TAILQ_EMPTY(parenexps)) {
-            TAILQ_FOREACH(pentry, parenexps, items) {
-                if (check_license_abbrev(ri, p, db, pentry->data)) {
-                    xasprintf(&tmp, "(%s)", pentry->data);
-                    assert(tmp != NULL);
-                    nlicense = strreplace(wlicense, tmp, NULL);
-                    free(tmp);
-                    free(wlicense);
-                    wlicense = nlicense;
-                }
-            }
-
-            list_free(parenexps, free);
-        }
-
-        /* close this db */
-        p->fini(db);
-    }
-
-    /*
-     * third, check each remaining token not caught in the second
-     * step.  this is individual tag checking for whole compound
-     * expressions.
-     */
-    tags = tokenize_license_tag(wlicense);
-
-    if (tags) {
-        TAILQ_FOREACH(pentry, ri->licensedb, items) {
-            /* read in this license database */
-            p = read_licensedb(ri, pentry->data, &db);
-
-            if (p == NULL) {
-                continue;
-            }
-
-            HASH_ITER(hh, tags, tagtoken, tmp_tagtoken) {
-                if (tagtoken->value == tagtoken->key) {
-                    /* already validated */
-                    continue;
-                }
-
-                if (check_license_abbrev(ri, p, db, tagtoken->key)) {
-                    /* set the value to non-NULL so we know it passed (DO NOT FREE) */
-                    tagtoken->value = tagtoken->key;
-                }
-            }
-
-            /* close this db */
-            p->fini(db);
-        }
+    if (verdict->whole) {
+        return true;
     }
 
     /* report unapproved license tag tokens */
-    if (tags) {
-        HASH_ITER(hh, tags, tagtoken, tmp_tagtoken) {
-            if (tagtoken->value == NULL) {
-                r = false;
+    if (verdict->unapproved) {
+        TAILQ_FOREACH(entry, verdict->unapproved, items) {
+            r = false;
 
-                if (ri->results == NULL) {
-                    ri->results = init_results();
-                }
+            if (ri->results == NULL) {
+                ri->results = init_results();
+            }
 
-                params->severity = RESULT_BAD;
-                params->remedy = REMEDY_UNAPPROVED_LICENSE;
-                xasprintf(&params->msg, _("Unapproved license in %s: %s"), nevra, tagtoken->key);
-                add_result(ri, params);
-                result = get_result(result, params->severity);
-                free(params->msg);
+            params->severity = RESULT_BAD;
+            params->remedy = REMEDY_UNAPPROVED_LICENSE;
+            xasprintf(&params->msg, _("Unapproved license in %s: %s"), nevra, entry->data);
+            add_result(ri, params);
+            result = get_result(result, params->severity);
+            free(params->msg);
 
-                /*
-                 * make sure to set the worst result based on queued
-                 * license inspection failures.
-                 */
-                if (params->severity > ri->worst_result) {
-                    ri->worst_result = params->severity;
-                }
+            /*
+             * make sure to set the worst result based on queued
+             * license inspection failures.
+             */
+            if (params->severity > ri->worst_result) {
+                ri->worst_result = params->severity;
             }
         }
     }
 
-    free_tags(tags);
-    free(wlicense);
-
     /* for SPDX tags found, ensure booleans are all uppercase or all lowercase */
-    if (nlegacy == 0 && ndual == 0 && nspdx > 0 && (booleans && !TAILQ_EMPTY(booleans))) {
-        TAILQ_FOREACH(entry, booleans, items) {
+    if (verdict->nlegacy == 0 && verdict->ndual == 0 && verdict->nspdx > 0 && (verdict->booleans && !TAILQ_EMPTY(verdict->booleans))) {
+        TAILQ_FOREACH(entry, verdict->booleans, items) {
             if ((!strcasecmp(entry->data, "AND") && strcmp(entry->data, "and") && strcmp(entry->data, "AND"))
                 || (!strcasecmp(entry->data, "OR") && strcmp(entry->data, "or") && strcmp(entry->data, "OR"))
                 || (!strcasecmp(entry->data, "WITH") && strcmp(entry->data, "with") && strcmp(entry->data, "WITH"))) {
@@ -785,7 +986,7 @@ static bool is_valid_license(struct rpminspect *ri, struct result_params *params
     }
 
     /* mixed SPDX and legacy tags are forbidden */
-    if (nlegacy > 0 && nspdx > 0 && ndual == 0) {
+    if (verdict->nlegacy > 0 && verdict->nspdx > 0 && verdict->ndual == 0) {
         params->severity = RESULT_BAD;
         params->remedy = REMEDY_MIXED_LICENSE_TAGS;
         xasprintf(&params->msg, _("Mixed SPDX and legacy license identifiers found in %s."), nevra);
@@ -862,14 +1063,6 @@ static int check_peer_license(struct rpminspect *ri, struct result_params *param
     }
 
     free(nevra);
-    list_free(booleans, free);
-    booleans = NULL;
-
-    /* reset the abbreviation counters for the next package */
-    nlegacy = 0;
-    ndual = 0;
-    nspdx = 0;
-
     return ret;
 }
 
@@ -888,9 +1081,6 @@ bool inspect_license(struct rpminspect *ri)
     int good = 0;
     int seen = 0;
     rpmpeer_entry_t *peer = NULL;
-    parser_plugin *p = NULL;
-    parser_context *db = NULL;
-    string_entry_t *entry = NULL;
     struct result_params params;
 
     assert(ri != NULL);
@@ -927,20 +1117,11 @@ bool inspect_license(struct rpminspect *ri)
         }
     }
 
-    /* Gather all of the dual SPDX/legacy license expressions */
-    TAILQ_FOREACH(entry, ri->licensedb, items) {
-        /* read in this license database */
-        p = read_licensedb(ri, entry->data, &db);
-
-        if (p == NULL) {
-            continue;
-        }
-
-        gather_dual_licenses(ri, p, db);
-
-        /* close this db */
-        p->fini(db);
-    }
+    /*
+     * Load the license databases and gather all of the dual
+     * SPDX/legacy license expressions
+     */
+    load_license_indexes(ri);
 
     /*
      * The license test just looks at the licenses on the after build
@@ -967,6 +1148,9 @@ bool inspect_license(struct rpminspect *ri)
         result = get_result(result, params.severity);
     }
 
+    free_license_verdicts();
+    free_license_indexes();
     list_free(dual, free);
+    dual = NULL;
     return result;
 }
@@ -98,6 +98,7 @@ static bool lto_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     bool result = true;
     Elf *elf = NULL;
     int fd = -1;
+    const elf_facts_t *facts = NULL;
     string_list_t *names = NULL;
     string_entry_t *entry = NULL;
     string_entry_t *prefix = NULL;
@@ -152,9 +153,9 @@ static bool lto_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             free(badsyms);
             result = false;
         }
-    } else if (((elf = get_elf(file, &fd)) != NULL) && (get_elf_type(elf) == ET_REL)) {
+    } else if (((facts = get_elf_facts(file)) != NULL) && (facts->type == ET_REL)) {
         /* we found an ELF relocatable */
-        names = get_elf_section_names(elf, SHT_SYMTAB);
+        names = get_elf_facts_section_names(facts, SHT_SYMTAB);
 
         if (names != NULL) {
             TAILQ_FOREACH(entry, names, items) {
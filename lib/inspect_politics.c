@@ -5,32 +5,26 @@
 
 #include <stdbool.h>
 #include <assert.h>
-#include <fnmatch.h>
-#include <err.h>
-#include <openssl/md5.h>
-#include <openssl/sha.h>
+#include <string.h>
 #include "rpminspect.h"
 
 static bool politics_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
     bool result = true;
     politics_entry_t *pentry = NULL;
-    int type = 0;
-    char *digest = NULL;
+    unsigned int types = 0;
+    const char *digest = NULL;
     bool matched = false;
     bool allowed = false;
-    int flags = FNM_PERIOD;
+    size_t i = 0;
+    size_t n = 0;
+    void **matches = NULL;
     const char *name = NULL;
     struct result_params params;
 
     assert(ri != NULL);
     assert(file != NULL);
 
-#ifdef FNM_EXTMATCH
-    /* glibc provides this extended pattern matching syntax */
-    flags |= FNM_EXTMATCH;
-#endif
-
     /* special files and directories can be skipped */
     if (S_ISDIR(file->st_mode) ||
         S_ISCHR(file->st_mode) ||
@@ -40,76 +34,57 @@ static bool politics_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
+    /* the rules matching this file, in the order of the politics file */
+    n = rule_index_find_all(ri->politics_index, file->localpath, &matches);
+
     /* first pass handles the wildcard entries and sees if we have a match */
-    TAILQ_FOREACH(pentry, ri->politics, items) {
-        /* malformatted lines */
-        if (pentry->pattern == NULL || pentry->digest == NULL) {
-            warnx(_("*** invalid politics entry with pattern=%s and digest=%s"), pentry->pattern, pentry->digest);
-            continue;
-        }
+    for (i = 0; i < n; i++) {
+        pentry = matches[i];
 
         /* if we are not looking at a wildcard line, skip */
-        if (strcmp(pentry->digest, "*")) {
+        if (pentry->type != NULLSUM) {
             continue;
         }
 
         /* the last entry in the file will take effect here */
-        if (!fnmatch(pentry->pattern, file->localpath, flags)) {
-            matched = true;
-            allowed = pentry->allowed;
+        matched = true;
+        allowed = pentry->allowed;
+    }
+
+    /* compute every digest type the matching entries use in one read */
+    for (i = 0; i < n; i++) {
+        pentry = matches[i];
+
+        if (pentry->type != NULLSUM) {
+            types |= CHECKSUM_BIT(pentry->type);
         }
     }
 
+    if (types) {
+        /* failures leave the digest NULL and are reported already */
+        (void) get_checksums(file, types);
+    }
+
     /* look for entries */
-    TAILQ_FOREACH(pentry, ri->politics, items) {
-        /* malformatted lines */
-        if (pentry->pattern == NULL || pentry->digest == NULL) {
-            warnx(_("*** invalid politics entry with pattern=%s and digest=%s"), pentry->pattern, pentry->digest);
-            continue;
-        }
+    for (i = 0; i < n; i++) {
+        pentry = matches[i];
 
         /* if we are looking at a wildcard line, skip */
-        if (!strcmp(pentry->digest, "*")) {
+        if (pentry->type == NULLSUM) {
             continue;
         }
 
         /* the last entry in the file will take effect here */
-        if (!fnmatch(pentry->pattern, file->localpath, flags)) {
-            /* get the type of digest string */
-            if (strlen(pentry->digest) == (MD5_DIGEST_LENGTH * 2)) {
-                type = MD5SUM;
-            } else if (strlen(pentry->digest) == (SHA_DIGEST_LENGTH * 2)) {
-                type = SHA1SUM;
-            } else if (strlen(pentry->digest) == (SHA224_DIGEST_LENGTH * 2)) {
-                type = SHA224SUM;
-            } else if (strlen(pentry->digest) == (SHA256_DIGEST_LENGTH * 2)) {
-                type = SHA256SUM;
-            } else if (strlen(pentry->digest) == (SHA384_DIGEST_LENGTH * 2)) {
-                type = SHA384SUM;
-            } else if (strlen(pentry->digest) == (SHA512_DIGEST_LENGTH * 2)) {
-                type = SHA512SUM;
-            } else {
-                warnx(_("*** unknown digest type for pattern %s: %s"), pentry->pattern, pentry->digest);
-                continue;
-            }
-
-            /* get the digest */
-            if (type == DEFAULT_MESSAGE_DIGEST && !strcmp(pentry->digest, checksum(file))) {
-                matched = true;
-                allowed = pentry->allowed;
-            } else {
-                digest = compute_checksum(file->fullpath, &file->st_mode, type);
-
-                if (!strcmp(pentry->digest, digest)) {
-                    matched = true;
-                    allowed = pentry->allowed;
-                }
-
-                free(digest);
-            }
+        digest = file->checksums[pentry->type];
+
+        if (digest && !strcmp(pentry->digest, digest)) {
+            matched = true;
+            allowed = pentry->allowed;
         }
     }
 
+    free(matches);
+
     /* report */
     if (matched) {
         /* use the package name for reporting */
@@ -19,31 +19,119 @@ static char *pkg_evr = NULL;
 static char *pkg_vr = NULL;
 static uint64_t pkg_epoch = 0;
 
+/* %{_isa} substring pattern, see remove_isa_substring() */
+static regex_t isa_re;
+static bool have_isa_re = false;
+
 /*
- * Given a package name, return true if this is a valid subpackage in
- * the current build.
+ * The after build subpackages sharing a lookup key, in the order
+ * they appear in the peer list.
+ */
+struct peer_key {
+    char *key;
+    rpmpeer_entry_t **peers;
+    const deprule_entry_t **deprules;  /* peers_by_requires only */
+    size_t *order;                     /* peers_by_requires only */
+    size_t num;
+    UT_hash_handle hh;
+};
+
+/*
+ * Built once per run by build_peer_index() so the explicit dependency
+ * checks can look up subpackages rather than walk every deprule of
+ * every peer for each Requires.  Subpackages are indexed by name, by
+ * each Provides with any %{_isa} substring removed, and by each
+ * Requires (listed once per Requires carried).
  */
-static bool is_subpackage(rpmpeer_t *peers, const char *package)
+static struct peer_key *peers_by_name = NULL;
+static struct peer_key *peers_by_provides = NULL;
+static struct peer_key *peers_by_requires = NULL;
+
+/* Add a subpackage to a lookup table under the given key */
+static void add_peer_key(struct peer_key **table, const char *key, rpmpeer_entry_t *peer, const bool unique)
 {
-    rpmpeer_entry_t *peer = NULL;
-    const char *name = NULL;
+    struct peer_key *k = NULL;
+
+    assert(table != NULL);
+    assert(key != NULL);
+    assert(peer != NULL);
+
+    HASH_FIND_STR(*table, key, k);
+
+    if (k == NULL) {
+        k = xalloc(sizeof(*k));
+        k->key = strdup(key);
+        assert(k->key != NULL);
+        HASH_ADD_KEYPTR(hh, *table, k->key, strlen(k->key), k);
+    } else if (unique && k->num > 0 && k->peers[k->num - 1] == peer) {
+        /* listed twice in the same subpackage */
+        return;
+    }
 
-    assert(peers != NULL);
-    assert(package != NULL);
+    k->peers = xrealloc(k->peers, (k->num + 1) * sizeof(*k->peers));
+    k->peers[k->num++] = peer;
+    return;
+}
 
-    TAILQ_FOREACH(peer, peers, items) {
-        name = headerGetString(peer->after_hdr, RPMTAG_NAME);
+/* Return the subpackages listed under key in a lookup table, or NULL */
+static struct peer_key *find_peer_key(struct peer_key *table, const char *key)
+{
+    struct peer_key *k = NULL;
 
-        if (name == NULL) {
-            continue;
-        }
+    if (key == NULL) {
+        return NULL;
+    }
 
-        if (!strcmp(name, package)) {
-            return true;
-        }
+    HASH_FIND_STR(table, key, k);
+    return k;
+}
+
+/*
+ * Add a Requires to peers_by_requires.  order is the position of the
+ * deprule in a walk over every deprule of every peer, so lookups can
+ * report in the same order as that walk.
+ */
+static void add_requires_key(const deprule_entry_t *deprule, rpmpeer_entry_t *peer, const size_t order)
+{
+    struct peer_key *k = NULL;
+
+    add_peer_key(&peers_by_requires, deprule->requirement, peer, false);
+    k = find_peer_key(peers_by_requires, deprule->requirement);
+    assert(k != NULL);
+
+    k->deprules = xrealloc(k->deprules, k->num * sizeof(*k->deprules));
+    k->deprules[k->num - 1] = deprule;
+    k->order = xrealloc(k->order, k->num * sizeof(*k->order));
+    k->order[k->num - 1] = order;
+    return;
+}
+
+static void free_peer_keys(struct peer_key **table)
+{
+    struct peer_key *k = NULL;
+    struct peer_key *tmp_k = NULL;
+
+    HASH_ITER(hh, *table, k, tmp_k) {
+        HASH_DEL(*table, k);
+        free(k->key);
+        free(k->peers);
+        free(k->deprules);
+        free(k->order);
+        free(k);
     }
 
-    return false;
+    *table = NULL;
+    return;
+}
+
+/*
+ * Given a package name, return true if this is a valid subpackage in
+ * the current build.
+ */
+static bool is_subpackage(const char *package)
+{
+    assert(package != NULL);
+    return find_peer_key(peers_by_name, package) != NULL;
 }
 
 /*
@@ -63,7 +151,6 @@ static char *remove_isa_substring(char *requirement)
     char *r = NULL;
     char *tmp = NULL;
     char *s = requirement;
-    regex_t re;
     regmatch_t pmatch[1];
     size_t nmatch = sizeof(pmatch) / sizeof(pmatch[0]);
 
@@ -72,15 +159,19 @@ static char *remove_isa_substring(char *requirement)
         return NULL;
     }
 
-    /* isa substring regex pattern */
-    if (regcomp(&re, "\\([a-zA-Z0-9]+-(32|64)\\)", REG_EXTENDED | REG_NEWLINE) != 0) {
-        warn("*** regcomp");
-        r = strdup(requirement);
-        return r;
+    /* isa substring regex pattern, compiled once per run */
+    if (!have_isa_re) {
+        if (regcomp(&isa_re, "\\([a-zA-Z0-9]+-(32|64)\\)", REG_EXTENDED | REG_NEWLINE) != 0) {
+            warn("*** regcomp");
+            r = strdup(requirement);
+            return r;
+        }
+
+        have_isa_re = true;
     }
 
     /* scan the requirement string and remove all isa substrings */
-    while (regexec(&re, s, nmatch, pmatch, 0) != REG_NOMATCH) {
+    while (regexec(&isa_re, s, nmatch, pmatch, 0) != REG_NOMATCH) {
         if (r) {
             tmp = strreplace(r, s + pmatch[0].rm_so, NULL);
             assert(tmp != NULL);
@@ -98,12 +189,56 @@ static char *remove_isa_substring(char *requirement)
         r = strdup(requirement);
     }
 
-    /* clean up */
-    regfree(&re);
-
     return r;
 }
 
+/*
+ * Fill in the subpackage lookup tables from the after build peers.
+ * Called once the deprules have been gathered.
+ */
+static void build_peer_index(rpmpeer_t *peers)
+{
+    rpmpeer_entry_t *peer = NULL;
+    deprule_entry_t *deprule = NULL;
+    const char *name = NULL;
+    char *isaprov = NULL;
+    size_t order = 0;
+
+    assert(peers != NULL);
+
+    TAILQ_FOREACH(peer, peers, items) {
+        if (peer->after_hdr == NULL) {
+            continue;
+        }
+
+        name = headerGetString(peer->after_hdr, RPMTAG_NAME);
+
+        if (name) {
+            add_peer_key(&peers_by_name, name, peer, true);
+        }
+
+        if (peer->after_deprules == NULL) {
+            continue;
+        }
+
+        TAILQ_FOREACH(deprule, peer->after_deprules, items) {
+            order++;
+
+            if (deprule->type == TYPE_PROVIDES) {
+                /* trim the '(x86-64)' or similar ISA substring for comparison purposes */
+                isaprov = remove_isa_substring(deprule->requirement);
+                assert(isaprov != NULL);
+                add_peer_key(&peers_by_provides, isaprov, peer, true);
+                free(isaprov);
+            } else if (deprule->type == TYPE_REQUIRES) {
+                add_requires_key(deprule, peer, order);
+            }
+        }
+    }
+
+    return;
+}
+
 /*
  * Scan all dependencies and look for version values containing
  * unexpanded macros.  Anything found is reported as a failure.
@@ -172,19 +307,43 @@ static bool have_unexpanded_macros(struct rpminspect *ri, const char *name, cons
     return result;
 }
 
+/* Helpers for get_explicit_requires() */
+struct explicit_require {
+    size_t order;
+    size_t provider;
+    const char *requirement;
+};
+
+static int cmp_explicit_requires(const void *a, const void *b)
+{
+    const struct explicit_require *x = a;
+    const struct explicit_require *y = b;
+
+    if (x->order != y->order) {
+        return (x->order < y->order) ? -1 : 1;
+    }
+
+    if (x->provider != y->provider) {
+        return (x->provider < y->provider) ? -1 : 1;
+    }
+
+    return 0;
+}
+
 /*
  * Given a list of multiple providers of a dynamic provides, check for
  * explicit requires and return a list of them.
  */
-static string_list_t *get_explicit_requires(struct rpminspect *ri, const deprule_entry_t *dep)
+static string_list_t *get_explicit_requires(const deprule_entry_t *dep)
 {
     string_list_t *requires = NULL;
     string_entry_t *entry = NULL;
-    deprule_entry_t *req = NULL;
-    rpmpeer_entry_t *peer = NULL;
+    struct peer_key *k = NULL;
+    struct explicit_require *found = NULL;
+    size_t nfound = 0;
+    size_t nprov = 0;
+    size_t i = 0;
 
-    assert(ri != NULL);
-    assert(ri->peers != NULL);
     assert(dep != NULL);
 
     if (dep->providers == NULL || TAILQ_EMPTY(dep->providers)) {
@@ -199,27 +358,36 @@ static string_list_t *get_explicit_requires(struct rpminspect *ri, const deprule
      * given a list of providers, check for any Requires on any other
      * packages for those providers
      */
-    TAILQ_FOREACH(peer, ri->peers, items) {
-        /* skip anything with no dependencies */
-        if (peer->after_deprules == NULL || TAILQ_EMPTY(peer->after_deprules)) {
-            continue;
-        }
+    TAILQ_FOREACH(entry, dep->providers, items) {
+        k = find_peer_key(peers_by_requires, entry->data);
 
-        /* check for explicit Requires of multiple providers */
-        TAILQ_FOREACH(req, peer->after_deprules, items) {
-            /* skip the deprule we were called with or non-Requires */
-            if (req == dep || req->type != TYPE_REQUIRES) {
-                continue;
-            }
-
-            TAILQ_FOREACH(entry, dep->providers, items) {
-                if (!strcmp(entry->data, req->requirement)) {
-                    requires = list_add(requires, entry->data);
+        if (k != NULL) {
+            for (i = 0; i < k->num; i++) {
+                /* skip the deprule we were called with */
+                if (k->deprules[i] == dep) {
+                    continue;
                 }
+
+                found = xrealloc(found, (nfound + 1) * sizeof(*found));
+                found[nfound].order = k->order[i];
+                found[nfound].provider = nprov;
+                found[nfound++].requirement = entry->data;
             }
         }
+
+        nprov++;
     }
 
+    /* list them in peer and deprule order */
+    if (nfound > 1) {
+        qsort(found, nfound, sizeof(*found), cmp_explicit_requires);
+    }
+
+    for (i = 0; i < nfound; i++) {
+        requires = list_add(requires, found[i].requirement);
+    }
+
+    free(found);
     return requires;
 }
 
@@ -240,9 +408,7 @@ static bool check_explicit_lib_deps(struct rpminspect *ri, Header h, deprule_lis
     rpmpeer_entry_t *potential_prov = NULL;
     deprule_entry_t *verify = NULL;
     deprule_entry_t *req = NULL;
-    deprule_entry_t *prov = NULL;
     char *isareq = NULL;
-    char *isaprov = NULL;
     string_list_t *explicit_requires = NULL;
     char *multiples = NULL;
     char *requires = NULL;
@@ -256,9 +422,11 @@ static bool check_explicit_lib_deps(struct rpminspect *ri, Header h, deprule_lis
     uint64_t epoch = 0;
     char *rulestr = NULL;
     bool found = false;
-    const char *tn = NULL;
     string_entry_t *entry = NULL;
     string_list_t *transitive = NULL;
+    struct peer_key *k = NULL;
+    size_t i = 0;
+    size_t j = 0;
     struct result_params params;
 
     assert(ri != NULL);
@@ -287,13 +455,21 @@ static bool check_explicit_lib_deps(struct rpminspect *ri, Header h, deprule_lis
         found = false;
         potential_prov = NULL;
 
-        /* we have a lib Requires, find what subpackage Provides it */
-        TAILQ_FOREACH(peer, ri->peers, items) {
-            /* skip anything with no dependencies */
-            if (peer->after_deprules == NULL || TAILQ_EMPTY(peer->after_deprules)) {
-                continue;
-            }
-
+        /*
+         * we have a lib Requires, find what subpackage Provides it
+         *
+         * we may have a dependency such as:
+         *     Requires: %{name}-libs%{?_isa} = %{version}-%{release}'
+         * so the '(x86-64)' or similar ISA substring is trimmed for
+         * comparison purposes, the same as the Provides in the index
+         */
+        isareq = remove_isa_substring(req->requirement);
+        assert(isareq != NULL);
+        k = find_peer_key(peers_by_provides, isareq);
+        free(isareq);
+
+        for (i = 0; k != NULL && i < k->num; i++) {
+            peer = k->peers[i];
             peer_srpm = headerGetString(peer->after_hdr, RPMTAG_SOURCERPM);
 
             /*
@@ -304,63 +480,20 @@ static bool check_explicit_lib_deps(struct rpminspect *ri, Header h, deprule_lis
                 continue;
             }
 
-            /* check this peer's Provides */
-            TAILQ_FOREACH(prov, peer->after_deprules, items) {
-                /* skip the entry we're trying to match against */
-                if (req == prov) {
-                    continue;
-                }
-
-                /* only looking at Provides right now */
-                if ((prov->type != TYPE_PROVIDES)
-                    || !(strprefix(req->requirement, SHARED_LIB_PREFIX) && strstr(req->requirement, SHARED_LIB_SUFFIX))) {
-                    continue;
-                }
-
-                pn = headerGetString(peer->after_hdr, RPMTAG_NAME);
-
-                /* check that the Requires is explicit and matches the Provides */
-                if (!strcmp(req->requirement, prov->requirement)) {
-                    /* a package is allowed to to Provide and Require the same thing */
-                    /* otherwise we found the subpackage that Provides this explicit Requires */
-                    potential_prov = peer;
-
-                    if (!list_contains(req->providers, pn)) {
-                        req->providers = list_add(req->providers, pn);
-                    }
+            /* a package is allowed to to Provide and Require the same thing */
+            /* otherwise we found the subpackage that Provides this explicit Requires */
+            pn = headerGetString(peer->after_hdr, RPMTAG_NAME);
+            potential_prov = peer;
 
-                    found = true;
-                } else if (xstrrchr(req->requirement, '(') || xstrrchr(prov->requirement, '(')) {
-                    /*
-                     * we may have a dependency such as:
-                     *     Requires: %{name}-libs%{?_isa} = %{version}-%{release}'
-                     * trim the '(x86-64)' or similar ISA substring for comparison purposes
-                     * also trim leading '(' to account for rich deps
-                     */
-                    isareq = remove_isa_substring(req->requirement);
-                    assert(isareq != NULL);
-
-                    isaprov = remove_isa_substring(prov->requirement);
-                    assert(isaprov != NULL);
-
-                    if (!strcmp(isareq, isaprov)) {
-                        potential_prov = peer;
-
-                        if (!list_contains(req->providers, pn)) {
-                            req->providers = list_add(req->providers, pn);
-                        }
-
-                        found = true;
-                    }
-
-                    free(isareq);
-                    free(isaprov);
-                }
+            if (!list_contains(req->providers, pn)) {
+                req->providers = list_add(req->providers, pn);
             }
+
+            found = true;
         }
 
         /* all of the explicit Requires for this req */
-        explicit_requires = get_explicit_requires(ri, req);
+        explicit_requires = get_explicit_requires(req);
 
         /* now look for the explicit Requires of potential_prov */
         if (list_len(req->providers) == 1 && list_len(explicit_requires) == 0) {
@@ -421,7 +554,7 @@ static bool check_explicit_lib_deps(struct rpminspect *ri, Header h, deprule_lis
                             isareq = remove_isa_substring(verify->requirement);
                             assert(isareq != NULL);
 
-                            if (is_subpackage(ri->peers, isareq) && !list_contains(transitive, isareq)) {
+                            if (is_subpackage(isareq) && !list_contains(transitive, isareq)) {
                                 transitive = list_add(transitive, isareq);
                             }
 
@@ -439,10 +572,12 @@ static bool check_explicit_lib_deps(struct rpminspect *ri, Header h, deprule_lis
                      */
                     if (transitive && !TAILQ_EMPTY(transitive)) {
                         TAILQ_FOREACH(entry, transitive, items) {
-                            TAILQ_FOREACH(peer, ri->peers, items) {
-                                tn = headerGetString(peer->after_hdr, RPMTAG_NAME);
+                            k = find_peer_key(peers_by_name, entry->data);
 
-                                if (tn == NULL || strcmp(entry->data, tn)) {
+                            for (j = 0; k != NULL && j < k->num; j++) {
+                                peer = k->peers[j];
+
+                                if (peer->after_deprules == NULL) {
                                     continue;
                                 }
 
@@ -453,7 +588,7 @@ static bool check_explicit_lib_deps(struct rpminspect *ri, Header h, deprule_lis
                                         isareq = remove_isa_substring(verify->requirement);
                                         assert(isareq != NULL);
 
-                                        if (is_subpackage(ri->peers, isareq) && !list_contains(transitive, isareq)) {
+                                        if (is_subpackage(isareq) && !list_contains(transitive, isareq)) {
                                             transitive = list_add(transitive, isareq);
                                         }
 
@@ -475,10 +610,12 @@ static bool check_explicit_lib_deps(struct rpminspect *ri, Header h, deprule_lis
 
                     /* See if the reverse transitive is present. */
                     if (!found && !list_contains(transitive, pn)) {
-                        TAILQ_FOREACH(peer, ri->peers, items) {
-                            tn = headerGetString(peer->after_hdr, RPMTAG_NAME);
+                        k = find_peer_key(peers_by_name, pn);
+
+                        for (j = 0; k != NULL && j < k->num; j++) {
+                            peer = k->peers[j];
 
-                            if (tn == NULL || strcmp(tn, pn)) {
+                            if (peer->after_deprules == NULL) {
                                 continue;
                             }
 
@@ -587,6 +724,8 @@ static bool check_explicit_epoch(struct rpminspect *ri, Header h, deprule_list_t
     char *drs = NULL;
     char *noun = NULL;
     rpmpeer_entry_t *peer = NULL;
+    struct peer_key *k = NULL;
+    size_t i = 0;
     struct result_params params;
 
     assert(ri != NULL);
@@ -623,19 +762,11 @@ static bool check_explicit_epoch(struct rpminspect *ri, Header h, deprule_list_t
         }
 
         /* find the package providing this deprule */
-        TAILQ_FOREACH(peer, ri->peers, items) {
-            if (!peer->after_hdr) {
-                continue;
-            }
-
-            name = headerGetString(peer->after_hdr, RPMTAG_NAME);
-            assert(name != NULL);
-
-            if (strcmp(deprule->requirement, name)) {
-                /* not found */
-                continue;
-            }
+        k = find_peer_key(peers_by_name, deprule->requirement);
 
+        for (i = 0; k != NULL && i < k->num; i++) {
+            peer = k->peers[i];
+            name = k->key;
             epoch = headerGetNumber(peer->after_hdr, RPMTAG_EPOCH);
 
             /* check the deprule to see that it carries the required Epoch */
@@ -667,7 +798,7 @@ static bool check_explicit_epoch(struct rpminspect *ri, Header h, deprule_list_t
 /*
  * Check if the deprule change is expected (e.g., automatic Provides).
  */
-static bool expected_deprule_change(const bool rebase, const deprule_entry_t *deprule, const Header h, const rpmpeer_t *peers)
+static bool expected_deprule_change(const bool rebase, const deprule_entry_t *deprule, const Header h)
 {
     bool r = false;
     bool config = false;
@@ -679,7 +810,8 @@ static bool expected_deprule_change(const bool rebase, const deprule_entry_t *de
     char *buf = NULL;
     char *suffix = NULL;
     rpmpeer_entry_t *peer = NULL;
-    const char *name = NULL;
+    struct peer_key *k = NULL;
+    size_t i = 0;
     const char *arch = NULL;
     const char *peerarch = NULL;
     const char *version = NULL;
@@ -735,22 +867,20 @@ static bool expected_deprule_change(const bool rebase, const deprule_entry_t *de
     }
 
     /* see if this deprule requirement name matches a subpackage */
-    TAILQ_FOREACH(peer, peers, items) {
-        /* no after peer, ignore */
-        if (peer->after_hdr == NULL) {
-            continue;
-        }
+    k = find_peer_key(peers_by_name, working_req);
+
+    for (i = 0; k != NULL && i < k->num; i++) {
+        peer = k->peers[i];
 
         /* skip source */
         if (headerIsSource(peer->after_hdr)) {
             continue;
         }
 
-        /* match the arch and name */
+        /* match the arch */
         peerarch = get_rpm_header_arch(peer->after_hdr);
-        name = headerGetString(peer->after_hdr, RPMTAG_NAME);
 
-        if (!strcmp(arch, peerarch) && !strcmp(name, working_req)) {
+        if (!strcmp(arch, peerarch)) {
             /* we found the subpackage, which is now 'peer' for code below */
             found = true;
             working_hdr = peer->after_hdr;
@@ -950,6 +1080,9 @@ bool inspect_rpmdeps(struct rpminspect *ri)
         }
     }
 
+    /* the subpackage lookups used below */
+    build_peer_index(ri->peers);
+
     /*
      * the second pass performs more complex checks
      */
@@ -989,13 +1122,13 @@ bool inspect_rpmdeps(struct rpminspect *ri)
                     /* determine what to report */
                     if (drs && pdrs == NULL) {
                         if (!strcmp(arch, SRPM_ARCH_NAME)) {
-                            if (expected_deprule_change(rebase, deprule, peer->after_hdr, ri->peers)) {
+                            if (expected_deprule_change(rebase, deprule, peer->after_hdr)) {
                                 xasprintf(&params.msg, _("Gained '%s' in source package %s; this is expected"), drs, name);
                             } else {
                                 xasprintf(&params.msg, _("Gained '%s' in source package %s"), drs, name);
                             }
                         } else {
-                            if (expected_deprule_change(rebase, deprule, peer->after_hdr, ri->peers)) {
+                            if (expected_deprule_change(rebase, deprule, peer->after_hdr)) {
                                 xasprintf(&params.msg, _("Gained '%s' in subpackage %s on %s; this is expected"), drs, name, arch);
                             } else {
                                 xasprintf(&params.msg, _("Gained '%s' in subpackage %s on %s"), drs, name, arch);
@@ -1007,13 +1140,13 @@ bool inspect_rpmdeps(struct rpminspect *ri)
                         params.verb = VERB_ADDED;
                     } else if (deprules_match(deprule, deprule->peer_deprule)) {
                         if (!strcmp(arch, SRPM_ARCH_NAME)) {
-                            if (expected_deprule_change(rebase, deprule, peer->after_hdr, ri->peers)) {
+                            if (expected_deprule_change(rebase, deprule, peer->after_hdr)) {
                                 xasprintf(&params.msg, _("Retained '%s' in source package %s; this is expected"), drs, name);
                             } else {
                                 xasprintf(&params.msg, _("Retained '%s' in source package %s"), drs, name);
                             }
                         } else {
-                            if (expected_deprule_change(rebase, deprule, peer->after_hdr, ri->peers)) {
+                            if (expected_deprule_change(rebase, deprule, peer->after_hdr)) {
                                 xasprintf(&params.msg, _("Retained '%s' in subpackage %s on %s; this is expected"), drs, name, arch);
                             } else {
                                 xasprintf(&params.msg, _("Retained '%s' in subpackage %s on %s"), drs, name, arch);
@@ -1025,13 +1158,13 @@ bool inspect_rpmdeps(struct rpminspect *ri)
                         params.verb = VERB_OK;
                     } else {
                         if (!strcmp(arch, SRPM_ARCH_NAME)) {
-                            if (expected_deprule_change(rebase, deprule, peer->after_hdr, ri->peers)) {
+                            if (expected_deprule_change(rebase, deprule, peer->after_hdr)) {
                                 xasprintf(&params.msg, _("Changed '%s' to '%s' in source package %s; this is expected"), pdrs, drs, name);
                             } else {
                                 xasprintf(&params.msg, _("Changed '%s' to '%s' in source package %s"), pdrs, drs, name);
                             }
                         } else {
-                            if (expected_deprule_change(rebase, deprule, peer->after_hdr, ri->peers)) {
+                            if (expected_deprule_change(rebase, deprule, peer->after_hdr)) {
                                 xasprintf(&params.msg, _("Changed '%s' to '%s' in subpackage %s on %s; this is expected"), pdrs, drs, name, arch);
                             } else {
                                 xasprintf(&params.msg, _("Changed '%s' to '%s' in subpackage %s on %s"), pdrs, drs, name, arch);
@@ -1098,6 +1231,14 @@ bool inspect_rpmdeps(struct rpminspect *ri)
 
     free(pkg_vr);
     free(pkg_evr);
+    free_peer_keys(&peers_by_name);
+    free_peer_keys(&peers_by_provides);
+    free_peer_keys(&peers_by_requires);
+
+    if (have_isa_re) {
+        regfree(&isa_re);
+        have_isa_re = false;
+    }
 
     return result;
 }
@@ -13,27 +13,6 @@
 
 #include "rpminspect.h"
 
-static string_list_t *get_tag_list(Elf *elf, const Elf64_Sxword tag)
-{
-    GElf_Dyn *dyn = NULL;
-    size_t sz = 0;
-    GElf_Shdr shdr;
-    size_t i = 0;
-    string_list_t *result = NULL;
-
-    assert(elf != NULL);
-
-    if (get_dynamic_tags(elf, tag, &dyn, &sz, &shdr)) {
-        for (i = 0; i < sz; i++) {
-            result = list_add(result, elf_strptr(elf, shdr.sh_link, (size_t) (dyn[i].d_un.d_ptr)));
-        }
-
-        free(dyn);
-    }
-
-    return result;
-}
-
 /*
  * Given a working path, check to see if any packages in our build own
  * that path.  True if we find it, false otherwise.
@@ -205,9 +184,7 @@ static bool check_runpath(struct rpminspect *ri, const rpmfile_entry_t *file, co
 static bool runpath_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
     bool result = true;
-    int fd = -1;
-    Elf *elf = NULL;
-    GElf_Half type;
+    const elf_facts_t *elf = NULL;
     string_list_t *rpath = NULL;
     string_list_t *runpath = NULL;
     const char *arch = NULL;
@@ -232,22 +209,20 @@ static bool runpath_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
     /* If we lack dynamic or shared ELF files, we're done */
-    if ((elf = get_elf(file, &fd)) == NULL) {
+    if ((elf = get_elf_facts(file)) == NULL) {
         result = true;
         goto cleanup;
     }
 
-    type = get_elf_type(elf);
-
     /* From here on, we expect ET_EXEC or ET_DYN; ignore all other types */
-    if (type != ET_EXEC && type != ET_DYN) {
+    if (elf->type != ET_EXEC && elf->type != ET_DYN) {
         result = true;
         goto cleanup;
     }
 
     /* Gather any DT_RPATH and DT_RUNPATH entries */
-    rpath = get_tag_list(elf, DT_RPATH);
-    runpath = get_tag_list(elf, DT_RUNPATH);
+    rpath = get_elf_facts_tag_strings(elf, DT_RPATH);
+    runpath = get_elf_facts_tag_strings(elf, DT_RUNPATH);
 
     /* No entries to check, just return successfully */
     if ((rpath == NULL || TAILQ_EMPTY(rpath)) && (runpath == NULL || TAILQ_EMPTY(runpath))) {
@@ -288,11 +263,6 @@ static bool runpath_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
 cleanup:
-    if (elf && fd != -1) {
-        elf_end(elf);
-        close(fd);
-    }
-
     list_free(rpath, free);
     list_free(runpath, free);
 
@@ -11,6 +11,7 @@
 #include <assert.h>
 
 #include "rpminspect.h"
+#include "parallel.h"
 
 /*
  * Get the basename of the shell from the #! line of a script.
@@ -136,20 +137,33 @@ static char *get_shell(const struct rpminspect *ri, const char *fullpath)
     return shell;
 }
 
+/* A shell script queued by shellsyntax_driver() and its results */
+struct shellsyntax_job {
+    rpmfile_entry_t *file;
+    const char *arch;
+    char *shell;
+    char *before_shell;
+    cmd_result_t after;
+    cmd_result_t before;
+    cmd_result_t extglob;
+    bool run_extglob;
+    TAILQ_ENTRY(shellsyntax_job) items;
+};
+
+static TAILQ_HEAD(shellsyntax_jobs_s, shellsyntax_job) jobs;
+static cmdpool_t *pool = NULL;
+
+/*
+ * Find shell scripts and queue '-n' runs of the shell on them.  The
+ * results are reported by report_shellsyntax_job() once all of the
+ * commands have finished.
+ */
 static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
-    bool result = true;
-    const char *arch = NULL;
     const char *type = NULL;
     char *shell = NULL;
-    char *before_shell = NULL;
-    int exitcode = -1;
-    char *before_errors = NULL;
-    int before_exitcode = -1;
-    char *errors = NULL;
-    char *tmp = NULL;
-    bool extglob = false;
-    struct result_params params;
+    char *argv[] = { NULL, "-n", NULL, NULL };
+    struct shellsyntax_job *job = NULL;
 
     /* Ignore files in the SRPM */
     if (headerIsSource(file->rpm_header)) {
@@ -163,9 +177,6 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
-    /* We need the architecture for reporting */
-    arch = get_rpm_header_arch(file->rpm_header);
-
     /* Get the shell from the #! line */
     shell = get_shell(ri, file->fullpath);
 
@@ -175,6 +186,52 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
     DEBUG_PRINT("shell=|%s|\n", shell);
 
+    job = xalloc(sizeof(*job));
+    job->file = file;
+    job->shell = shell;
+
+    /* We need the architecture for reporting */
+    job->arch = get_rpm_header_arch(file->rpm_header);
+
+    /* Run with -n and capture results */
+    argv[0] = shell;
+    argv[2] = file->fullpath;
+    cmdpool_add(pool, ri->worksubdir, argv, cmdpool_store_result, &job->after);
+
+    if (file->peer_file) {
+        job->before_shell = get_shell(ri, file->peer_file->fullpath);
+        DEBUG_PRINT("before_shell=|%s|\n", job->before_shell);
+
+        if (job->before_shell) {
+            argv[0] = job->before_shell;
+            argv[2] = file->peer_file->fullpath;
+            cmdpool_add(pool, ri->worksubdir, argv, cmdpool_store_result, &job->before);
+        }
+    }
+
+    TAILQ_INSERT_TAIL(&jobs, job, items);
+    return true;
+}
+
+/*
+ * Report the results for one shell script.  Returns false if the
+ * script is not valid.
+ */
+static bool report_shellsyntax_job(struct rpminspect *ri, struct shellsyntax_job *job)
+{
+    bool result = true;
+    rpmfile_entry_t *file = job->file;
+    const char *arch = job->arch;
+    const char *shell = job->shell;
+    const char *before_shell = job->before_shell;
+    int exitcode = job->after.exitcode;
+    char *errors = job->after.output;
+    int before_exitcode = job->before.exitcode;
+    char *before_errors = job->before.output;
+    char *tmp = NULL;
+    bool extglob = false;
+    struct result_params params;
+
     /* Set up the result parameters */
     init_result_params(&params);
     params.header = NAME_SHELLSYNTAX;
@@ -182,9 +239,6 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.file = file->localpath;
 
     if (file->peer_file) {
-        before_shell = get_shell(ri, file->peer_file->fullpath);
-        DEBUG_PRINT("before_shell=|%s|\n", before_shell);
-
         if (!before_shell) {
             xasprintf(&params.msg, _("%s is a shell script but was not before on %s"), file->localpath, arch);
         } else if (strcmp(shell, before_shell)) {
@@ -202,12 +256,9 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
     }
 
-    /* Run with -n and capture results */
-    errors = run_cmd(&exitcode, ri->worksubdir, shell, "-n", file->fullpath, NULL);
     DEBUG_PRINT("exitcode=%d, errors=|%s|\n", exitcode, errors);
 
     if (before_shell) {
-        before_errors = run_cmd(&before_exitcode, ri->worksubdir, before_shell, "-n", file->peer_file->fullpath, NULL);
         DEBUG_PRINT("before_exitcode=%d, before_errors=|%s|\n", before_exitcode, before_errors);
 
         /* remove the working directory prefix */
@@ -217,9 +268,10 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
     /* Special check for GNU bash, try with extglob */
-    if (exitcode && !strcmp(shell, "bash")) {
+    if (job->run_extglob) {
         free(errors);
-        errors = run_cmd(&exitcode, ri->worksubdir, shell, "-n", "-O", "extglob", file->fullpath, NULL);
+        exitcode = job->extglob.exitcode;
+        errors = job->extglob.output;
         DEBUG_PRINT("exitcode=%d, errors=|%s|\n", exitcode, errors);
 
         if (!exitcode) {
@@ -297,8 +349,8 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
     }
 
-    free(shell);
-    free(before_shell);
+    free(job->shell);
+    free(job->before_shell);
     free(errors);
     free(before_errors);
     return result;
@@ -310,11 +362,43 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 bool inspect_shellsyntax(struct rpminspect *ri)
 {
     bool result;
+    char *argv[] = { NULL, "-n", "-O", "extglob", NULL, NULL };
+    struct shellsyntax_job *job = NULL;
     struct result_params params;
 
     assert(ri != NULL);
 
+    /* queue the syntax checks and wait for them */
+    TAILQ_INIT(&jobs);
+    pool = new_cmdpool(0);
     result = foreach_peer_file(ri, NAME_SHELLSYNTAX, shellsyntax_driver);
+    cmdpool_wait(pool);
+
+    /* scripts that fail as GNU bash scripts get a second try with extglob */
+    TAILQ_FOREACH(job, &jobs, items) {
+        if (job->after.exitcode && !strcmp(job->shell, "bash")) {
+            argv[0] = job->shell;
+            argv[4] = job->file->fullpath;
+            job->run_extglob = true;
+            cmdpool_add(pool, ri->worksubdir, argv, cmdpool_store_result, &job->extglob);
+        }
+    }
+
+    cmdpool_wait(pool);
+    free_cmdpool(pool);
+    pool = NULL;
+
+    /* report in the order the files were found */
+    while (!TAILQ_EMPTY(&jobs)) {
+        job = TAILQ_FIRST(&jobs);
+        TAILQ_REMOVE(&jobs, job, items);
+
+        if (!report_shellsyntax_job(ri, job)) {
+            result = false;
+        }
+
+        free(job);
+    }
 
     if (result) {
         init_result_params(&params);
@@ -15,6 +15,7 @@
 #include <dirent.h>
 
 #include "rpminspect.h"
+#include "parallel.h"
 
 /*
  * Called by udevrules_driver() to determine if a found file is one
@@ -51,27 +52,24 @@ static bool is_udev_rules_file(struct rpminspect *ri, const rpmfile_entry_t *fil
     return false;
 }
 
-/*
- * A trivial wrapper called by udevrules_driver() and inspect_udevrules()
- * to invoke udevadm verify.
- */
-static char *run_udevadm_verify(int *exitcode, const struct rpminspect *ri, const char *arg)
-{
-    assert(ri != NULL);
-    assert(arg != NULL);
+/* A udev rules file queued by udevrules_driver() and its results */
+struct udevrules_job {
+    rpmfile_entry_t *file;
+    bool has_before;
+    cmd_result_t after;
+    cmd_result_t before;
+    TAILQ_ENTRY(udevrules_job) items;
+};
 
-    return run_cmd(exitcode, ri->worksubdir, ri->commands.udevadm, "verify", "--no-summary", "--no-style", "--resolve-names=never", arg, NULL);
-}
+static TAILQ_HEAD(udevrules_jobs_s, udevrules_job) jobs;
 
+/*
+ * Find udev rules files.  They are verified together by
+ * inspect_udevrules() and reported by report_udevrules_job().
+ */
 static bool udevrules_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
-    bool result = true;
-    const char *arch = NULL;
-    int before_rc = 0;
-    int after_rc = 0;
-    char *details = NULL;
-    char *tmpbuf;
-    struct result_params params;
+    struct udevrules_job *job = NULL;
 
     /*
      * Is this a file we should look at?
@@ -81,6 +79,30 @@ static bool udevrules_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
+    job = xalloc(sizeof(*job));
+    job->file = file;
+
+    /* If we have a before peer, validate the corresponding udev rules file */
+    job->has_before = (file->peer_file && is_udev_rules_file(ri, file->peer_file));
+
+    TAILQ_INSERT_TAIL(&jobs, job, items);
+    return true;
+}
+
+/*
+ * Report the udevadm verify results for one udev rules file.  Returns
+ * false if the file is not valid.
+ */
+static bool report_udevrules_job(struct rpminspect *ri, struct udevrules_job *job)
+{
+    bool result = true;
+    const char *arch = NULL;
+    int before_rc = 0;
+    int after_rc = job->after.exitcode;
+    char *details = NULL;
+    rpmfile_entry_t *file = job->file;
+    struct result_params params;
+
     /* We need the architecture for reporting */
     arch = get_rpm_header_arch(file->rpm_header);
 
@@ -91,15 +113,13 @@ static bool udevrules_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.arch = arch;
     params.file = file->localpath;
 
-    /* Validate the udev rules file */
-    tmpbuf = run_udevadm_verify(&after_rc, ri, file->fullpath);
-    details = strreplace(tmpbuf, file->fullpath, file->localpath);
-    free(tmpbuf);
+    /* Results of validating the udev rules file */
+    details = strreplace(job->after.output, file->fullpath, file->localpath);
+    free(job->after.output);
 
-    /* If we have a before peer, validate the corresponding udev rules file */
-    if (file->peer_file && is_udev_rules_file(ri, file->peer_file)) {
-        tmpbuf = run_udevadm_verify(&before_rc, ri, file->peer_file->fullpath);
-        free(tmpbuf);
+    if (job->has_before) {
+        before_rc = job->before.exitcode;
+        free(job->before.output);
 
         if (before_rc == 0 && after_rc == 0) {
             xasprintf(&params.msg, _("%s is a valid udev rules file on %s"), file->localpath, arch);
@@ -149,6 +169,12 @@ bool inspect_udevrules(struct rpminspect *ri)
     char *details;
     int rc = 0;
     bool result;
+    size_t n = 0;
+    char **files = NULL;
+    void **data = NULL;
+    char *argv[] = { NULL, "verify", "--no-summary", "--no-style", "--resolve-names=never", NULL };
+    struct udevrules_job *job = NULL;
+    cmdpool_t *pool = NULL;
     struct result_params params;
 
     assert(ri != NULL);
@@ -173,8 +199,42 @@ bool inspect_udevrules(struct rpminspect *ri)
     free(details);
 
     /* Perform syntax check on udev rules files using udevadm verify. */
+    TAILQ_INIT(&jobs);
     result = foreach_peer_file(ri, NAME_UDEVRULES, udevrules_driver);
 
+    /* udevadm verify takes more than one file, run them in batches */
+    TAILQ_FOREACH(job, &jobs, items) {
+        files = xrealloc(files, sizeof(*files) * (n + 2));
+        data = xrealloc(data, sizeof(*data) * (n + 2));
+        files[n] = job->file->fullpath;
+        data[n++] = &job->after;
+
+        if (job->has_before) {
+            files[n] = job->file->peer_file->fullpath;
+            data[n++] = &job->before;
+        }
+    }
+
+    argv[0] = ri->commands.udevadm;
+    pool = new_cmdpool(0);
+    cmdpool_add_files(pool, ri->worksubdir, argv, files, data, n, cmdpool_store_result);
+    cmdpool_wait(pool);
+    free_cmdpool(pool);
+    free(files);
+    free(data);
+
+    /* report in the order the files were found */
+    while (!TAILQ_EMPTY(&jobs)) {
+        job = TAILQ_FIRST(&jobs);
+        TAILQ_REMOVE(&jobs, job, items);
+
+        if (!report_udevrules_job(ri, job)) {
+            result = false;
+        }
+
+        free(job);
+    }
+
     if (result) {
         init_result_params(&params);
         params.header = NAME_UDEVRULES;
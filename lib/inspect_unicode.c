@@ -4,18 +4,21 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <assert.h>
 #include <libgen.h>
 #include <errno.h>
 #include <err.h>
+#include <fcntl.h>
 #include <ftw.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <rpm/rpmspec.h>
 #include <rpm/rpmbuild.h>
 #include <rpm/rpmlog.h>
-#include <unicode/ustdio.h>
 #include <unicode/ustring.h>
 #include "rpminspect.h"
 
@@ -38,6 +41,18 @@ static bool uses_unpack_base = false;
 static struct rpminspect *globalri = NULL;
 static bool globalresult = true;
 static UChar32_list_t *forbidden = NULL;
+
+/*
+ * Lookup tables built from the forbidden list, see
+ * init_forbidden_table().  The BMP bitmap answers most lookups, code
+ * points above it are rare enough in source files to check against
+ * the list.
+ */
+static unsigned char forbidden_bmp[0x10000 / 8];
+static UChar32 *forbidden_cps = NULL;
+static size_t num_forbidden = 0;
+static bool forbidden_above_bmp = false;
+static unsigned int ascii_skip_limit = 0;
 static const char *globalspec = NULL;
 static const char *globalarch = NULL;
 static rpmfile_entry_t *globalfile = NULL;
@@ -155,10 +170,7 @@ static char *rpm_prep_source(struct rpminspect *ri, const rpmfile_entry_t *file,
     int pfd[2];
     pid_t proc = 0;
     int status = 0;
-    FILE *reader = NULL;
     char *tail = NULL;
-    size_t n = BUFSIZ;
-    char *buf = NULL;
     rpmSpec spec = NULL;
     char *macro = NULL;
     rpmts ts = NULL;
@@ -267,31 +279,11 @@ static char *rpm_prep_source(struct rpminspect *ri, const rpmfile_entry_t *file,
         }
 
         /* Read the child output back which would be what 'rpmbuild -bp' runs */
-        reader = fdopen(pfd[STDIN_FILENO], "r");
-
-        if (reader == NULL) {
-            warn("*** fdopen");
-
-            if (close(pfd[STDIN_FILENO]) == -1) {
-                warn("*** close");
-            }
-
-            return NULL;
-        }
-
         free(*details);
-        *details = NULL;
-        buf = xalloc(n);
+        *details = read_cmd_output(pfd[STDIN_FILENO], NULL, NULL);
 
-        while (getline(&buf, &n, reader) != -1) {
-            *details = strappend(*details, buf, NULL);
-        }
-
-        free(buf);
-
-        /* remember that fclose() closes underlying file handles */
-        if (fclose(reader) == -1) {
-            warn("*** fclose");
+        if (close(pfd[STDIN_FILENO]) == -1) {
+            warn("*** close");
         }
 
         /* wait for the child to exit */
@@ -402,14 +394,14 @@ static char *manual_prep_source(struct rpminspect *ri, const rpmfile_entry_t *fi
 }
 
 /*
- * Returns true if the UChar is what we consider a line ending.
+ * Returns true if the code point is what we consider a line ending.
  *
  * This function contains code adapted from this blog post about
  * Unicode with the ICU library:
  *
  * https://begriffs.com/posts/2019-05-23-unicode-icu.html
  */
-static bool end_of_line(const UChar c)
+static bool end_of_line(const UChar32 c)
 {
     if ((c >= 0xA && c <= 0xD) || c == 0x85 || c == 0x2028 || c == 0x2029) {
         return true;
@@ -418,14 +410,278 @@ static bool end_of_line(const UChar c)
     return false;
 }
 
+/*
+ * Build the lookup tables for the forbidden list.  Also work out the
+ * smallest ASCII value that scan_file() has to stop at: line endings
+ * and any forbidden ASCII code points.
+ */
+static void init_forbidden_table(void)
+{
+    size_t i = 0;
+    UChar32_entry_t *entry = NULL;
+
+    assert(forbidden != NULL);
+
+    memset(forbidden_bmp, 0, sizeof(forbidden_bmp));
+    forbidden_above_bmp = false;
+    ascii_skip_limit = 0xE;
+    num_forbidden = 0;
+
+    TAILQ_FOREACH(entry, forbidden, items) {
+        num_forbidden++;
+    }
+
+    forbidden_cps = xcalloc(num_forbidden, sizeof(*forbidden_cps));
+
+    TAILQ_FOREACH(entry, forbidden, items) {
+        forbidden_cps[i++] = entry->data;
+
+        if (entry->data < 0 || entry->data > 0x10FFFF) {
+            continue;
+        } else if (entry->data >= 0x10000) {
+            forbidden_above_bmp = true;
+        } else {
+            forbidden_bmp[entry->data / 8] |= (1 << (entry->data % 8));
+
+            if (entry->data < 0x80 && (unsigned int) entry->data >= ascii_skip_limit) {
+                ascii_skip_limit = entry->data + 1;
+            }
+        }
+    }
+
+    return;
+}
+
+static void free_forbidden_table(void)
+{
+    free(forbidden_cps);
+    forbidden_cps = NULL;
+    num_forbidden = 0;
+    return;
+}
+
+/* Return the index of the code point in the forbidden list or -1. */
+static long forbidden_index(const UChar32 c)
+{
+    size_t i = 0;
+
+    if (c < 0x10000) {
+        if (!(forbidden_bmp[c / 8] & (1 << (c % 8)))) {
+            return -1;
+        }
+    } else if (!forbidden_above_bmp) {
+        return -1;
+    }
+
+    for (i = 0; i < num_forbidden; i++) {
+        if (forbidden_cps[i] == c) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Decode one UTF-8 sequence that starts with a non-ASCII byte.
+ * Stores the code point in c and returns the number of bytes used.
+ * Malformed input decodes one byte at a time as U+FFFD, the same
+ * substitution the ICU converter makes.
+ */
+static size_t decode_utf8(const unsigned char *s, const unsigned char *end, UChar32 *c)
+{
+    size_t len = 0;
+    size_t i = 0;
+    UChar32 min = 0;
+    UChar32 cp = 0;
+
+    if (*s >= 0xC2 && *s <= 0xDF) {
+        len = 2;
+        min = 0x80;
+        cp = *s & 0x1F;
+    } else if (*s >= 0xE0 && *s <= 0xEF) {
+        len = 3;
+        min = 0x800;
+        cp = *s & 0x0F;
+    } else if (*s >= 0xF0 && *s <= 0xF4) {
+        len = 4;
+        min = 0x10000;
+        cp = *s & 0x07;
+    } else {
+        *c = 0xFFFD;
+        return 1;
+    }
+
+    if ((size_t) (end - s) < len) {
+        *c = 0xFFFD;
+        return 1;
+    }
+
+    for (i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *c = 0xFFFD;
+            return 1;
+        }
+
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+
+    /* overlong forms, surrogates, and values past the last plane */
+    if (cp < min || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) {
+        *c = 0xFFFD;
+        return 1;
+    }
+
+    *c = cp;
+    return len;
+}
+
+/*
+ * True if any byte in the word has the high bit set or is less than
+ * n (n <= 0x80).  Used to skip over runs of plain ASCII text eight
+ * bytes at a time.
+ */
+#define ONES_64 UINT64_C(0x0101010101010101)
+#define HIGH_64 UINT64_C(0x8080808080808080)
+#define STOP_IN_WORD(w, n) (((w) & HIGH_64) || (((w) - (ONES_64 * (n))) & ~(w) & HIGH_64))
+
+/*
+ * Report the forbidden code points found on one line, in the order
+ * they appear in the forbidden list.
+ */
+static void report_line(struct result_params *params, const char *localpath, const long int linenum, long int *cols)
+{
+    size_t i = 0;
+
+    assert(params != NULL);
+    assert(cols != NULL);
+
+    for (i = 0; i < num_forbidden; i++) {
+        if (cols[i] == -1) {
+            continue;
+        }
+
+        /* report result based on the secrule */
+        if (params->severity != RESULT_NULL && params->severity != RESULT_SKIP) {
+            xasprintf(&params->msg, _("A forbidden code point, 0x%04X, was found in the %s source file on line %ld at column %ld.  This source file is used by %s."), (unsigned int) forbidden_cps[i], localpath, linenum, cols[i], globalspec);
+            add_result(globalri, params);
+            free(params->msg);
+            params->msg = NULL;
+        }
+
+        cols[i] = -1;
+    }
+
+    return;
+}
+
+/*
+ * Scan a mapped UTF-8 file for forbidden code points.  Lines and
+ * columns are counted the same way the ICU line reader counted them:
+ * lines start at 1 and columns are 0-based UTF-16 code units.  Only
+ * the first occurrence of each code point on a line is reported.
+ */
+static void scan_file(const unsigned char *data, const size_t size, struct result_params *params, const char *localpath)
+{
+    const unsigned char *p = data;
+    const unsigned char *end = data + size;
+    uint64_t word = 0;
+    UChar32 c = 0;
+    long int idx = 0;
+    long int linenum = 1;
+    long int colnum = 0;
+    long int *cols = NULL;
+    bool line_hits = false;
+    bool have_severity = false;
+
+    cols = xcalloc(num_forbidden, sizeof(*cols));
+    memset(cols, -1, num_forbidden * sizeof(*cols));
+
+    while (p < end) {
+        /* skip plain ASCII text that cannot end a line or be forbidden */
+        while ((end - p) >= 8) {
+            memcpy(&word, p, sizeof(word));
+
+            if (STOP_IN_WORD(word, ascii_skip_limit)) {
+                break;
+            }
+
+            p += 8;
+            colnum += 8;
+        }
+
+        if (p == end) {
+            break;
+        }
+
+        if (*p < 0x80) {
+            c = *p++;
+        } else {
+            p += decode_utf8(p, end, &c);
+        }
+
+        if (end_of_line(c)) {
+            /* eat newline if terminated by a carriage return */
+            if (c == 0xD && p < end && *p == 0xA) {
+                p++;
+            }
+
+            if (line_hits) {
+                report_line(params, localpath, linenum, cols);
+                line_hits = false;
+            }
+
+            linenum++;
+            colnum = 0;
+            continue;
+        }
+
+        idx = forbidden_index(c);
+
+        if (idx != -1 && cols[idx] == -1) {
+            if (!have_severity) {
+                /* build a pretend rpmfile_entry_t to look up the secrule */
+                globalfile->localpath = strdup(localpath);
+                assert(globalfile->localpath != NULL);
+
+                /* get reporting severity */
+                params->severity = get_secrule_result_severity(globalri, globalfile, SECRULE_UNICODE);
+
+                /* this will be recycled as nftw() runs validate_file() */
+                free(globalfile->localpath);
+                globalfile->localpath = NULL;
+
+                if (params->severity == RESULT_INFO) {
+                    params->waiverauth = NOT_WAIVABLE;
+                    params->verb = VERB_OK;
+                } else if (params->severity != RESULT_NULL && params->severity != RESULT_SKIP) {
+                    params->waiverauth = WAIVABLE_BY_SECURITY;
+                    params->verb = VERB_FAILED;
+                    globalresult = false;
+                }
+
+                have_severity = true;
+            }
+
+            cols[idx] = colnum;
+            line_hits = true;
+        }
+
+        /* code points above the BMP take two UTF-16 code units */
+        colnum += (c >= 0x10000) ? 2 : 1;
+    }
+
+    if (line_hits) {
+        report_line(params, localpath, linenum, cols);
+    }
+
+    free(cols);
+    return;
+}
+
 /*
  * nftw() helper used to validate each source file.
  *
- * This function contains code adapted from this blog post about
- * Unicode with the ICU library:
- *
- * https://begriffs.com/posts/2019-05-23-unicode-icu.html
- *
  * NOTE: The global 'build' is used in this function, so make sure any
  * calls to free build are done after calls to validate_file().
  */
@@ -434,16 +690,9 @@ static int validate_file(const char *fpath, __attribute__((unused)) const struct
     char realbuf[PATH_MAX];
     char *real = realbuf;
     const char *localpath = fpath;
-    UFILE *src = NULL;
-    UChar32 c;
-    UChar *line = NULL;
-    UChar *line_new = NULL;
-    size_t i = 0;
-    size_t sz = BUFSIZ;
-    UChar *needle = NULL;
-    long int linenum = 0;
-    long int colnum = 0;
-    UChar32_entry_t *uentry = NULL;
+    int fd = -1;
+    struct stat fsb;
+    void *data = MAP_FAILED;
     struct result_params params;
 
     assert(globalri != NULL);
@@ -519,85 +768,39 @@ static int validate_file(const char *fpath, __attribute__((unused)) const struct
     params.noun = _("forbidden code point in ${FILE} on ${ARCH}");
     params.remedy = REMEDY_UNICODE;
 
-    /* Read in the file as Unicode data */
-    src = u_fopen(fpath, "r", NULL, NULL);
+    /* Map in the file, it is scanned as UTF-8 data */
+    fd = open(fpath, O_RDONLY);
 
-    if (src == NULL) {
-        warn("*** u_fopen");
+    if (fd == -1) {
+        warn("*** open");
         return 0;
     }
 
-    line = xcalloc(sz, sizeof(*line));
-    linenum = 1;
-
-    while (!u_feof(src)) {
-        /* read in one whole line of text from the file */
-        for (i = 0; (line[i] = u_fgetc(src)) != U_EOF && !end_of_line(line[i]); i++) {
-            /* increase the buffer size if necessary */
-            if (i >= sz) {
-                sz *= 2;
-                sz++;
-                errno = 0;
-#ifdef _HAVE_REALLOCARRAY
-                line_new = xreallocarray(line, sz, sizeof(*line));
-#else
-                line_new = xrealloc(line, sz * sizeof(*line));
-#endif
-                line = line_new;
-            }
-        }
+    if (fstat(fd, &fsb) == -1) {
+        warn("*** fstat");
+    } else if (S_ISREG(fsb.st_mode) && fsb.st_size > 0) {
+        data = mmap(NULL, fsb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
 
-        /* eat newline if terminated by a carriage return */
-        if (line[i] == 0xD && (c = u_fgetc(src)) != 0xA) {
-            u_fungetc(c, src);
+        if (data == MAP_FAILED) {
+            warn("*** mmap");
         }
+    }
 
-        /* this is either U_EOF or newline, trim it */
-        line[i] = '\0';
-
-        /* check this line for any prohibited characters */
-        TAILQ_FOREACH(uentry, forbidden, items) {
-            needle = u_strchr32(line, uentry->data);
-
-            /* forbidden code point found */
-            if (needle != NULL) {
-                /* build a pretend rpmfile_entry_t to look up the secrule */
-                globalfile->localpath = strdup(localpath);
-                assert(globalfile->localpath != NULL);
-
-                /* get reporting severity */
-                params.severity = get_secrule_result_severity(globalri, globalfile, SECRULE_UNICODE);
+    if (close(fd) == -1) {
+        warn("*** close");
+    }
 
-                /* this will be recycled as nftw() runs validate_file() */
-                free(globalfile->localpath);
-                globalfile->localpath = NULL;
+    if (data == MAP_FAILED) {
+        return 0;
+    }
 
-                /* report result based on the secrule */
-                if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                    if (params.severity == RESULT_INFO) {
-                        params.waiverauth = NOT_WAIVABLE;
-                        params.verb = VERB_OK;
-                    } else {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        params.verb = VERB_FAILED;
-                        globalresult = false;
-                    }
-
-                    colnum = u_strlen(line) - u_strlen(needle);
-                    xasprintf(&params.msg, _("A forbidden code point, 0x%04X, was found in the %s source file on line %ld at column %ld.  This source file is used by %s."), *needle, localpath, linenum, colnum, globalspec);
-                    add_result(globalri, &params);
-                    free(params.msg);
-                }
-            }
-        }
+    (void) madvise(data, fsb.st_size, MADV_SEQUENTIAL);
+    scan_file(data, fsb.st_size, &params, localpath);
 
-        /* advance the line counter */
-        linenum++;
+    if (munmap(data, fsb.st_size) == -1) {
+        warn("*** munmap");
     }
 
-    u_fclose(src);
-    free(line);
-
     return 0;
 }
 
@@ -739,6 +942,8 @@ bool inspect_unicode(struct rpminspect *ri)
             TAILQ_INSERT_TAIL(forbidden, entry, items);
         }
 
+        init_forbidden_table();
+
         /* so the nftw() helper can report results */
         globalri = ri;
 
@@ -759,6 +964,8 @@ bool inspect_unicode(struct rpminspect *ri)
         }
 
         /* free the forbidden list memory */
+        free_forbidden_table();
+
         while (!TAILQ_EMPTY(forbidden)) {
             entry = TAILQ_FIRST(forbidden);
             TAILQ_REMOVE(forbidden, entry, items);
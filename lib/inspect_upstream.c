@@ -167,6 +167,10 @@ bool inspect_upstream(struct rpminspect *ri)
             continue;
         }
 
+        /* Checksum the source files of both builds in one batch */
+        checksum_files(peer->before_files, CHECKSUM_BIT(DEFAULT_MESSAGE_DIGEST));
+        checksum_files(peer->after_files, CHECKSUM_BIT(DEFAULT_MESSAGE_DIGEST));
+
         /* Get the list of source files from each build */
         before_source = get_rpm_header_string_array(peer->before_hdr, RPMTAG_SOURCE);
         source = get_rpm_header_string_array(peer->after_hdr, RPMTAG_SOURCE);
@@ -4,7 +4,13 @@
  */
 
 #include <errno.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <assert.h>
+#include "rpminspect.h"
 
 /*
  * Write *all* of the supplied buffer out to a fd.
@@ -45,3 +51,77 @@ ssize_t full_write(int fd, const void *buf, size_t len)
 
     return total;
 }
+
+/*
+ * Write a single optional string to a stream for read_stream_string().
+ * A leading flag byte distinguishes NULL from the empty string.  Used
+ * by the serializers that send data from child processes back to the
+ * parent, such as write_results() and write_files().
+ */
+void write_stream_string(FILE *fp, const char *s)
+{
+    assert(fp != NULL);
+
+    if (s == NULL) {
+        fputc(0, fp);
+        return;
+    }
+
+    fputc(1, fp);
+    fputs(s, fp);
+    fputc('\0', fp);
+    return;
+}
+
+/*
+ * Copy a fixed size field out of a serialized buffer and advance *pos
+ * past it.  Returns false if the buffer is too short.
+ */
+bool read_stream_field(void *dest, const size_t size, const char **pos, const char *end)
+{
+    assert(dest != NULL);
+    assert(pos != NULL);
+
+    if ((size_t) (end - *pos) < size) {
+        return false;
+    }
+
+    memcpy(dest, *pos, size);  /* copy unaligned bytes */
+    *pos += size;
+    return true;
+}
+
+/*
+ * Read a string written by write_stream_string() out of a serialized
+ * buffer and advance *pos past it.  *dest is set to NULL or a new
+ * string the caller must free.  Returns false if the buffer is
+ * malformed.
+ */
+bool read_stream_string(char **dest, const char **pos, const char *end)
+{
+    const char *nul = NULL;
+
+    assert(dest != NULL);
+    assert(pos != NULL);
+
+    *dest = NULL;
+
+    if (*pos >= end) {
+        return false;
+    }
+
+    if (*(*pos)++ == 0) {
+        return true;
+    }
+
+    nul = memchr(*pos, '\0', end - *pos);
+
+    if (nul == NULL) {
+        return false;
+    }
+
+    *dest = strdup(*pos);
+    assert(*dest != NULL);
+    *pos = nul + 1;
+    return true;
+}
@@ -286,24 +286,126 @@ void free_module_aliases(kernel_alias_data_t *data)
     return;
 }
 
-static string_list_t *wildcard_alias_search(const char *alias, kernel_alias_data_t *data)
+/*
+ * An alias of a kernel_alias_data_t and its position in that table,
+ * see index_module_aliases().
+ */
+struct alias_candidate {
+    size_t order;
+    kernel_alias_data_t *kentry;
+};
+
+/* The aliases sharing a literal prefix */
+struct alias_prefix {
+    struct alias_candidate *candidates;
+    size_t num;
+    UT_hash_handle hh;
+};
+
+/*
+ * Index the aliases in data by the literal text before their first
+ * wildcard.  An alias can only match a pattern whose literal prefix
+ * is a prefix of the alias, so wildcard_alias_search() only runs
+ * fnmatch() on the patterns found by looking up each prefix of the
+ * alias rather than on every alias in data.
+ */
+static struct alias_prefix *index_module_aliases(kernel_alias_data_t *data)
 {
-    string_list_t *r = NULL;
-    string_entry_t *iter = NULL;
+    size_t order = 0;
+    size_t len = 0;
+    struct alias_prefix *index = NULL;
+    struct alias_prefix *prefix = NULL;
     kernel_alias_data_t *kentry = NULL;
     kernel_alias_data_t *tmp_kentry = NULL;
 
+    HASH_ITER(hh, data, kentry, tmp_kentry) {
+        len = strcspn(kentry->alias, "*?[\\");
+        HASH_FIND(hh, index, kentry->alias, len, prefix);
+
+        if (prefix == NULL) {
+            prefix = xalloc(sizeof(*prefix));
+            HASH_ADD_KEYPTR(hh, index, kentry->alias, len, prefix);
+        }
+
+        prefix->candidates = xrealloc(prefix->candidates, (prefix->num + 1) * sizeof(*prefix->candidates));
+        prefix->candidates[prefix->num].order = order++;
+        prefix->candidates[prefix->num++].kentry = kentry;
+    }
+
+    return index;
+}
+
+static void free_alias_index(struct alias_prefix *index)
+{
+    struct alias_prefix *prefix = NULL;
+    struct alias_prefix *tmp_prefix = NULL;
+
+    HASH_ITER(hh, index, prefix, tmp_prefix) {
+        HASH_DEL(index, prefix);
+        free(prefix->candidates);
+        free(prefix);
+    }
+
+    return;
+}
+
+static int cmp_alias_candidates(const void *a, const void *b)
+{
+    const struct alias_candidate *x = a;
+    const struct alias_candidate *y = b;
+
+    if (x->order < y->order) {
+        return -1;
+    } else if (x->order > y->order) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static string_list_t *wildcard_alias_search(const char *alias, struct alias_prefix *index)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t len = 0;
+    size_t nmatches = 0;
+    string_list_t *r = NULL;
+    string_entry_t *iter = NULL;
+    struct alias_prefix *prefix = NULL;
+    struct alias_candidate *matches = NULL;
+
     assert(alias != NULL);
-    assert(data != NULL);
+    assert(index != NULL);
 
-    HASH_ITER(hh, data, kentry, tmp_kentry) {
-        if (fnmatch(kentry->alias, alias, 0) == 0) {
-            TAILQ_FOREACH(iter, kentry->modules, items) {
-                r = list_add(r, iter->data);
+    len = strlen(alias);
+
+    for (i = 0; i <= len; i++) {
+        HASH_FIND(hh, index, alias, i, prefix);
+
+        if (prefix == NULL) {
+            continue;
+        }
+
+        for (j = 0; j < prefix->num; j++) {
+            if (fnmatch(prefix->candidates[j].kentry->alias, alias, 0) == 0) {
+                matches = xrealloc(matches, (nmatches + 1) * sizeof(*matches));
+                matches[nmatches++] = prefix->candidates[j];
             }
         }
     }
 
+    /* report the modules in the order of the alias table */
+    if (nmatches > 1) {
+        qsort(matches, nmatches, sizeof(*matches), cmp_alias_candidates);
+    }
+
+    for (i = 0; i < nmatches; i++) {
+        TAILQ_FOREACH(iter, matches[i].kentry->modules, items) {
+            r = list_add(r, iter->data);
+        }
+    }
+
+    free(matches);
     return r;
 }
 
@@ -320,19 +422,20 @@ static string_list_t *wildcard_alias_search(const char *alias, kernel_alias_data
  * "pci:v00001425d00000020sv*sd*bc*sc*i*". The after string still
  * matches the before string, so this is not a regression.
  *
- * However, since matching up module aliases does involve
- * arbitrary-length wildcards, this function effectively needs to run
- * fnmatch() between every combination of before and after aliases,
- * resulting in a complexity of O(n^2).  To speed things up in the
- * (hopefully) usual case, the wildcard search is only run when an
- * exact string match of an alias (using hash tables) results in an
- * apparent regression.
+ * Matching up module aliases involves arbitrary-length wildcards, so
+ * in the worst case fnmatch() runs between every combination of
+ * before and after aliases.  To speed things up in the (hopefully)
+ * usual case, the wildcard search is only run when an exact string
+ * match of an alias (using hash tables) results in an apparent
+ * regression, and then only against the after aliases whose literal
+ * prefix matches (see index_module_aliases()).
  */
 bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *after, module_alias_callback callback, void *user_data)
 {
     kernel_alias_data_t *iter = NULL;
     kernel_alias_data_t *tmp_iter = NULL;
     kernel_alias_data_t *after_entry = NULL;
+    struct alias_prefix *after_index = NULL;
     string_list_t *before_modules = NULL;
     string_list_t *after_modules = NULL;
     string_list_t *difference = NULL;
@@ -370,7 +473,11 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
 
         /* No match found, do a wildcard search */
         if (after_entry == NULL) {
-            after_modules = wildcard_alias_search(iter->alias, after);
+            if (after_index == NULL) {
+                after_index = index_module_aliases(after);
+            }
+
+            after_modules = wildcard_alias_search(iter->alias, after_index);
             wildcard_search = true;
         } else {
             after_modules = after_entry->modules;
@@ -378,7 +485,11 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
 
             /* If the lists differ, do a wildcard search */
             if (difference != NULL && !TAILQ_EMPTY(difference)) {
-                after_modules = wildcard_alias_search(iter->alias, after);
+                if (after_index == NULL) {
+                    after_index = index_module_aliases(after);
+                }
+
+                after_modules = wildcard_alias_search(iter->alias, after_index);
                 wildcard_search = true;
             }
 
@@ -401,5 +512,6 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
         list_free(difference, NULL);
     }
 
+    free_alias_index(after_index);
     return result;
 }
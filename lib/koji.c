@@ -13,6 +13,7 @@
 #include <xmlrpc-c/client_global.h>
 #include "queue.h"
 #include "rpminspect.h"
+#include "parallel.h"
 
 /*
  * Koji build types supported by rpminspect.
@@ -288,6 +289,370 @@ static string_list_t *read_koji_descendent_results(xmlrpc_env *env, xmlrpc_value
     return results;
 }
 
+/*
+ * The XML-RPC client is set up the first time a Koji call is made
+ * and kept for the rest of the run so every call after the first
+ * reuses the same transport and connection to the hub.
+ */
+static bool koji_client_ready = false;
+
+/*
+ * Set up the shared XML-RPC client if it is not already.
+ */
+static void init_koji_client(xmlrpc_env *env)
+{
+    assert(env != NULL);
+
+    if (koji_client_ready) {
+        return;
+    }
+
+    xmlrpc_limit_set(XMLRPC_XML_SIZE_LIMIT_ID, SIZE_MAX);
+    xmlrpc_client_init2(env, XMLRPC_CLIENT_NO_FLAGS, SOFTWARE_NAME, PACKAGE_VERSION, NULL, 0);
+    xmlrpc_abort_on_fault(env);
+    koji_client_ready = true;
+    return;
+}
+
+/*
+ * Tear down the shared XML-RPC client.
+ */
+void free_koji_client(void)
+{
+    if (koji_client_ready) {
+        xmlrpc_client_cleanup();
+        koji_client_ready = false;
+    }
+
+    return;
+}
+
+/*
+ * Add a call to a Koji method taking a single integer argument to
+ * an array of calls for koji_multicall().
+ */
+static void add_koji_call(xmlrpc_env *env, xmlrpc_value *calls, const char *method, const int arg)
+{
+    xmlrpc_value *call = NULL;
+
+    assert(env != NULL);
+    assert(calls != NULL);
+    assert(method != NULL);
+
+    call = xmlrpc_build_value(env, "{s:s,s:(i)}", "methodName", method, "params", arg);
+    xmlrpc_abort_on_fault(env);
+    xmlrpc_array_append_item(env, calls, call);
+    xmlrpc_abort_on_fault(env);
+    xmlrpc_DECREF(call);
+    return;
+}
+
+/*
+ * One multiCall request sent to the hub.
+ */
+struct koji_multicall_batch {
+    xmlrpc_value *calls;        /* the calls in this batch */
+    xmlrpc_value *results;      /* array returned by multiCall */
+    int fault_code;             /* transport or hub fault */
+    char *fault_string;
+};
+
+/*
+ * Response handler for an asynchronous multiCall request.
+ */
+static void koji_multicall_done(__attribute__((unused)) const char *server_url, __attribute__((unused)) const char *method_name, __attribute__((unused)) xmlrpc_value *param_array, void *user_data, xmlrpc_env *fault, xmlrpc_value *result)
+{
+    struct koji_multicall_batch *batch = user_data;
+
+    assert(batch != NULL);
+
+    if (fault->fault_occurred) {
+        batch->fault_code = fault->fault_code;
+        batch->fault_string = strdup(fault->fault_string);
+        return;
+    }
+
+    /* the result belongs to the client, keep our own reference */
+    xmlrpc_INCREF(result);
+    batch->results = result;
+    return;
+}
+
+/*
+ * Run an array of calls built with add_koji_call() through the
+ * Koji multiCall method.  The calls are split in to batches of
+ * KOJI_MULTICALL_SIZE and up to the number of parallel processes
+ * worth of batches are in flight at once.  Returns an array holding
+ * the result of each call in the order the calls were added.  The
+ * caller must xmlrpc_DECREF() the returned array.
+ *
+ * A fault in any of the calls is fatal, the same as when the calls
+ * are made one at a time.
+ */
+static xmlrpc_value *koji_multicall(xmlrpc_env *env, const char *hub, xmlrpc_value *calls)
+{
+    int i = 0;
+    int j = 0;
+    int ncalls = 0;
+    int nbatches = 0;
+    int size = 0;
+    int first = 0;
+    int fault_code = 0;
+    char *fault_string = NULL;
+    unsigned int max = 0;
+    struct koji_multicall_batch *batches = NULL;
+    xmlrpc_value *params = NULL;
+    xmlrpc_value *item = NULL;
+    xmlrpc_value *value = NULL;
+    xmlrpc_value *results = NULL;
+
+    assert(env != NULL);
+    assert(hub != NULL);
+    assert(calls != NULL);
+
+    results = xmlrpc_array_new(env);
+    xmlrpc_abort_on_fault(env);
+
+    ncalls = xmlrpc_array_size(env, calls);
+    xmlrpc_abort_on_fault(env);
+
+    if (ncalls == 0) {
+        return results;
+    }
+
+    /* split the calls in to batches */
+    nbatches = (ncalls + KOJI_MULTICALL_SIZE - 1) / KOJI_MULTICALL_SIZE;
+    batches = xcalloc(nbatches, sizeof(*batches));
+
+    for (i = 0; i < nbatches; i++) {
+        batches[i].calls = xmlrpc_array_new(env);
+        xmlrpc_abort_on_fault(env);
+
+        for (j = i * KOJI_MULTICALL_SIZE; j < ncalls && j < (i + 1) * KOJI_MULTICALL_SIZE; j++) {
+            xmlrpc_array_read_item(env, calls, j, &item);
+            xmlrpc_abort_on_fault(env);
+            xmlrpc_array_append_item(env, batches[i].calls, item);
+            xmlrpc_abort_on_fault(env);
+            xmlrpc_DECREF(item);
+        }
+    }
+
+    /* send the batches, a bounded number at a time */
+    max = get_parallel_processes();
+
+    for (first = 0; first < nbatches; first += max) {
+        for (i = first; i < nbatches && i < (int) (first + max); i++) {
+            params = xmlrpc_build_value(env, "(A)", batches[i].calls);
+            xmlrpc_abort_on_fault(env);
+            xmlrpc_client_call_asynch_params(hub, "multiCall", koji_multicall_done, &batches[i], params);
+            xmlrpc_DECREF(params);
+        }
+
+        xmlrpc_client_event_loop_finish_asynch();
+    }
+
+    /*
+     * Each multiCall result is an array with one entry per call.  An
+     * entry is either a single element array holding the return
+     * value of the call or a fault struct.
+     */
+    for (i = 0; i < nbatches; i++) {
+        if (batches[i].fault_string != NULL) {
+            errx(RI_PROGRAM_ERROR, _("*** XML-RPC Fault: %s (%d)"), batches[i].fault_string, batches[i].fault_code);
+        }
+
+        if (batches[i].results == NULL) {
+            errx(RI_PROGRAM_ERROR, _("*** no multiCall response from %s"), hub);
+        }
+
+        size = xmlrpc_array_size(env, batches[i].results);
+        xmlrpc_abort_on_fault(env);
+
+        for (j = 0; j < size; j++) {
+            xmlrpc_array_read_item(env, batches[i].results, j, &item);
+            xmlrpc_abort_on_fault(env);
+
+            if (xmlrpc_value_type(item) == XMLRPC_TYPE_STRUCT) {
+                xmlrpc_decompose_value(env, item, "{s:i,s:s,*}", "faultCode", &fault_code, "faultString", &fault_string);
+                xmlrpc_abort_on_fault(env);
+                errx(RI_PROGRAM_ERROR, _("*** XML-RPC Fault: %s (%d)"), fault_string, fault_code);
+            }
+
+            xmlrpc_array_read_item(env, item, 0, &value);
+            xmlrpc_abort_on_fault(env);
+            xmlrpc_array_append_item(env, results, value);
+            xmlrpc_abort_on_fault(env);
+            xmlrpc_DECREF(value);
+            xmlrpc_DECREF(item);
+        }
+
+        xmlrpc_DECREF(batches[i].results);
+        xmlrpc_DECREF(batches[i].calls);
+    }
+
+    free(batches);
+
+    if (xmlrpc_array_size(env, results) != ncalls) {
+        errx(RI_PROGRAM_ERROR, _("*** multiCall to %s returned %d results for %d calls"), hub, xmlrpc_array_size(env, results), ncalls);
+    }
+
+    return results;
+}
+
+/*
+ * Read the result of a 'listBuildRPMs' call and add the RPMs for
+ * allowed architectures to the build entry.
+ */
+static void read_koji_build_rpms(xmlrpc_env *env, const struct rpminspect *ri, struct koji_build *build, koji_buildlist_entry_t *buildentry, xmlrpc_value *result)
+{
+    int i = 0;
+    int j = 0;
+    int size = 0;
+    int subsize = 0;
+    int32_t isz = 0;
+    int64_t idsz = 0;
+    xmlrpc_value *key = NULL;
+    xmlrpc_value *value = NULL;
+    xmlrpc_value *element = NULL;
+    char *keyname = NULL;
+    koji_rpmlist_entry_t *rpm = NULL;
+
+    assert(env != NULL);
+    assert(ri != NULL);
+    assert(build != NULL);
+    assert(buildentry != NULL);
+    assert(result != NULL);
+
+    /* read the values from the result */
+    size = xmlrpc_array_size(env, result);
+    xmlrpc_abort_on_fault(env);
+
+    for (i = 0; i < size; i++) {
+        xmlrpc_array_read_item(env, result, i, &element);
+        xmlrpc_abort_on_fault(env);
+
+        /* each array element is a struct */
+        subsize = xmlrpc_struct_size(env, element);
+        xmlrpc_abort_on_fault(env);
+
+        /* create a new rpm list entry */
+        rpm = xalloc(sizeof(*rpm));
+
+        for (j = 0; j < subsize; j++) {
+            xmlrpc_struct_read_member(env, element, j, &key, &value);
+            xmlrpc_abort_on_fault(env);
+
+            /* Get the key as a string */
+            xmlrpc_decompose_value(env, key, "s", &keyname);
+            xmlrpc_abort_on_fault(env);
+
+            /* Skip nil values */
+            if (xmlrpc_value_type(value) == XMLRPC_TYPE_NIL) {
+                xmlrpc_DECREF(value);
+                xmlrpc_DECREF(key);
+                free(keyname);
+                keyname = NULL;
+                continue;
+            }
+
+            /* Grab the values we need */
+            if (!strcmp(keyname, "arch")) {
+                xmlrpc_decompose_value(env, value, "s", &rpm->arch);
+            } else if (!strcmp(keyname, "name")) {
+                xmlrpc_decompose_value(env, value, "s", &rpm->name);
+            } else if (!strcmp(keyname, "version")) {
+                xmlrpc_decompose_value(env, value, "s", &rpm->version);
+            } else if (!strcmp(keyname, "release")) {
+                xmlrpc_decompose_value(env, value, "s", &rpm->release);
+            } else if (!strcmp(keyname, "epoch")) {
+                xmlrpc_decompose_value(env, value, "i", &rpm->epoch);
+            } else if (!strcmp(keyname, "size")) {
+                if (xmlrpc_value_type(value) == XMLRPC_TYPE_INT) {
+                    isz = 0;
+                    xmlrpc_decompose_value(env, value, "i", &isz);
+                    rpm->size = isz;
+                } else if (xmlrpc_value_type(value) == XMLRPC_TYPE_I8) {
+                    idsz = 0;
+                    xmlrpc_decompose_value(env, value, "I", &idsz);
+                    rpm->size = idsz;
+                } else {
+                    /*
+                     * XXX: have no idea what we got back here
+                     */
+                    rpm->size = 0;
+                }
+            }
+
+            xmlrpc_abort_on_fault(env);
+            xmlrpc_DECREF(value);
+            xmlrpc_DECREF(key);
+            free(keyname);
+            keyname = NULL;
+        }
+
+        /* add this rpm to the list */
+        if (allowed_arch(ri, rpm->arch)) {
+            build->total_size += rpm->size;
+            TAILQ_INSERT_TAIL(buildentry->rpms, rpm, items);
+        } else {
+            free_koji_rpmlist_entry(rpm);
+        }
+
+        xmlrpc_DECREF(element);
+    }
+
+    return;
+}
+
+/*
+ * Read the result of a 'getTaskResult' call in to a descendent task
+ * entry.
+ */
+static void read_koji_task_result(xmlrpc_env *env, xmlrpc_value *dresult, koji_task_entry_t *descendent)
+{
+    int k = 0;
+    int rsize = 0;
+    char *key = NULL;
+    xmlrpc_value *tr_k = NULL;
+    xmlrpc_value *tr_v = NULL;
+
+    assert(env != NULL);
+    assert(dresult != NULL);
+    assert(descendent != NULL);
+
+    rsize = xmlrpc_struct_size(env, dresult);
+
+    for (k = 0; k < rsize; k++) {
+        /* Read the result struct */
+        xmlrpc_struct_read_member(env, dresult, k, &tr_k, &tr_v);
+        xmlrpc_abort_on_fault(env);
+
+        /* Get the key as a string */
+        xmlrpc_decompose_value(env, tr_k, "s", &key);
+        xmlrpc_abort_on_fault(env);
+        xmlrpc_DECREF(tr_k);
+
+        /* Read the values */
+        if (!strcmp(key, "brootid") || !strcmp(key, "buildroot_id")) {
+            xmlrpc_decompose_value(env, tr_v, "i", &descendent->brootid);
+            xmlrpc_abort_on_fault(env);
+        } else if (xmlrpc_value_type(tr_v) == XMLRPC_TYPE_ARRAY) {
+            if (!strcmp(key, "srpms")) {
+                descendent->srpms = read_koji_descendent_results(env, tr_v);
+            } else if (!strcmp(key, "rpms")) {
+                descendent->rpms = read_koji_descendent_results(env, tr_v);
+            } else if (!strcmp(key, "logs")) {
+                descendent->logs = read_koji_descendent_results(env, tr_v);
+            }
+        }
+
+        xmlrpc_DECREF(tr_v);
+        free(key);
+    }
+
+    return;
+}
+
 /*
  * Initialize a koji_buildlist_t.
  */
@@ -589,18 +954,17 @@ struct koji_build *get_koji_build(struct rpminspect *ri, const char *buildspec)
     int size = 0;
     int subsize = 0;
     int modsize = 0;
-    int32_t isz = 0;
-    int64_t idsz = 0;
     xmlrpc_env env;
     xmlrpc_value *key = NULL;
     xmlrpc_value *value = NULL;
     xmlrpc_value *subv = NULL;
     xmlrpc_value *modv = NULL;
     xmlrpc_value *result = NULL;
+    xmlrpc_value *results = NULL;
+    xmlrpc_value *calls = NULL;
     xmlrpc_value *element = NULL;
     char *keyname = NULL;
     koji_buildlist_entry_t *buildentry = NULL;
-    koji_rpmlist_entry_t *rpm = NULL;
 
     assert(ri != NULL);
 
@@ -616,10 +980,8 @@ struct koji_build *get_koji_build(struct rpminspect *ri, const char *buildspec)
     /* initialize everything and get XMLRPC ready */
     build = xalloc(sizeof(*build));
     init_koji_build(build);
-    xmlrpc_limit_set(XMLRPC_XML_SIZE_LIMIT_ID, SIZE_MAX);
     xmlrpc_env_init(&env);
-    xmlrpc_client_init2(&env, XMLRPC_CLIENT_NO_FLAGS, SOFTWARE_NAME, PACKAGE_VERSION, NULL, 0);
-    xmlrpc_abort_on_fault(&env);
+    init_koji_client(&env);
 
     /* call 'getBuild' on the koji hub */
     result = xmlrpc_client_call(&env, ri->kojihub, "getBuild", "(s)", buildspec);
@@ -632,7 +994,6 @@ struct koji_build *get_koji_build(struct rpminspect *ri, const char *buildspec)
 
             /* server side error which means Koji protocol error */
             xmlrpc_env_clean(&env);
-            xmlrpc_client_cleanup();
             free_koji_build(build);
 
             return NULL;
@@ -645,7 +1006,6 @@ struct koji_build *get_koji_build(struct rpminspect *ri, const char *buildspec)
     /* is this a valid build? */
     if (xmlrpc_value_type(result) == XMLRPC_TYPE_NIL) {
         xmlrpc_env_clean(&env);
-        xmlrpc_client_cleanup();
         xmlrpc_DECREF(result);
         free_koji_build(build);
         return NULL;
@@ -979,94 +1339,29 @@ struct koji_build *get_koji_build(struct rpminspect *ri, const char *buildspec)
     }
 
     /* Call 'listBuildRPMs' on the koji hub for each build_id */
-    TAILQ_FOREACH(buildentry, build->builds, builditems) {
-        result = xmlrpc_client_call(&env, ri->kojihub, "listBuildRPMs", "(i)", buildentry->build_id);
-        xmlrpc_abort_on_fault(&env);
-
-        /* read the values from the result */
-        size = xmlrpc_array_size(&env, result);
-        xmlrpc_abort_on_fault(&env);
-
-        for (i = 0; i < size; i++) {
-            xmlrpc_array_read_item(&env, result, i, &element);
-            xmlrpc_abort_on_fault(&env);
-
-            /* each array element is a struct */
-            subsize = xmlrpc_struct_size(&env, element);
-            xmlrpc_abort_on_fault(&env);
-
-            /* create a new rpm list entry */
-            rpm = xalloc(sizeof(*rpm));
-
-            for (j = 0; j < subsize; j++) {
-                xmlrpc_struct_read_member(&env, element, j, &key, &value);
-                xmlrpc_abort_on_fault(&env);
-
-                /* Get the key as a string */
-                xmlrpc_decompose_value(&env, key, "s", &keyname);
-                xmlrpc_abort_on_fault(&env);
-
-                /* Skip nil values */
-                if (xmlrpc_value_type(value) == XMLRPC_TYPE_NIL) {
-                    xmlrpc_DECREF(value);
-                    xmlrpc_DECREF(key);
-                    free(keyname);
-                    keyname = NULL;
-                    continue;
-                }
-
-                /* Grab the values we need */
-                if (!strcmp(keyname, "arch")) {
-                    xmlrpc_decompose_value(&env, value, "s", &rpm->arch);
-                } else if (!strcmp(keyname, "name")) {
-                    xmlrpc_decompose_value(&env, value, "s", &rpm->name);
-                } else if (!strcmp(keyname, "version")) {
-                    xmlrpc_decompose_value(&env, value, "s", &rpm->version);
-                } else if (!strcmp(keyname, "release")) {
-                    xmlrpc_decompose_value(&env, value, "s", &rpm->release);
-                } else if (!strcmp(keyname, "epoch")) {
-                    xmlrpc_decompose_value(&env, value, "i", &rpm->epoch);
-                } else if (!strcmp(keyname, "size")) {
-                    if (xmlrpc_value_type(value) == XMLRPC_TYPE_INT) {
-                        isz = 0;
-                        xmlrpc_decompose_value(&env, value, "i", &isz);
-                        rpm->size = isz;
-                    } else if (xmlrpc_value_type(value) == XMLRPC_TYPE_I8) {
-                        idsz = 0;
-                        xmlrpc_decompose_value(&env, value, "I", &idsz);
-                        rpm->size = idsz;
-                    } else {
-                        /*
-                         * XXX: have no idea what we got back here
-                         */
-                        rpm->size = 0;
-                    }
-                }
-
-                xmlrpc_abort_on_fault(&env);
-                xmlrpc_DECREF(value);
-                xmlrpc_DECREF(key);
-                free(keyname);
-                keyname = NULL;
-            }
+    calls = xmlrpc_array_new(&env);
+    xmlrpc_abort_on_fault(&env);
 
-            /* add this rpm to the list */
-            if (allowed_arch(ri, rpm->arch)) {
-                build->total_size += rpm->size;
-                TAILQ_INSERT_TAIL(buildentry->rpms, rpm, items);
-            } else {
-                free_koji_rpmlist_entry(rpm);
-            }
+    TAILQ_FOREACH(buildentry, build->builds, builditems) {
+        add_koji_call(&env, calls, "listBuildRPMs", buildentry->build_id);
+    }
 
-            xmlrpc_DECREF(element);
-        }
+    results = koji_multicall(&env, ri->kojihub, calls);
+    xmlrpc_DECREF(calls);
+    i = 0;
 
+    TAILQ_FOREACH(buildentry, build->builds, builditems) {
+        xmlrpc_array_read_item(&env, results, i, &result);
+        xmlrpc_abort_on_fault(&env);
+        read_koji_build_rpms(&env, ri, build, buildentry, result);
         xmlrpc_DECREF(result);
+        i++;
     }
 
+    xmlrpc_DECREF(results);
+
     /* Cleanup */
     xmlrpc_env_clean(&env);
-    xmlrpc_client_cleanup();
 
     return build;
 }
@@ -1076,19 +1371,20 @@ struct koji_build *get_koji_build(struct rpminspect *ri, const char *buildspec)
  */
 struct koji_task *get_koji_task(struct rpminspect *ri, const char *taskspec)
 {
-    int i, j, k;
-    int size, dsize, rsize;
+    int i, j;
+    int size, dsize;
+    int npending = 0;
     xmlrpc_env env;
     xmlrpc_value *result = NULL;
+    xmlrpc_value *results = NULL;
+    xmlrpc_value *calls = NULL;
     xmlrpc_value *xk = NULL;
     xmlrpc_value *xv = NULL;
-    xmlrpc_value *tr_k = NULL;
-    xmlrpc_value *tr_v = NULL;
     xmlrpc_value *dstruct = NULL;
     xmlrpc_value *dresult = NULL;
-    char *key = NULL;
     struct koji_task *task = NULL;
     koji_task_entry_t *descendent = NULL;
+    koji_task_entry_t **pending = NULL;
 
     assert(ri != NULL);
 
@@ -1104,10 +1400,8 @@ struct koji_task *get_koji_task(struct rpminspect *ri, const char *taskspec)
     /* initialize everything and get XMLRPC ready */
     task = xalloc(sizeof(*task));
     init_koji_task(task);
-    xmlrpc_limit_set(XMLRPC_XML_SIZE_LIMIT_ID, SIZE_MAX);
     xmlrpc_env_init(&env);
-    xmlrpc_client_init2(&env, XMLRPC_CLIENT_NO_FLAGS, SOFTWARE_NAME, PACKAGE_VERSION, NULL, 0);
-    xmlrpc_abort_on_fault(&env);
+    init_koji_client(&env);
 
     /* call 'getTaskInfo' on the koji hub */
     result = xmlrpc_client_call(&env, ri->kojihub, "getTaskInfo", "(s)", taskspec);
@@ -1120,7 +1414,6 @@ struct koji_task *get_koji_task(struct rpminspect *ri, const char *taskspec)
 
             /* server side error which means Koji protocol error */
             xmlrpc_env_clean(&env);
-            xmlrpc_client_cleanup();
             free_koji_task(task);
 
             return NULL;
@@ -1134,7 +1427,6 @@ struct koji_task *get_koji_task(struct rpminspect *ri, const char *taskspec)
     if (xmlrpc_value_type(result) == XMLRPC_TYPE_NIL) {
         xmlrpc_DECREF(result);
         xmlrpc_env_clean(&env);
-        xmlrpc_client_cleanup();
         free_koji_task(task);
         return NULL;
     }
@@ -1146,7 +1438,6 @@ struct koji_task *get_koji_task(struct rpminspect *ri, const char *taskspec)
     if (task->state != TASK_CLOSED) {
         warnx(_("*** Koji task state is %s for task %s, cannot continue"), task_state_desc(task->state), taskspec);
         xmlrpc_env_clean(&env);
-        xmlrpc_client_cleanup();
         free_koji_task(task);
         return NULL;
     }
@@ -1162,6 +1453,10 @@ struct koji_task *get_koji_task(struct rpminspect *ri, const char *taskspec)
     task->descendents = xalloc(sizeof(*task->descendents));
     TAILQ_INIT(task->descendents);
 
+    /* collect the descendent tasks and queue a result lookup for each */
+    calls = xmlrpc_array_new(&env);
+    xmlrpc_abort_on_fault(&env);
+
     for (i = 0; i < size; i++) {
         xmlrpc_struct_read_member(&env, result, i, &xk, &xv);
         xmlrpc_abort_on_fault(&env);
@@ -1185,70 +1480,52 @@ struct koji_task *get_koji_task(struct rpminspect *ri, const char *taskspec)
             descendent = xalloc(sizeof(*descendent));
             init_koji_task_entry(descendent);
             read_koji_task_struct(&env, dstruct, descendent->task);
+            xmlrpc_DECREF(dstruct);
+
+            pending = xrealloc(pending, (npending + 1) * sizeof(*pending));
+            pending[npending++] = descendent;
 
-            /* gather the task results */
+            /* the task results */
             if (task->method && !strcmp(task->method, "wrapperRPM")) {
-                dresult = xmlrpc_client_call(&env, ri->kojihub, "getTaskResult", "(i)", descendent->task->parent);
+                add_koji_call(&env, calls, "getTaskResult", descendent->task->parent);
             } else {
-                dresult = xmlrpc_client_call(&env, ri->kojihub, "getTaskResult", "(i)", descendent->task->id);
-            }
-
-            xmlrpc_abort_on_fault(&env);
-
-            if (xmlrpc_value_type(dresult) == XMLRPC_TYPE_NIL) {
-                /* some task IDs may be nothing, so ignore */
-                xmlrpc_DECREF(dresult);
-                xmlrpc_DECREF(dstruct);
-                free_koji_task_entry(descendent);
-                continue;
+                add_koji_call(&env, calls, "getTaskResult", descendent->task->id);
             }
+        }
 
-            rsize = xmlrpc_struct_size(&env, dresult);
-
-            for (k = 0; k < rsize; k++) {
-                /* Read the result struct */
-                xmlrpc_struct_read_member(&env, dresult, k, &tr_k, &tr_v);
-                xmlrpc_abort_on_fault(&env);
-
-                /* Get the key as a string */
-                xmlrpc_decompose_value(&env, tr_k, "s", &key);
-                xmlrpc_abort_on_fault(&env);
-                xmlrpc_DECREF(tr_k);
+        xmlrpc_DECREF(xk);
+        xmlrpc_DECREF(xv);
+    }
 
-                /* Read the values */
-                if (!strcmp(key, "brootid") || !strcmp(key, "buildroot_id")) {
-                    xmlrpc_decompose_value(&env, tr_v, "i", &descendent->brootid);
-                    xmlrpc_abort_on_fault(&env);
-                } else if (xmlrpc_value_type(tr_v) == XMLRPC_TYPE_ARRAY) {
-                    if (!strcmp(key, "srpms")) {
-                        descendent->srpms = read_koji_descendent_results(&env, tr_v);
-                    } else if (!strcmp(key, "rpms")) {
-                        descendent->rpms = read_koji_descendent_results(&env, tr_v);
-                    } else if (!strcmp(key, "logs")) {
-                        descendent->logs = read_koji_descendent_results(&env, tr_v);
-                    }
-                }
+    xmlrpc_DECREF(result);
 
-                xmlrpc_DECREF(tr_v);
-                free(key);
-            }
+    /* gather the task results */
+    results = koji_multicall(&env, ri->kojihub, calls);
+    xmlrpc_DECREF(calls);
 
-            /* save this descendent in the list */
-            TAILQ_INSERT_TAIL(task->descendents, descendent, items);
+    for (i = 0; i < npending; i++) {
+        xmlrpc_array_read_item(&env, results, i, &dresult);
+        xmlrpc_abort_on_fault(&env);
 
+        if (xmlrpc_value_type(dresult) == XMLRPC_TYPE_NIL) {
+            /* some task IDs may be nothing, so ignore */
             xmlrpc_DECREF(dresult);
-            xmlrpc_DECREF(dstruct);
+            free_koji_task_entry(pending[i]);
+            continue;
         }
 
-        xmlrpc_DECREF(xk);
-        xmlrpc_DECREF(xv);
+        read_koji_task_result(&env, dresult, pending[i]);
+
+        /* save this descendent in the list */
+        TAILQ_INSERT_TAIL(task->descendents, pending[i], items);
+        xmlrpc_DECREF(dresult);
     }
 
-    xmlrpc_DECREF(result);
+    xmlrpc_DECREF(results);
+    free(pending);
 
     /* Cleanup */
     xmlrpc_env_clean(&env);
-    xmlrpc_client_cleanup();
 
     return task;
 }
@@ -1284,10 +1561,8 @@ string_list_t *get_all_arches(const struct rpminspect *ri)
     arches = list_add(arches, SRPM_ARCH_NAME);
 
     /* initialize everything and get XMLRPC ready */
-    xmlrpc_limit_set(XMLRPC_XML_SIZE_LIMIT_ID, SIZE_MAX);
     xmlrpc_env_init(&env);
-    xmlrpc_client_init2(&env, XMLRPC_CLIENT_NO_FLAGS, SOFTWARE_NAME, PACKAGE_VERSION, NULL, 0);
-    xmlrpc_abort_on_fault(&env);
+    init_koji_client(&env);
 
     /*
      * call 'getAllArches' on the koji hub
@@ -1313,7 +1588,6 @@ string_list_t *get_all_arches(const struct rpminspect *ri)
     /* is this a valid return value? */
     if (xmlrpc_value_type(result) != XMLRPC_TYPE_ARRAY) {
         xmlrpc_env_clean(&env);
-        xmlrpc_client_cleanup();
         xmlrpc_DECREF(result);
         return NULL;
     }
@@ -1376,7 +1650,6 @@ string_list_t *get_all_arches(const struct rpminspect *ri)
 
     /* Cleanup */
     xmlrpc_env_clean(&env);
-    xmlrpc_client_cleanup();
 
     return arches;
 }
@@ -32,6 +32,27 @@ static void init_magic_cookie(struct rpminspect *ri)
     return;
 }
 
+/*
+ * All of the MIME type strings handed out live in the magic_types
+ * table, so each type is only stored once.
+ */
+static const char *add_mime_type(struct rpminspect *ri, const char *type)
+{
+    string_hash_t *entry = NULL;
+
+    /* look for the type first, add if not found */
+    HASH_FIND_STR(ri->magic_types, type, entry);
+
+    if (entry == NULL) {
+        /* start a new entry for this type */
+        entry = xalloc(sizeof(*entry));
+        entry->data = strdup(type);
+        HASH_ADD_KEYPTR(hh, ri->magic_types, entry->data, strlen(entry->data), entry);
+    }
+
+    return entry->data;
+}
+
 /*
  * Get the MIME type of a file specified by path rather than
  * rpmfile_entry_t.  It does use the open libmagic handle if it's
@@ -42,7 +63,6 @@ const char *mime_type(struct rpminspect *ri, const char *file)
     const char *tmp = NULL;
     char *type = NULL;
     char *pos = NULL;
-    string_hash_t *entry = NULL;
 
     assert(ri != NULL);
 
@@ -65,40 +85,34 @@ const char *mime_type(struct rpminspect *ri, const char *file)
         return NULL;
     }
 
-    if (type != NULL) {
-        /*
-         * Trim any trailing metadata after the MIME type, such
-         * as '; charset=utf-8' and stuff like that.
-         */
-        pos = xstrchr(type, ';');
-
-        if (pos != NULL) {
-            *pos = '\0';
-        }
-
-        /* look for the type first, add if not found */
-        HASH_FIND_STR(ri->magic_types, type, entry);
-
-        if (entry == NULL) {
-            /* start a new entry for this type */
-            entry = xalloc(sizeof(*entry));
-            entry->data = strdup(type);
-            HASH_ADD_KEYPTR(hh, ri->magic_types, entry->data, strlen(entry->data), entry);
-        }
+    /*
+     * Trim any trailing metadata after the MIME type, such
+     * as '; charset=utf-8' and stuff like that.
+     */
+    pos = xstrchr(type, ';');
+
+    if (pos != NULL) {
+        *pos = '\0';
     }
 
+    tmp = add_mime_type(ri, type);
     free(type);
-    return entry->data;
+    return tmp;
 }
 
 /*
  * Return the MIME type of the specified file.  The type is cached in the
  * rpmfile_entry_t.  If that is not NULL, this function returns that value.
  * Otherwise it gets the MIME type, caches it, and returns the value.
- * The caller should not free the pointer returned.
+ * The caller should not free the pointer returned, it points in to
+ * the magic_types table.
  */
-const char *get_mime_type(struct rpminspect *ri, const rpmfile_entry_t *file)
+const char *get_mime_type(struct rpminspect *ri, rpmfile_entry_t *file)
 {
+    char kind[32];
+    char *cached = NULL;
+    const char *type = NULL;
+
     assert(ri != NULL);
     assert(file != NULL);
 
@@ -112,8 +126,21 @@ const char *get_mime_type(struct rpminspect *ri, const rpmfile_entry_t *file)
         return file->type;
     }
 
+    /* or known from an earlier run, results depend on the magic database */
+    snprintf(kind, sizeof(kind), "mime-%d", magic_version());
+    cached = cache_get(file, kind);
+
+    if (cached) {
+        file->type = add_mime_type(ri, cached);
+        free(cached);
+        return file->type;
+    }
+
     /* look it up */
-    return mime_type(ri, file->fullpath);
+    type = mime_type(ri, file->fullpath);
+    cache_put(file, kind, type);
+    file->type = type;
+    return type;
 }
 
 /* Return true if the named file is a text file according to libmagic */
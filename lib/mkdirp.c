@@ -72,7 +72,7 @@ int mkdirp(const char *path, mode_t mode)
                 *p = PATH_SEP;
                 p++;
                 continue;
-            } else if (mkdir(start, mode) == -1) {
+            } else if (mkdir(start, mode) == -1 && errno != EEXIST) { /* EEXIST: lost a race with another process */
                 warn(_("*** unable to mkdir %s"), start);
                 free(start);
                 return -1;
@@ -85,7 +85,7 @@ int mkdirp(const char *path, mode_t mode)
     }
 
     /* final directory */
-    if ((stat(start, &sb) != 0) && (mkdir(start, mode) == -1)) {
+    if ((stat(start, &sb) != 0) && (mkdir(start, mode) == -1) && errno != EEXIST) {
         warn(_("*** unable to mkdir %s"), start);
         free(start);
         return -1;
@@ -32,7 +32,7 @@ void output_json(const results_t *results, const char *dest, __attribute__((unus
     assert(results != NULL);
 
     /* output the results */
-    TAILQ_FOREACH(result, results, items) {
+    TAILQ_FOREACH(result, &results->entries, items) {
         /* Ignore suppressed results */
         if (suppressed_results(results, result->header, suppress)) {
             continue;
@@ -26,7 +26,7 @@ void output_summary(const results_t *results, const char *dest, __attribute__((u
     fprintf(stderr, "*** DEPRECATION WARNING: the '-F summary' or '--format=summary' output mode is deprecated and will be removed in a future release.\n");
 
     /* output the results */
-    TAILQ_FOREACH(result, results, items) {
+    TAILQ_FOREACH(result, &results->entries, items) {
         /* skip conditions */
         if (!strcmp(result->header, NAME_DIAGNOSTICS)
             || (result->verb == VERB_OK && result->noun == NULL)
@@ -28,7 +28,7 @@ void output_text(const results_t *results, const char *dest, __attribute__((unus
     size_t width = tty_width();
 
     /* output the results */
-    TAILQ_FOREACH(result, results, items) {
+    TAILQ_FOREACH(result, &results->entries, items) {
         /* section header */
         if (header == NULL || strcmp(header, result->header)) {
             header = result->header;
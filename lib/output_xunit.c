@@ -27,7 +27,7 @@ void output_xunit(const results_t *results, const char *dest, const severity_t t
     char *cdata = NULL;
 
     /* count up total test cases and total failures */
-    TAILQ_FOREACH(result, results, items) {
+    TAILQ_FOREACH(result, &results->entries, items) {
         if (header == NULL || strcmp(header, result->header)) {
             total++;
         }
@@ -40,7 +40,7 @@ void output_xunit(const results_t *results, const char *dest, const severity_t t
     }
 
     /* output the results */
-    TAILQ_FOREACH(result, results, items) {
+    TAILQ_FOREACH(result, &results->entries, items) {
         /* Ignore suppressed results */
         if (suppressed_results(results, result->header, suppress)) {
             continue;
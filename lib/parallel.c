@@ -5,6 +5,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <errno.h>
 #include <err.h>
 #include <sched.h>
@@ -17,6 +18,9 @@
 
 unsigned default_parallel_processes = 0;
 
+/* number of processes splitting the machine, see share_parallel_processes() */
+static unsigned parallel_shares = 1;
+
 static unsigned available_cpus(void)
 {
 #if 0
@@ -57,6 +61,118 @@ static unsigned available_cpus(void)
 #endif
 }
 
+/*
+ * Return the number of processes to run in parallel by default.  This
+ * is default_parallel_processes if set (e.g., by the -j option),
+ * otherwise the number of CPUs available to us.
+ */
+unsigned get_parallel_processes(void)
+{
+    unsigned max = default_parallel_processes;
+
+    if (max == 0) {
+        max = available_cpus();
+
+        if ((int)max <= 0) { /* paranoia */
+            max = 1;
+        }
+
+        if (max > 1024) { /* paranoia */
+            max = 1024;
+        }
+
+        default_parallel_processes = max;
+    }
+
+    return max;
+}
+
+/*
+ * Called in a child process that runs alongside shares - 1 others,
+ * each of which may start processes of its own.  The children split
+ * get_parallel_processes() between them, rather than each of them
+ * starting that many processes, so the total stays about the same.
+ */
+void share_parallel_processes(const unsigned shares)
+{
+    unsigned max = get_parallel_processes();
+
+    if (shares > 1) {
+        max /= shares;
+        parallel_shares = shares;
+    }
+
+    default_parallel_processes = (max == 0) ? 1 : max;
+    return;
+}
+
+/*
+ * Return the memory available for new processes in bytes, which is
+ * MemAvailable from /proc/meminfo.  That counts the page cache that
+ * can be reclaimed, unlike _SC_AVPHYS_PAGES which is only used if
+ * /proc/meminfo cannot be read.  Returns 0 if unknown.
+ */
+static unsigned long long available_memory(void)
+{
+    FILE *fp = NULL;
+    char line[BUFSIZ];
+    unsigned long long kb = 0;
+    unsigned long long avail = 0;
+    long pages = 0;
+    long pagesize = 0;
+
+    fp = fopen("/proc/meminfo", "r");
+
+    if (fp != NULL) {
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            if (sscanf(line, "MemAvailable: %llu kB", &kb) == 1) {
+                avail = kb * 1024;
+                break;
+            }
+        }
+
+        if (fclose(fp) != 0) {
+            warn("*** fclose");
+        }
+    }
+
+    if (avail == 0) {
+        pages = sysconf(_SC_AVPHYS_PAGES);
+        pagesize = sysconf(_SC_PAGESIZE);
+
+        if (pages > 0 && pagesize > 0) {
+            avail = (unsigned long long) pages * pagesize;
+        }
+    }
+
+    return avail;
+}
+
+/*
+ * Return the number of processes to run in parallel when each one is
+ * expected to use up to per_process bytes of memory.  This is
+ * get_parallel_processes() lowered so the processes fit in this
+ * process's share of the available memory (see
+ * share_parallel_processes()), but never less than 1.
+ */
+unsigned get_memory_limited_processes(const unsigned long long per_process)
+{
+    unsigned max = get_parallel_processes();
+    unsigned long long avail = available_memory();
+
+    if (per_process == 0 || avail == 0) {
+        return max;
+    }
+
+    avail /= parallel_shares;
+
+    if (avail / per_process < max) {
+        max = avail / per_process;
+    }
+
+    return (max == 0) ? 1 : max;
+}
+
 /* If MAX > 0: prepare for up to MAX processes.
  *
  * If MAX is 0, default_parallel_processes is used
@@ -81,21 +197,7 @@ parallel_t *new_parallel(int max)
     }
 
     if (max <= 0) {
-        max = default_parallel_processes;
-
-        if (max <= 0) {
-            max = available_cpus();
-
-            if ((int)max <= 0) { /* paranoia */
-                max = 1;
-            }
-
-            if (max > 1024) { /* paranoia */
-                max = 1024;
-            }
-
-            default_parallel_processes = max;
-        }
+        max = get_parallel_processes();
     }
 
     max_pids *= max;
@@ -197,11 +299,24 @@ parallel_slot_t* collect_one(parallel_t *col)
             if (r > 0) {
                 unsigned newsz = slot->output_len + r;
 
-                if (newsz > col->max_len) { /* usually just paranoia check */
+                /* max_len 0 means no limit beyond what fits the counters */
+                if ((col->max_len && newsz > col->max_len) || newsz > UINT_MAX / 2) {
                     errx(EXIT_FAILURE, "maximum length of output exceeded: %u", newsz);
                 }
 
-                slot->output = xrealloc(slot->output, newsz + 1);
+                /* grow the buffer by doubling to keep big outputs linear */
+                if (slot->output == NULL || newsz + 1 > slot->output_size) {
+                    if (slot->output == NULL || slot->output_size == 0) {
+                        slot->output_size = sizeof(buf);
+                    }
+
+                    while (newsz + 1 > slot->output_size) {
+                        slot->output_size *= 2;
+                    }
+
+                    slot->output = xrealloc(slot->output, slot->output_size);
+                }
+
                 char *end = mempcpy(slot->output + slot->output_len, buf, r);
                 *end = '\0';
                 slot->output_len = newsz;
@@ -259,6 +374,7 @@ void insert_new_pid_and_fd(parallel_t *col, pid_t pid, int fd)
             free(slot->output);
             slot->output = NULL;
             slot->output_len = 0;
+            slot->output_size = 0;
             return;
         }
     }
@@ -10,7 +10,6 @@
 #include <limits.h>
 #include <assert.h>
 #include <err.h>
-#include <glob.h>
 #include <fnmatch.h>
 #include <rpm/header.h>
 #include <rpm/rpmtag.h>
@@ -192,135 +191,364 @@ bool usable_path(const char *path)
 }
 
 /*
- * Helper function for glob(7) matching given a path string and
- * (optional) root directory.
+ * Expand the GLOB_BRACE alternatives in pattern the same way glob(3)
+ * does.  The first unescaped '{' with a matching '}' is replaced by
+ * each comma separated alternative in turn and the result is
+ * expanded again, which handles nested and multiple brace
+ * expressions.  If the first '{' is unmatched, glob(3) takes the
+ * whole pattern literally and so do we.  Expansions are added to
+ * list, which is returned.
  */
-bool match_path(const char *pattern, const char *root, const char *path)
+static string_list_t *expand_braces(string_list_t *list, const char *pattern)
 {
-    bool match = false;
-    int r = 0;
-    int flags = FNM_NOESCAPE;
-    int gflags = GLOB_NOSORT;
-    char globpath[PATH_MAX + 1];
-    char *globsub = NULL;
-    char *gp = globpath;
-    glob_t found;
-    size_t len = 0;
-    size_t i = 0;
-    char *n = NULL;
+    int depth = 0;
+    const char *p = NULL;
+    const char *open = NULL;
+    const char *close = NULL;
+    const char *start = NULL;
+    char *alt = NULL;
 
     assert(pattern != NULL);
-    assert(path != NULL);
 
-    /* Simple check first */
-    if (!strcmp(pattern, path)) {
-        return true;
+    /* find the first unescaped '{' and its matching '}' */
+    for (p = pattern; *p != '\0' && open == NULL; p++) {
+        if (*p == '\\' && *(p + 1) != '\0') {
+            p++;
+            continue;
+        }
+
+        if (*p != '{') {
+            continue;
+        }
+
+        for (close = p; *close != '\0'; close++) {
+            if (*close == '\\' && *(close + 1) != '\0') {
+                close++;
+            } else if (*close == '{') {
+                depth++;
+            } else if (*close == '}' && --depth == 0) {
+                break;
+            }
+        }
+
+        if (*close != '}') {
+            return list_add(list, pattern);
+        }
+
+        open = p;
     }
 
-    /* Try a simple glob match */
-    if (!fnmatch(pattern, path, flags)) {
-        return true;
+    if (open == NULL) {
+        return list_add(list, pattern);
     }
 
-    /* A pattern ending with PATH_SEP will match a path prefix */
-    if (strsuffix(pattern, "/") && strprefix(path, pattern)) {
-        return true;
+    /* substitute each top level alternative and expand the result */
+    start = open + 1;
+    depth = 0;
+
+    for (p = open + 1; p <= close; p++) {
+        if (*p == '\\' && p < close) {
+            p++;
+        } else if (*p == '{') {
+            depth++;
+        } else if (*p == '}' && depth > 0) {
+            depth--;
+        } else if ((*p == ',' && depth == 0) || p == close) {
+            xasprintf(&alt, "%.*s%.*s%s", (int) (open - pattern), pattern, (int) (p - start), start, close + 1);
+            list = expand_braces(list, alt);
+            free(alt);
+            start = p + 1;
+        }
     }
 
+    return list;
+}
+
+/*
+ * Compile a single glob(7) pattern for path_glob_match().
+ */
+static path_glob_t *compile_path_glob(const char *pattern)
+{
+    path_glob_t *glob = NULL;
+
+    assert(pattern != NULL);
+
+    glob = xalloc(sizeof(*glob));
+    glob->pattern = strdup(pattern);
+    assert(glob->pattern != NULL);
+
     /*
-     * Also handle the incredibly common case of the trailing PATH_SEP
+     * A pattern ending with PATH_SEP will match a path prefix.  Also
+     * handle the incredibly common case of the trailing PATH_SEP
      * where users specify an asterisk after the slash to mean
      * everything below this directory.
      */
-    if (strsuffix(pattern, "/*")) {
-        globsub = strdup(pattern);
-        assert(globsub != NULL);
-        globsub[strlen(globsub) - 1] = '\0';
+    if (strsuffix(pattern, "/")) {
+        glob->prefix = strdup(pattern);
+        assert(glob->prefix != NULL);
+    } else if (strsuffix(pattern, "/*")) {
+        glob->prefix = strndup(pattern, strlen(pattern) - 1);
+        assert(glob->prefix != NULL);
+    }
 
-        if (globsub && strprefix(path, globsub)) {
-            free(globsub);
-            return true;
-        }
+    /* match on the leading subdirectory */
+    glob->leading_dir = (strsuffix(pattern, "*") || strsuffix(pattern, "?"));
 
-        free(globsub);
+    /*
+     * The remaining glob(3) behavior that fnmatch(3) does not
+     * already cover is brace expansion and backslash escapes.
+     */
+    if (strpbrk(pattern, "{\\") != NULL) {
+        glob->alternatives = expand_braces(NULL, pattern);
+    }
+
+    return glob;
+}
+
+static void free_path_glob(path_glob_t *glob)
+{
+    if (glob == NULL) {
+        return;
+    }
+
+    free(glob->pattern);
+    free(glob->prefix);
+    list_free(glob->alternatives, free);
+    free(glob);
+    return;
+}
+
+/*
+ * Match a path string against a compiled pattern.  This used to
+ * fall through to glob(3) under the package root, which scanned the
+ * filesystem for every file and pattern.  Matching the path string
+ * directly gives the same answer for files in the package:
+ * GLOB_PERIOD lets wildcards match a leading '.', which fnmatch(3)
+ * already does without FNM_PERIOD, and glob(3) wildcards do not
+ * cross a PATH_SEP, which is FNM_PATHNAME.
+ */
+static bool path_glob_match(const path_glob_t *glob, const char *path)
+{
+    string_entry_t *alt = NULL;
+
+    assert(glob != NULL);
+    assert(path != NULL);
+
+    /* Try a simple glob match */
+    if (!fnmatch(glob->pattern, path, FNM_NOESCAPE)) {
+        return true;
+    }
+
+    /* Directory prefix match */
+    if (glob->prefix != NULL && strprefix(path, glob->prefix)) {
+        return true;
     }
 
     /* Try a match on the leading subdirectory */
-    if ((strsuffix(pattern, "*") || strsuffix(pattern, "?")) && !fnmatch(pattern, path, FNM_LEADING_DIR)) {
+    if (glob->leading_dir && !fnmatch(glob->pattern, path, FNM_LEADING_DIR)) {
         return true;
     }
 
-    /* Fall through to glob(3) matching */
-#ifdef GLOB_BRACE
-    /* this is a GNU extension, see glob(3) */
-    gflags |= GLOB_BRACE;
-#endif
+    /* What glob(3) with GLOB_BRACE and GLOB_PERIOD would match */
+    if (glob->alternatives != NULL) {
+        TAILQ_FOREACH(alt, glob->alternatives, items) {
+            if (!fnmatch(alt->data, path, FNM_PATHNAME)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
 
-#ifdef GLOB_PERIOD
-    /* this is a GNU extension, see glob(3) */
-    gflags |= GLOB_PERIOD;
-#endif
+/*
+ * Helper function for glob(7) matching given a path string.  The
+ * root directory is no longer needed since matching works on the
+ * path string alone, but it is kept for existing callers.
+ */
+bool match_path(const char *pattern, __attribute__((unused)) const char *root, const char *path)
+{
+    bool match = false;
+    path_glob_t *glob = NULL;
 
-    n = strdup(path);
-    assert(n != NULL);
+    assert(pattern != NULL);
+    assert(path != NULL);
 
-    if (root != NULL) {
-        len = strlen(root);
+    /* Simple check first */
+    if (!strcmp(pattern, path)) {
+        return true;
     }
 
-    memset(globpath, 0, sizeof(globpath));
+    glob = compile_path_glob(pattern);
+    match = path_glob_match(glob, path);
+    free_path_glob(glob);
 
-    if (root != NULL) {
-        gp = stpcpy(gp, root);
-    }
+    return match;
+}
 
-    free(n);
+/*
+ * Compile a list of glob(7) patterns in to a path_matcher_t.
+ * Patterns without any glob characters go in a hash table for exact
+ * matching; everything else is compiled with compile_path_glob().
+ * Returns NULL for an empty list.
+ */
+path_matcher_t *compile_path_matcher(const string_list_t *patterns)
+{
+    path_matcher_t *matcher = NULL;
+    path_glob_t *glob = NULL;
+    string_entry_t *entry = NULL;
+    string_hash_t *hentry = NULL;
 
-    if (!strsuffix(globpath, "/") && !strprefix(pattern, "/")) {
-        gp = stpcpy(gp, "/");
-        len++;
+    if (patterns == NULL || TAILQ_EMPTY(patterns)) {
+        return NULL;
     }
 
-    (void) stpcpy(gp, pattern);
-    r = glob(globpath, gflags, NULL, &found);
+    matcher = xalloc(sizeof(*matcher));
+    matcher->globs = xalloc(sizeof(*matcher->globs));
+    TAILQ_INIT(matcher->globs);
+
+    TAILQ_FOREACH(entry, patterns, items) {
+        if (strpbrk(entry->data, "*?[{\\") == NULL && !strsuffix(entry->data, "/")) {
+            HASH_FIND_STR(matcher->exact, entry->data, hentry);
+
+            if (hentry == NULL) {
+                hentry = xalloc(sizeof(*hentry));
+                hentry->data = strdup(entry->data);
+                assert(hentry->data != NULL);
+                HASH_ADD_KEYPTR(hh, matcher->exact, hentry->data, strlen(hentry->data), hentry);
+            }
+
+            continue;
+        }
 
-    if (r == GLOB_NOSPACE || r == GLOB_ABORTED) {
-        warn("*** glob");
+        glob = compile_path_glob(entry->data);
+        TAILQ_INSERT_TAIL(matcher->globs, glob, items);
     }
 
-    if (r != 0) {
+    return matcher;
+}
+
+/*
+ * Return true if path matches any pattern in the matcher.
+ */
+bool path_matcher_match(const path_matcher_t *matcher, const char *path)
+{
+    string_hash_t *hentry = NULL;
+    path_glob_t *glob = NULL;
+
+    assert(path != NULL);
+
+    if (matcher == NULL) {
         return false;
     }
 
-    for (i = 0; i < found.gl_pathc; i++) {
-        globsub = found.gl_pathv[i] + len;
+    HASH_FIND_STR(matcher->exact, path, hentry);
 
-        if (!strcmp(globsub, path)) {
-            match = true;
-            break;
+    if (hentry != NULL) {
+        return true;
+    }
+
+    TAILQ_FOREACH(glob, matcher->globs, items) {
+        if (path_glob_match(glob, path)) {
+            return true;
         }
     }
 
-    globfree(&found);
+    return false;
+}
 
-    return match;
+void free_path_matcher(path_matcher_t *matcher)
+{
+    path_glob_t *glob = NULL;
+
+    if (matcher == NULL) {
+        return;
+    }
+
+    free_string_hash(matcher->exact);
+
+    while (!TAILQ_EMPTY(matcher->globs)) {
+        glob = TAILQ_FIRST(matcher->globs);
+        TAILQ_REMOVE(matcher->globs, glob, items);
+        free_path_glob(glob);
+    }
+
+    free(matcher->globs);
+    free(matcher);
+    return;
+}
+
+/*
+ * Free the compiled ignore lists in the struct rpminspect.
+ */
+void free_ignores(struct rpminspect *ri)
+{
+    path_matcher_map_t *mapentry = NULL;
+    path_matcher_map_t *tmp_mapentry = NULL;
+
+    assert(ri != NULL);
+
+    free_path_matcher(ri->ignore_matcher);
+    ri->ignore_matcher = NULL;
+
+    HASH_ITER(hh, ri->inspection_ignore_matchers, mapentry, tmp_mapentry) {
+        HASH_DEL(ri->inspection_ignore_matchers, mapentry);
+        free(mapentry->key);
+        free_path_matcher(mapentry->value);
+        free(mapentry);
+    }
+
+    ri->inspection_ignore_matchers = NULL;
+    return;
+}
+
+/*
+ * Compile the global and per-inspection ignore lists read from the
+ * configuration files.  Called once all configuration files have
+ * been read.
+ */
+void compile_ignores(struct rpminspect *ri)
+{
+    string_list_map_t *ignentry = NULL;
+    string_list_map_t *tmp_ignentry = NULL;
+    path_matcher_map_t *mapentry = NULL;
+
+    assert(ri != NULL);
+
+    free_ignores(ri);
+    ri->ignore_matcher = compile_path_matcher(ri->ignores);
+
+    HASH_ITER(hh, ri->inspection_ignores, ignentry, tmp_ignentry) {
+        if (ignentry->value == NULL || TAILQ_EMPTY(ignentry->value)) {
+            continue;
+        }
+
+        mapentry = xalloc(sizeof(*mapentry));
+        mapentry->key = strdup(ignentry->key);
+        assert(mapentry->key != NULL);
+        mapentry->value = compile_path_matcher(ignentry->value);
+        HASH_ADD_KEYPTR(hh, ri->inspection_ignore_matchers, mapentry->key, strlen(mapentry->key), mapentry);
+    }
+
+    return;
 }
 
 /**
  * @brief Given a path and struct rpminspect, determine if the path
  * should be ignored or not.
  *
+ * The ignore lists are compiled by compile_ignores() when the
+ * configuration is loaded, so this only looks at the path string.
+ *
  * @param ri The struct rpminspect for the program.
  * @param inspection The name of the inspection currently running.
  * @param path The relative path to check (i.e., localpath).
- * @param root The root directory, optional (pass NULL to use PATH_SEP).
+ * @param root The root directory, unused.
  * @return True if path should be ignored, false otherwise.
  */
-bool ignore_path(const struct rpminspect *ri, const char *inspection, const char *path, const char *root)
+bool ignore_path(const struct rpminspect *ri, const char *inspection, const char *path, __attribute__((unused)) const char *root)
 {
-    bool match = false;
-    string_entry_t *entry = NULL;
-    string_list_map_t *mapentry = NULL;
+    path_matcher_map_t *mapentry = NULL;
 
     assert(ri != NULL);
     assert(inspection != NULL);
@@ -330,32 +558,20 @@ bool ignore_path(const struct rpminspect *ri, const char *inspection, const char
     }
 
     /* first, handle the global ignores */
-    if (ri->ignores != NULL && !TAILQ_EMPTY(ri->ignores)) {
-        TAILQ_FOREACH(entry, ri->ignores, items) {
-            match = match_path(entry->data, root, path);
-
-            if (match) {
-                return match;
-            }
-        }
+    if (path_matcher_match(ri->ignore_matcher, path)) {
+        return true;
     }
 
     /* second, handle the per-inspection ignores */
-    if (ri->inspection_ignores != NULL) {
-        HASH_FIND_STR(ri->inspection_ignores, inspection, mapentry);
+    if (ri->inspection_ignore_matchers != NULL) {
+        HASH_FIND_STR(ri->inspection_ignore_matchers, inspection, mapentry);
 
-        if (mapentry != NULL && mapentry->value != NULL && !TAILQ_EMPTY(mapentry->value)) {
-            TAILQ_FOREACH(entry, mapentry->value, items) {
-                match = match_path(entry->data, root, path);
-
-                if (match) {
-                    return match;
-                }
-            }
+        if (mapentry != NULL && path_matcher_match(mapentry->value, path)) {
+            return true;
         }
     }
 
-    return match;
+    return false;
 }
 
 /**
@@ -369,23 +585,9 @@ bool ignore_path(const struct rpminspect *ri, const char *inspection, const char
  */
 bool ignore_rpmfile_entry(const struct rpminspect *ri, const char *inspection, const rpmfile_entry_t *file)
 {
-    bool ignore = false;
-    char *head = NULL;
-    char save;
-
     assert(ri != NULL);
     assert(inspection != NULL);
     assert(file != NULL);
 
-    head = file->fullpath;
-    head += strlen(head) - strlen(file->localpath);
-    save = *head;
-    *head = '\0';
-
-    ignore = ignore_path(ri, inspection, file->localpath, file->fullpath);
-
-    *head = save;
-    head = NULL;
-
-    return ignore;
+    return ignore_path(ri, inspection, file->localpath, NULL);
 }
@@ -4,10 +4,26 @@
  */
 
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
 #include <assert.h>
 #include <err.h>
 
 #include "rpminspect.h"
+#include "parallel.h"
+
+/*
+ * One side of a peer to extract.  extract_peers() uses these to map
+ * collector slots back to the package being extracted.
+ */
+struct extract_job {
+    rpmpeer_entry_t *peer;
+    int whichbuild;
+    bool pending;
+};
 
 /*
  * Initialize a new rpmpeer_t list.
@@ -146,12 +162,142 @@ void add_peer(rpmpeer_t **peers, deprule_ignore_map_t *ignores, int whichbuild,
     return;
 }
 
+/*
+ * Fork a child process to extract one package.  The child writes the
+ * extraction root and file list to the pipe (see write_files()).
+ */
+static void start_extraction(struct rpminspect *ri, parallel_t *col, int *running, const struct extract_job *job, const int jobidx)
+{
+    int pipefd[2];
+    pid_t pid;
+    unsigned int i = 0;
+    char *root = NULL;
+    rpmfile_t *files = NULL;
+    FILE *fp = NULL;
+
+    if (pipe(pipefd)) {
+        err(RI_PROGRAM_ERROR, "*** pipe");
+    }
+
+    pid = fork();
+
+    if (pid < 0) {
+        err(RI_PROGRAM_ERROR, "*** fork");
+    }
+
+    if (pid == 0) {
+        /* child */
+        if (close(pipefd[0]) == -1) {
+            warn("*** close");
+        }
+
+        if (job->whichbuild == BEFORE_BUILD) {
+            files = extract_rpm(ri, job->peer->before_rpm, job->peer->before_hdr, BEFORE_SUBDIR, &root, need_payload(ri));
+        } else {
+            files = extract_rpm(ri, job->peer->after_rpm, job->peer->after_hdr, AFTER_SUBDIR, &root, need_payload(ri));
+        }
+
+        fp = fdopen(pipefd[1], "w");
+
+        if (fp == NULL) {
+            err(RI_PROGRAM_ERROR, "*** fdopen");
+        }
+
+        if (!write_files(fp, root, files) || fclose(fp) != 0) {
+            errx(RI_PROGRAM_ERROR, _("*** unable to write file list for %s"), (job->whichbuild == BEFORE_BUILD) ? job->peer->before_rpm : job->peer->after_rpm);
+        }
+
+        _exit(RI_SUCCESS);
+    }
+
+    /* parent */
+    if (close(pipefd[1]) == -1) {
+        warn("*** close");
+    }
+
+    insert_new_pid_and_fd(col, pid, pipefd[0]);
+
+    for (i = 0; i < col->max_pids; i++) {
+        if (col->slot[i].pid == pid) {
+            running[i] = jobidx;
+            break;
+        }
+    }
+
+    return;
+}
+
+/*
+ * Process the output of one finished extraction child process.  Once
+ * both sides of a peer are extracted, match up the file peers.
+ */
+static void collect_extraction(struct rpminspect *ri, parallel_t *col, parallel_slot_t *slot, const int *running, struct extract_job *jobs)
+{
+    int i = 0;
+    int r = 0;
+    bool ok = false;
+    struct extract_job *job = NULL;
+    rpmpeer_entry_t *peer = NULL;
+
+    assert(slot != NULL);
+
+    i = running[slot - col->slot];
+    job = &jobs[i];
+    peer = job->peer;
+    r = slot->exit_status;
+
+    if (!WIFEXITED(r)) {
+        delete_parallel(col, SIGTERM);
+        errx(RI_PROGRAM_ERROR, _("*** package extraction killed by signal %u"), WTERMSIG(r));
+    }
+
+    if (WEXITSTATUS(r) != 0) {
+        /* the child already reported why, exit the same way */
+        delete_parallel(col, SIGTERM);
+        exit(WEXITSTATUS(r));
+    }
+
+    if (job->whichbuild == BEFORE_BUILD) {
+        peer->before_files = read_files(slot->output, slot->output_len, peer->before_hdr, &peer->before_root, &ok);
+    } else {
+        peer->after_files = read_files(slot->output, slot->output_len, peer->after_hdr, &peer->after_root, &ok);
+    }
+
+    if (!ok) {
+        delete_parallel(col, SIGTERM);
+        errx(RI_PROGRAM_ERROR, _("*** unable to read file list for %s"), (job->whichbuild == BEFORE_BUILD) ? peer->before_rpm : peer->after_rpm);
+    }
+
+    free(slot->output);
+    slot->output = NULL;
+    slot->output_len = 0;
+    slot->output_size = 0;
+    job->pending = false;
+
+    /* jobs come in before/after pairs, match up file peers when both are done */
+    i -= (i % 2);
+
+    if (!jobs[i].pending && !jobs[i + 1].pending && peer->before_files && peer->after_files) {
+        find_file_peers(ri, peer->before_files, peer->after_files);
+    }
+
+    return;
+}
+
 int extract_peers(struct rpminspect *ri, bool fetchonly)
 {
     unsigned long int avail = 0;
+    bool contents = true;
     char *availh = NULL;
     char *needh = NULL;
     rpmpeer_entry_t *peer = NULL;
+    unsigned int max = 0;
+    int i = 0;
+    int npeers = 0;
+    int *running = NULL;
+    struct extract_job *jobs = NULL;
+    parallel_t *col = NULL;
+    parallel_slot_t *slot = NULL;
 
     if (fetchonly) {
         return RI_SUCCESS;
@@ -165,11 +311,20 @@ int extract_peers(struct rpminspect *ri, bool fetchonly)
     TAILQ_FOREACH(peer, ri->peers, items) {
         ri->unpacked_size += peer->before_unpacked_size;
         ri->unpacked_size += peer->after_unpacked_size;
+        npeers++;
     }
 
-    avail = get_available_space(ri->workdir);
+    /*
+     * If the selected inspections only look at headers and file
+     * lists, the payloads are read but not written to the workdir.
+     */
+    contents = need_payload(ri);
+
+    if (contents) {
+        avail = get_available_space(ri->workdir);
+    }
 
-    if (avail < ri->unpacked_size) {
+    if (contents && avail < ri->unpacked_size) {
         availh = human_size(avail);
         needh = human_size(ri->unpacked_size);
 
@@ -182,23 +337,81 @@ int extract_peers(struct rpminspect *ri, bool fetchonly)
         return RI_INSUFFICIENT_SPACE;
     }
 
-    /* unpack all RPMs */
-    TAILQ_FOREACH(peer, ri->peers, items) {
-        /* extract the before peer */
-        if (peer->before_hdr && peer->before_rpm) {
-            peer->before_files = extract_rpm(ri, peer->before_rpm, peer->before_hdr, BEFORE_SUBDIR, &peer->before_root);
+    /*
+     * Packages are extracted in parallel, one per process.  The number
+     * of processes is limited by the CPU count (or -j) and optionally
+     * by the extract_jobs setting for storage bound systems.
+     */
+    max = get_parallel_processes();
+
+    if (ri->extract_jobs > 0 && ri->extract_jobs < max) {
+        max = ri->extract_jobs;
+    }
+
+    if (max == 1) {
+        /* unpack all RPMs */
+        TAILQ_FOREACH(peer, ri->peers, items) {
+            /* extract the before peer */
+            if (peer->before_hdr && peer->before_rpm) {
+                peer->before_files = extract_rpm(ri, peer->before_rpm, peer->before_hdr, BEFORE_SUBDIR, &peer->before_root, contents);
+            }
+
+            /* extract the after peer */
+            if (peer->after_hdr && peer->after_rpm) {
+                peer->after_files = extract_rpm(ri, peer->after_rpm, peer->after_hdr, AFTER_SUBDIR, &peer->after_root, contents);
+            }
+
+            /* match up file peers between builds */
+            if (peer->before_files && peer->after_files) {
+                find_file_peers(ri, peer->before_files, peer->after_files);
+            }
         }
 
-        /* extract the after peer */
-        if (peer->after_hdr && peer->after_rpm) {
-            peer->after_files = extract_rpm(ri, peer->after_rpm, peer->after_hdr, AFTER_SUBDIR, &peer->after_root);
+        return RI_SUCCESS;
+    }
+
+    /* two jobs per peer, before and after */
+    jobs = xcalloc(npeers * 2, sizeof(*jobs));
+    i = 0;
+
+    TAILQ_FOREACH(peer, ri->peers, items) {
+        jobs[i].peer = peer;
+        jobs[i].whichbuild = BEFORE_BUILD;
+        jobs[i].pending = (peer->before_hdr && peer->before_rpm);
+        jobs[i + 1].peer = peer;
+        jobs[i + 1].whichbuild = AFTER_BUILD;
+        jobs[i + 1].pending = (peer->after_hdr && peer->after_rpm);
+        i += 2;
+    }
+
+    fflush(NULL);
+    col = new_parallel(max);
+
+    /* a file list can be any size, same as extracting serially */
+    col->max_len = 0;
+    running = xcalloc(col->max_pids, sizeof(*running));
+
+    for (i = 0; i < (npeers * 2); i++) {
+        if (!jobs[i].pending) {
+            continue;
         }
 
-        /* match up file peers between builds */
-        if (peer->before_files && peer->after_files) {
-            find_file_peers(ri, peer->before_files, peer->after_files);
+        /* wait for a free slot */
+        while (col->running == col->max_pids) {
+            slot = collect_one(col);
+            collect_extraction(ri, col, slot, running, jobs);
         }
+
+        start_extraction(ri, col, running, &jobs[i], i);
+    }
+
+    while ((slot = collect_one(col)) != NULL) {
+        collect_extraction(ri, col, slot, running, jobs);
     }
 
+    delete_parallel(col, 0);
+    free(running);
+    free(jobs);
+
     return RI_SUCCESS;
 }
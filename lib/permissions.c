@@ -18,7 +18,7 @@
 
 #include "rpminspect.h"
 
-bool check_permissions(struct rpminspect *ri, const rpmfile_entry_t *file, const char *header, bool *reported, bool force_non_security_checks)
+bool check_permissions(struct rpminspect *ri, rpmfile_entry_t *file, const char *header, bool *reported, bool force_non_security_checks)
 {
     bool result = true;
     bool ignore = false;
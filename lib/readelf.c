@@ -62,7 +62,13 @@ GElf_Half get_elf_machine(Elf *elf)
     return _get_elf_helper(elf, ELF_MACHINE, EM_NONE);
 }
 
-static Elf *get_elf_with_kind(const char *fullpath, int *out_fd, Elf_Kind kind)
+/*
+ * Open fullpath with libelf.  Returns NULL if the file is not a
+ * regular file or cannot be read, otherwise the Elf handle, which may
+ * be of any kind including ELF_K_NONE.  On success, the opened file
+ * descriptor is written to out_fd.
+ */
+static Elf *open_elf(const char *fullpath, int *out_fd)
 {
     int fd;
     Elf *elf = NULL;
@@ -90,7 +96,7 @@ static Elf *get_elf_with_kind(const char *fullpath, int *out_fd, Elf_Kind kind)
         return NULL;
     }
 
-    /* verify we can access the file and it's an ELF object */
+    /* verify we can access the file */
     if ((fd = open(fullpath, O_RDONLY)) == -1) {
         return NULL;
     }
@@ -107,6 +113,21 @@ static Elf *get_elf_with_kind(const char *fullpath, int *out_fd, Elf_Kind kind)
         return NULL;
     }
 
+    *out_fd = fd;
+    return elf;
+}
+
+static Elf *get_elf_with_kind(const char *fullpath, int *out_fd, Elf_Kind kind)
+{
+    int fd;
+    Elf *elf = NULL;
+
+    elf = open_elf(fullpath, &fd);
+
+    if (elf == NULL) {
+        return NULL;
+    }
+
     if (elf_kind(elf) == kind) {
         *out_fd = fd;
         return elf;
@@ -154,25 +175,62 @@ bool is_elf(rpmfile_entry_t *file)
     return (is_elf_file(file) || is_elf_archive(file));
 }
 
-static bool _is_elf_type(rpmfile_entry_t *file, int type)
+/*
+ * Fill in all of the is_elf_* flags of the file with a single open,
+ * or from the analysis cache if an earlier run looked at the same
+ * file.
+ */
+static void classify_elf(rpmfile_entry_t *file)
 {
-    bool result = false;
-    int fd = 0;
+    int fd = -1;
     Elf *elf = NULL;
+    char *cached = NULL;
+    char value[32];
+    GElf_Half type = ET_NONE;
 
-    elf = get_elf(file, &fd);
+    cached = cache_get(file, "elf");
 
-    if (elf && get_elf_type(elf) == type) {
-        result = true;
+    if (cached && sscanf(cached, "%hhd %hhd %hhd %hhd", &file->is_elf_file, &file->is_elf_archive, &file->is_elf_executable, &file->is_elf_shared_library) == 4) {
+        free(cached);
+        return;
+    }
+
+    free(cached);
+
+    /* -1 "no", 1 "yes" */
+    file->is_elf_file = -1;
+    file->is_elf_archive = -1;
+    file->is_elf_executable = -1;
+    file->is_elf_shared_library = -1;
+
+    elf = open_elf(file->fullpath, &fd);
+
+    if (elf == NULL) {
+        return;
+    }
+
+    if (elf_kind(elf) == ELF_K_ELF) {
+        file->is_elf_file = 1;
+        type = get_elf_type(elf);
+
+        if (type == ET_EXEC) {
+            file->is_elf_executable = 1;
+        } else if (type == ET_DYN) {
+            file->is_elf_shared_library = 1;
+        }
+    } else if (elf_kind(elf) == ELF_K_AR) {
+        file->is_elf_archive = 1;
     }
 
     elf_end(elf);
 
-    if (fd) {
-        close(fd);
+    if (close(fd) == -1) {
+        warn("*** close");
     }
 
-    return result;
+    snprintf(value, sizeof(value), "%d %d %d %d", file->is_elf_file, file->is_elf_archive, file->is_elf_executable, file->is_elf_shared_library);
+    cache_put(file, "elf", value);
+    return;
 }
 
 /*
@@ -182,13 +240,11 @@ static bool _is_elf_type(rpmfile_entry_t *file, int type)
 bool is_elf_shared_library(rpmfile_entry_t *file)
 {
     /* -1 "no", 1 "yes", 0 "don't know yet" */
-    if (file->is_elf_shared_library != 0) {
-        return (file->is_elf_shared_library + 1) >> 1; /* return 1/0 for "yes" / "no" */
+    if (file->is_elf_shared_library == 0) {
+        classify_elf(file);
     }
 
-    bool r = _is_elf_type(file, ET_DYN);
-    file->is_elf_shared_library = r ? 1 : -1;
-    return r;
+    return file->is_elf_shared_library == 1;
 }
 
 /*
@@ -198,13 +254,11 @@ bool is_elf_shared_library(rpmfile_entry_t *file)
 bool is_elf_executable(rpmfile_entry_t *file)
 {
     /* -1 "no", 1 "yes", 0 "don't know yet" */
-    if (file->is_elf_executable != 0) {
-        return (file->is_elf_executable + 1) >> 1; /* return 1/0 for "yes" / "no" */
+    if (file->is_elf_executable == 0) {
+        classify_elf(file);
     }
 
-    bool r = _is_elf_type(file, ET_EXEC);
-    file->is_elf_executable = r ? 1 : -1;
-    return r;
+    return file->is_elf_executable == 1;
 }
 
 /*
@@ -213,27 +267,11 @@ bool is_elf_executable(rpmfile_entry_t *file)
 bool is_elf_file(rpmfile_entry_t *file)
 {
     /* -1 "no", 1 "yes", 0 "don't know yet" */
-    if (file->is_elf_file != 0) {
-        return (file->is_elf_file + 1) >> 1; /* return 1/0 for "yes" / "no" */
+    if (file->is_elf_file == 0) {
+        classify_elf(file);
     }
 
-    int fd = 0;
-    Elf *elf = NULL;
-
-    /* try it as a shared object */
-    elf = get_elf(file, &fd); /* sets file->is_elf_file to 1 or -1 */
-
-    if (elf) {
-        elf_end(elf);
-
-        if (fd) {
-            close(fd);
-        }
-
-        return true;
-    }
-
-    return false;
+    return file->is_elf_file == 1;
 }
 
 /*
@@ -242,27 +280,11 @@ bool is_elf_file(rpmfile_entry_t *file)
 bool is_elf_archive(rpmfile_entry_t *file)
 {
     /* -1 "no", 1 "yes", 0 "don't know yet" */
-    if (file->is_elf_archive != 0) {
-        return (file->is_elf_archive + 1) >> 1; /* return 1/0 for "yes" / "no" */
-    }
-
-    int fd = 0;
-    Elf *elf = NULL;
-
-    /* try it as a static library */
-    elf = get_elf_archive(file, &fd); /* sets is_elf_archive to 1 or -1 */
-
-    if (elf) {
-        elf_end(elf);
-
-        if (fd) {
-            close(fd);
-        }
-
-        return true;
+    if (file->is_elf_archive == 0) {
+        classify_elf(file);
     }
 
-    return false;
+    return file->is_elf_archive == 1;
 }
 
 bool have_elf_section(Elf *elf, int64_t section, const char *name)
@@ -508,36 +530,18 @@ GElf_Phdr * get_elf_phdr(Elf *elf, Elf64_Word type, GElf_Phdr *out)
  */
 char *get_elf_soname(rpmfile_entry_t *file)
 {
-    char *soname = NULL;
-    Elf *e = NULL;
-    int fd = 0;
-    GElf_Dyn *tags = NULL;
-    GElf_Shdr shdr;
-    size_t sz = 0;
-    bool found = false;
-
-    if ((e = get_elf(file, &fd)) == NULL) {
-        if (fd != 0) {
-            close(fd);
-        }
-
-        return NULL;
-    }
-
-    found = get_dynamic_tags(e, DT_SONAME, &tags, &sz, &shdr);
+    const elf_facts_t *facts = NULL;
 
     /*
      * Expect exactly one SONAME, if we have more than that then the
      * ELF format changed and the world is strange and confusing.
+     * The facts only carry a soname in that case.
      */
-    if (found && sz == 1) {
-        soname = strdup(elf_strptr(e, shdr.sh_link, (size_t) tags[0].d_un.d_ptr));
+    if ((facts = get_elf_facts(file)) == NULL || facts->soname == NULL) {
+        return NULL;
     }
 
-    free(tags);
-    elf_end(e);
-    close(fd);
-    return soname;
+    return strdup(facts->soname);
 }
 
 static string_list_t *get_elf_symbol_list(Elf *elf, bool (*filter)(const char *), uint32_t sh_type, const char *table_name)
@@ -641,3 +645,317 @@ void elf_archive_iterate(int fd, Elf *archive, elf_ar_action action, string_list
 
     return;
 }
+
+/*
+ * Collect the section headers, program headers, and .dynamic entries
+ * of an ELF object in to facts.  Returns false if the ELF structures
+ * cannot be read.
+ */
+static bool read_elf_facts(Elf *elf, elf_facts_t *facts)
+{
+    size_t shstrndx = 0;
+    size_t shnum = 0;
+    size_t i = 0;
+    size_t entry_size = 0;
+    size_t nsonames = 0;
+    char *name = NULL;
+    Elf_Scn *scn = NULL;
+    Elf_Scn *dyn_section = NULL;
+    GElf_Shdr shdr;
+    GElf_Shdr dyn_shdr;
+    Elf_Data *data = NULL;
+    GElf_Dyn dyn;
+
+    assert(elf != NULL);
+    assert(facts != NULL);
+
+    facts->type = get_elf_type(elf);
+    facts->machine = get_elf_machine(elf);
+
+    /* section headers */
+    if (elf_getshdrstrndx(elf, &shstrndx) != 0 || elf_getshdrnum(elf, &shnum) != 0) {
+        return false;
+    }
+
+    /* the first section returned by elf_nextscn() is index 1 */
+    if (shnum > 0) {
+        facts->sections = xcalloc(shnum, sizeof(*facts->sections));
+    }
+
+    while ((scn = elf_nextscn(elf, scn)) != NULL && facts->num_sections < shnum) {
+        if (gelf_getshdr(scn, &shdr) != &shdr) {
+            return false;
+        }
+
+        name = elf_strptr(elf, shstrndx, shdr.sh_name);
+
+        if (name != NULL) {
+            facts->sections[facts->num_sections].name = strdup(name);
+            assert(facts->sections[facts->num_sections].name != NULL);
+        }
+
+        facts->sections[facts->num_sections].type = shdr.sh_type;
+        facts->sections[facts->num_sections].flags = shdr.sh_flags;
+        facts->num_sections++;
+
+        if (dyn_section == NULL && shdr.sh_type == SHT_DYNAMIC && name != NULL && !strcmp(name, ".dynamic")) {
+            dyn_section = scn;
+            dyn_shdr = shdr;
+        }
+    }
+
+    /* program headers */
+    if (elf_getphdrnum(elf, &facts->num_phdrs) == 0 && facts->num_phdrs > 0) {
+        facts->phdrs = xcalloc(facts->num_phdrs, sizeof(*facts->phdrs));
+
+        for (i = 0; i < facts->num_phdrs; i++) {
+            if (gelf_getphdr(elf, i, &facts->phdrs[i]) == NULL) {
+                facts->num_phdrs = i;
+                break;
+            }
+        }
+    } else {
+        facts->num_phdrs = 0;
+    }
+
+    /* .dynamic entries */
+    if (dyn_section == NULL) {
+        return true;
+    }
+
+    while ((data = elf_getdata(dyn_section, data)) != NULL) {
+        entry_size = gelf_fsize(elf, data->d_type, 1, EV_CURRENT);
+
+        if (entry_size == 0) {
+            break;
+        }
+
+        facts->dyn = xrealloc(facts->dyn, (facts->num_dyn + (dyn_shdr.sh_size / entry_size)) * sizeof(*facts->dyn));
+
+        for (i = 0; i < (dyn_shdr.sh_size / entry_size); i++) {
+            if (gelf_getdyn(data, i, &dyn) == NULL) {
+                continue;
+            }
+
+            facts->dyn[facts->num_dyn].tag = dyn.d_tag;
+            facts->dyn[facts->num_dyn].val = dyn.d_un.d_val;
+            facts->dyn[facts->num_dyn].str = NULL;
+
+            if (dyn.d_tag == DT_NEEDED || dyn.d_tag == DT_SONAME || dyn.d_tag == DT_RPATH || dyn.d_tag == DT_RUNPATH) {
+                name = elf_strptr(elf, dyn_shdr.sh_link, (size_t) dyn.d_un.d_ptr);
+
+                if (name != NULL) {
+                    facts->dyn[facts->num_dyn].str = strdup(name);
+                    assert(facts->dyn[facts->num_dyn].str != NULL);
+                }
+
+                if (dyn.d_tag == DT_SONAME) {
+                    nsonames++;
+
+                    if (facts->soname == NULL && name != NULL) {
+                        facts->soname = strdup(name);
+                        assert(facts->soname != NULL);
+                    }
+                }
+            }
+
+            facts->num_dyn++;
+        }
+    }
+
+    /* expect exactly one DT_SONAME, see get_elf_soname() */
+    if (nsonames != 1) {
+        free(facts->soname);
+        facts->soname = NULL;
+    }
+
+    return true;
+}
+
+/*
+ * Return the ELF facts for a file, reading them the first time.
+ */
+const elf_facts_t *get_elf_facts(rpmfile_entry_t *file)
+{
+    int fd = 0;
+    Elf *elf = NULL;
+    elf_facts_t *facts = NULL;
+
+    assert(file != NULL);
+
+    if (file->elf_facts != NULL) {
+        return file->elf_facts;
+    }
+
+    if ((elf = get_elf(file, &fd)) == NULL) {
+        return NULL;
+    }
+
+    facts = xalloc(sizeof(*facts));
+
+    if (!read_elf_facts(elf, facts)) {
+        warnx(_("*** unable to read ELF data from %s"), file->fullpath);
+    }
+
+    facts->imported = get_elf_imported_functions(elf, NULL);
+
+    elf_end(elf);
+    close(fd);
+
+    file->elf_facts = facts;
+    return facts;
+}
+
+/*
+ * Read the ELF facts of every regular file in the peers ahead of
+ * time.  Inspections running in child processes then share them
+ * rather than each reading every ELF file again.
+ */
+void load_elf_facts(const rpmpeer_t *peers)
+{
+    rpmpeer_entry_t *peer = NULL;
+    rpmfile_entry_t *file = NULL;
+
+    if (peers == NULL) {
+        return;
+    }
+
+    TAILQ_FOREACH(peer, peers, items) {
+        if (peer->before_files) {
+            TAILQ_FOREACH(file, peer->before_files, items) {
+                if (file->fullpath && S_ISREG(file->st_mode)) {
+                    (void) get_elf_facts(file);
+                }
+            }
+        }
+
+        if (peer->after_files) {
+            TAILQ_FOREACH(file, peer->after_files, items) {
+                if (file->fullpath && S_ISREG(file->st_mode)) {
+                    (void) get_elf_facts(file);
+                }
+            }
+        }
+    }
+
+    return;
+}
+
+void free_elf_facts(elf_facts_t *facts)
+{
+    size_t i = 0;
+
+    if (facts == NULL) {
+        return;
+    }
+
+    for (i = 0; i < facts->num_sections; i++) {
+        free(facts->sections[i].name);
+    }
+
+    for (i = 0; i < facts->num_dyn; i++) {
+        free(facts->dyn[i].str);
+    }
+
+    free(facts->sections);
+    free(facts->phdrs);
+    free(facts->dyn);
+    free(facts->soname);
+    list_free(facts->imported, free);
+    list_free(facts->exported, free);
+    free(facts);
+    return;
+}
+
+bool have_elf_facts_section(const elf_facts_t *facts, int64_t section, const char *name)
+{
+    size_t i = 0;
+
+    assert(facts != NULL);
+
+    for (i = 0; i < facts->num_sections; i++) {
+        if (((section < 0) || (facts->sections[i].type == (GElf_Word) section)) &&
+            ((name == NULL) || ((facts->sections[i].name != NULL) &&
+                                !strcmp(name, facts->sections[i].name)))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+string_list_t *get_elf_facts_section_names(const elf_facts_t *facts, size_t start)
+{
+    size_t i = 0;
+    string_list_t *names = NULL;
+
+    assert(facts != NULL);
+
+    /* sections[] begins at section index 1, see read_elf_facts() */
+    for (i = start; i < facts->num_sections; i++) {
+        names = list_add(names, facts->sections[i].name);
+    }
+
+    return names;
+}
+
+string_list_t *get_elf_facts_tag_strings(const elf_facts_t *facts, const Elf64_Sxword tag)
+{
+    size_t i = 0;
+    string_list_t *list = NULL;
+
+    assert(facts != NULL);
+
+    for (i = 0; i < facts->num_dyn; i++) {
+        if (facts->dyn[i].tag == tag) {
+            list = list_add(list, facts->dyn[i].str);
+        }
+    }
+
+    return list;
+}
+
+const GElf_Phdr *get_elf_facts_phdr(const elf_facts_t *facts, Elf64_Word type)
+{
+    size_t i = 0;
+
+    assert(facts != NULL);
+
+    for (i = 0; i < facts->num_phdrs; i++) {
+        if (facts->phdrs[i].p_type == type) {
+            return &facts->phdrs[i];
+        }
+    }
+
+    return NULL;
+}
+
+const string_list_t *get_elf_facts_exported_functions(rpmfile_entry_t *file)
+{
+    int fd = 0;
+    Elf *elf = NULL;
+    elf_facts_t *facts = NULL;
+
+    assert(file != NULL);
+
+    if (get_elf_facts(file) == NULL) {
+        return NULL;
+    }
+
+    facts = file->elf_facts;
+
+    if (facts->have_exported) {
+        return facts->exported;
+    }
+
+    facts->have_exported = true;
+
+    if ((elf = get_elf(file, &fd)) == NULL) {
+        return NULL;
+    }
+
+    facts->exported = get_elf_exported_functions(elf, NULL);
+    elf_end(elf);
+    close(fd);
+    return facts->exported;
+}
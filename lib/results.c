@@ -4,8 +4,12 @@
  */
 
 #include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <err.h>
 #include "queue.h"
 #include "rpminspect.h"
+#include "uthash.h"
 
 /*
  * Initialize a struct result_params.
@@ -36,10 +40,49 @@ results_t *init_results(void)
     results_t *results = NULL;
 
     results = xalloc(sizeof(*results));
-    TAILQ_INIT(results);
+    TAILQ_INIT(&results->entries);
+    results->summary = NULL;
     return results;
 }
 
+/*
+ * Account for one result in the per-inspection summary.
+ */
+static void add_result_summary(results_t *results, const results_entry_t *entry)
+{
+    results_summary_t *summary = NULL;
+
+    assert(results != NULL);
+    assert(entry != NULL);
+
+    HASH_FIND_STR(results->summary, entry->header, summary);
+
+    if (summary == NULL) {
+        summary = xalloc(sizeof(*summary));
+        summary->header = entry->header;
+        summary->worst = entry->severity;
+        HASH_ADD_KEYPTR(hh, results->summary, summary->header, strlen(summary->header), summary);
+    } else if (entry->severity > summary->worst) {
+        summary->worst = entry->severity;
+    }
+
+    summary->count++;
+    return;
+}
+
+static void free_results_summary(results_t *results)
+{
+    results_summary_t *summary = NULL;
+    results_summary_t *tmp_summary = NULL;
+
+    HASH_ITER(hh, results->summary, summary, tmp_summary) {
+        HASH_DEL(results->summary, summary);
+        free(summary);
+    }
+
+    return;
+}
+
 /*
  * Free memory associated with an results_t list.
  */
@@ -51,9 +94,11 @@ void free_results(results_t *results)
         return;
     }
 
-    while (!TAILQ_EMPTY(results)) {
-        entry = TAILQ_FIRST(results);
-        TAILQ_REMOVE(results, entry, items);
+    free_results_summary(results);
+
+    while (!TAILQ_EMPTY(&results->entries)) {
+        entry = TAILQ_FIRST(&results->entries);
+        TAILQ_REMOVE(&results->entries, entry, items);
         free(entry->msg);
         free(entry->details);
         free(entry->noun);
@@ -145,7 +190,8 @@ void add_result_entry(results_t **results, struct result_params *params)
         entry->file = strdup(params->file);
     }
 
-    TAILQ_INSERT_TAIL(*results, entry, items);
+    TAILQ_INSERT_TAIL(&(*results)->entries, entry, items);
+    add_result_summary(*results, entry);
     return;
 }
 
@@ -166,13 +212,28 @@ void add_result(struct rpminspect *ri, struct result_params *params)
     return;
 }
 
+/*
+ * Returns the summary (worst severity and result count) for the named
+ * inspection, or NULL if there are no results for it.
+ */
+const results_summary_t *get_results_summary(const results_t *results, const char *header)
+{
+    results_summary_t *summary = NULL;
+
+    assert(results != NULL);
+    assert(header != NULL);
+
+    HASH_FIND_STR(results->summary, header, summary);
+    return summary;
+}
+
 /*
  * Returns true if all the results for the named inspection are
  * suppressed.
  */
 bool suppressed_results(const results_t *results, const char *header, const severity_t suppress)
 {
-    results_entry_t *result = NULL;
+    const results_summary_t *summary = NULL;
 
     assert(results != NULL);
     assert(header != NULL);
@@ -182,11 +243,124 @@ bool suppressed_results(const results_t *results, const char *header, const seve
         return false;
     }
 
-    TAILQ_FOREACH(result, results, items) {
-        if (!strcmp(header, result->header) && result->severity >= suppress) {
-            return false;
+    summary = get_results_summary(results, header);
+    return (summary == NULL || summary->worst < suppress);
+}
+
+/*
+ * Write the results list to the given stream in a form that
+ * read_results() can reconstruct.  This is used to send the results
+ * of an inspection run in a child process back to the parent.
+ *
+ * The header is written as a pointer value rather than a string.
+ * Result headers always point to constant strings (the NAME_*
+ * macros), so the pointer is valid in the parent after fork().
+ *
+ * Returns true on success, false on write errors.
+ */
+bool write_results(FILE *fp, const results_t *results)
+{
+    results_entry_t *result = NULL;
+
+    assert(fp != NULL);
+
+    if (results == NULL) {
+        return true;
+    }
+
+    TAILQ_FOREACH(result, &results->entries, items) {
+        fwrite(&result->severity, sizeof(result->severity), 1, fp);
+        fwrite(&result->waiverauth, sizeof(result->waiverauth), 1, fp);
+        fwrite(&result->header, sizeof(result->header), 1, fp);
+        fwrite(&result->remedy, sizeof(result->remedy), 1, fp);
+        fwrite(&result->verb, sizeof(result->verb), 1, fp);
+        write_stream_string(fp, result->msg);
+        write_stream_string(fp, result->details);
+        write_stream_string(fp, result->noun);
+        write_stream_string(fp, result->arch);
+        write_stream_string(fp, result->file);
+    }
+
+    return !ferror(fp);
+}
+
+/*
+ * Reconstruct a results list from a buffer written by
+ * write_results().  Returns a new results_t (possibly empty) that the
+ * caller must free, or NULL if the buffer is malformed.
+ */
+results_t *read_results(const char *buf, const size_t len)
+{
+    results_t *results = NULL;
+    results_entry_t *entry = NULL;
+    const char *pos = buf;
+    const char *end = buf + len;
+    bool ok = true;
+
+    results = init_results();
+
+    if (buf == NULL) {
+        return results;
+    }
+
+    while (pos < end) {
+        entry = xalloc(sizeof(*entry));
+        TAILQ_INSERT_TAIL(&results->entries, entry, items);
+
+        ok = read_stream_field(&entry->severity, sizeof(entry->severity), &pos, end)
+             && read_stream_field(&entry->waiverauth, sizeof(entry->waiverauth), &pos, end)
+             && read_stream_field(&entry->header, sizeof(entry->header), &pos, end)
+             && read_stream_field(&entry->remedy, sizeof(entry->remedy), &pos, end)
+             && read_stream_field(&entry->verb, sizeof(entry->verb), &pos, end)
+             && read_stream_string(&entry->msg, &pos, end)
+             && read_stream_string(&entry->details, &pos, end)
+             && read_stream_string(&entry->noun, &pos, end)
+             && read_stream_string(&entry->arch, &pos, end)
+             && read_stream_string(&entry->file, &pos, end);
+
+        if (!ok || entry->header == NULL) {
+            warnx(_("*** malformed results buffer"));
+            free_results(results);
+            return NULL;
         }
+
+        add_result_summary(results, entry);
     }
 
-    return true;
+    return results;
+}
+
+/*
+ * Move all of the entries in src to the end of dest, preserving
+ * their order.  src is freed.  Returns the worst severity found in
+ * the moved entries.
+ */
+severity_t merge_results(results_t **dest, results_t *src)
+{
+    severity_t worst = RESULT_NULL;
+    results_entry_t *result = NULL;
+
+    assert(dest != NULL);
+
+    if (src == NULL) {
+        return worst;
+    }
+
+    if (*dest == NULL) {
+        *dest = init_results();
+    }
+
+    TAILQ_FOREACH(result, &src->entries, items) {
+        if (result->severity > worst) {
+            worst = result->severity;
+        }
+
+        add_result_summary(*dest, result);
+    }
+
+    TAILQ_CONCAT(&(*dest)->entries, &src->entries, items);
+    free_results_summary(src);
+    free(src);
+
+    return worst;
 }
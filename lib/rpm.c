@@ -217,38 +217,118 @@ string_list_t *get_rpm_header_string_array(Header hdr, rpmTagVal tag)
 }
 
 /*
- * Helper function for functions below.  Create an rpmtd and position
- * the td index at the named file for the given header tag.  Return
- * the rpmtd.  Caller is responsible for freeing the rpmtd.
+ * File array tags decoded from an RPM header.  Each column holds one
+ * tag for every file in the package, indexed by rpmfile_entry_t.idx,
+ * so per-file lookups do not decode the whole tag again.  Columns are
+ * decoded the first time a tag is asked for.
  */
-static int _get_rpm_header_array_value_helper(rpmtd *td, const rpmfile_entry_t *file, rpmTag tag)
+struct file_column {
+    int tag;                     /* key, the RPM header tag */
+    rpm_count_t count;           /* number of values */
+    char **strs;                 /* values of string array tags */
+    uint64_t *nums;              /* values of numeric array tags */
+    UT_hash_handle hh;           /* makes this structure hashable */
+};
+
+struct file_table {
+    Header hdr;                  /* key, the RPM header */
+    struct file_column *columns; /* decoded tags */
+    UT_hash_handle hh;           /* makes this structure hashable */
+};
+
+static struct file_table *file_tables = NULL;
+
+/*
+ * Return the decoded column for the given header and tag, decoding
+ * the tag if this is the first request for it.
+ */
+static struct file_column *get_file_column(Header hdr, rpmTag tag)
 {
+    int i = 0;
+    int key = tag;
+    struct file_table *table = NULL;
+    struct file_column *column = NULL;
+    rpmtd td = NULL;
     rpmFlags flags = HEADERGET_MINMEM | HEADERGET_EXT | HEADERGET_ARGV;
+    const char *val = NULL;
+
+    assert(hdr != NULL);
+
+    HASH_FIND_PTR(file_tables, &hdr, table);
+
+    if (table == NULL) {
+        table = xalloc(sizeof(*table));
+        table->hdr = hdr;
+        HASH_ADD_PTR(file_tables, hdr, table);
+    }
+
+    HASH_FIND_INT(table->columns, &key, column);
+
+    if (column) {
+        return column;
+    }
+
+    column = xalloc(sizeof(*column));
+    column->tag = key;
+    td = rpmtdNew();
+
+    if (headerGet(hdr, tag, td, flags)) {
+        column->count = rpmtdCount(td);
+
+        if (rpmtdClass(td) == RPM_STRING_CLASS) {
+            column->strs = xcalloc(column->count, sizeof(*column->strs));
+
+            while ((i = rpmtdNext(td)) != -1) {
+                val = rpmtdGetString(td);
+
+                if (val) {
+                    column->strs[i] = strdup(val);
+                    assert(column->strs[i] != NULL);
+                }
+            }
+        } else {
+            column->nums = xcalloc(column->count, sizeof(*column->nums));
+
+            while ((i = rpmtdNext(td)) != -1) {
+                column->nums[i] = rpmtdGetNumber(td);
+            }
+        }
+
+        rpmtdFreeData(td);
+    }
+
+    rpmtdFree(td);
+    HASH_ADD_INT(table->columns, tag, column);
+    return column;
+}
+
+/*
+ * Helper for the functions below.  Return the decoded column of the
+ * header tag for the given file, or NULL if the file has no usable
+ * array index or the tag is not in the header.
+ */
+static struct file_column *get_file_column_for(const rpmfile_entry_t *file, rpmTag tag)
+{
+    struct file_column *column = NULL;
 
-    assert(td != NULL);
     assert(file != NULL);
 
-    if (file->idx == -1) {
-        return -1;
+    if (file->idx == -1 || file->rpm_header == NULL) {
+        return NULL;
     }
 
-    /* new header transaction */
-    *td = rpmtdNew();
+    column = get_file_column(file->rpm_header, tag);
 
-    /* find the header tag we want to extract values from */
-    if (!headerGet(file->rpm_header, tag, *td, flags)) {
-        rpmtdFree(*td);
-        return -1;
+    if (column->count == 0) {
+        return NULL;
     }
 
-    /* set the array index */
-    if (rpmtdSetIndex(*td, file->idx) == -1) {
-        warn(_("*** file index %d is out of bounds for %s"), file->idx, file->fullpath);
-        rpmtdFree(*td);
-        return -1;
+    if ((rpm_count_t) file->idx >= column->count) {
+        warnx(_("*** file index %d is out of bounds for %s"), file->idx, file->fullpath);
+        return NULL;
     }
 
-    return 0;
+    return column;
 }
 
 /*
@@ -267,23 +347,17 @@ static int _get_rpm_header_array_value_helper(rpmtd *td, const rpmfile_entry_t *
  */
 char *get_rpm_header_string_array_value(const rpmfile_entry_t *file, rpmTag tag)
 {
-    rpmtd td = NULL;
-    const char *val = NULL;
+    struct file_column *column = NULL;
     char *ret = NULL;
 
-    /* new header transaction */
-    if (_get_rpm_header_array_value_helper(&td, file, tag) != 0) {
-        return NULL;
-    }
-
-    /* get the tag we are looking for and copy the value */
-    val = rpmtdGetString(td);
+    column = get_file_column_for(file, tag);
 
-    if (val) {
-        ret = strdup(val);
+    if (column == NULL || column->strs == NULL || column->strs[file->idx] == NULL) {
+        return NULL;
     }
 
-    rpmtdFree(td);
+    ret = strdup(column->strs[file->idx]);
+    assert(ret != NULL);
     return ret;
 }
 
@@ -301,19 +375,49 @@ char *get_rpm_header_string_array_value(const rpmfile_entry_t *file, rpmTag tag)
  */
 uint64_t get_rpm_header_num_array_value(const rpmfile_entry_t *file, rpmTag tag)
 {
-    rpmtd td = NULL;
-    uint64_t ret = 0;
+    struct file_column *column = NULL;
 
-    /* new header transaction */
-    if (_get_rpm_header_array_value_helper(&td, file, tag) != 0) {
+    column = get_file_column_for(file, tag);
+
+    if (column == NULL || column->nums == NULL) {
         return 0;
     }
 
-    /* get the tag we are looking for and copy the value */
-    ret = rpmtdGetNumber(td);
-    rpmtdFree(td);
+    return column->nums[file->idx];
+}
 
-    return ret;
+/*
+ * Free the decoded file array tags for all RPM headers.  Call this
+ * before freeing the headers themselves.
+ */
+void free_rpm_file_tables(void)
+{
+    rpm_count_t i = 0;
+    struct file_table *table = NULL;
+    struct file_table *tmp_table = NULL;
+    struct file_column *column = NULL;
+    struct file_column *tmp_column = NULL;
+
+    HASH_ITER(hh, file_tables, table, tmp_table) {
+        HASH_ITER(hh, table->columns, column, tmp_column) {
+            HASH_DEL(table->columns, column);
+
+            if (column->strs) {
+                for (i = 0; i < column->count; i++) {
+                    free(column->strs[i]);
+                }
+            }
+
+            free(column->strs);
+            free(column->nums);
+            free(column);
+        }
+
+        HASH_DEL(file_tables, table);
+        free(table);
+    }
+
+    return;
 }
 
 /**
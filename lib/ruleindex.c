@@ -0,0 +1,316 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fnmatch.h>
+#include "rpminspect.h"
+
+/*
+ * Index of fnmatch(3) patterns from the vendor data tables (caps,
+ * politics, security).  Those tables are mostly exact paths with some
+ * wildcard rules mixed in, and looking up a file used to mean calling
+ * fnmatch(3) on every row.
+ *
+ * Patterns without glob characters are hashed as-is.  A string can
+ * only match a glob if it starts with the glob's literal prefix, so
+ * globs are hashed by the directory part of that prefix (up to and
+ * including the last slash, or "" if there is none).  A lookup hashes
+ * the string once and then each of its directory prefixes, and only
+ * runs fnmatch(3) on the globs found there.
+ *
+ * Rules remember the order they were added in so lookups give the
+ * same answer as walking the original table from the top.
+ */
+
+/* Return true if p starts a glob construct for the given flags */
+static bool is_glob_char(const char *p, const int flags)
+{
+    if (*p == '*' || *p == '?' || *p == '[') {
+        return true;
+    }
+
+    if (*p == '\\' && !(flags & FNM_NOESCAPE)) {
+        return true;
+    }
+
+#ifdef FNM_EXTMATCH
+    if ((flags & FNM_EXTMATCH) && (*p == '+' || *p == '@' || *p == '!') && *(p + 1) == '(') {
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+static bool rule_matches(const rule_index_t *index, const rule_t *rule, const char *s)
+{
+    return !strcmp(rule->pattern, s) || !fnmatch(rule->pattern, s, index->flags);
+}
+
+static int cmp_rules(const void *a, const void *b)
+{
+    const rule_t *x = *(const rule_t * const *) a;
+    const rule_t *y = *(const rule_t * const *) b;
+
+    if (x->order < y->order) {
+        return -1;
+    } else if (x->order > y->order) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Create an empty rule index.  flags are passed to fnmatch(3) when
+ * matching the glob rules.
+ */
+rule_index_t *new_rule_index(const int flags)
+{
+    rule_index_t *index = NULL;
+
+    index = xalloc(sizeof(*index));
+    index->flags = flags;
+
+    return index;
+}
+
+/*
+ * Add a rule to the index.  The pattern is not copied and must
+ * outlive the index; it is normally a field of data.
+ */
+void rule_index_add(rule_index_t *index, const char *pattern, void *data)
+{
+    const char *p = NULL;
+    size_t len = 0;
+    bool glob = false;
+    rule_bucket_t **table = NULL;
+    rule_bucket_t *bucket = NULL;
+    rule_t *rule = NULL;
+
+    assert(index != NULL);
+    assert(pattern != NULL);
+
+    for (p = pattern; *p != '\0'; p++) {
+        if (is_glob_char(p, index->flags)) {
+            glob = true;
+            break;
+        }
+
+        if (*p == PATH_SEP) {
+            len = (p - pattern) + 1;
+        }
+    }
+
+    if (glob) {
+        /* hash on the directory part of the literal prefix */
+        table = &index->globs;
+    } else {
+        table = &index->literals;
+        len = strlen(pattern);
+    }
+
+    HASH_FIND(hh, *table, pattern, len, bucket);
+
+    if (bucket == NULL) {
+        bucket = xalloc(sizeof(*bucket));
+        bucket->key = strndup(pattern, len);
+        assert(bucket->key != NULL);
+        HASH_ADD_KEYPTR(hh, *table, bucket->key, len, bucket);
+    }
+
+    bucket->rules = xrealloc(bucket->rules, (bucket->num + 1) * sizeof(*bucket->rules));
+    rule = &bucket->rules[bucket->num];
+    rule->pattern = pattern;
+    rule->data = data;
+    rule->order = index->num;
+
+    bucket->num++;
+    index->num++;
+    return;
+}
+
+/*
+ * Call fn for each bucket of globs that could match s.  Returns early
+ * if fn returns false.
+ */
+static void foreach_glob_bucket(const rule_index_t *index, const char *s, bool (*fn)(const rule_bucket_t *, void *), void *data)
+{
+    const char *p = NULL;
+    rule_bucket_t *bucket = NULL;
+
+    for (p = s; ; p++) {
+        if (p == s || *(p - 1) == PATH_SEP) {
+            HASH_FIND(hh, index->globs, s, (size_t) (p - s), bucket);
+
+            if (bucket && !fn(bucket, data)) {
+                return;
+            }
+        }
+
+        if (*p == '\0') {
+            break;
+        }
+    }
+
+    return;
+}
+
+/* Used by rule_index_find() */
+struct first_rule {
+    const rule_index_t *index;
+    const char *s;
+    const rule_t *best;
+};
+
+static bool find_first_rule(const rule_bucket_t *bucket, void *data)
+{
+    size_t i = 0;
+    struct first_rule *first = data;
+
+    /* the rules in a bucket are in order, stop at the first match */
+    for (i = 0; i < bucket->num; i++) {
+        if (first->best && bucket->rules[i].order > first->best->order) {
+            break;
+        }
+
+        if (rule_matches(first->index, &bucket->rules[i], first->s)) {
+            first->best = &bucket->rules[i];
+            break;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Return the data of the first rule added to the index that matches
+ * s, or NULL if none match.
+ */
+void *rule_index_find(const rule_index_t *index, const char *s)
+{
+    rule_bucket_t *bucket = NULL;
+    struct first_rule first;
+
+    if (index == NULL || s == NULL) {
+        return NULL;
+    }
+
+    first.index = index;
+    first.s = s;
+    first.best = NULL;
+
+    HASH_FIND(hh, index->literals, s, strlen(s), bucket);
+
+    if (bucket) {
+        first.best = &bucket->rules[0];
+    }
+
+    foreach_glob_bucket(index, s, find_first_rule, &first);
+
+    return first.best ? first.best->data : NULL;
+}
+
+/* Used by rule_index_find_all() */
+struct all_rules {
+    const rule_index_t *index;
+    const char *s;
+    const rule_t **rules;
+    size_t num;
+};
+
+static bool find_all_rules(const rule_bucket_t *bucket, void *data)
+{
+    size_t i = 0;
+    struct all_rules *all = data;
+
+    for (i = 0; i < bucket->num; i++) {
+        if (rule_matches(all->index, &bucket->rules[i], all->s)) {
+            all->rules = xrealloc(all->rules, (all->num + 1) * sizeof(*all->rules));
+            all->rules[all->num++] = &bucket->rules[i];
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Find every rule that matches s.  The data of the matching rules
+ * is returned in *matches in the order the rules were added and the
+ * number of matches is returned.  The caller must free *matches.
+ */
+size_t rule_index_find_all(const rule_index_t *index, const char *s, void ***matches)
+{
+    size_t i = 0;
+    rule_bucket_t *bucket = NULL;
+    struct all_rules all;
+
+    assert(matches != NULL);
+    *matches = NULL;
+
+    if (index == NULL || s == NULL) {
+        return 0;
+    }
+
+    all.index = index;
+    all.s = s;
+    all.rules = NULL;
+    all.num = 0;
+
+    HASH_FIND(hh, index->literals, s, strlen(s), bucket);
+
+    if (bucket) {
+        all.rules = xcalloc(bucket->num, sizeof(*all.rules));
+
+        for (i = 0; i < bucket->num; i++) {
+            all.rules[all.num++] = &bucket->rules[i];
+        }
+    }
+
+    foreach_glob_bucket(index, s, find_all_rules, &all);
+
+    if (all.num == 0) {
+        return 0;
+    }
+
+    qsort(all.rules, all.num, sizeof(*all.rules), cmp_rules);
+    *matches = xcalloc(all.num, sizeof(**matches));
+
+    for (i = 0; i < all.num; i++) {
+        (*matches)[i] = all.rules[i]->data;
+    }
+
+    free(all.rules);
+    return all.num;
+}
+
+static void free_rule_buckets(rule_bucket_t *table)
+{
+    rule_bucket_t *bucket = NULL;
+    rule_bucket_t *tmp_bucket = NULL;
+
+    HASH_ITER(hh, table, bucket, tmp_bucket) {
+        HASH_DEL(table, bucket);
+        free(bucket->key);
+        free(bucket->rules);
+        free(bucket);
+    }
+
+    return;
+}
+
+void free_rule_index(rule_index_t *index)
+{
+    if (index == NULL) {
+        return;
+    }
+
+    free_rule_buckets(index->literals);
+    free_rule_buckets(index->globs);
+    free(index);
+    return;
+}
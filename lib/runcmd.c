@@ -16,8 +16,10 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <limits.h>
+#include <signal.h>
 
 #include "rpminspect.h"
+#include "parallel.h"
 
 #define RD STDIN_FILENO
 #define WR STDOUT_FILENO
@@ -125,34 +127,156 @@ char *find_cmd(const char *cmd)
 }
 
 /*
- * Generic fork()/execvp() wrapper to return the output of the
- * process and the exit code (if desired).  This function returns an
- * allocated string of the output from the program that ran or NULL if
- * there was no output.
- *
- * The first argument is a pointer to an int that will hold the exit
- * code from execvp().  If this pointer is NULL, then the caller does
- * not want the exit code.  Internally the exit code will be used to
- * determine if the process was signaled or not, but the exit code
- * will not be given back to the caller.
- *
- * The second argument is the command followed by any additional
- * arguments that should be included with it.  Note that it is not a
- * format string, all of the subsequent arguments need to be strings
- * because they all get concatenated together.
+ * Finish the output collected from a command.  Sets the exit code
+ * (if the caller wants it) from the wait status, adds a note to the
+ * output if the command was killed by a signal, and trims the
+ * trailing newline.  Returns the output, which may be reallocated.
  */
-char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
+static char *finish_cmd_output(char *output, const int status, int *exitcode)
 {
     int i = 0;
+    char *signame = NULL;
+    char *tail = NULL;
+
+    if (WIFEXITED(status)) {
+        if (exitcode) {
+            *exitcode = WEXITSTATUS(status);
+        }
+    } else if (WIFSIGNALED(status)) {
+        if (exitcode) {
+            *exitcode = EXIT_FAILURE;
+        }
+
+        /* generate a string with the signal name if possible */
+        i = WTERMSIG(status);
+
+        if (strsignal(i) == NULL) {
+            xasprintf(&signame, _("%d"), i);
+        } else {
+            xasprintf(&signame, _("%d (%s)"), i, strsignal(i));
+        }
+
+        /* generic output indicating the command we tried to run and the signal received */
+        if (output) {
+            xasprintf(&tail, _("%s\n\n%s tried to run the command and it received signal %s"), output, COMMAND_NAME, signame);
+            free(output);
+            output = tail;
+        } else {
+            xasprintf(&output, _("%s tried to run the command and it received signal %s"), COMMAND_NAME, signame);
+        }
+
+        free(signame);
+    }
+
+    /* There may be no results from the tool */
+    if (output != NULL) {
+        /* Trim trailing newline */
+        tail = xstrrchr(output, '\n');
+
+        if (tail != NULL) {
+            tail[strcspn(tail, "\n")] = 0;
+        }
+    }
+
+    return output;
+}
+
+/*
+ * Read everything a command writes to fd.  The output is read in
+ * large chunks in to a buffer that doubles in size as needed, so
+ * collecting a lot of output is linear rather than copying it all for
+ * every line.
+ *
+ * If fn is NULL, the output is returned as an allocated string (or
+ * NULL if there was none).  Otherwise fn is called with each line as
+ * it arrives and only the current partial line is held in memory; the
+ * return value is NULL.  The caller closes fd.
+ */
+char *read_cmd_output(int fd, cmd_output_line_fn fn, void *data)
+{
+    char *buf = NULL;
+    char *nl = NULL;
+    size_t len = 0;
+    size_t size = 0;
+    size_t start = 0;
+    ssize_t r = 0;
+
+    while (1) {
+        /* make room for the next read and a terminator */
+        if (size - len < CMD_OUTPUT_READ_SIZE + 1) {
+            if (size == 0) {
+                size = CMD_OUTPUT_READ_SIZE + 1;
+            }
+
+            while (size - len < CMD_OUTPUT_READ_SIZE + 1) {
+                size *= 2;
+            }
+
+            buf = xrealloc(buf, size);
+        }
+
+        r = read(fd, buf + len, CMD_OUTPUT_READ_SIZE);
+
+        if (r == -1 && errno == EINTR) {
+            continue;
+        } else if (r == -1) {
+            warn("*** read");
+            break;
+        } else if (r == 0) {
+            break;
+        }
+
+        len += r;
+
+        if (fn == NULL) {
+            continue;
+        }
+
+        /* hand over the complete lines and keep the partial one */
+        start = 0;
+
+        while ((nl = memchr(buf + start, '\n', len - start)) != NULL) {
+            *nl = '\0';
+            fn(buf + start, data);
+            start = (nl - buf) + 1;
+        }
+
+        if (start > 0) {
+            memmove(buf, buf + start, len - start);
+            len -= start;
+        }
+    }
+
+    if (buf != NULL) {
+        buf[len] = '\0';
+    }
+
+    if (fn) {
+        if (len > 0) {
+            fn(buf, data);
+        }
+
+        len = 0;
+    }
+
+    if (len == 0) {
+        free(buf);
+        return NULL;
+    }
+
+    return buf;
+}
+
+/*
+ * Fork and exec argv in workdir.  Helper for run_cmd_vp() and
+ * run_cmd_vp_lines(), see those for details.
+ */
+static char *exec_cmd(int *exitcode, const char *workdir, char **argv, cmd_output_line_fn fn, void *data)
+{
     int pfd[2];
     int status = 0;
     pid_t proc = 0;
-    FILE *reader = 0;
-    char *signame = NULL;
     char *output = NULL;
-    char *tail = NULL;
-    size_t n = BUFSIZ;
-    char *buf = NULL;
     char cwd[PATH_MAX + 1];
     char *cmd = NULL;
 
@@ -174,6 +298,13 @@ char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
 
     if (cmd == NULL) {
         xasprintf(&output, "%s NOT FOUND", argv[0]);
+
+        if (fn) {
+            fn(output, data);
+            free(output);
+            output = NULL;
+        }
+
         return output;
     }
 
@@ -234,40 +365,11 @@ char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
             warn("*** close");
         }
 
-        /*
-         * Read in all of the information back from the command and store
-         * it as our result.  Just concatenate the string as we read it
-         * back in buffer size chunks.
-         */
-        reader = fdopen(pfd[RD], "r");
-
-        if (reader == NULL) {
-            if (close(pfd[RD]) == -1) {
-                warn("*** close");
-            }
-
-            if (exitcode) {
-                *exitcode = EXIT_FAILURE;
-            }
+        /* read in all of the output from the command */
+        output = read_cmd_output(pfd[RD], fn, data);
 
-            free(cmd);
-            return NULL;
-        }
-
-        output = NULL;
-        buf = xalloc(n);
-
-        while (getline(&buf, &n, reader) != -1) {
-            xasprintf(&tail, "%s%s", (output == NULL) ? "" : output, buf);
-            assert(tail != NULL);
-            free(output);
-            output = tail;
-        }
-
-        free(buf);
-
-        if (fclose(reader) == -1) {
-            warn("*** fclose");
+        if (close(pfd[RD]) == -1) {
+            warn("*** close");
         }
 
         /* wait for the command */
@@ -279,44 +381,13 @@ char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
             warn("*** waitpid");
         }
 
-        if (WIFEXITED(status)) {
-            if (exitcode) {
-                *exitcode = WEXITSTATUS(status);
-            }
-        } else if (WIFSIGNALED(status)) {
-            if (exitcode) {
-                *exitcode = EXIT_FAILURE;
-            }
-
-            /* generate a string with the signal name if possible */
-            i = WTERMSIG(status);
-
-            if (strsignal(i) == NULL) {
-                xasprintf(&signame, _("%d"), i);
-            } else {
-                xasprintf(&signame, _("%d (%s)"), i, strsignal(i));
-            }
-
-            /* generic output indicating the command we tried to run and the signal received */
-            if (output) {
-                xasprintf(&tail, _("%s\n\n%s tried to run the command and it received signal %s"), output, COMMAND_NAME, signame);
-                free(output);
-                output = tail;
-            } else {
-                xasprintf(&output, _("%s tried to run the command and it received signal %s"), COMMAND_NAME, signame);
-            }
+        output = finish_cmd_output(output, status, exitcode);
 
-            free(signame);
-        }
-
-        /* There may be no results from the tool */
-        if (output != NULL) {
-            /* Trim trailing newline */
-            tail = xstrrchr(output, '\n');
-
-            if (tail != NULL) {
-                tail[strcspn(tail, "\n")] = 0;
-            }
+        /* a note about a signal is all that is left when streaming */
+        if (fn && output) {
+            fn(output, data);
+            free(output);
+            output = NULL;
         }
     }
 
@@ -329,6 +400,41 @@ char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
     return output;
 }
 
+/*
+ * Generic fork()/execvp() wrapper to return the output of the
+ * process and the exit code (if desired).  This function returns an
+ * allocated string of the output from the program that ran or NULL if
+ * there was no output.
+ *
+ * The first argument is a pointer to an int that will hold the exit
+ * code from execvp().  If this pointer is NULL, then the caller does
+ * not want the exit code.  Internally the exit code will be used to
+ * determine if the process was signaled or not, but the exit code
+ * will not be given back to the caller.
+ *
+ * The second argument is the command followed by any additional
+ * arguments that should be included with it.  Note that it is not a
+ * format string, all of the subsequent arguments need to be strings
+ * because they all get concatenated together.
+ */
+char *run_cmd_vp(int *exitcode, const char *workdir, char **argv)
+{
+    return exec_cmd(exitcode, workdir, argv, NULL, NULL);
+}
+
+/*
+ * Same as run_cmd_vp(), but fn is called with each line of output as
+ * the command writes it instead of collecting all of it in memory.
+ * Useful for tools that can generate a lot of output when the caller
+ * only needs to scan it.
+ */
+void run_cmd_vp_lines(int *exitcode, const char *workdir, char **argv, cmd_output_line_fn fn, void *data)
+{
+    assert(fn != NULL);
+    (void) exec_cmd(exitcode, workdir, argv, fn, data);
+    return;
+}
+
 /*
  * Wrapper for run_cmd_vp() that lets you pass in varargs instead of a
  * string_list_t.
@@ -374,6 +480,358 @@ char *run_cmd(int *exitcode, const char *workdir, const char *cmd, ...)
     return output;
 }
 
+/*
+ * Create a pool to run external commands in.  Commands added with
+ * cmdpool_add() run up to max at a time, or get_parallel_processes()
+ * at a time if max is 0, and their output is collected with poll(2)
+ * as it arrives.  Like run_cmd_vp(), the output is read to the end
+ * no matter how large it is.  Callers queue all of their commands,
+ * call cmdpool_wait(), and then report using whatever their
+ * callbacks stored.
+ */
+cmdpool_t *new_cmdpool(const unsigned int max)
+{
+    cmdpool_t *pool = NULL;
+
+    pool = xalloc(sizeof(*pool));
+    pool->col = new_parallel(max);
+    pool->col->max_len = 0;
+    pool->jobs = xcalloc(pool->col->max_pids, sizeof(*pool->jobs));
+
+    return pool;
+}
+
+/*
+ * Wait for one running command to finish and hand its exit code and
+ * output to the callback.
+ */
+static void cmdpool_collect(cmdpool_t *pool)
+{
+    int exitcode = EXIT_FAILURE;
+    char *output = NULL;
+    parallel_slot_t *slot = NULL;
+    cmdpool_job_t job;
+
+    assert(pool != NULL);
+
+    slot = collect_one(pool->col);
+
+    if (slot == NULL) {
+        return;
+    }
+
+    /* the callback may reuse this slot, so take what we need first */
+    job = pool->jobs[slot - pool->col->slot];
+    output = slot->output;
+    slot->output = NULL;
+    slot->output_len = 0;
+    slot->output_size = 0;
+
+    output = finish_cmd_output(output, slot->exit_status, &exitcode);
+    job.done(exitcode, output, job.data);
+    return;
+}
+
+/*
+ * Start a command in the pool, waiting for a free slot if all of
+ * them are busy.  argv is the same as for run_cmd_vp() and may be
+ * freed once this returns.  If the command cannot be started, done
+ * is called right away with a non-zero exit code.
+ */
+void cmdpool_add(cmdpool_t *pool, const char *workdir, char **argv, cmdpool_done_fn done, void *data)
+{
+    int pfd[2];
+    pid_t proc = 0;
+    unsigned int i = 0;
+    char *cmd = NULL;
+    char *output = NULL;
+
+    assert(pool != NULL);
+    assert(argv != NULL);
+    assert(argv[0] != NULL);
+    assert(done != NULL);
+
+    /* find the command */
+    cmd = find_cmd(argv[0]);
+
+    if (cmd == NULL) {
+        xasprintf(&output, "%s NOT FOUND", argv[0]);
+        done(EXIT_FAILURE, output, data);
+        return;
+    }
+
+    /* wait for a free slot */
+    while (pool->col->running == pool->col->max_pids) {
+        cmdpool_collect(pool);
+    }
+
+    /* create pipes to interact with the child */
+    if (pipe(pfd) == -1) {
+        warn("*** pipe");
+        free(cmd);
+        done(EXIT_FAILURE, NULL, data);
+        return;
+    }
+
+    /* run the command */
+    proc = fork();
+
+    if (proc == 0) {
+        /* connect the output */
+        if (dup2(pfd[WR], STDOUT_FILENO) == -1 || dup2(pfd[WR], STDERR_FILENO) == -1) {
+            warn("*** dup2");
+            _exit(EXIT_FAILURE);
+        }
+
+        /* close the pipes */
+        if (close(pfd[RD]) == -1 || close(pfd[WR]) == -1) {
+            warn("*** close");
+            _exit(EXIT_FAILURE);
+        }
+
+        setlinebuf(stdout);
+        setlinebuf(stderr);
+
+        /* change to the working directory */
+        if (workdir && (chdir(workdir) == -1)) {
+            warn("*** chdir");
+        }
+
+        /* run the command */
+        if (execvp(cmd, argv) == -1) {
+            warn("*** execvp");
+            _exit(EXIT_FAILURE);
+        }
+    } else if (proc == -1) {
+        /* failure */
+        warn("*** fork");
+
+        if (close(pfd[RD]) == -1) {
+            warn("*** close");
+        }
+
+        if (close(pfd[WR]) == -1) {
+            warn("*** close");
+        }
+
+        free(cmd);
+        done(EXIT_FAILURE, NULL, data);
+        return;
+    }
+
+    /* close the pipe */
+    if (close(pfd[WR]) == -1) {
+        warn("*** close");
+    }
+
+    /* hand the child over to the collector */
+    insert_new_pid_and_fd(pool->col, proc, pfd[RD]);
+
+    for (i = 0; i < pool->col->max_pids; i++) {
+        if (pool->col->slot[i].pid == proc) {
+            pool->jobs[i].done = done;
+            pool->jobs[i].data = data;
+            break;
+        }
+    }
+
+    free(cmd);
+    return;
+}
+
+/*
+ * Copy argv and append files to the copy.  Caller must free the
+ * result with free_argv().
+ */
+static char **append_argv(char **argv, char **files, const size_t nfiles)
+{
+    size_t i = 0;
+    size_t n = 0;
+    char **r = NULL;
+
+    assert(argv != NULL);
+
+    for (n = 0; argv[n] != NULL; n++) ;
+
+    r = xcalloc(n + nfiles + 1, sizeof(*r));
+
+    for (i = 0; i < n; i++) {
+        r[i] = strdup(argv[i]);
+        assert(r[i] != NULL);
+    }
+
+    for (i = 0; i < nfiles; i++) {
+        r[n + i] = strdup(files[i]);
+        assert(r[n + i] != NULL);
+    }
+
+    return r;
+}
+
+/* A batch of files given to one command by cmdpool_add_files() */
+struct cmdpool_batch {
+    cmdpool_t *pool;
+    char *workdir;
+    char **argv;
+    char **files;
+    void **data;
+    size_t nfiles;
+    cmdpool_done_fn done;
+};
+
+/*
+ * A batch passes only if the command exits cleanly without saying
+ * anything.  Otherwise we cannot tell which file the output belongs
+ * to, so each file in the batch is run again on its own.
+ */
+static void cmdpool_batch_done(int exitcode, char *output, void *data)
+{
+    size_t i = 0;
+    char **argv = NULL;
+    struct cmdpool_batch *batch = data;
+
+    assert(batch != NULL);
+
+    if (exitcode == 0 && (output == NULL || *output == '\0')) {
+        for (i = 0; i < batch->nfiles; i++) {
+            batch->done(0, NULL, batch->data[i]);
+        }
+    } else {
+        for (i = 0; i < batch->nfiles; i++) {
+            argv = append_argv(batch->argv, &batch->files[i], 1);
+            cmdpool_add(batch->pool, batch->workdir, argv, batch->done, batch->data[i]);
+            free_argv(argv);
+        }
+    }
+
+    free(output);
+    free(batch->workdir);
+    free_argv(batch->argv);
+    free_argv(batch->files);
+    free(batch->data);
+    free(batch);
+    return;
+}
+
+/*
+ * Run argv on each of the files, for validators that accept more
+ * than one file per invocation.  The files are split in to batches
+ * of at most CMDPOOL_BATCH_SIZE and spread across the pool.  done
+ * is called once per file with data[i], just as if each file had
+ * been given to cmdpool_add() separately.
+ */
+void cmdpool_add_files(cmdpool_t *pool, const char *workdir, char **argv, char **files, void **data, const size_t nfiles, cmdpool_done_fn done)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = 0;
+    size_t chunk = 0;
+    char **cmd = NULL;
+    struct cmdpool_batch *batch = NULL;
+
+    assert(pool != NULL);
+    assert(argv != NULL);
+    assert(done != NULL);
+
+    if (nfiles == 0) {
+        return;
+    }
+
+    assert(files != NULL);
+    assert(data != NULL);
+
+    /* keep every slot busy, but do not let the batches get too big */
+    chunk = (nfiles + pool->col->max_pids - 1) / pool->col->max_pids;
+
+    if (chunk > CMDPOOL_BATCH_SIZE) {
+        chunk = CMDPOOL_BATCH_SIZE;
+    }
+
+    for (i = 0; i < nfiles; i += n) {
+        n = nfiles - i;
+
+        if (n > chunk) {
+            n = chunk;
+        }
+
+        cmd = append_argv(argv, &files[i], n);
+
+        if (n == 1) {
+            cmdpool_add(pool, workdir, cmd, done, data[i]);
+        } else {
+            batch = xalloc(sizeof(*batch));
+            batch->pool = pool;
+            batch->argv = append_argv(argv, NULL, 0);
+            batch->files = xcalloc(n + 1, sizeof(*batch->files));
+            batch->data = xcalloc(n, sizeof(*batch->data));
+            batch->nfiles = n;
+            batch->done = done;
+
+            if (workdir) {
+                batch->workdir = strdup(workdir);
+                assert(batch->workdir != NULL);
+            }
+
+            for (j = 0; j < n; j++) {
+                batch->files[j] = strdup(files[i + j]);
+                assert(batch->files[j] != NULL);
+                batch->data[j] = data[i + j];
+            }
+
+            cmdpool_add(pool, workdir, cmd, cmdpool_batch_done, batch);
+        }
+
+        free_argv(cmd);
+    }
+
+    return;
+}
+
+/*
+ * cmdpool_done_fn that stores the exit code and output in the
+ * cmd_result_t given as data.
+ */
+void cmdpool_store_result(int exitcode, char *output, void *data)
+{
+    cmd_result_t *r = data;
+
+    assert(r != NULL);
+    r->exitcode = exitcode;
+    r->output = output;
+    return;
+}
+
+/*
+ * Wait for every command in the pool to finish, including any that
+ * the callbacks queue along the way.
+ */
+void cmdpool_wait(cmdpool_t *pool)
+{
+    assert(pool != NULL);
+
+    while (pool->col->running > 0) {
+        cmdpool_collect(pool);
+    }
+
+    return;
+}
+
+/*
+ * Free the pool.  Call cmdpool_wait() first; anything still running
+ * is killed and its callback is never called.
+ */
+void free_cmdpool(cmdpool_t *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+
+    delete_parallel(pool->col, SIGTERM);
+    free(pool->jobs);
+    free(pool);
+    return;
+}
+
 /*
  * Split a string in to a char ** of all the arguments, terminated
  * with a NULL entry.  Caller must free.
@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: LGPL-3.0-or-later
  */
 
+#include <stdlib.h>
 #include <assert.h>
 #include <err.h>
 #include <fnmatch.h>
@@ -20,11 +21,11 @@ security_entry_t *get_secrule_by_path(struct rpminspect *ri, const rpmfile_entry
     const char *version = NULL;
     const char *release = NULL;
     security_entry_t *sentry = NULL;
+    security_entry_t *found = NULL;
     int flags = FNM_NOESCAPE;
-    int w = -1;
-    int x = -1;
-    int y = -1;
-    int z = -1;
+    size_t i = 0;
+    size_t n = 0;
+    void **matches = NULL;
 
     assert(ri != NULL);
     assert(file != NULL);
@@ -43,31 +44,26 @@ security_entry_t *get_secrule_by_path(struct rpminspect *ri, const rpmfile_entry
     version = headerGetString(file->rpm_header, RPMTAG_VERSION);
     release = headerGetString(file->rpm_header, RPMTAG_RELEASE);
 
-    /* try to find a secrule */
-    TAILQ_FOREACH(sentry, ri->security, items) {
-        w = x = y = z = -1;
-        w = fnmatch(sentry->path, file->localpath, flags);
+    /* a rule has to match all of the NVR */
+    if (name == NULL || version == NULL || release == NULL) {
+        return NULL;
+    }
 
-        if (name) {
-            x = fnmatch(sentry->pkg, name, flags);
-        }
+    /* try to find a secrule among the ones matching this path */
+    n = rule_index_find_all(ri->security_index, file->localpath, &matches);
 
-        if (version) {
-            y = fnmatch(sentry->ver, version, flags);
-        }
-
-        if (release) {
-            z = fnmatch(sentry->rel, release, flags);
-        }
+    for (i = 0; i < n; i++) {
+        sentry = matches[i];
 
-        if (w == 0 && x == 0 && y == 0 && z == 0) {
+        if (!fnmatch(sentry->pkg, name, flags) && !fnmatch(sentry->ver, version, flags) && !fnmatch(sentry->rel, release, flags)) {
             /* match found */
-            return sentry;
+            found = sentry;
+            break;
         }
     }
 
-    /* no match found */
-    return NULL;
+    free(matches);
+    return found;
 }
 
 /*
@@ -30,6 +30,7 @@ extern int strverscmp (const char *, const char *);
 #endif
 
 #include "rpminspect.h"
+#include "parallel.h"
 
 void sigabrt_handler(__attribute__ ((unused)) int i)
 {
@@ -66,6 +67,9 @@ static void usage(void)
     printf(_("                              failure (default: VERIFY)\n"));
     printf(_("  -s TAG, --suppress=TAG      Results suppression threshold\n"));
     printf(_("                                (default: off, report everything)\n"));
+    printf(_("  -j N, --jobs=N              Number of parallel jobs (packages to extract\n"));
+    printf(_("                                and inspections to run at once)\n"));
+    printf(_("                                (default: number of available CPUs)\n"));
     printf(_("  -l, --list                  List available tests and formats\n"));
     printf(_("  -w PATH, --workdir=PATH     Temporary directory to use\n"));
     printf(_("                                (default: %s)\n"), DEFAULT_WORKDIR);
@@ -328,6 +332,350 @@ static char *gather_arg(char *val, char *arg, const char *opt)
     return r;
 }
 
+/*
+ * Report the state of one inspection in verbose mode.
+ */
+static void report_inspection(const int i, const bool skipped, const bool passed)
+{
+    char *r = NULL;
+
+    if (skipped) {
+        xasprintf(&r, _("Skipping %s inspection..."), inspections[i].name);
+    } else {
+        xasprintf(&r, _("Running %s inspection..."), inspections[i].name);
+    }
+
+    assert(r != NULL);
+    printf("%-36s", r);
+    free(r);
+
+    if (skipped) {
+        printf("%5s\n", _("skip"));
+    } else {
+        printf("%5s\n", passed ? _("pass") : _("FAIL"));
+    }
+
+    return;
+}
+
+/*
+ * Add a skipped result for an inspection not selected by the user.
+ */
+static void add_skipped_result(results_t **results, const int i)
+{
+    struct result_params params;
+
+    init_result_params(&params);
+    params.header = inspections[i].name;
+    params.severity = RESULT_SKIP;
+    params.verb = VERB_SKIP;
+    add_result_entry(results, &params);
+    return;
+}
+
+/*
+ * Process the output of one finished inspection child process.  The
+ * child writes the driver return value followed by its results (see
+ * write_results()).  running maps collector slots to inspections.
+ */
+static void collect_inspection(parallel_t *col, parallel_slot_t *slot, const int *running, results_t **buffers, bool *done, bool *passed)
+{
+    int i = 0;
+    int r = 0;
+    bool ires = false;
+
+    assert(col != NULL);
+    assert(slot != NULL);
+
+    i = running[slot - col->slot];
+    r = slot->exit_status;
+
+    if (!WIFEXITED(r)) {
+        delete_parallel(col, SIGTERM);
+        errx(RI_PROGRAM_ERROR, _("*** %s inspection killed by signal %u"), inspections[i].name, WTERMSIG(r));
+    }
+
+    if (WEXITSTATUS(r) != 0) {
+        /* the child already reported why, exit the same way */
+        delete_parallel(col, SIGTERM);
+        exit(WEXITSTATUS(r));
+    }
+
+    if (slot->output == NULL || slot->output_len < sizeof(ires)) {
+        delete_parallel(col, SIGTERM);
+        errx(RI_PROGRAM_ERROR, _("*** %s inspection returned no status"), inspections[i].name);
+    }
+
+    memcpy(&ires, slot->output, sizeof(ires));
+    buffers[i] = read_results(slot->output + sizeof(ires), slot->output_len - sizeof(ires));
+
+    if (buffers[i] == NULL) {
+        delete_parallel(col, SIGTERM);
+        errx(RI_PROGRAM_ERROR, _("*** unable to read %s inspection results"), inspections[i].name);
+    }
+
+    passed[i] = ires;
+    done[i] = true;
+
+    free(slot->output);
+    slot->output = NULL;
+    slot->output_len = 0;
+    slot->output_size = 0;
+    return;
+}
+
+/*
+ * Fork a child process to run one inspection.  The child collects
+ * only the results of that inspection and writes them to the pipe
+ * before exiting.
+ */
+static void start_inspection(struct rpminspect *ri, parallel_t *col, int *running, const int i)
+{
+    int pipefd[2];
+    pid_t pid;
+    bool ires = false;
+    unsigned int j = 0;
+    FILE *fp = NULL;
+
+    if (pipe(pipefd)) {
+        err(RI_PROGRAM_ERROR, "*** pipe");
+    }
+
+    pid = fork();
+
+    if (pid < 0) {
+        err(RI_PROGRAM_ERROR, "*** fork");
+    }
+
+    if (pid == 0) {
+        /* child */
+        if (close(pipefd[0]) == -1) {
+            warn("*** close");
+        }
+
+        /* leave processes for the inspections running alongside this one */
+        share_parallel_processes(col->max_pids);
+
+        ri->results = NULL;
+        ires = inspections[i].driver(ri);
+
+        fp = fdopen(pipefd[1], "w");
+
+        if (fp == NULL) {
+            err(RI_PROGRAM_ERROR, "*** fdopen");
+        }
+
+        fwrite(&ires, sizeof(ires), 1, fp);
+
+        if (!write_results(fp, ri->results) || fclose(fp) != 0) {
+            errx(RI_PROGRAM_ERROR, _("*** unable to write %s inspection results"), inspections[i].name);
+        }
+
+        fflush(NULL);
+        _exit(RI_SUCCESS);
+    }
+
+    /* parent */
+    if (close(pipefd[1]) == -1) {
+        warn("*** close");
+    }
+
+    insert_new_pid_and_fd(col, pid, pipefd[0]);
+
+    for (j = 0; j < col->max_pids; j++) {
+        if (col->slot[j].pid == pid) {
+            running[j] = i;
+            break;
+        }
+    }
+
+    return;
+}
+
+/*
+ * Run the selected inspections.
+ *
+ * Each inspection runs in its own child process, up to
+ * default_parallel_processes at a time, and sends its results back
+ * over a pipe.  The results are held in a buffer per inspection and
+ * merged in to ri->results in inspections[] order once all of the
+ * preceding inspections are done, so the output is the same no
+ * matter which inspection finishes first.
+ *
+ * Each child gets an equal share of the parallel processes for
+ * anything it runs in parallel itself (see share_parallel_processes()),
+ * so running inspections side by side does not multiply the number of
+ * processes.  The results of an inspection are not limited in size
+ * like other collected output.
+ *
+ * Inspections only communicate through the results list, so running
+ * them in separate processes is safe.  Anything an inspection
+ * caches on the peers (MIME types, checksums, etc) is discarded when
+ * its child exits.  ELF facts are the exception: they are read before
+ * the children start when more than one inspection needs them.
+ *
+ * If jobs is 1, the inspections run one after the other in this
+ * process.
+ */
+static void run_inspections(struct rpminspect *ri, const unsigned int jobs, const bool verbose)
+{
+    int i = 0;
+    int n = 0;
+    int merged = 0;
+    unsigned int nrun = 0;
+    unsigned int max = 0;
+    uint64_t elf_tests = 0;
+    char *r = NULL;
+    bool ires = false;
+    bool *done = NULL;
+    bool *passed = NULL;
+    bool *skipped = NULL;
+    bool *ran = NULL;
+    int *running = NULL;
+    results_t **buffers = NULL;
+    parallel_t *col = NULL;
+    parallel_slot_t *slot = NULL;
+    severity_t worst = RESULT_NULL;
+    struct result_params params;
+
+    assert(ri != NULL);
+
+    if (jobs == 1) {
+        for (i = 0; inspections[i].name != NULL; i++) {
+            /* test not selected by user */
+            if (!(ri->tests & inspections[i].flag)) {
+                /*
+                 * tell the user this inspection is skipped when in
+                 * verbose mode
+                 */
+                if (verbose) {
+                    report_inspection(i, true, true);
+                }
+
+                /* add a skipped result for this inspection */
+                init_result_params(&params);
+                params.header = inspections[i].name;
+                params.severity = RESULT_SKIP;
+                params.verb = VERB_SKIP;
+                add_result(ri, &params);
+
+                /* next inspection */
+                continue;
+            }
+
+            /* inspection requires before/after builds and we have one */
+            if (ri->before == NULL && !inspections[i].single_build) {
+                continue;
+            }
+
+            if (verbose) {
+                xasprintf(&r, _("Running %s inspection..."), inspections[i].name);
+                assert(r != NULL);
+                printf("%-36s", r);
+                free(r);
+            }
+
+            ires = inspections[i].driver(ri);
+
+            if (verbose) {
+                printf("%5s\n", ires ? _("pass") : _("FAIL"));
+            }
+        }
+
+        return;
+    }
+
+    for (n = 0; inspections[n].name != NULL; n++) ;
+
+    buffers = xcalloc(n, sizeof(*buffers));
+    done = xcalloc(n, sizeof(*done));
+    passed = xcalloc(n, sizeof(*passed));
+    skipped = xcalloc(n, sizeof(*skipped));
+    ran = xcalloc(n, sizeof(*ran));
+
+    /* no more children than inspections to run */
+    for (i = 0; i < n; i++) {
+        if ((ri->tests & inspections[i].flag) && (ri->before != NULL || inspections[i].single_build)) {
+            nrun++;
+        }
+    }
+
+    max = get_parallel_processes();
+
+    if (nrun > 0 && nrun < max) {
+        max = nrun;
+    }
+
+    /*
+     * When more than one selected inspection reads ELF files, read
+     * them here once so the children share the results.
+     */
+    elf_tests = ri->tests & ELF_FACTS_INSPECTIONS;
+
+    if (elf_tests & (elf_tests - 1)) {
+        load_elf_facts(ri->peers);
+    }
+
+    fflush(NULL);
+    col = new_parallel(max);
+
+    /* results are not bounded by the usual output limit */
+    col->max_len = 0;
+    running = xcalloc(col->max_pids, sizeof(*running));
+
+    for (i = 0; i < n; i++) {
+        if (!(ri->tests & inspections[i].flag)) {
+            add_skipped_result(&buffers[i], i);
+            skipped[i] = true;
+            done[i] = true;
+        } else if (ri->before == NULL && !inspections[i].single_build) {
+            done[i] = true;
+        } else {
+            /* wait for a free slot */
+            while (col->running == col->max_pids) {
+                slot = collect_one(col);
+                collect_inspection(col, slot, running, buffers, done, passed);
+            }
+
+            start_inspection(ri, col, running, i);
+            ran[i] = true;
+        }
+    }
+
+    /* collect the remaining children, merging results in order */
+    while (merged < n) {
+        while (merged < n && done[merged]) {
+            worst = merge_results(&ri->results, buffers[merged]);
+            buffers[merged] = NULL;
+
+            if (worst > ri->worst_result) {
+                ri->worst_result = worst;
+            }
+
+            if (verbose && (skipped[merged] || ran[merged])) {
+                report_inspection(merged, skipped[merged], passed[merged]);
+            }
+
+            merged++;
+        }
+
+        if (merged < n) {
+            slot = collect_one(col);
+            assert(slot != NULL);
+            collect_inspection(col, slot, running, buffers, done, passed);
+        }
+    }
+
+    delete_parallel(col, 0);
+    free(buffers);
+    free(done);
+    free(passed);
+    free(skipped);
+    free(ran);
+    free(running);
+    return;
+}
+
 int main(int argc, char **argv)
 {
     struct sigaction abrt;
@@ -339,7 +687,7 @@ int main(int argc, char **argv)
     int ret = RI_SUCCESS;
     wordexp_t expand;
     struct stat sb;
-    char *short_options = "c:p:T:E:a:r:nb:o:F:lw:t:s:fkdDv\?V";
+    char *short_options = "c:p:T:E:a:r:nb:o:F:j:lw:t:s:fkdDv\?V";
     struct option long_options[] = {
         { "config", required_argument, 0, 'c' },
         { "profile", required_argument, 0, 'p' },
@@ -352,6 +700,7 @@ int main(int argc, char **argv)
         { "list", no_argument, 0, 'l' },
         { "output", required_argument, 0, 'o' },
         { "format", required_argument, 0, 'F' },
+        { "jobs", required_argument, 0, 'j' },
         { "workdir", required_argument, 0, 'w' },
         { "threshold", required_argument, 0, 't' },
         { "suppress", required_argument, 0, 's' },
@@ -372,7 +721,6 @@ int main(int argc, char **argv)
     char *walk = NULL;
     char *token = NULL;
     char *cwd = NULL;
-    char *r = NULL;
     char *output = NULL;
     char *release = NULL;
     bool rebase_detection = true;
@@ -380,6 +728,9 @@ int main(int argc, char **argv)
     char *threshold = NULL;
     char *suppress = NULL;
     int formatidx = -1;
+    unsigned int jobs = 0;
+    long int val = 0;
+    char *endptr = NULL;
     bool fetch_only = false;
     bool keep = false;
     bool list = false;
@@ -403,7 +754,6 @@ int main(int argc, char **argv)
     struct result_params params;
     size_t cmdlen = 0;
     char *tail = NULL;
-    bool ires = false;
     string_list_t *diags = NULL;
     struct rpminspect *ri = NULL;
 
@@ -511,6 +861,18 @@ int main(int argc, char **argv)
                     errx(RI_PROGRAM_ERROR, _("*** invalid output format: `%s`."), optarg);
                 }
 
+                break;
+            case 'j':
+                /* number of parallel jobs */
+                errno = 0;
+                val = strtol(optarg, &endptr, 10);
+
+                if (errno != 0 || *endptr != '\0' || val < 1 || val > 1024) {
+                    errx(RI_PROGRAM_ERROR, _("*** invalid number of jobs: `%s`."), optarg);
+                }
+
+                jobs = val;
+                default_parallel_processes = jobs;
                 break;
             case 'l':
                 list = true;
@@ -1004,51 +1366,8 @@ int main(int argc, char **argv)
             }
         }
 
-        for (i = 0; inspections[i].name != NULL; i++) {
-            /* test not selected by user */
-            if (!(ri->tests & inspections[i].flag)) {
-                /*
-                 * tell the user this inspection is skipped when in
-                 * verbose mode
-                 */
-                if (verbose) {
-                    xasprintf(&r, _("Skipping %s inspection..."), inspections[i].name);
-                    assert(r != NULL);
-                    printf("%-36s", r);
-                    free(r);
-
-                    printf("%5s\n", _("skip"));
-                }
-
-                /* add a skipped result for this inspection */
-                init_result_params(&params);
-                params.header = inspections[i].name;
-                params.severity = RESULT_SKIP;
-                params.verb = VERB_SKIP;
-                add_result(ri, &params);
-
-                /* next inspection */
-                continue;
-            }
-
-            /* inspection requires before/after builds and we have one */
-            if (ri->before == NULL && !inspections[i].single_build) {
-                continue;
-            }
-
-            if (verbose) {
-                xasprintf(&r, _("Running %s inspection..."), inspections[i].name);
-                assert(r != NULL);
-                printf("%-36s", r);
-                free(r);
-            }
-
-            ires = inspections[i].driver(ri);
-
-            if (verbose) {
-                printf("%5s\n", ires ? _("pass") : _("FAIL"));
-            }
-        }
+        run_inspections(ri, jobs, verbose);
+        trim_cache(ri->cachedir, ri->cache_size);
 
         if (verbose) {
             printf("\n");
@@ -0,0 +1,235 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * A minimal HTTP/1.1 server for unit tests that need something on
+ * the other end of a URL, such as a Koji hub or a package download
+ * server.  It listens on an ephemeral loopback port in a forked
+ * process and answers one connection at a time, closing each
+ * connection after the response.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <err.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "stub-httpd.h"
+
+/*
+ * Write all of buf to fd.
+ */
+void stub_write(int fd, const char *buf, size_t len)
+{
+    ssize_t n = 0;
+
+    while (len > 0) {
+        n = write(fd, buf, len);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return;
+        }
+
+        buf += n;
+        len -= n;
+    }
+
+    return;
+}
+
+/*
+ * Send a complete response with the given status and body.
+ */
+void stub_reply(int fd, const int status, const char *body, const size_t len)
+{
+    char header[BUFSIZ];
+    int n = 0;
+
+    n = snprintf(header, sizeof(header), "HTTP/1.1 %d %s\r\nContent-Type: text/xml\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", status, (status == 200) ? "OK" : "Error", len);
+    stub_write(fd, header, n);
+    stub_write(fd, body, len);
+    return;
+}
+
+/*
+ * Read one request from fd and hand it to the handler.
+ */
+static void serve_request(int fd, stub_handler_fn handler, void *data)
+{
+    char *buf = NULL;
+    char *end = NULL;
+    char *path = NULL;
+    char *body = NULL;
+    char *value = NULL;
+    size_t size = BUFSIZ;
+    size_t len = 0;
+    size_t want = 0;
+    ssize_t n = 0;
+
+    buf = malloc(size + 1);
+
+    if (buf == NULL) {
+        return;
+    }
+
+    /* the request line and headers */
+    while (end == NULL) {
+        if (len == size) {
+            size *= 2;
+            buf = realloc(buf, size + 1);
+
+            if (buf == NULL) {
+                return;
+            }
+        }
+
+        n = read(fd, buf + len, size - len);
+
+        if (n <= 0) {
+            free(buf);
+            return;
+        }
+
+        len += n;
+        buf[len] = '\0';
+        end = strstr(buf, "\r\n\r\n");
+    }
+
+    *end = '\0';
+    body = end + 4;
+
+    value = strcasestr(buf, "\r\nContent-Length:");
+
+    if (value != NULL) {
+        want = strtoul(value + 17, NULL, 10);
+    }
+
+    /* large request bodies wait for the go ahead */
+    if (strcasestr(buf, "\r\nExpect: 100-continue") != NULL) {
+        stub_write(fd, "HTTP/1.1 100 Continue\r\n\r\n", 25);
+    }
+
+    /* the rest of the body */
+    while ((size_t) (len - (body - buf)) < want) {
+        if (len == size) {
+            size *= 2;
+            n = body - buf;
+            buf = realloc(buf, size + 1);
+
+            if (buf == NULL) {
+                return;
+            }
+
+            body = buf + n;
+        }
+
+        n = read(fd, buf + len, size - len);
+
+        if (n <= 0) {
+            break;
+        }
+
+        len += n;
+    }
+
+    buf[len] = '\0';
+
+    /* request target from "METHOD /path HTTP/1.1" */
+    path = strchr(buf, ' ');
+
+    if (path != NULL) {
+        path++;
+        path[strcspn(path, " ")] = '\0';
+        handler(fd, path, body, data);
+    }
+
+    free(buf);
+    return;
+}
+
+/*
+ * Start a server on a loopback port and fill in httpd with the
+ * process and port.  Requests are handled by handler until
+ * stop_stub_httpd() is called.
+ */
+void start_stub_httpd(struct stub_httpd *httpd, stub_handler_fn handler, void *data)
+{
+    int s = -1;
+    int fd = -1;
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+
+    s = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (s == -1) {
+        err(EXIT_FAILURE, "*** socket");
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    if (bind(s, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+        err(EXIT_FAILURE, "*** bind");
+    }
+
+    if (listen(s, 64) == -1) {
+        err(EXIT_FAILURE, "*** listen");
+    }
+
+    if (getsockname(s, (struct sockaddr *) &addr, &addrlen) == -1) {
+        err(EXIT_FAILURE, "*** getsockname");
+    }
+
+    httpd->port = ntohs(addr.sin_port);
+    fflush(NULL);
+    httpd->pid = fork();
+
+    if (httpd->pid == -1) {
+        err(EXIT_FAILURE, "*** fork");
+    } else if (httpd->pid == 0) {
+        /* clients may hang up early */
+        signal(SIGPIPE, SIG_IGN);
+
+        while (1) {
+            fd = accept(s, NULL, NULL);
+
+            if (fd == -1) {
+                continue;
+            }
+
+            serve_request(fd, handler, data);
+            shutdown(fd, SHUT_WR);
+            close(fd);
+        }
+    }
+
+    close(s);
+    return;
+}
+
+/*
+ * Stop a server started with start_stub_httpd().
+ */
+void stop_stub_httpd(struct stub_httpd *httpd)
+{
+    if (httpd->pid > 0) {
+        kill(httpd->pid, SIGTERM);
+        waitpid(httpd->pid, NULL, 0);
+        httpd->pid = 0;
+    }
+
+    return;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifndef _LIBRPMINSPECT_TEST_STUB_HTTPD_H
+#define _LIBRPMINSPECT_TEST_STUB_HTTPD_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/*
+ * Called once per request with the connected socket.  path is the
+ * request target and body is the NUL terminated request body (empty
+ * for a GET).  The handler writes the complete response to fd.  Any
+ * state in data persists between requests since every connection
+ * is handled by the same server process.
+ */
+typedef void (*stub_handler_fn)(int fd, const char *path, const char *body, void *data);
+
+/* A running stub server */
+struct stub_httpd {
+    pid_t pid;
+    int port;
+};
+
+void start_stub_httpd(struct stub_httpd *httpd, stub_handler_fn handler, void *data);
+void stop_stub_httpd(struct stub_httpd *httpd);
+void stub_write(int fd, const char *buf, size_t len);
+void stub_reply(int fd, const int status, const char *body, const size_t len);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+static char tmpfile_path[] = "/tmp/test-checksums.XXXXXX";
+
+int init_test_checksums(void) {
+    int fd = mkstemp(tmpfile_path);
+
+    if (fd == -1) {
+        return -1;
+    }
+
+    if (write(fd, "abc", 3) != 3) {
+        close(fd);
+        return -1;
+    }
+
+    return close(fd);
+}
+
+int clean_test_checksums(void) {
+    return unlink(tmpfile_path);
+}
+
+void test_compute_checksum(void) {
+    ASSERT_AND_FREE(compute_checksum(tmpfile_path, NULL, MD5SUM), "900150983cd24fb0d6963f7d28e17f72");
+    ASSERT_AND_FREE(compute_checksum(tmpfile_path, NULL, SHA1SUM), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    ASSERT_AND_FREE(compute_checksum(tmpfile_path, NULL, SHA224SUM), "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7");
+    ASSERT_AND_FREE(compute_checksum(tmpfile_path, NULL, SHA256SUM), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    ASSERT_AND_FREE(compute_checksum(tmpfile_path, NULL, SHA384SUM), "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7");
+    ASSERT_AND_FREE(compute_checksum(tmpfile_path, NULL, SHA512SUM), "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+}
+
+void test_compute_checksums(void) {
+    int i = 0;
+    char *digests[NUM_CHECKSUMS] = { NULL };
+
+    /* several digests in one pass, the others are left alone */
+    RI_ASSERT_TRUE(compute_checksums(tmpfile_path, NULL, CHECKSUM_BIT(MD5SUM) | CHECKSUM_BIT(SHA256SUM), digests));
+    RI_ASSERT_STRING_EQUAL(digests[MD5SUM], "900150983cd24fb0d6963f7d28e17f72");
+    RI_ASSERT_STRING_EQUAL(digests[SHA256SUM], "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    RI_ASSERT_PTR_NULL(digests[SHA1SUM]);
+    RI_ASSERT_PTR_NULL(digests[SHA512SUM]);
+
+    for (i = 0; i < NUM_CHECKSUMS; i++) {
+        free(digests[i]);
+    }
+
+    RI_ASSERT_FALSE(compute_checksums("/nonexistent/test-checksums", NULL, CHECKSUM_BIT(MD5SUM), digests));
+}
+
+void test_get_digest_type(void) {
+    RI_ASSERT_EQUAL(get_digest_type("900150983cd24fb0d6963f7d28e17f72"), MD5SUM);
+    RI_ASSERT_EQUAL(get_digest_type("a9993e364706816aba3e25717850c26c9cd0d89d"), SHA1SUM);
+    RI_ASSERT_EQUAL(get_digest_type("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"), SHA256SUM);
+    RI_ASSERT_EQUAL(get_digest_type("*"), NULLSUM);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("checksums", init_test_checksums, clean_test_checksums);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test compute_checksum()", test_compute_checksum) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test compute_checksums()", test_compute_checksums) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test get_digest_type()", test_get_digest_type) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+#include "stub-httpd.h"
+
+/* files served by the stub download server */
+#define STUB_FILES      8
+
+static char tmpdir_path[] = "/tmp/test-curl.XXXXXX";
+static struct stub_httpd server;
+
+/*
+ * Size of stub file n.  Large and uneven enough that every transfer
+ * takes several reads on both ends.
+ */
+static size_t stub_file_size(const int n)
+{
+    return (65536 * (n + 1)) + n;
+}
+
+/*
+ * Fill buf with the contents of stub file n.
+ */
+static void stub_file_contents(const int n, char *buf, const size_t len)
+{
+    size_t i = 0;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = 'a' + ((i + n) % 26);
+    }
+
+    return;
+}
+
+/*
+ * A stub download server.  /files/N returns stub file N, /short
+ * closes the connection part way through the body, and anything
+ * else is a 404.
+ */
+static void download_server(int fd, const char *path, __attribute__((unused)) const char *body, __attribute__((unused)) void *data)
+{
+    int n = 0;
+    size_t len = 0;
+    char *buf = NULL;
+    char header[BUFSIZ];
+
+    if (sscanf(path, "/files/%d", &n) == 1 && n >= 0 && n < STUB_FILES) {
+        len = stub_file_size(n);
+        buf = malloc(len);
+
+        if (buf != NULL) {
+            stub_file_contents(n, buf, len);
+            stub_reply(fd, 200, buf, len);
+            free(buf);
+        }
+    } else if (!strcmp(path, "/short")) {
+        n = snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Length: 100000\r\nConnection: close\r\n\r\n");
+        stub_write(fd, header, n);
+        stub_write(fd, "truncated", 9);
+    } else {
+        stub_reply(fd, 404, "not found", 9);
+    }
+
+    return;
+}
+
+int init_test_curl(void) {
+    if (mkdtemp(tmpdir_path) == NULL) {
+        return -1;
+    }
+
+    start_stub_httpd(&server, download_server, NULL);
+    return 0;
+}
+
+int clean_test_curl(void) {
+    stop_stub_httpd(&server);
+    free_curl_share();
+    return rmtree(tmpdir_path, true, false);
+}
+
+/*
+ * Add a download of path from the server on port to list, saved as
+ * name in the temporary directory.
+ */
+static void add_download(pair_list_t *list, const int port, const char *path, const char *name)
+{
+    pair_entry_t *pair = NULL;
+
+    pair = xalloc(sizeof(*pair));
+    xasprintf(&pair->key, "http://127.0.0.1:%d%s", port, path);
+    xasprintf(&pair->value, "%s/%s", tmpdir_path, name);
+    TAILQ_INSERT_TAIL(list, pair, items);
+    return;
+}
+
+/*
+ * Check that name in the temporary directory holds stub file n.
+ */
+static void check_download(const char *name, const int n)
+{
+    off_t len = 0;
+    char *path = NULL;
+    char *buf = NULL;
+    char *expected = NULL;
+
+    xasprintf(&path, "%s/%s", tmpdir_path, name);
+    buf = read_file_bytes(path, &len);
+    RI_ASSERT_PTR_NOT_NULL(buf);
+
+    if (buf != NULL) {
+        RI_ASSERT_EQUAL(len, stub_file_size(n));
+
+        if ((size_t) len == stub_file_size(n)) {
+            expected = xalloc(len);
+            stub_file_contents(n, expected, len);
+            RI_ASSERT_EQUAL(memcmp(buf, expected, len), 0);
+            free(expected);
+        }
+
+        free(buf);
+    }
+
+    /* start clean for the next test */
+    unlink(path);
+    free(path);
+    return;
+}
+
+/*
+ * Check that a failed download left nothing behind.
+ */
+static void check_no_download(const char *name)
+{
+    char *path = NULL;
+
+    xasprintf(&path, "%s/%s", tmpdir_path, name);
+    RI_ASSERT_EQUAL(access(path, F_OK), -1);
+    free(path);
+    return;
+}
+
+/*
+ * Download a list mixing good files with a 404, a truncated body,
+ * and a server that is not there, max at a time.  The good files
+ * must arrive intact and the failed ones must be removed.
+ */
+static void get_files_with_errors(const long max)
+{
+    pair_list_t *list = NULL;
+    struct stub_httpd gone;
+
+    /* a port nothing is listening on */
+    start_stub_httpd(&gone, download_server, NULL);
+    stop_stub_httpd(&gone);
+
+    list = xalloc(sizeof(*list));
+    TAILQ_INIT(list);
+    add_download(list, server.port, "/files/0", "file0");
+    add_download(list, server.port, "/missing", "missing");
+    add_download(list, server.port, "/files/1", "file1");
+    add_download(list, server.port, "/short", "short");
+    add_download(list, gone.port, "/files/2", "refused");
+    add_download(list, server.port, "/files/3", "file3");
+
+    curl_get_files(false, list, max);
+
+    check_download("file0", 0);
+    check_download("file1", 1);
+    check_download("file3", 3);
+    check_no_download("missing");
+    check_no_download("short");
+    check_no_download("refused");
+
+    free_pair(list);
+    return;
+}
+
+void test_curl_get_files(void) {
+    int i = 0;
+    char path[BUFSIZ];
+    char name[BUFSIZ];
+    pair_list_t *list = NULL;
+
+    /* more files than transfer slots so the slots get reused */
+    list = xalloc(sizeof(*list));
+    TAILQ_INIT(list);
+
+    for (i = 0; i < STUB_FILES; i++) {
+        snprintf(path, sizeof(path), "/files/%d", i);
+        snprintf(name, sizeof(name), "file%d", i);
+        add_download(list, server.port, path, name);
+    }
+
+    curl_get_files(false, list, 3);
+
+    for (i = 0; i < STUB_FILES; i++) {
+        snprintf(name, sizeof(name), "file%d", i);
+        check_download(name, i);
+    }
+
+    free_pair(list);
+}
+
+void test_curl_get_files_errors(void) {
+    get_files_with_errors(3);
+}
+
+void test_curl_get_files_serial(void) {
+    get_files_with_errors(1);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("curl", init_test_curl, clean_test_curl);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test curl_get_files()", test_curl_get_files) == NULL ||
+        CU_add_test(pSuite, "test curl_get_files() failed downloads", test_curl_get_files_errors) == NULL ||
+        CU_add_test(pSuite, "test curl_get_files() serial downloads", test_curl_get_files_serial) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
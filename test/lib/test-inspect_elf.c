@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <elf.h>
 #include <CUnit/Basic.h>
 #include "rpminspect.h"
@@ -251,6 +252,36 @@ void test_is_pic_ok(void) {
     return;
 }
 
+void test_get_elf_facts(void) {
+    rpmfile_entry_t file;
+    const elf_facts_t *facts = NULL;
+    string_list_t *needed = NULL;
+
+    memset(&file, 0, sizeof(file));
+    file.fullpath = _BUILDDIR_"/execstack";
+
+    /* expect the facts to match the Elf object helpers */
+    facts = get_elf_facts(&file);
+    RI_ASSERT_PTR_NOT_NULL(facts);
+    RI_ASSERT_TRUE(facts->type == ET_EXEC || facts->type == ET_DYN);
+    RI_ASSERT_PTR_NOT_NULL(get_elf_facts_phdr(facts, PT_GNU_RELRO));
+    RI_ASSERT_PTR_NOT_NULL(get_elf_facts_phdr(facts, PT_GNU_STACK));
+    RI_ASSERT_TRUE(have_elf_facts_section(facts, SHT_DYNAMIC, ".dynamic"));
+    RI_ASSERT_FALSE(have_elf_facts_section(facts, -1, ".no-such-section"));
+    RI_ASSERT_PTR_NOT_NULL(facts->imported);
+
+    /* the program links with libc */
+    needed = get_elf_facts_tag_strings(facts, DT_NEEDED);
+    RI_ASSERT_PTR_NOT_NULL(needed);
+    list_free(needed, free);
+
+    /* expect the same facts on the second call */
+    RI_ASSERT(get_elf_facts(&file) == facts);
+
+    free_elf_facts(file.elf_facts);
+    return;
+}
+
 CU_pSuite get_suite(void) {
     CU_pSuite pSuite = NULL;
 
@@ -271,7 +302,8 @@ CU_pSuite get_suite(void) {
         CU_add_test(pSuite, "test has_bind_now()", test_has_bind_now) == NULL ||
         CU_add_test(pSuite, "test get_fortified_symbols()", test_get_fortified_symbols) == NULL ||
         CU_add_test(pSuite, "test get_fortifiable_symbols()", test_get_fortifiable_symbols) == NULL ||
-        CU_add_test(pSuite, "test is_pic_ok()", test_is_pic_ok) == NULL) {
+        CU_add_test(pSuite, "test is_pic_ok()", test_is_pic_ok) == NULL ||
+        CU_add_test(pSuite, "test get_elf_facts()", test_get_elf_facts) == NULL) {
         return NULL;
     }
 
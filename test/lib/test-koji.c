@@ -3,10 +3,20 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include <CUnit/Basic.h>
 #include "rpminspect.h"
 
 #include "test-main.h"
+#include "stub-httpd.h"
+
+/* module builds served by the stub hub, enough for several multiCall batches */
+#define STUB_BUILDS     250
+#define STUB_FIRST_ID   1000
 
 struct koji_build *build = NULL;
 koji_rpmlist_t *list = NULL;
@@ -19,6 +29,136 @@ int clean_test_koji(void) {
     return 0;
 }
 
+/*
+ * Return the next integer parameter in an XML-RPC request body and
+ * advance *p past it, or -1 if there are no more.
+ */
+static int next_int_param(const char **p)
+{
+    const char *i4 = strstr(*p, "<i4>");
+    const char *in = strstr(*p, "<int>");
+    const char *v = NULL;
+
+    if (i4 == NULL && in == NULL) {
+        return -1;
+    }
+
+    if (in == NULL || (i4 != NULL && i4 < in)) {
+        v = i4 + 4;
+    } else {
+        v = in + 5;
+    }
+
+    *p = v;
+    return atoi(v);
+}
+
+/*
+ * A stub Koji hub.  getBuild returns a module build whose tag holds
+ * STUB_BUILDS builds and multiCall answers listBuildRPMs with one
+ * RPM per build.  The RPM release is the number of calls in the
+ * multiCall batch that returned it.  A build ID passed in data gets
+ * a fault in place of its result.
+ */
+static void koji_hub(int fd, __attribute__((unused)) const char *path, const char *body, void *data)
+{
+    int i = 0;
+    int id = 0;
+    int ncalls = 0;
+    int fault_id = *(int *) data;
+    const char *p = NULL;
+    char *reply = NULL;
+    size_t len = 0;
+    FILE *fp = NULL;
+
+    fp = open_memstream(&reply, &len);
+    fprintf(fp, "<?xml version=\"1.0\"?><methodResponse><params><param><value>");
+
+    if (strstr(body, "<methodName>getBuild</methodName>")) {
+        fprintf(fp, "<struct>"
+                    "<member><name>id</name><value><int>1</int></value></member>"
+                    "<member><name>name</name><value><string>stub</string></value></member>"
+                    "<member><name>nvr</name><value><string>stub-1.0-1</string></value></member>"
+                    "<member><name>state</name><value><int>1</int></value></member>"
+                    "<member><name>extra</name><value><struct>"
+                    "<member><name>typeinfo</name><value><struct>"
+                    "<member><name>module</name><value><struct>"
+                    "<member><name>name</name><value><string>stub</string></value></member>"
+                    "<member><name>stream</name><value><string>1</string></value></member>"
+                    "<member><name>content_koji_tag</name><value><string>module-stub</string></value></member>"
+                    "<member><name>modulemd_str</name><value><string>document: modulemd</string></value></member>"
+                    "</struct></value></member>"
+                    "</struct></value></member>"
+                    "</struct></value></member>"
+                    "</struct>");
+    } else if (strstr(body, "<methodName>getLatestBuilds</methodName>")) {
+        fprintf(fp, "<array><data>");
+
+        for (i = 0; i < STUB_BUILDS; i++) {
+            fprintf(fp, "<value><struct>"
+                        "<member><name>build_id</name><value><int>%d</int></value></member>"
+                        "<member><name>name</name><value><string>pkg%d</string></value></member>"
+                        "</struct></value>", STUB_FIRST_ID + i, STUB_FIRST_ID + i);
+        }
+
+        fprintf(fp, "</data></array>");
+    } else if (strstr(body, "<methodName>multiCall</methodName>")) {
+        for (p = body; next_int_param(&p) != -1; ncalls++);
+
+        fprintf(fp, "<array><data>");
+        p = body;
+
+        while ((id = next_int_param(&p)) != -1) {
+            if (id == fault_id) {
+                fprintf(fp, "<value><struct>"
+                            "<member><name>faultCode</name><value><int>1000</int></value></member>"
+                            "<member><name>faultString</name><value><string>no build %d</string></value></member>"
+                            "</struct></value>", id);
+                continue;
+            }
+
+            fprintf(fp, "<value><array><data><value><array><data><value><struct>"
+                        "<member><name>arch</name><value><string>x86_64</string></value></member>"
+                        "<member><name>name</name><value><string>pkg%d</string></value></member>"
+                        "<member><name>version</name><value><string>1.0</string></value></member>"
+                        "<member><name>release</name><value><string>%d</string></value></member>"
+                        "<member><name>epoch</name><value><int>0</int></value></member>"
+                        "<member><name>size</name><value><int>%d</int></value></member>"
+                        "</struct></value></data></array></value></data></array></value>", id, ncalls, id);
+        }
+
+        fprintf(fp, "</data></array>");
+    } else {
+        fprintf(fp, "<nil/>");
+    }
+
+    fprintf(fp, "</value></param></params></methodResponse>");
+    fclose(fp);
+    stub_reply(fd, 200, reply, len);
+    free(reply);
+    return;
+}
+
+/*
+ * Look up the stub module build from the stub hub on port.
+ */
+static struct koji_build *get_stub_build(const int port)
+{
+    struct rpminspect *ri = NULL;
+    struct koji_build *kb = NULL;
+
+    ri = calloc(1, sizeof(*ri));
+    RI_ASSERT_PTR_NOT_NULL(ri);
+    xasprintf(&ri->kojihub, "http://127.0.0.1:%d/kojihub", port);
+
+    kb = get_koji_build(ri, "stub-1.0-1");
+
+    free_koji_client();
+    free(ri->kojihub);
+    free(ri);
+    return kb;
+}
+
 void test_init_koji_build(void) {
     build = calloc(1, sizeof(*build));
     RI_ASSERT_PTR_NOT_NULL(build);
@@ -31,6 +171,81 @@ void test_init_koji_rpmlist(void) {
     RI_ASSERT_PTR_NOT_NULL(list);
 }
 
+void test_get_koji_build_multicall(void) {
+    int i = 0;
+    int nrpms = 0;
+    int fault_id = -1;
+    unsigned long total = 0;
+    char *name = NULL;
+    char *batch = NULL;
+    struct stub_httpd hub;
+    struct koji_build *kb = NULL;
+    koji_buildlist_entry_t *entry = NULL;
+    koji_rpmlist_entry_t *rpm = NULL;
+
+    start_stub_httpd(&hub, koji_hub, &fault_id);
+    kb = get_stub_build(hub.port);
+    stop_stub_httpd(&hub);
+    RI_ASSERT_PTR_NOT_NULL(kb);
+
+    if (kb == NULL) {
+        return;
+    }
+
+    RI_ASSERT_STRING_EQUAL(kb->module_content_koji_tag, "module-stub");
+
+    /* every build gets its own RPMs back, in order, across batches */
+    TAILQ_FOREACH(entry, kb->builds, builditems) {
+        RI_ASSERT_EQUAL(entry->build_id, STUB_FIRST_ID + i);
+        nrpms = 0;
+
+        TAILQ_FOREACH(rpm, entry->rpms, items) {
+            xasprintf(&name, "pkg%d", entry->build_id);
+            RI_ASSERT_STRING_EQUAL(rpm->name, name);
+            free(name);
+
+            /* the first two batches are full, the last has the rest */
+            xasprintf(&batch, "%d", (i < 2 * KOJI_MULTICALL_SIZE) ? KOJI_MULTICALL_SIZE : STUB_BUILDS - (2 * KOJI_MULTICALL_SIZE));
+            RI_ASSERT_STRING_EQUAL(rpm->release, batch);
+            free(batch);
+
+            nrpms++;
+        }
+
+        RI_ASSERT_EQUAL(nrpms, 1);
+        total += STUB_FIRST_ID + i;
+        i++;
+    }
+
+    RI_ASSERT_EQUAL(i, STUB_BUILDS);
+    RI_ASSERT_EQUAL(kb->total_size, total);
+    free_koji_build(kb);
+}
+
+void test_get_koji_build_multicall_fault(void) {
+    int status = 0;
+    int fault_id = STUB_FIRST_ID + KOJI_MULTICALL_SIZE + (KOJI_MULTICALL_SIZE / 2);
+    pid_t pid = 0;
+    struct stub_httpd hub;
+
+    start_stub_httpd(&hub, koji_hub, &fault_id);
+
+    /* a fault in the middle of a batch is fatal */
+    fflush(NULL);
+    pid = fork();
+    RI_ASSERT_NOT_EQUAL(pid, -1);
+
+    if (pid == 0) {
+        get_stub_build(hub.port);
+        _exit(EXIT_SUCCESS);
+    }
+
+    RI_ASSERT_EQUAL(waitpid(pid, &status, 0), pid);
+    stop_stub_httpd(&hub);
+    RI_ASSERT_TRUE(WIFEXITED(status));
+    RI_ASSERT_EQUAL(WEXITSTATUS(status), RI_PROGRAM_ERROR);
+}
+
 CU_pSuite get_suite(void) {
     CU_pSuite pSuite = NULL;
 
@@ -42,7 +257,9 @@ CU_pSuite get_suite(void) {
 
     /* add tests to the suite */
     if (CU_add_test(pSuite, "test init_koji_build()", test_init_koji_build) == NULL ||
-        CU_add_test(pSuite, "test init_koji_rpmlist()", test_init_koji_rpmlist) == NULL) {
+        CU_add_test(pSuite, "test init_koji_rpmlist()", test_init_koji_rpmlist) == NULL ||
+        CU_add_test(pSuite, "test get_koji_build() multiCall batches", test_get_koji_build_multicall) == NULL ||
+        CU_add_test(pSuite, "test get_koji_build() multiCall fault", test_get_koji_build_multicall_fault) == NULL) {
         return NULL;
     }
 
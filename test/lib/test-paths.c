@@ -0,0 +1,87 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+int init_test_paths(void) {
+    return 0;
+}
+
+int clean_test_paths(void) {
+    return 0;
+}
+
+void test_match_path(void) {
+    /* exact and fnmatch(3) matches */
+    RI_ASSERT_TRUE(match_path("/usr/bin/foo", NULL, "/usr/bin/foo"));
+    RI_ASSERT_TRUE(match_path("/usr/bin/*", NULL, "/usr/bin/foo"));
+    RI_ASSERT_TRUE(match_path("/usr/*/foo", NULL, "/usr/lib/x/foo"));
+    RI_ASSERT_FALSE(match_path("/usr/bin/foo", NULL, "/usr/bin/food"));
+
+    /* directory prefixes */
+    RI_ASSERT_TRUE(match_path("/usr/share/doc/", NULL, "/usr/share/doc/foo/README"));
+    RI_ASSERT_TRUE(match_path("/usr/share/doc/*", NULL, "/usr/share/doc/foo/README"));
+    RI_ASSERT_FALSE(match_path("/usr/share/doc/", NULL, "/usr/share/docs/README"));
+
+    /* GLOB_BRACE */
+    RI_ASSERT_TRUE(match_path("/usr/{lib,lib64}/*.so", NULL, "/usr/lib64/libfoo.so"));
+    RI_ASSERT_TRUE(match_path("/usr/{lib,lib64}/*.so", NULL, "/usr/lib/libfoo.so"));
+    RI_ASSERT_TRUE(match_path("/usr/lib/{a,{b,c}}.so", NULL, "/usr/lib/c.so"));
+    RI_ASSERT_FALSE(match_path("/usr/{lib,lib64}/*.so", NULL, "/usr/libexec/libfoo.so"));
+    RI_ASSERT_FALSE(match_path("/usr/{lib,lib64}/*.so", NULL, "/usr/lib/foo/libfoo.so"));
+
+    /* GLOB_PERIOD */
+    RI_ASSERT_TRUE(match_path("/etc/{skel,foo}/*", NULL, "/etc/skel/.bashrc"));
+
+    return;
+}
+
+void test_path_matcher(void) {
+    string_list_t *patterns = NULL;
+    path_matcher_t *matcher = NULL;
+
+    RI_ASSERT_PTR_NULL(compile_path_matcher(NULL));
+    RI_ASSERT_FALSE(path_matcher_match(NULL, "/usr/bin/foo"));
+
+    patterns = list_add(patterns, "/usr/bin/foo");
+    patterns = list_add(patterns, "/usr/share/doc/");
+    patterns = list_add(patterns, "/usr/{lib,lib64}/*.a");
+    matcher = compile_path_matcher(patterns);
+    RI_ASSERT_PTR_NOT_NULL(matcher);
+
+    RI_ASSERT_TRUE(path_matcher_match(matcher, "/usr/bin/foo"));
+    RI_ASSERT_TRUE(path_matcher_match(matcher, "/usr/share/doc/foo/README"));
+    RI_ASSERT_TRUE(path_matcher_match(matcher, "/usr/lib64/libfoo.a"));
+    RI_ASSERT_FALSE(path_matcher_match(matcher, "/usr/bin/bar"));
+    RI_ASSERT_FALSE(path_matcher_match(matcher, "/usr/lib64/libfoo.so"));
+
+    free_path_matcher(matcher);
+    list_free(patterns, free);
+
+    return;
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("paths", init_test_paths, clean_test_paths);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test match_path()", test_match_path) == NULL ||
+        CU_add_test(pSuite, "test path_matcher_match()", test_path_matcher) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -35,27 +35,27 @@ int clean_test_results(void) {
 void test_init_results(void) {
     ri->results = init_results();
     RI_ASSERT_PTR_NOT_NULL(ri->results);
-    RI_ASSERT_TRUE(TAILQ_EMPTY(ri->results));
+    RI_ASSERT_TRUE(TAILQ_EMPTY(&ri->results->entries));
     return;
 }
 
 void test_add_result_entry(void) {
     add_result_entry(&ri->results, &params_emptyrpm);
-    RI_ASSERT_FALSE(TAILQ_EMPTY(ri->results));
+    RI_ASSERT_FALSE(TAILQ_EMPTY(&ri->results->entries));
 
-    RI_ASSERT_STRING_EQUAL(NAME_EMPTYRPM, TAILQ_LAST(ri->results, results_s)->header);
-    RI_ASSERT_EQUAL(RESULT_DIAG, TAILQ_LAST(ri->results, results_s)->severity);
-    RI_ASSERT_EQUAL(WAIVABLE_BY_ANYONE, TAILQ_LAST(ri->results, results_s)->waiverauth);
+    RI_ASSERT_STRING_EQUAL(NAME_EMPTYRPM, TAILQ_LAST(&ri->results->entries, results_s)->header);
+    RI_ASSERT_EQUAL(RESULT_DIAG, TAILQ_LAST(&ri->results->entries, results_s)->severity);
+    RI_ASSERT_EQUAL(WAIVABLE_BY_ANYONE, TAILQ_LAST(&ri->results->entries, results_s)->waiverauth);
     return;
 }
 
 void test_add_result(void) {
     add_result(ri, &params_license);
-    RI_ASSERT_FALSE(TAILQ_EMPTY(ri->results));
+    RI_ASSERT_FALSE(TAILQ_EMPTY(&ri->results->entries));
 
-    RI_ASSERT_STRING_EQUAL(NAME_LICENSE, TAILQ_LAST(ri->results, results_s)->header);
-    RI_ASSERT_EQUAL(RESULT_SKIP, TAILQ_LAST(ri->results, results_s)->severity);
-    RI_ASSERT_EQUAL(WAIVABLE_BY_SECURITY, TAILQ_LAST(ri->results, results_s)->waiverauth);
+    RI_ASSERT_STRING_EQUAL(NAME_LICENSE, TAILQ_LAST(&ri->results->entries, results_s)->header);
+    RI_ASSERT_EQUAL(RESULT_SKIP, TAILQ_LAST(&ri->results->entries, results_s)->severity);
+    RI_ASSERT_EQUAL(WAIVABLE_BY_SECURITY, TAILQ_LAST(&ri->results->entries, results_s)->waiverauth);
     return;
 }
 
@@ -66,6 +66,59 @@ void test_suppressed_results(void) {
     return;
 }
 
+void test_write_read_results(void) {
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *fp = NULL;
+    results_t *copy = NULL;
+    results_entry_t *a = NULL;
+    results_entry_t *b = NULL;
+    severity_t worst = RESULT_NULL;
+
+    params_license.msg = "license message";
+    params_license.noun = "license noun";
+    add_result(ri, &params_license);
+
+    fp = open_memstream(&buf, &len);
+    RI_ASSERT_PTR_NOT_NULL(fp);
+    RI_ASSERT_TRUE(write_results(fp, ri->results));
+    fclose(fp);
+
+    copy = read_results(buf, len);
+    free(buf);
+    RI_ASSERT_PTR_NOT_NULL(copy);
+
+    b = TAILQ_FIRST(&copy->entries);
+
+    TAILQ_FOREACH(a, &ri->results->entries, items) {
+        RI_ASSERT_PTR_NOT_NULL(b);
+        RI_ASSERT_STRING_EQUAL(b->header, a->header);
+        RI_ASSERT_EQUAL(b->severity, a->severity);
+        RI_ASSERT_EQUAL(b->waiverauth, a->waiverauth);
+        RI_ASSERT_TRUE((a->msg == NULL && b->msg == NULL) || !strcmp(a->msg, b->msg));
+        RI_ASSERT_TRUE((a->noun == NULL && b->noun == NULL) || !strcmp(a->noun, b->noun));
+        RI_ASSERT_PTR_NULL(b->details);
+        b = TAILQ_NEXT(b, items);
+    }
+
+    RI_ASSERT_PTR_NULL(b);
+
+    /* merging appends in order and reports the worst severity */
+    worst = merge_results(&ri->results, copy);
+    RI_ASSERT_EQUAL(worst, RESULT_SKIP);
+    RI_ASSERT_STRING_EQUAL(TAILQ_LAST(&ri->results->entries, results_s)->msg, "license message");
+
+    /* the summary follows along */
+    RI_ASSERT_EQUAL(get_results_summary(ri->results, NAME_LICENSE)->worst, RESULT_SKIP);
+    RI_ASSERT_EQUAL(get_results_summary(ri->results, NAME_LICENSE)->count, 4);
+    RI_ASSERT_EQUAL(get_results_summary(ri->results, NAME_EMPTYRPM)->count, 2);
+    RI_ASSERT_PTR_NULL(get_results_summary(ri->results, NAME_UPSTREAM));
+
+    params_license.msg = NULL;
+    params_license.noun = NULL;
+    return;
+}
+
 CU_pSuite get_suite(void) {
     CU_pSuite pSuite = NULL;
 
@@ -79,7 +132,8 @@ CU_pSuite get_suite(void) {
     if (CU_add_test(pSuite, "test init_results()", test_init_results) == NULL ||
         CU_add_test(pSuite, "test add_result_entry()", test_add_result_entry) == NULL ||
         CU_add_test(pSuite, "test add_result()", test_add_result) == NULL ||
-        CU_add_test(pSuite, "test suppressed_results()", test_suppressed_results) == NULL) {
+        CU_add_test(pSuite, "test suppressed_results()", test_suppressed_results) == NULL ||
+        CU_add_test(pSuite, "test write_results() and read_results()", test_write_read_results) == NULL) {
         return NULL;
     }
 
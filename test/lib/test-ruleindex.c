@@ -0,0 +1,90 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+int init_test_ruleindex(void) {
+    return 0;
+}
+
+int clean_test_ruleindex(void) {
+    return 0;
+}
+
+void test_rule_index_find(void) {
+    rule_index_t *index = NULL;
+
+    index = new_rule_index(FNM_NOESCAPE);
+    rule_index_add(index, "/usr/bin/*", "glob");
+    rule_index_add(index, "/usr/bin/foo", "literal");
+    rule_index_add(index, "*.so", "suffix");
+
+    /* the first rule added wins, glob or not */
+    RI_ASSERT_STRING_EQUAL(rule_index_find(index, "/usr/bin/foo"), "glob");
+    RI_ASSERT_STRING_EQUAL(rule_index_find(index, "/usr/bin/bar"), "glob");
+
+    /* globs with no literal directory prefix match anywhere */
+    RI_ASSERT_STRING_EQUAL(rule_index_find(index, "/usr/lib64/libfoo.so"), "suffix");
+    RI_ASSERT_PTR_NULL(rule_index_find(index, "/usr/sbin/foo"));
+
+    free_rule_index(index);
+
+    /* a missing index never matches */
+    RI_ASSERT_PTR_NULL(rule_index_find(NULL, "/usr/bin/foo"));
+}
+
+void test_rule_index_find_all(void) {
+    size_t n = 0;
+    void **matches = NULL;
+    rule_index_t *index = NULL;
+
+    index = new_rule_index(FNM_NOESCAPE);
+    rule_index_add(index, "/usr/*/foo", "first");
+    rule_index_add(index, "/usr/bin/foo", "second");
+    rule_index_add(index, "/usr/bin/fo?", "third");
+    rule_index_add(index, "/etc/*", "fourth");
+
+    /* every match in the order the rules were added */
+    n = rule_index_find_all(index, "/usr/bin/foo", &matches);
+    RI_ASSERT_EQUAL(n, 3);
+    RI_ASSERT_STRING_EQUAL(matches[0], "first");
+    RI_ASSERT_STRING_EQUAL(matches[1], "second");
+    RI_ASSERT_STRING_EQUAL(matches[2], "third");
+    free(matches);
+
+    n = rule_index_find_all(index, "/usr/share/bar", &matches);
+    RI_ASSERT_EQUAL(n, 0);
+    RI_ASSERT_PTR_NULL(matches);
+
+    free_rule_index(index);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("ruleindex", init_test_ruleindex, clean_test_ruleindex);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test rule_index_find()", test_rule_index_find) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test rule_index_find_all()", test_rule_index_find_all) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
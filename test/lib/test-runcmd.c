@@ -0,0 +1,104 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+/* counts lines handed to the run_cmd_vp_lines() callback */
+struct line_count {
+    unsigned long lines;
+    char *last;
+};
+
+static void count_line(const char *line, void *data)
+{
+    struct line_count *count = data;
+
+    count->lines++;
+    free(count->last);
+    count->last = strdup(line);
+}
+
+int init_test_runcmd(void) {
+    return 0;
+}
+
+int clean_test_runcmd(void) {
+    return 0;
+}
+
+void test_run_cmd(void) {
+    int exitcode = -1;
+    char *output = NULL;
+
+    /* output and exit code, trailing newline trimmed */
+    output = run_cmd(&exitcode, NULL, "sh", "-c", "echo hello; exit 3", NULL);
+    RI_ASSERT_PTR_NOT_NULL(output);
+    RI_ASSERT_STRING_EQUAL(output, "hello");
+    RI_ASSERT_EQUAL(exitcode, 3);
+    free(output);
+
+    /* no output */
+    output = run_cmd(&exitcode, NULL, "true", NULL);
+    RI_ASSERT_PTR_NULL(output);
+    RI_ASSERT_EQUAL(exitcode, 0);
+}
+
+void test_run_cmd_large_output(void) {
+    int exitcode = -1;
+    char *output = NULL;
+
+    /* much more than one read's worth of output */
+    output = run_cmd(&exitcode, NULL, "seq", "1", "200000", NULL);
+    RI_ASSERT_PTR_NOT_NULL(output);
+    RI_ASSERT_EQUAL(exitcode, 0);
+    RI_ASSERT_EQUAL(strncmp(output, "1\n2\n3\n", 6), 0);
+    RI_ASSERT_STRING_EQUAL(strrchr(output, '\n') + 1, "200000");
+    RI_ASSERT_EQUAL(strlen(output), 1288894);
+    free(output);
+}
+
+void test_run_cmd_vp_lines(void) {
+    int exitcode = -1;
+    char *argv[] = { "sh", "-c", "seq 1 200000; printf partial", NULL };
+    struct line_count count = { 0, NULL };
+
+    run_cmd_vp_lines(&exitcode, NULL, argv, count_line, &count);
+    RI_ASSERT_EQUAL(exitcode, 0);
+    RI_ASSERT_EQUAL(count.lines, 200001);
+    RI_ASSERT_PTR_NOT_NULL(count.last);
+    RI_ASSERT_STRING_EQUAL(count.last, "partial");
+    free(count.last);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("runcmd", init_test_runcmd, clean_test_runcmd);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test run_cmd()", test_run_cmd) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test run_cmd() with large output", test_run_cmd_large_output) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test run_cmd_vp_lines()", test_run_cmd_vp_lines) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}